@@ -13,6 +13,7 @@
 #include "Linker/RawLinker.h"
 #include "Linker/ElfLinker.h"
 #include "InstructionSetV1/InstructionSetV1.h"
+#include "InstructionSetV1/InstructionSetV1Fixed.h"
 #include "Simd/SIMDInstructionSet.h"
 #include "InstructionSet.h"
 
@@ -35,6 +36,7 @@ static void Usage() {
     fmt::println("  -I <path>      Include path, specify multiple times for more");
     fmt::println("  -o <output>    Output filename (default: a.gnk)");
     fmt::println("  -t <raw | elf> Binary type (default: elf)");
+    fmt::println("  -f             Fixed width (32 bit) instruction encoding, no extensions");
     fmt::println("Ex:");
     fmt::println("  asm -o mybinary.bin -t raw mysource.asm");
     exit(1);
@@ -63,6 +65,9 @@ int main(int argc, const char **argv) {
                     }
                     break;
                 }
+                case 'f' :
+                    gnilk::vcpu::InstructionSetManager::Instance().SetInstructionSet<gnilk::vcpu::InstructionSetV1Fixed>();
+                    break;
                 case 'I' : {
                     std::filesystem::path incPath(argv[++i]);
                     if (!exists(incPath)) {
@@ -195,6 +200,9 @@ bool CompileData(const std::string &outFilename, const std::string_view &srcData
     if (!gnilk::vcpu::InstructionSetManager::Instance().HaveInstructionSet()) {
         gnilk::vcpu::InstructionSetManager::Instance().SetInstructionSet<gnilk::vcpu::InstructionSetV1>();
     }
+    if (!gnilk::vcpu::InstructionSetManager::Instance().HaveExtension(gnilk::vcpu::OperandCode::SIMD)) {
+        gnilk::vcpu::InstructionSetManager::Instance().RegisterExtension<gnilk::vcpu::InstructionSetSIMD>(gnilk::vcpu::OperandCode::SIMD);
+    }
 
     gnilk::assembler::Parser parser;
     gnilk::assembler::Compiler compiler;
@@ -0,0 +1,108 @@
+//
+// Created by gnilk on 19.10.26.
+//
+// Coherence benchmark - broadcast snooping (RamBus) vs directory (DirectoryRamBus)
+// Each core runs a mix of private and shared accesses, we count the number of bus messages and snoop callbacks.
+//
+// Note: Must be built with GNK_CPU_NUM_CORES >= 16 (see CMakeLists.txt)
+//
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "fmt/format.h"
+#include "DurationTimer.h"
+#include "System.h"
+#include "MemorySubSys/CacheController.h"
+#include "MemorySubSys/DirectoryRamBus.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+static_assert(GNK_CPU_NUM_CORES >= 16, "Coherence benchmark needs GNK_CPU_NUM_CORES >= 16");
+
+static const size_t NUM_ITERATIONS = 200'000;
+static const uint64_t PRIVATE_BASE = 0x4000;
+static const size_t PRIVATE_SIZE = 0x400;       // per core
+static const uint64_t SHARED_BASE = 0x0000;
+static const size_t SHARED_SIZE = 0x400;
+
+static MemoryRegionConfiguration snoopConfig[] = {
+        {
+                .regionFlags = kMemRegion_Default_Ram,
+                .vAddrStart = 0x00,
+                .sizeBytes = 65535,
+                .coherence = kCoherenceMode::Snooping,
+        },
+};
+static MemoryRegionConfiguration directoryConfig[] = {
+        {
+                .regionFlags = kMemRegion_Default_Ram,
+                .vAddrStart = 0x00,
+                .sizeBytes = 65535,
+                .coherence = kCoherenceMode::Directory,
+        },
+};
+
+struct BenchResult {
+    double seconds;
+    uint64_t messages;
+    uint64_t snoops;
+};
+
+// Simple LCG - we want the same access pattern for both runs
+static uint32_t NextRandom(uint32_t &state) {
+    state = state * 1664525 + 1013904223;
+    return state >> 8;
+}
+
+static BenchResult RunBench(std::span<MemoryRegionConfiguration> config, size_t numCores) {
+    SoC::Instance().CreateMemoryRegionsFromConfig(config);
+    auto bus = std::static_pointer_cast<MesiBusBase>(SoC::Instance().GetMemoryRegionFromAddress(0).bus);
+
+    std::vector<std::unique_ptr<CacheController>> cores;
+    for(size_t i=0;i<numCores;i++) {
+        auto controller = std::make_unique<CacheController>();
+        controller->Initialize(i);
+        cores.push_back(std::move(controller));
+    }
+    bus->ResetStatistics();
+
+    uint32_t rndState = 4711;
+    DurationTimer timer;
+    for(size_t i=0;i<NUM_ITERATIONS;i++) {
+        auto idxCore = i % numCores;
+        auto &core = cores[idxCore];
+        auto rnd = NextRandom(rndState);
+        auto op = rnd % 100;
+        if (op < 70) {
+            // private read
+            core->Read<uint32_t>(PRIVATE_BASE + idxCore * PRIVATE_SIZE + ((rnd >> 7) % PRIVATE_SIZE));
+        } else if (op < 90) {
+            // shared read
+            core->Read<uint32_t>(SHARED_BASE + ((rnd >> 7) % SHARED_SIZE));
+        } else {
+            // shared write
+            core->Write<uint32_t>(SHARED_BASE + ((rnd >> 7) % SHARED_SIZE), rnd);
+        }
+    }
+    auto tElapsed = timer.Sample();
+
+    return {
+        .seconds = tElapsed,
+        .messages = bus->GetStatistics().messages,
+        .snoops = bus->GetStatistics().snoops,
+    };
+}
+
+int main(int argc, char **argv) {
+    fmt::println("Coherence benchmark, {} iterations", NUM_ITERATIONS);
+    fmt::println("cores  mode       time(ms)  messages   snoops     snoops/msg");
+    for(auto numCores : {4, 8, 16}) {
+        auto resSnoop = RunBench(snoopConfig, numCores);
+        auto resDir = RunBench(directoryConfig, numCores);
+        fmt::println("{:<6} snooping   {:<9.2f} {:<10} {:<10} {:.2f}", numCores, resSnoop.seconds * 1000.0, resSnoop.messages, resSnoop.snoops, double(resSnoop.snoops) / double(resSnoop.messages));
+        fmt::println("{:<6} directory  {:<9.2f} {:<10} {:<10} {:.2f}", numCores, resDir.seconds * 1000.0, resDir.messages, resDir.snoops, double(resDir.snoops) / double(resDir.messages));
+    }
+    return 0;
+}
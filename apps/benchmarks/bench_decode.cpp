@@ -0,0 +1,132 @@
+//
+// Created by gnilk on 19.10.26.
+//
+// Decode benchmark - variable length (v1) vs fixed width encoding
+// The same program is assembled with both encodings, we measure code size, decode time (decoder only, no execution)
+// and the time per instruction when running it.
+//
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "fmt/format.h"
+#include "DurationTimer.h"
+#include "VirtualCPU.h"
+#include "InstructionSet.h"
+#include "InstructionSetV1/InstructionSetV1.h"
+#include "InstructionSetV1/InstructionSetV1Fixed.h"
+#include "Compiler/Compiler.h"
+#include "Parser/Parser.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+static const size_t NUM_DECODE_PASSES = 20'000;
+
+static const char srcCode[] = {
+    "  .code \n"\
+    "   .org 0x0000 \n"\
+    "   move.l d0, 2000\n"\
+    "   move.l d1, 0\n"\
+    "   lea a0, values\n"\
+    "lp: \n"\
+    "   move.b d2, 0x12\n"\
+    "   move.w d3, 0x1234\n"\
+    "   move.d d4, 0x12345678\n"\
+    "   add.l d5, d2\n"\
+    "   move.d d6, (a0+4)\n"\
+    "   move.b d7, (a0+d2<<0)\n"\
+    "   and.w d3, 0xff\n"\
+    "   add.l d1, 1\n"\
+    "   blt.l d1, d0, lp\n"\
+    "   brk\n"\
+    "values: \n"\
+    "   dc.d 0, 0x11223344\n"\
+    ""
+};
+
+static uint8_t ram[512*1024] = {};
+
+struct BenchResult {
+    size_t codeSize;            // up to and including 'brk'
+    size_t numInstr;
+    double decodeNsPerInstr;
+    double runNsPerInstr;
+    size_t numExecuted;
+};
+
+template<typename TInstrSet>
+static bool RunBench(BenchResult &outResult) {
+    InstructionSetManager::Instance().SetInstructionSet<TInstrSet>();
+
+    assembler::Parser parser;
+    assembler::Compiler compiler;
+    auto ast = parser.ProduceAST(srcCode);
+    if ((ast == nullptr) || !compiler.CompileAndLink(ast)) {
+        fmt::println(stderr, "Failed to compile");
+        return false;
+    }
+    auto &data = compiler.Data();
+    memset(ram, 0, sizeof(ram));
+    memcpy(ram, data.data(), data.size());
+
+    VirtualCPU cpu;
+    cpu.QuickStart(ram, sizeof(ram));
+
+    // Decoder only - walk the code linearly (branches are decoded, not taken) until 'brk'
+    auto decoderRef = InstructionSetManager::Instance().GetInstructionSet().CreateDecoder(0);
+    auto &decoder = dynamic_cast<InstructionSetV1Decoder &>(*decoderRef);
+    size_t numDecoded = 0;
+    DurationTimer timer;
+    for(size_t pass=0;pass<NUM_DECODE_PASSES;pass++) {
+        cpu.SetInstrPtr(0);
+        while(true) {
+            decoder.Reset();
+            while(!decoder.IsFinished()) {
+                if (!decoder.Tick(cpu)) {
+                    fmt::println(stderr, "Decode failed at {:#x}", decoder.GetInstrStartOfs());
+                    return false;
+                }
+            }
+            numDecoded++;
+            if (decoder.code.opCode == OperandCode::BRK) {
+                break;
+            }
+        }
+    }
+    auto tDecode = timer.Sample();
+    outResult.numInstr = numDecoded / NUM_DECODE_PASSES;
+    outResult.codeSize = cpu.GetInstrPtr().data.longword;
+    outResult.decodeNsPerInstr = (tDecode * 1'000'000'000.0) / static_cast<double>(numDecoded);
+
+    // Full run, decode and execute
+    cpu.QuickStart(ram, sizeof(ram));
+    size_t numExecuted = 0;
+    timer.Reset();
+    while(!cpu.IsHalted()) {
+        cpu.Step();
+        numExecuted++;
+    }
+    auto tRun = timer.Sample();
+    outResult.numExecuted = numExecuted;
+    outResult.runNsPerInstr = (tRun * 1'000'000'000.0) / static_cast<double>(numExecuted);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    BenchResult resVariable = {};
+    BenchResult resFixed = {};
+    if (!RunBench<InstructionSetV1>(resVariable) || !RunBench<InstructionSetV1Fixed>(resFixed)) {
+        return 1;
+    }
+    InstructionSetManager::Instance().SetInstructionSet<InstructionSetV1>();
+
+    fmt::println("Decode benchmark, {} decode passes", NUM_DECODE_PASSES);
+    fmt::println("encoding  instr  bytes  bytes/instr  decode(ns/instr)  executed  run(ns/instr)");
+    for(auto &[name, res] : {std::pair{"variable", resVariable}, std::pair{"fixed32", resFixed}}) {
+        fmt::println("{:<9} {:<6} {:<6} {:<12.2f} {:<17.1f} {:<9} {:.1f}", name, res.numInstr, res.codeSize,
+                     static_cast<double>(res.codeSize) / static_cast<double>(res.numInstr),
+                     res.decodeNsPerInstr, res.numExecuted, res.runNsPerInstr);
+    }
+    return 0;
+}
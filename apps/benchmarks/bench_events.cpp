@@ -0,0 +1,102 @@
+//
+// Created by gnilk on 19.10.26.
+//
+// Peripheral update benchmark - polling every peripheral per cycle vs the discrete event scheduler
+// Each peripheral wants to do some work with a fixed period (in cycles), we measure the overhead per emulated cycle.
+//
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "fmt/format.h"
+#include "DurationTimer.h"
+#include "Peripheral.h"
+#include "EventScheduler.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+static const uint64_t NUM_CYCLES = 20'000;
+
+// This is how UpdatePeripherals used to work, every peripheral is asked every cycle
+class PolledPeripheral : public Peripheral {
+public:
+    PolledPeripheral(uint64_t newPeriod) : period(newPeriod), nextCycle(newPeriod) {}
+    bool Update() override {
+        cycle++;
+        if (cycle < nextCycle) {
+            return false;
+        }
+        nextCycle += period;
+        nServiced++;
+        return true;
+    }
+public:
+    uint64_t period;
+    uint64_t nextCycle;
+    uint64_t cycle = 0;
+    uint64_t nServiced = 0;
+};
+
+struct BenchResult {
+    double seconds;
+    uint64_t nServiced;
+};
+
+static BenchResult RunPolled(size_t numPeripherals) {
+    std::vector<std::unique_ptr<Peripheral>> peripherals;
+    for(size_t i=0;i<numPeripherals;i++) {
+        peripherals.push_back(std::make_unique<PolledPeripheral>(1000 + (i * 7) % 9000));
+    }
+
+    DurationTimer timer;
+    for(uint64_t cycle=1;cycle<=NUM_CYCLES;cycle++) {
+        for(auto &p : peripherals) {
+            p->Update();
+        }
+    }
+    auto tElapsed = timer.Sample();
+
+    uint64_t nServiced = 0;
+    for(auto &p : peripherals) {
+        nServiced += static_cast<PolledPeripheral *>(p.get())->nServiced;
+    }
+    return {.seconds = tElapsed, .nServiced = nServiced};
+}
+
+static BenchResult RunScheduled(size_t numPeripherals) {
+    EventScheduler scheduler;
+    uint64_t nServiced = 0;
+
+    // Periodic - the handler puts itself back in the queue
+    std::vector<EventScheduler::EventHandler> handlers(numPeripherals);
+    for(size_t i=0;i<numPeripherals;i++) {
+        uint64_t period = 1000 + (i * 7) % 9000;
+        handlers[i] = [&, i, period](uint64_t cycle) {
+            nServiced++;
+            scheduler.Schedule(cycle + period, handlers[i]);
+        };
+        scheduler.Schedule(period, handlers[i]);
+    }
+
+    DurationTimer timer;
+    for(uint64_t cycle=1;cycle<=NUM_CYCLES;cycle++) {
+        if (scheduler.IsDue(cycle)) {
+            scheduler.RunUntil(cycle);
+        }
+    }
+    auto tElapsed = timer.Sample();
+    return {.seconds = tElapsed, .nServiced = nServiced};
+}
+
+int main(int argc, char **argv) {
+    fmt::println("Peripheral update benchmark, {} cycles", NUM_CYCLES);
+    fmt::println("peripherals  mode       time(ms)  ns/cycle  serviced");
+    for(auto numPeripherals : {1, 100, 1000, 10000}) {
+        auto resPolled = RunPolled(numPeripherals);
+        auto resScheduled = RunScheduled(numPeripherals);
+        fmt::println("{:<12} polled     {:<9.2f} {:<9.1f} {}", numPeripherals, resPolled.seconds * 1000.0, resPolled.seconds * 1e9 / NUM_CYCLES, resPolled.nServiced);
+        fmt::println("{:<12} scheduled  {:<9.2f} {:<9.1f} {}", numPeripherals, resScheduled.seconds * 1000.0, resScheduled.seconds * 1e9 / NUM_CYCLES, resScheduled.nServiced);
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+//
+// Created by gnilk on 19.10.26.
+//
+// Ping-pong benchmark - MESI vs MOESI vs MESIF
+// Two cores take turns incrementing a set of shared counters (classic producer/consumer hand-over).
+// We count the lines written to and read from memory and the number of cache-to-cache transfers.
+//
+#include <stdint.h>
+#include <memory>
+
+#include "fmt/format.h"
+#include "DurationTimer.h"
+#include "System.h"
+#include "MemorySubSys/CacheController.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+static const size_t NUM_ITERATIONS = 200'000;
+static const size_t NUM_COUNTERS = 4;           // each on it's own line
+static const uint64_t COUNTER_BASE = 0x1000;
+
+struct BenchResult {
+    double seconds;
+    uint32_t finalValue;
+    MesiBusBase::Statistics stats;
+};
+
+static BenchResult RunBench(kCoherenceProtocol protocol) {
+    SoC::Instance().SetCoherenceProtocol(protocol);
+    SoC::Instance().Reset();
+    auto bus = std::static_pointer_cast<MesiBusBase>(SoC::Instance().GetMemoryRegionFromAddress(COUNTER_BASE).bus);
+
+    CacheController ping;
+    CacheController pong;
+    ping.Initialize(0);
+    pong.Initialize(1);
+    bus->ResetStatistics();
+
+    DurationTimer timer;
+    for(size_t i=0;i<NUM_ITERATIONS;i++) {
+        auto &core = (i & 1) ? pong : ping;
+        // Both cores touch the same counter before we move to the next
+        auto address = COUNTER_BASE + ((i >> 1) % NUM_COUNTERS) * GNK_L1_CACHE_LINE_SIZE;
+        auto value = core.Read<uint32_t>(address);
+        core.Write<uint32_t>(address, value + 1);
+    }
+    auto tElapsed = timer.Sample();
+
+    uint32_t finalValue = 0;
+    for(size_t i=0;i<NUM_COUNTERS;i++) {
+        finalValue += ping.Read<uint32_t>(COUNTER_BASE + i * GNK_L1_CACHE_LINE_SIZE);
+    }
+
+    return {
+        .seconds = tElapsed,
+        .finalValue = finalValue,
+        .stats = bus->GetStatistics(),
+    };
+}
+
+int main(int argc, char **argv) {
+    fmt::println("Ping-pong benchmark, {} iterations, {} counters", NUM_ITERATIONS, NUM_COUNTERS);
+    fmt::println("protocol  time(ms)  mem writes  mem reads   c2c         sum");
+
+    auto resMESI = RunBench(kCoherenceProtocol::MESI);
+    auto resMOESI = RunBench(kCoherenceProtocol::MOESI);
+    auto resMESIF = RunBench(kCoherenceProtocol::MESIF);
+    SoC::Instance().SetCoherenceProtocol(kCoherenceProtocol::MESI);
+
+    for(auto &[name, res] : {std::pair{"MESI", resMESI}, std::pair{"MOESI", resMOESI}, std::pair{"MESIF", resMESIF}}) {
+        fmt::println("{:<9} {:<9.2f} {:<11} {:<11} {:<11} {}", name, res.seconds * 1000.0, res.stats.lineWrites, res.stats.lineReads, res.stats.cacheToCache, res.finalValue);
+    }
+    fmt::println("MOESI saved {} memory writes, MESIF saved {} memory reads (vs MESI)",
+                 int64_t(resMESI.stats.lineWrites) - int64_t(resMOESI.stats.lineWrites),
+                 int64_t(resMESI.stats.lineReads) - int64_t(resMESIF.stats.lineReads));
+    return 0;
+}
@@ -0,0 +1,177 @@
+//
+// Created by gnilk on 19.10.26.
+//
+// Posit benchmark - fp8/fp16 through the posit library vs the lookup tables (SIMDPositTables) and the kernels
+// the SIMD extension uses (scalar and best host level).
+// Every variant must produce the same bits as the library, mismatches are counted.
+//
+#include <stdint.h>
+#include <vector>
+#include <random>
+#include <string.h>
+
+#include "fmt/format.h"
+#include "DurationTimer.h"
+#include "Simd/SIMDInstructionSetDef.h"
+#include "Simd/SIMDPositTables.h"
+#include "Simd/SIMDKernels.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+static const size_t NUM_VALUES = 1'000'000;     // multiple of 16
+static const size_t NUM_ROUNDS = 20;            // DurationTimer has ms resolution
+
+struct BenchResult {
+    double seconds;
+    size_t nMismatch;
+};
+
+static void PrintResult(const char *name, const char *variant, const BenchResult &result, const BenchResult &reference) {
+    fmt::println("{:<16} {:<12} {:<9.2f} {:<8.2f} {:<8.1f} {}", name, variant, result.seconds * 1000.0, result.seconds * 1e9 / (NUM_VALUES * NUM_ROUNDS),
+                 reference.seconds / result.seconds, result.nMismatch);
+}
+
+template<typename TRaw>
+static BenchResult RunEncodeLib(std::vector<TRaw> &out, const std::vector<float> &values, TRaw (*encode)(float)) {
+    DurationTimer timer;
+    for(size_t round=0;round<NUM_ROUNDS;round++) {
+        for(size_t i=0;i<values.size();i++) {
+            out[i] = encode(values[i]);
+        }
+    }
+    return {.seconds = timer.Sample(), .nMismatch = 0};
+}
+
+template<typename TRaw>
+static BenchResult RunEncodeKernel(const std::vector<TRaw> &expected, const std::vector<float> &values, void (*kernel)(TRaw *, const float *, size_t)) {
+    std::vector<TRaw> out(values.size());
+    // One register at a time, like the SIMD extension
+    static const size_t numLanes = 16 / sizeof(TRaw);
+    DurationTimer timer;
+    for(size_t round=0;round<NUM_ROUNDS;round++) {
+        for(size_t i=0;i<values.size();i+=numLanes) {
+            kernel(out.data() + i, values.data() + i, numLanes);
+        }
+    }
+    BenchResult result = {.seconds = timer.Sample(), .nMismatch = 0};
+    for(size_t i=0;i<values.size();i++) {
+        result.nMismatch += (out[i] != expected[i]) ? 1 : 0;
+    }
+    return result;
+}
+
+template<typename TRaw>
+static BenchResult RunDecodeLib(std::vector<float> &out, const std::vector<TRaw> &raw, float (*decode)(TRaw)) {
+    DurationTimer timer;
+    for(size_t round=0;round<NUM_ROUNDS;round++) {
+        for(size_t i=0;i<raw.size();i++) {
+            out[i] = decode(raw[i]);
+        }
+    }
+    return {.seconds = timer.Sample(), .nMismatch = 0};
+}
+
+template<typename TRaw>
+static BenchResult RunDecodeKernel(const std::vector<float> &expected, const std::vector<TRaw> &raw, void (*kernel)(float *, const TRaw *, size_t)) {
+    std::vector<float> out(raw.size());
+    static const size_t numLanes = 16 / sizeof(TRaw);
+    DurationTimer timer;
+    for(size_t round=0;round<NUM_ROUNDS;round++) {
+        for(size_t i=0;i<raw.size();i+=numLanes) {
+            kernel(out.data() + i, raw.data() + i, numLanes);
+        }
+    }
+    BenchResult result = {.seconds = timer.Sample(), .nMismatch = 0};
+    for(size_t i=0;i<raw.size();i++) {
+        // compare bits, NaR decodes to NaN
+        result.nMismatch += (memcmp(&out[i], &expected[i], sizeof(float)) != 0) ? 1 : 0;
+    }
+    return result;
+}
+
+static BenchResult RunMulFp8Lib(std::vector<int8_t> &out, const std::vector<int8_t> &a, const std::vector<int8_t> &b) {
+    DurationTimer timer;
+    for(size_t round=0;round<NUM_ROUNDS;round++) {
+        for(size_t i=0;i<a.size();i++) {
+            fp8 pa, pb;
+            memcpy(&pa, &a[i], 1);
+            memcpy(&pb, &b[i], 1);
+            fp8 res = pa * pb;
+            memcpy(&out[i], &res, 1);
+        }
+    }
+    return {.seconds = timer.Sample(), .nMismatch = 0};
+}
+
+static BenchResult RunMulFp8Kernel(const std::vector<int8_t> &expected, const std::vector<int8_t> &a, const std::vector<int8_t> &b, const SIMDKernels &kernels) {
+    std::vector<int8_t> out(a.size());
+    DurationTimer timer;
+    for(size_t round=0;round<NUM_ROUNDS;round++) {
+        for(size_t i=0;i<a.size();i+=16) {
+            kernels.MulFp8(out.data() + i, a.data() + i, b.data() + i);
+        }
+    }
+    BenchResult result = {.seconds = timer.Sample(), .nMismatch = 0};
+    for(size_t i=0;i<a.size();i++) {
+        result.nMismatch += (out[i] != expected[i]) ? 1 : 0;
+    }
+    return result;
+}
+
+int main(int argc, char **argv) {
+    DurationTimer timerTables;
+    SIMDPositTables::Instance();
+    fmt::println("Posit benchmark, {} values x {} rounds - tables built in {:.2f} ms", NUM_VALUES, NUM_ROUNDS, timerTables.Sample() * 1000.0);
+
+    auto &scalar = SIMDKernels::Get(SIMDKernelLevel::Scalar);
+    auto &host = SIMDKernels::Get();
+    auto hostName = (host.level == SIMDKernelLevel::AVX2) ? "avx2" : (host.level == SIMDKernelLevel::SSE42) ? "sse4.2" : "scalar";
+
+    // Mostly in the dense range around 1, some far out and a few special values
+    std::mt19937 rng(4711);
+    std::normal_distribution<float> dist(0.0f, 4.0f);
+    std::vector<float> values(NUM_VALUES);
+    for(auto &v : values) {
+        v = dist(rng);
+    }
+    values[0] = 0.0f;
+    values[1] = -0.0f;
+    values[2] = 1e30f;
+    values[3] = -1e-30f;
+
+    fmt::println("operation        variant      time(ms)  ns/value speedup  mismatch");
+
+    std::vector<int8_t> fp8Raw(NUM_VALUES);
+    auto libEnc8 = RunEncodeLib<int8_t>(fp8Raw, values, SIMDPositTables::LibFloatToFp8);
+    PrintResult("float->fp8", "library", libEnc8, libEnc8);
+    PrintResult("float->fp8", "scalar", RunEncodeKernel<int8_t>(fp8Raw, values, scalar.F32ToFp8), libEnc8);
+    PrintResult("float->fp8", hostName, RunEncodeKernel<int8_t>(fp8Raw, values, host.F32ToFp8), libEnc8);
+
+    std::vector<int16_t> fp16Raw(NUM_VALUES);
+    auto libEnc16 = RunEncodeLib<int16_t>(fp16Raw, values, SIMDPositTables::LibFloatToFp16);
+    PrintResult("float->fp16", "library", libEnc16, libEnc16);
+    PrintResult("float->fp16", "scalar", RunEncodeKernel<int16_t>(fp16Raw, values, scalar.F32ToFp16), libEnc16);
+    PrintResult("float->fp16", hostName, RunEncodeKernel<int16_t>(fp16Raw, values, host.F32ToFp16), libEnc16);
+
+    std::vector<float> decoded(NUM_VALUES);
+    auto libDec8 = RunDecodeLib<int8_t>(decoded, fp8Raw, SIMDPositTables::LibFp8ToFloat);
+    PrintResult("fp8->float", "library", libDec8, libDec8);
+    PrintResult("fp8->float", "scalar", RunDecodeKernel<int8_t>(decoded, fp8Raw, scalar.Fp8ToF32), libDec8);
+    PrintResult("fp8->float", hostName, RunDecodeKernel<int8_t>(decoded, fp8Raw, host.Fp8ToF32), libDec8);
+
+    auto libDec16 = RunDecodeLib<int16_t>(decoded, fp16Raw, SIMDPositTables::LibFp16ToFloat);
+    PrintResult("fp16->float", "library", libDec16, libDec16);
+    PrintResult("fp16->float", "scalar", RunDecodeKernel<int16_t>(decoded, fp16Raw, scalar.Fp16ToF32), libDec16);
+    PrintResult("fp16->float", hostName, RunDecodeKernel<int16_t>(decoded, fp16Raw, host.Fp16ToF32), libDec16);
+
+    // a * b with b being a - shifted one step
+    std::vector<int8_t> fp8RawB(fp8Raw.begin() + 1, fp8Raw.end());
+    fp8RawB.push_back(fp8Raw[0]);
+    std::vector<int8_t> product(NUM_VALUES);
+    auto libMul8 = RunMulFp8Lib(product, fp8Raw, fp8RawB);
+    PrintResult("fp8 mul", "library", libMul8, libMul8);
+    PrintResult("fp8 mul", "table", RunMulFp8Kernel(product, fp8Raw, fp8RawB, host), libMul8);
+
+    return 0;
+}
@@ -12,6 +12,7 @@
 #include "elfio/elfio.hpp"
 #include "InstructionSet.h"
 #include "InstructionSetV1/InstructionSetV1.h"
+#include "InstructionSetV1/InstructionSetV1Fixed.h"
 
 using namespace gnilk;
 using namespace gnilk::vcpu;
@@ -22,6 +23,7 @@ static gnilk::vcpu::VirtualCPU cpuemu;
 
 static uint64_t rawLoadToAddress = 0;
 static uint64_t rawStartAddress = 0;
+static bool useFixedEncoding = false;
 
 // 1024 pages is more than enough for simple testing...
 static uint8_t cpu_ram_memory[1024*VCPU_MMU_PAGE_SIZE] = {};    // 512kb of RAM for my CPU...
@@ -40,6 +42,7 @@ static void Usage() {
     fmt::println("Options:");
     fmt::println("  -d <num>     Load and Start to this address (default=0)");
     fmt::println("  -s <num>     Start at this address (default=0)");
+    fmt::println("  -f           Binary uses the fixed width (32 bit) instruction encoding");
     fmt::println("Example (load binary to address 0 but start from address 0x2000):");
     fmt::println("  emu -s 0x2000 mybinary.bin");
 }
@@ -68,6 +71,9 @@ int main(int argc, char **argv)  {
                         rawStartAddress = *tmp;
                     }
                     break;
+                case 'f' :
+                    useFixedEncoding = true;
+                    break;
                 case 'h' :
                 case '?' :
                     Usage();
@@ -90,7 +96,11 @@ int main(int argc, char **argv)  {
     }
 
     // Set the root instruction set
-    InstructionSetManager::Instance().SetInstructionSet<InstructionSetV1>();
+    if (useFixedEncoding) {
+        InstructionSetManager::Instance().SetInstructionSet<InstructionSetV1Fixed>();
+    } else {
+        InstructionSetManager::Instance().SetInstructionSet<InstructionSetV1>();
+    }
 
     // Now, initialize the CPU
     cpuemu.Begin(cpu_ram_memory, 1024 * VCPU_MMU_PAGE_SIZE);
@@ -279,8 +279,9 @@ bool Context::RelocateChunkFromUnit(CompileUnit &unit, Segment::DataChunk::Ref s
                     return false;
                 }
             } else {
+                // Relative to the end of the placeholder, which is the end of the instruction
                 int64_t offset = static_cast<int64_t>(identifier->absoluteAddress) - static_cast<int64_t>(resolvePoint.placeholderAddress);
-                offset -= 1;
+                offset -= static_cast<int64_t>(vcpu::ByteSizeOfOperandSize(resolvePoint.opSize));
                 if (!activeSegment->currentChunk->ReplaceAt(resolvePoint.placeholderAddress + loadAddress, offset, resolvePoint.opSize)) {
                     return false;
                 }
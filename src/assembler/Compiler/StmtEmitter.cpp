@@ -10,6 +10,8 @@
 #include "Identifiers.h"
 #include "StmtEmitter.h"
 #include "InstructionSet.h"
+#include "Simd/SIMDInstructionSetDef.h"
+#include "InstructionSetV1/InstructionSetV1FixedDef.h"
 
 //
 // 1) Process AST and make a flat list of EmitStatements -> this can and should be done in parallell
@@ -40,7 +42,11 @@ EmitStatementBase::Ref EmitStatementBase::Create(ast::Statement::Ref statement)
     } else if (statement->Kind() == ast::NodeType::kStructStatement) {
         ref = std::make_shared<EmitStructStatement>();
     } else if (IsCodeStatement(statement->Kind())) {
-        ref = std::make_shared<EmitCodeStatement>();
+        if (vcpu::InstructionSetManager::Instance().GetInstructionSet().GetDefinition().GetEncoding() == vcpu::InstructionEncoding::kFixed32) {
+            ref = std::make_shared<EmitFixedCodeStatement>();
+        } else {
+            ref = std::make_shared<EmitCodeStatement>();
+        }
     } else if (statement->Kind() == ast::NodeType::kCommentStatement){
         ref = std::make_shared<EmitCommentStatement>();
     } else if (statement->Kind() == ast::NodeType::kExportStatement) {
@@ -77,7 +83,9 @@ bool EmitStatementBase::IsDataStatement(ast::NodeType nodeType) {
 bool EmitStatementBase::IsCodeStatement(ast::NodeType nodeType) {
     if ((nodeType ==ast::NodeType::kNoOpInstrStatement) ||
             (nodeType == ast::NodeType::kOneOpInstrStatement) ||
-            (nodeType == ast::NodeType::kTwoOpInstrStatement)) {
+            (nodeType == ast::NodeType::kTwoOpInstrStatement) ||
+            (nodeType == ast::NodeType::kSimdInstrStatement) ||
+            (nodeType == ast::NodeType::kThreeOpInstrStatement)) {
         return true;
     }
     return false;
@@ -585,6 +593,10 @@ bool EmitCodeStatement::Process(gnilk::assembler::CompileUnit &context) {
         return ProcessOneOpInstrStmt(context, std::dynamic_pointer_cast<ast::OneOpInstrStatment>(statement));
     } else if (statement->Kind() == ast::NodeType::kTwoOpInstrStatement) {
         return ProcessTwoOpInstrStmt(context, std::dynamic_pointer_cast<ast::TwoOpInstrStatment>(statement));
+    } else if (statement->Kind() == ast::NodeType::kSimdInstrStatement) {
+        return ProcessSimdInstrStmt(context, std::dynamic_pointer_cast<ast::SimdInstrStatement>(statement));
+    } else if (statement->Kind() == ast::NodeType::kThreeOpInstrStatement) {
+        return ProcessThreeOpInstrStmt(context, std::dynamic_pointer_cast<ast::ThreeOpInstrStatement>(statement));
     }
     return false;
 }
@@ -660,6 +672,27 @@ bool EmitCodeStatement::ProcessNoOpInstrStmt(ast::NoOpInstrStatment::Ref stmt) {
 }
 
 
+// Memory operands are dereferences, '(a0)', or labels (not constants)
+static bool IsMemoryOperand(CompileUnit &context, ast::Expression::Ref operandExp) {
+    if (operandExp->Kind() == ast::NodeType::kDeRefExpression) {
+        return true;
+    }
+    if (operandExp->Kind() == ast::NodeType::kIdentifier) {
+        auto identifier = std::dynamic_pointer_cast<ast::Identifier>(operandExp);
+        return !context.HasConstant(identifier->Symbol());
+    }
+    return false;
+}
+
+// Cache maintenance/prefetch (cflush/cinval/cclean/prefetch) operate on an address - '(a0)' or a label
+static bool VerifyAddressOnlyOperand(CompileUnit &context, ast::OneOpInstrStatment::Ref stmt) {
+    if (IsMemoryOperand(context, stmt->Operand())) {
+        return true;
+    }
+    fmt::println(stderr, "Compiler, '{}' requires a memory operand", stmt->Symbol());
+    return false;
+}
+
 // FIXME: InstructionSet dependent?
 bool EmitCodeStatement::ProcessOneOpInstrStmt(CompileUnit &context, ast::OneOpInstrStatment::Ref stmt) {
     if (!EmitOpCodeForSymbol(stmt->Symbol())) {
@@ -675,6 +708,9 @@ bool EmitCodeStatement::ProcessOneOpInstrStmt(CompileUnit &context, ast::OneOpIn
     auto opClass = *instrSet.GetDefinition().GetOperandFromStr(stmt->Symbol());
     auto opDesc = *instrSet.GetDefinition().GetOpDescFromClass(opClass);
 
+    if ((opDesc.features & vcpu::OperandFeatureFlags::kFeature_AddressOnly) && !VerifyAddressOnlyOperand(context, stmt)) {
+        return false;
+    }
 
     if (!EmitInstrOperand(context, opDesc, opSize, stmt->Operand())) {
         return false;
@@ -691,6 +727,151 @@ bool EmitCodeStatement::ProcessOneOpInstrStmt(CompileUnit &context, ast::OneOpIn
     return true;
 }
 
+//
+// SIMD extension, see SIMDInstructionSetDef.h
+//   <ext> | <op code> | <op.size>|<addr mode> | <low flags>|<dst> | <srcA>|<srcB or mask>
+//
+// Registers are encoded with their number only (a0 and v0 are both 0), the addr mode tells if dst/srcA are address registers.
+//
+static std::unordered_map<std::string, uint8_t> simdOpSizes = {
+        {"fp8", vcpu::kSimdOpSize::kOpSize_Fp8},
+        {"fp16", vcpu::kSimdOpSize::kOpSize_Fp16},
+        {"fp32", vcpu::kSimdOpSize::kOpSize_Fp32},
+        {"fp64", vcpu::kSimdOpSize::kOpSize_Fp64},
+};
+static std::unordered_map<std::string, uint8_t> simdIntOpSizes = {
+        {"i8", vcpu::kSimdOpSize::kOpSize_Fp8},
+        {"i16", vcpu::kSimdOpSize::kOpSize_Fp16},
+        {"i32", vcpu::kSimdOpSize::kOpSize_Fp32},
+        {"i64", vcpu::kSimdOpSize::kOpSize_Fp64},
+};
+
+// Returns the register number if the expression is a register of the class ('v', 'a' or 'd'), -1 otherwise
+static int SimdRegisterIndex(ast::Expression::Ref expression, char regClass) {
+    if (expression->Kind() != ast::NodeType::kRegisterLiteral) {
+        return -1;
+    }
+    auto &symbol = std::dynamic_pointer_cast<ast::RegisterLiteral>(expression)->Symbol();
+    if ((symbol.size() < 2) || (symbol[0] != regClass)) {
+        return -1;
+    }
+    return strutil::to_int32(symbol.substr(1));
+}
+
+// '(aN)' - returns the address register number or -1
+static int SimdAddressRegisterIndex(ast::Expression::Ref expression) {
+    if (expression->Kind() != ast::NodeType::kDeRefExpression) {
+        return -1;
+    }
+    return SimdRegisterIndex(std::dynamic_pointer_cast<ast::DeReferenceExpression>(expression)->GetDeRefExp(), 'a');
+}
+
+bool EmitCodeStatement::ProcessSimdInstrStmt(CompileUnit &context, ast::SimdInstrStatement::Ref stmt) {
+    auto &simdDefinition = vcpu::InstructionSetManager::Instance().GetExtension(vcpu::OperandCode::SIMD).GetDefinition();
+    auto opClass = simdDefinition.GetOperandFromStr(stmt->Symbol());
+    if (!opClass.has_value()) {
+        fmt::println(stderr, "Compiler, unsupported SIMD instruction '{}'", stmt->Symbol());
+        return false;
+    }
+    auto opDesc = *simdDefinition.GetOpDescFromClass(*opClass);
+
+    uint8_t opSizeAndAddrMode = 0;
+    uint8_t lowFlags = 0;
+    if (simdOpSizes.contains(stmt->OpSize())) {
+        opSizeAndAddrMode = simdOpSizes[stmt->OpSize()];
+    } else if (simdIntOpSizes.contains(stmt->OpSize())) {
+        opSizeAndAddrMode = simdIntOpSizes[stmt->OpSize()];
+        lowFlags |= vcpu::kSimdOpLowFlags::kOpLowFlag_Integer;
+    } else {
+        fmt::println(stderr, "Compiler, unsupported SIMD size '{}' for '{}'", stmt->OpSize(), stmt->Symbol());
+        return false;
+    }
+
+    auto &operands = stmt->Operands();
+    if ((operands.size() < 2) || (operands.size() > 3)) {
+        fmt::println(stderr, "Compiler, '{}' requires two or three operands", stmt->Symbol());
+        return false;
+    }
+
+    // Destination, 'vN' or '(aN)'
+    int idxDst = SimdRegisterIndex(operands[0].expression, 'v');
+    if (idxDst < 0) {
+        idxDst = SimdAddressRegisterIndex(operands[0].expression);
+        opSizeAndAddrMode |= vcpu::kSimdAddrMode::kOpAddrMode_DstReg;
+    }
+    // Source A, 'vN' or '(aN)'
+    int idxSrcA = SimdRegisterIndex(operands[1].expression, 'v');
+    if (idxSrcA < 0) {
+        idxSrcA = SimdAddressRegisterIndex(operands[1].expression);
+        opSizeAndAddrMode |= vcpu::kSimdAddrMode::kOpAddrMode_SrcReg;
+    }
+    if ((idxDst < 0) || (idxSrcA < 0) || ((opSizeAndAddrMode & vcpu::kSimdFlagAddrRegBitMask) == vcpu::kSimdFlagAddrRegBitMask)) {
+        fmt::println(stderr, "Compiler, invalid operands for '{}' - expected vector registers and at most one '(aN)'", stmt->Symbol());
+        return false;
+    }
+    if ((opSizeAndAddrMode & vcpu::kSimdFlagAddrRegBitMask) && !(opDesc.features & vcpu::OperandFeatureFlags::kFeature_AddressRegister)) {
+        fmt::println(stderr, "Compiler, '{}' does not support address registers", stmt->Symbol());
+        return false;
+    }
+    if (operands[0].advance || operands[1].advance) {
+        if (!(opDesc.features & vcpu::OperandFeatureFlags::kFeature_Advance)) {
+            fmt::println(stderr, "Compiler, '{}' does not support advance", stmt->Symbol());
+            return false;
+        }
+        lowFlags |= vcpu::kSimdOpLowFlags::kOpLowFlag_Advance;
+    }
+
+    // Source B, 'dN' for the strided ops (the stride), otherwise 'vN' or a mask
+    int srcBOrMask = 0;
+    if (operands.size() > 2) {
+        auto &srcB = operands[2].expression;
+        bool isStrided = (*opClass == vcpu::SimdOpCode::LOADS) || (*opClass == vcpu::SimdOpCode::STORES);
+        srcBOrMask = SimdRegisterIndex(srcB, isStrided ? 'd' : 'v');
+        if ((srcBOrMask < 0) && (opDesc.features & vcpu::OperandFeatureFlags::kFeature_Mask)) {
+            auto mask = EvaluateConstantExpression(context, srcB);
+            if ((mask != nullptr) && (mask->Kind() == ast::NodeType::kNumericLiteral)) {
+                srcBOrMask = std::dynamic_pointer_cast<ast::NumericLiteral>(mask)->Value();
+            }
+        }
+        if ((srcBOrMask < 0) || (srcBOrMask > 15)) {
+            fmt::println(stderr, "Compiler, invalid third operand for '{}'", stmt->Symbol());
+            return false;
+        }
+    }
+
+    EmitByte(vcpu::OperandCode::SIMD);
+    EmitByte(*opClass);
+    EmitByte(opSizeAndAddrMode);
+    EmitByte(lowFlags | (idxDst & 0x0f));
+    EmitByte(((idxSrcA & 0x0f) << 4) | (srcBOrMask & 0x0f));
+    return true;
+}
+
+// Atomics (ldl/stc/cas) must have exactly one memory operand and one register operand
+static bool VerifyAtomicOperands(CompileUnit &context, ast::TwoOpInstrStatment::Ref twoOpInstr) {
+    auto dst = twoOpInstr->Dst();
+    auto src = twoOpInstr->Src();
+    if (IsMemoryOperand(context, dst) && (src->Kind() == ast::NodeType::kRegisterLiteral)) {
+        return true;
+    }
+    if (IsMemoryOperand(context, src) && (dst->Kind() == ast::NodeType::kRegisterLiteral)) {
+        return true;
+    }
+    fmt::println(stderr, "Compiler, '{}' requires one register and one memory operand", twoOpInstr->Symbol());
+    return false;
+}
+
+// Block operations (movs/fill) advance the address registers - dst is '(aN)', movs src likewise and fill src is a value
+static bool VerifyBlockOperands(const vcpu::OperandDescriptionBase &opDesc, ast::TwoOpInstrStatment::Ref twoOpInstr) {
+    bool isSrcValue = (opDesc.features & vcpu::OperandFeatureFlags::kFeature_Immediate);
+    bool isSrcDeRef = (twoOpInstr->Src()->Kind() == ast::NodeType::kDeRefExpression);
+    if ((twoOpInstr->Dst()->Kind() == ast::NodeType::kDeRefExpression) && (isSrcDeRef != isSrcValue)) {
+        return true;
+    }
+    fmt::println(stderr, "Compiler, invalid operands for '{}'", twoOpInstr->Symbol());
+    return false;
+}
+
 // FIXME: InstructionSet dependent?
 bool EmitCodeStatement::ProcessTwoOpInstrStmt(CompileUnit &context, ast::TwoOpInstrStatment::Ref twoOpInstr) {
     if (twoOpInstr->Symbol() == "lea") {
@@ -718,6 +899,13 @@ bool EmitCodeStatement::ProcessTwoOpInstrStmt(CompileUnit &context, ast::TwoOpIn
     auto opClass = *instrSet.GetDefinition().GetOperandFromStr(twoOpInstr->Symbol());
     auto opDesc = *instrSet.GetDefinition().GetOpDescFromClass(opClass);
 
+    if ((opDesc.features & vcpu::OperandFeatureFlags::kFeature_Atomic) && !VerifyAtomicOperands(context, twoOpInstr)) {
+        return false;
+    }
+    if ((opDesc.features & vcpu::OperandFeatureFlags::kFeature_AddressOnly) && !VerifyBlockOperands(opDesc, twoOpInstr)) {
+        return false;
+    }
+
     // Save the write point..
     auto opSizeWritePoint = data.size();
     // This is temporary (might be changed)
@@ -877,6 +1065,7 @@ static std::unordered_map<std::string, uint8_t> regToIdx = {
         {"cr5",13},
         {"cr6",14},
         {"cr7",15},
+        {"zero",15},
 };
 
 
@@ -895,6 +1084,52 @@ bool EmitCodeStatement::EmitRegisterLiteralWithAddrMode(ast::RegisterLiteral::Re
     return true;
 }
 
+//
+// Compare and branch, see InstructionSetV1Def.h
+//   <op code> | <op.size>|<family> | <regA>|<regB> | <int16 offset>
+//
+bool EmitCodeStatement::ProcessThreeOpInstrStmt(CompileUnit &context, ast::ThreeOpInstrStatement::Ref stmt) {
+    uint8_t regIndex[2] = {};
+    ast::Expression::Ref regOperands[2] = {stmt->First(), stmt->Second()};
+    for(int i=0;i<2;i++) {
+        if (regOperands[i]->Kind() != ast::NodeType::kRegisterLiteral) {
+            fmt::println(stderr, "Compiler, '{}' requires two registers and a label", stmt->Symbol());
+            return false;
+        }
+        auto &regSymbol = std::dynamic_pointer_cast<ast::RegisterLiteral>(regOperands[i])->Symbol();
+        if (!regToIdx.contains(regSymbol)) {
+            fmt::println(stderr, "Illegal register: {}", regSymbol);
+            return false;
+        }
+        // Control family replaces the address registers with the control registers
+        if ((stmt->OpFamily() == vcpu::OperandFamily::Control) && strutil::startsWith(regSymbol, "a")) {
+            fmt::println(stderr, "Compiler, '{}' can't mix address and control registers", stmt->Symbol());
+            return false;
+        }
+        regIndex[i] = regToIdx[regSymbol];
+    }
+    if (stmt->Third()->Kind() != ast::NodeType::kIdentifier) {
+        fmt::println(stderr, "Compiler, '{}' requires a label as branch target", stmt->Symbol());
+        return false;
+    }
+
+    if (!EmitOpCodeForSymbol(stmt->Symbol())) {
+        return false;
+    }
+    uint8_t opSizeAndFamilyCode = static_cast<uint8_t>(stmt->OpSize());
+    opSizeAndFamilyCode |= static_cast<uint8_t>(stmt->OpFamily()) << 4;
+    EmitOpSize(opSizeAndFamilyCode);
+    EmitRegMode(((regIndex[0] << 4) & 0xf0) | (regIndex[1] & 0x0f));
+
+    // The offset is always a word (regardless of op.size) and relative to the end of the instruction
+    haveIdentifier = true;
+    isRelative = true;
+    symbol = std::dynamic_pointer_cast<ast::Identifier>(stmt->Third())->Symbol();
+    opSize = vcpu::OperandSize::Word;
+    placeholderAddress = data.size();
+    return EmitWord(0);
+}
+
 // This is a bit hairy - to say the least
 bool EmitCodeStatement::EmitDereference(CompileUnit &context, ast::DeReferenceExpression::Ref expression) {
 
@@ -1129,6 +1364,402 @@ bool EmitCodeStatement::EmitRelativeLabelAddress(CompileUnit &context, const vcp
     return true;
 }
 
+//
+// Fixed width encoding, see InstructionSetV1FixedDef.h
+//   <instr word> [<relative addressing word>] [<dst ext>] [<src ext>]
+//
+using FixedDef = vcpu::InstructionSetV1FixedDef;
+
+static void AppendBigEndian(std::vector<uint8_t> &out, uint64_t value, size_t nBytes) {
+    for(size_t i=0;i<nBytes;i++) {
+        out.push_back((value >> ((nBytes - 1 - i) * 8)) & 0xff);
+    }
+}
+
+bool EmitFixedCodeStatement::Process(CompileUnit &context) {
+    haveIdentifier = false;
+    isDeferring = false;
+
+    switch(statement->Kind()) {
+        case ast::NodeType::kNoOpInstrStatement :
+            return ProcessFixedNoOp(std::dynamic_pointer_cast<ast::NoOpInstrStatment>(statement));
+        case ast::NodeType::kOneOpInstrStatement :
+            return ProcessFixedOneOp(context, std::dynamic_pointer_cast<ast::OneOpInstrStatment>(statement));
+        case ast::NodeType::kTwoOpInstrStatement :
+            return ProcessFixedTwoOp(context, std::dynamic_pointer_cast<ast::TwoOpInstrStatment>(statement));
+        case ast::NodeType::kThreeOpInstrStatement :
+            return ProcessFixedThreeOp(context, std::dynamic_pointer_cast<ast::ThreeOpInstrStatement>(statement));
+        case ast::NodeType::kSimdInstrStatement :
+            fmt::println(stderr, "Compiler, extensions (SIMD) are not available with the fixed width encoding");
+            return false;
+        default :
+            break;
+    }
+    return false;
+}
+
+bool EmitFixedCodeStatement::ProcessFixedNoOp(ast::NoOpInstrStatment::Ref stmt) {
+    auto opCode = vcpu::InstructionSetManager::Instance().GetInstructionSet().GetDefinition().GetOperandFromStr(stmt->Symbol());
+    if (!opCode.has_value()) {
+        fmt::println(stderr, "Unknown/Unsupported symbol: {}", stmt->Symbol());
+        return false;
+    }
+    return EmitFixed(*opCode, vcpu::OperandSize::Byte, vcpu::OperandFamily::Integer, nullptr, nullptr);
+}
+
+bool EmitFixedCodeStatement::ProcessFixedOneOp(CompileUnit &context, ast::OneOpInstrStatment::Ref stmt) {
+    auto &definition = vcpu::InstructionSetManager::Instance().GetInstructionSet().GetDefinition();
+    auto opCode = definition.GetOperandFromStr(stmt->Symbol());
+    if (!opCode.has_value()) {
+        fmt::println(stderr, "Unknown/Unsupported symbol: {}", stmt->Symbol());
+        return false;
+    }
+    auto opDesc = *definition.GetOpDescFromClass(*opCode);
+    if ((opDesc.features & vcpu::OperandFeatureFlags::kFeature_AddressOnly) && !VerifyAddressOnlyOperand(context, stmt)) {
+        return false;
+    }
+    auto opSize = stmt->OpSize();
+
+    FixedOperand dst;
+    if (!EncodeOperand(context, opDesc, opSize, stmt->Operand(), dst)) {
+        return false;
+    }
+    if (isDeferring) {
+        return true;
+    }
+    return EmitFixed(*opCode, opSize, vcpu::OperandFamily::Integer, &dst, nullptr);
+}
+
+bool EmitFixedCodeStatement::ProcessFixedTwoOp(CompileUnit &context, ast::TwoOpInstrStatment::Ref stmt) {
+    auto &definition = vcpu::InstructionSetManager::Instance().GetInstructionSet().GetDefinition();
+    auto opCode = definition.GetOperandFromStr(stmt->Symbol());
+    if (!opCode.has_value()) {
+        fmt::println(stderr, "Unknown/Unsupported symbol: {}", stmt->Symbol());
+        return false;
+    }
+    auto opDesc = *definition.GetOpDescFromClass(*opCode);
+    if ((opDesc.features & vcpu::OperandFeatureFlags::kFeature_Atomic) && !VerifyAtomicOperands(context, stmt)) {
+        return false;
+    }
+    if ((opDesc.features & vcpu::OperandFeatureFlags::kFeature_AddressOnly) && !VerifyBlockOperands(opDesc, stmt)) {
+        return false;
+    }
+    if (stmt->OpFamily() == vcpu::OperandFamily::Float) {
+        fmt::println(stderr, "Compiler, the float family is not available with the fixed width encoding");
+        return false;
+    }
+
+    auto opSize = stmt->OpSize();
+    FixedOperand dst;
+    FixedOperand src;
+    if (!EncodeOperand(context, opDesc, opSize, stmt->Dst(), dst)) {
+        return false;
+    }
+    if (!EncodeOperand(context, opDesc, opSize, stmt->Src(), src)) {
+        return false;
+    }
+    if (isDeferring) {
+        return true;
+    }
+    return EmitFixed(*opCode, opSize, stmt->OpFamily(), &dst, &src);
+}
+
+//
+// Compare and branch, the registers are in the instruction word and the offset is a dword extension word
+//
+bool EmitFixedCodeStatement::ProcessFixedThreeOp(CompileUnit &context, ast::ThreeOpInstrStatement::Ref stmt) {
+    FixedOperand regOperands[2] = {};
+    ast::Expression::Ref regExpressions[2] = {stmt->First(), stmt->Second()};
+    for(int i=0;i<2;i++) {
+        if (regExpressions[i]->Kind() != ast::NodeType::kRegisterLiteral) {
+            fmt::println(stderr, "Compiler, '{}' requires two registers and a label", stmt->Symbol());
+            return false;
+        }
+        auto &regSymbol = std::dynamic_pointer_cast<ast::RegisterLiteral>(regExpressions[i])->Symbol();
+        if (!regToIdx.contains(regSymbol)) {
+            fmt::println(stderr, "Illegal register: {}", regSymbol);
+            return false;
+        }
+        if ((stmt->OpFamily() == vcpu::OperandFamily::Control) && strutil::startsWith(regSymbol, "a")) {
+            fmt::println(stderr, "Compiler, '{}' can't mix address and control registers", stmt->Symbol());
+            return false;
+        }
+        regOperands[i].regIndex = regToIdx[regSymbol];
+        regOperands[i].addrMode = vcpu::AddressMode::Register;
+    }
+    if (stmt->Third()->Kind() != ast::NodeType::kIdentifier) {
+        fmt::println(stderr, "Compiler, '{}' requires a label as branch target", stmt->Symbol());
+        return false;
+    }
+    auto opCode = vcpu::InstructionSetManager::Instance().GetInstructionSet().GetDefinition().GetOperandFromStr(stmt->Symbol());
+    if (!opCode.has_value()) {
+        fmt::println(stderr, "Unknown/Unsupported symbol: {}", stmt->Symbol());
+        return false;
+    }
+
+    // The offset goes with the first operand, relative to the end of the instruction
+    haveIdentifier = true;
+    isRelative = true;
+    symbol = std::dynamic_pointer_cast<ast::Identifier>(stmt->Third())->Symbol();
+    opSize = vcpu::OperandSize::DWord;
+    regOperands[0].havePlaceholder = true;
+    regOperands[0].placeholderOfs = 0;
+    AppendBigEndian(regOperands[0].ext, 0, sizeof(uint32_t));
+
+    return EmitFixed(*opCode, stmt->OpSize(), stmt->OpFamily(), &regOperands[0], &regOperands[1]);
+}
+
+bool EmitFixedCodeStatement::EncodeOperand(CompileUnit &context, const vcpu::OperandDescriptionBase &desc, vcpu::OperandSize &inOutOpSize, ast::Expression::Ref operandExp, FixedOperand &outOperand) {
+    // Constants are replaced by their value
+    if (operandExp->Kind() == ast::NodeType::kIdentifier) {
+        auto identifier = std::dynamic_pointer_cast<ast::Identifier>(operandExp);
+        if (context.HasConstant(identifier->Symbol())) {
+            auto constLiteral = context.GetConstant(identifier->Symbol());
+            auto constExpression = EvaluateConstantExpression(context, constLiteral->Expression());
+            return EncodeOperand(context, desc, inOutOpSize, constExpression, outOperand);
+        }
+    }
+
+    switch(operandExp->Kind()) {
+        case ast::NodeType::kNumericLiteral : {
+            if (!(desc.features & vcpu::OperandFeatureFlags::kFeature_Immediate)) {
+                fmt::println(stderr, "Instruction Operand does not support immediate");
+                return false;
+            }
+            auto value = std::dynamic_pointer_cast<ast::NumericLiteral>(operandExp)->Value();
+            outOperand.addrMode = vcpu::AddressMode::Immediate;
+            switch(inOutOpSize) {
+                case vcpu::OperandSize::Byte :
+                    outOperand.immediate = value & 0xff;
+                    break;
+                case vcpu::OperandSize::Word :
+                    AppendBigEndian(outOperand.ext, value & 0xffff, sizeof(uint32_t));
+                    break;
+                case vcpu::OperandSize::DWord :
+                    AppendBigEndian(outOperand.ext, value, sizeof(uint32_t));
+                    break;
+                case vcpu::OperandSize::Long :
+                    AppendBigEndian(outOperand.ext, value, sizeof(uint64_t));
+                    break;
+            }
+            return true;
+        }
+        case ast::NodeType::kRegisterLiteral : {
+            if (!(desc.features & vcpu::OperandFeatureFlags::kFeature_AnyRegister)) {
+                fmt::println(stderr, "Instruction Operand does not support register");
+                return false;
+            }
+            auto &regSymbol = std::dynamic_pointer_cast<ast::RegisterLiteral>(operandExp)->Symbol();
+            if (!regToIdx.contains(regSymbol)) {
+                fmt::println(stderr, "Illegal register: {}", regSymbol);
+                return false;
+            }
+            outOperand.regIndex = regToIdx[regSymbol];
+            outOperand.addrMode = vcpu::AddressMode::Register;
+            return true;
+        }
+        case ast::NodeType::kIdentifier :
+            return EncodeLabel(context, desc, inOutOpSize, std::dynamic_pointer_cast<ast::Identifier>(operandExp), outOperand);
+        case ast::NodeType::kDeRefExpression :
+            if (desc.features & vcpu::OperandFeatureFlags::kFeature_Addressing) {
+                return EncodeDereference(context, std::dynamic_pointer_cast<ast::DeReferenceExpression>(operandExp), outOperand);
+            }
+            break;
+        default :
+            fmt::println(stderr, "Unsupported instr. operand type in AST");
+            break;
+    }
+    return false;
+}
+
+//
+// Labels are absolute for '.l' and addressing instructions, otherwise relative - an unspecified size is a dword offset
+// (the extension word is 32 bit anyway, so there is nothing to gain from deducing the distance)
+//
+bool EmitFixedCodeStatement::EncodeLabel(CompileUnit &context, const vcpu::OperandDescriptionBase &desc, vcpu::OperandSize &inOutOpSize, ast::Identifier::Ref identifier, FixedOperand &outOperand) {
+    haveIdentifier = true;
+    symbol = identifier->Symbol();
+    outOperand.havePlaceholder = true;
+
+    if ((desc.features & vcpu::OperandFeatureFlags::kFeature_Addressing) && (inOutOpSize == vcpu::OperandSize::Long)) {
+        outOperand.addrMode = (desc.features & vcpu::OperandFeatureFlags::kFeature_Branching) ? vcpu::AddressMode::Immediate : vcpu::AddressMode::Absolute;
+        isRelative = false;
+        opSize = inOutOpSize;
+        outOperand.placeholderOfs = 0;
+        AppendBigEndian(outOperand.ext, 0, sizeof(uint64_t));
+        return true;
+    }
+
+    if (inOutOpSize == vcpu::OperandSize::Long) {
+        inOutOpSize = vcpu::OperandSize::DWord;
+    }
+    outOperand.addrMode = vcpu::AddressMode::Immediate;
+    isRelative = true;
+    opSize = inOutOpSize;
+    switch(inOutOpSize) {
+        case vcpu::OperandSize::Byte :
+            outOperand.isPlaceholderInInstrWord = true;
+            break;
+        case vcpu::OperandSize::Word :
+            // low half of the extension word
+            outOperand.placeholderOfs = sizeof(uint16_t);
+            AppendBigEndian(outOperand.ext, 0, sizeof(uint32_t));
+            break;
+        default :
+            outOperand.placeholderOfs = 0;
+            AppendBigEndian(outOperand.ext, 0, sizeof(uint32_t));
+            break;
+    }
+    return true;
+}
+
+bool EmitFixedCodeStatement::EncodeDereference(CompileUnit &context, ast::DeReferenceExpression::Ref expression, FixedOperand &outOperand) {
+    auto deRefExp = expression->GetDeRefExp();
+    if (deRefExp->Kind() == ast::NodeType::kIdentifier) {
+        fmt::println(stderr, "Compiler, dereferencing identifiers are not supported");
+        return false;
+    }
+
+    auto deref = EvaluateConstantExpression(context, deRefExp);
+    if (deref == nullptr) {
+        if (temp_isDeferredEmitter) {
+            fmt::println(stderr, "Compiler, unable to evaluate dereference");
+            return false;
+        }
+        // Try again when finalizing
+        temp_isDeferredEmitter = true;
+        isDeferring = true;
+        return true;
+    }
+
+    outOperand.addrMode = vcpu::AddressMode::Indirect;
+
+    auto regIndex = [](ast::RegisterLiteral::Ref regLiteral, uint8_t &outIndex) -> bool {
+        if (!regToIdx.contains(regLiteral->Symbol())) {
+            fmt::println(stderr, "Illegal register: {}", regLiteral->Symbol());
+            return false;
+        }
+        outIndex = regToIdx[regLiteral->Symbol()];
+        return true;
+    };
+
+    // (<reg>)
+    if (deref->Kind() == ast::NodeType::kRegisterLiteral) {
+        return regIndex(std::dynamic_pointer_cast<ast::RegisterLiteral>(deref), outOperand.regIndex);
+    }
+    if (deref->Kind() != ast::NodeType::kRelativeRegisterLiteral) {
+        fmt::println(stderr, "Compiler, Unsupported dereference construct!");
+        return false;
+    }
+
+    const auto relativeRegLiteral = std::dynamic_pointer_cast<ast::RelativeRegisterLiteral>(deref);
+    if (!regIndex(relativeRegLiteral->BaseRegister(), outOperand.regIndex)) {
+        return false;
+    }
+    auto relExp = relativeRegLiteral->RelativeExpression();
+
+    // (<reg> + <reg>)
+    if (relExp->Kind() == ast::NodeType::kRegisterLiteral) {
+        uint8_t relIndex = 0;
+        if (!regIndex(std::dynamic_pointer_cast<ast::RegisterLiteral>(relExp), relIndex)) {
+            return false;
+        }
+        outOperand.relMode = vcpu::RelativeAddressMode::RegRelative;
+        outOperand.relByte = relIndex << 4;
+        return true;
+    }
+
+    // (<reg> + <number>)
+    if (relExp->Kind() == ast::NodeType::kNumericLiteral) {
+        auto relValue = std::dynamic_pointer_cast<ast::NumericLiteral>(relExp)->Value();
+        if (relValue > 255) {
+            fmt::println(stderr, "Compiler, Absolute relative value {} out range - must be within 0..255", relValue);
+            return false;
+        }
+        outOperand.relMode = vcpu::RelativeAddressMode::AbsRelative;
+        outOperand.relByte = relValue;
+        return true;
+    }
+
+    // (<reg> + <reg> << <number>)
+    if (relExp->Kind() == ast::NodeType::kRelativeRegisterLiteral) {
+        const auto relRegShift = std::dynamic_pointer_cast<ast::RelativeRegisterLiteral>(relExp);
+        if (relRegShift->Operator() != "<<") {
+            fmt::println(stderr, "Compiler, only '<<' operator is supported for relative register scaling!");
+            return false;
+        }
+        if (relRegShift->RelativeExpression()->Kind() != ast::NodeType::kNumericLiteral) {
+            fmt::println(stderr, "Compiler, relative register scaling must be a numerical value!");
+            return false;
+        }
+        auto shiftNum = std::dynamic_pointer_cast<ast::NumericLiteral>(relRegShift->RelativeExpression())->Value();
+        if (shiftNum > 15) {
+            fmt::println(stderr, "Compiler, relative register scaling too high {}, allowed range is 0..15",shiftNum);
+            return false;
+        }
+        uint8_t relIndex = 0;
+        if (!regIndex(relRegShift->BaseRegister(), relIndex)) {
+            return false;
+        }
+        outOperand.relMode = vcpu::RelativeAddressMode::RegRelative;
+        outOperand.relByte = (relIndex << 4) | (shiftNum & 0x0f);
+        return true;
+    }
+
+    fmt::println(stderr, "Compiler, Unsupported dereference construct!");
+    return false;
+}
+
+bool EmitFixedCodeStatement::EmitFixed(uint8_t opCode, vcpu::OperandSize opSize, vcpu::OperandFamily opFamily, FixedOperand *dst, FixedOperand *src) {
+    uint32_t instrWord = static_cast<uint32_t>(opCode) << FixedDef::kShiftOpCode;
+    instrWord |= (static_cast<uint32_t>(opSize) & 0x03) << FixedDef::kShiftOpSize;
+    if (opFamily == vcpu::OperandFamily::Control) {
+        instrWord |= FixedDef::kBitControlFamily;
+    }
+
+    uint32_t relWord = 0;
+    bool haveRelWord = false;
+    if (dst != nullptr) {
+        instrWord |= static_cast<uint32_t>(dst->regIndex & 15) << FixedDef::kShiftDstReg;
+        instrWord |= static_cast<uint32_t>(dst->addrMode & 0x03) << FixedDef::kShiftDstAddrMode;
+        instrWord |= dst->immediate;
+        if (dst->relMode != vcpu::RelativeAddressMode::None) {
+            relWord |= static_cast<uint32_t>(dst->relMode) << FixedDef::kShiftDstRelMode;
+            relWord |= static_cast<uint32_t>(dst->relByte) << FixedDef::kShiftDstRelByte;
+            haveRelWord = true;
+        }
+    }
+    if (src != nullptr) {
+        instrWord |= static_cast<uint32_t>(src->regIndex & 15) << FixedDef::kShiftSrcReg;
+        instrWord |= static_cast<uint32_t>(src->addrMode & 0x03) << FixedDef::kShiftSrcAddrMode;
+        instrWord |= src->immediate;
+        if (src->relMode != vcpu::RelativeAddressMode::None) {
+            relWord |= static_cast<uint32_t>(src->relMode) << FixedDef::kShiftSrcRelMode;
+            relWord |= static_cast<uint32_t>(src->relByte) << FixedDef::kShiftSrcRelByte;
+            haveRelWord = true;
+        }
+    }
+    if (haveRelWord) {
+        instrWord |= FixedDef::kBitRelativeExt;
+    }
+
+    EmitDWord(instrWord);
+    if (haveRelWord) {
+        EmitDWord(relWord);
+    }
+    for(auto operand : {dst, src}) {
+        if (operand == nullptr) {
+            continue;
+        }
+        if (operand->havePlaceholder) {
+            // Byte offsets are the low byte of the instruction word
+            placeholderAddress = operand->isPlaceholderInInstrWord ? (FixedDef::kWordSize - 1) : (data.size() + operand->placeholderOfs);
+        }
+        data.insert(data.end(), operand->ext.begin(), operand->ext.end());
+    }
+    return true;
+}
+
 //
 // Evaluate a constant expression...
 //
@@ -225,6 +225,8 @@ namespace gnilk {
             bool ProcessNoOpInstrStmt(ast::NoOpInstrStatment::Ref stmt);
             bool ProcessOneOpInstrStmt(CompileUnit &context, ast::OneOpInstrStatment::Ref stmt);
             bool ProcessTwoOpInstrStmt(CompileUnit &context, ast::TwoOpInstrStatment::Ref stmt);
+            bool ProcessSimdInstrStmt(CompileUnit &context, ast::SimdInstrStatement::Ref stmt);
+            bool ProcessThreeOpInstrStmt(CompileUnit &context, ast::ThreeOpInstrStatement::Ref stmt);
 
             bool EmitOpCodeForSymbol(const std::string &symbol);
             void EmitOpSize(uint8_t opSize);
@@ -243,10 +245,10 @@ namespace gnilk {
             void AddPostEmitter(PostEmitOpData emitter);
             bool RunPostEmitters();
 
-            bool temp_isDeferredEmitter = false;
-
             std::vector<PostEmitOpData> postEmitters;
 
+        protected:
+            bool temp_isDeferredEmitter = false;
 
             // placeholder stuff here...
             bool haveIdentifier = false;
@@ -260,6 +262,45 @@ namespace gnilk {
             //int ofsRelative = 0;
 
         };
+
+        //
+        // Code for the fixed width encoding, see InstructionSetV1FixedDef.h - used when the root instruction set has the
+        // 'kFixed32' encoding. The statement is encoded in one go (no post emitters), extension words follow the instruction word.
+        //
+        class EmitFixedCodeStatement : public EmitCodeStatement {
+        public:
+            EmitFixedCodeStatement() = default;
+            virtual ~EmitFixedCodeStatement() = default;
+
+            bool Process(CompileUnit &context) override;
+
+        protected:
+            struct FixedOperand {
+                uint8_t regIndex = 0;
+                uint8_t addrMode = 0;
+                uint8_t relMode = 0;
+                uint8_t relByte = 0;
+                uint8_t immediate = 0;          // byte immediates are part of the instruction word
+                std::vector<uint8_t> ext;       // extension words
+                bool havePlaceholder = false;
+                bool isPlaceholderInInstrWord = false;
+                size_t placeholderOfs = 0;      // within 'ext'
+            };
+
+            bool ProcessFixedNoOp(ast::NoOpInstrStatment::Ref stmt);
+            bool ProcessFixedOneOp(CompileUnit &context, ast::OneOpInstrStatment::Ref stmt);
+            bool ProcessFixedTwoOp(CompileUnit &context, ast::TwoOpInstrStatment::Ref stmt);
+            bool ProcessFixedThreeOp(CompileUnit &context, ast::ThreeOpInstrStatement::Ref stmt);
+
+            bool EncodeOperand(CompileUnit &context, const vcpu::OperandDescriptionBase &desc, vcpu::OperandSize &inOutOpSize, ast::Expression::Ref operandExp, FixedOperand &outOperand);
+            bool EncodeDereference(CompileUnit &context, ast::DeReferenceExpression::Ref expression, FixedOperand &outOperand);
+            bool EncodeLabel(CompileUnit &context, const vcpu::OperandDescriptionBase &desc, vcpu::OperandSize &inOutOpSize, ast::Identifier::Ref identifier, FixedOperand &outOperand);
+
+            bool EmitFixed(uint8_t opCode, vcpu::OperandSize opSize, vcpu::OperandFamily opFamily, FixedOperand *dst, FixedOperand *src);
+        private:
+            // set while the statement waits for finalize (see EncodeDereference)
+            bool isDeferring = false;
+        };
     }
 }
 #endif //VCPU_STMTEMITTER_H
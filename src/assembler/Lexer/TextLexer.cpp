@@ -102,6 +102,24 @@ const Context &gnilk::GetLexerContext() {
         {"cr5", TokenType::ControlReg},
         {"cr6", TokenType::ControlReg},
         {"cr7", TokenType::ControlReg},
+        {"zero", TokenType::ControlReg},    // alias for cr7
+        // SIMD Registers
+        {"v0", TokenType::SimdReg},
+        {"v1", TokenType::SimdReg},
+        {"v2", TokenType::SimdReg},
+        {"v3", TokenType::SimdReg},
+        {"v4", TokenType::SimdReg},
+        {"v5", TokenType::SimdReg},
+        {"v6", TokenType::SimdReg},
+        {"v7", TokenType::SimdReg},
+        {"v8", TokenType::SimdReg},
+        {"v9", TokenType::SimdReg},
+        {"v10", TokenType::SimdReg},
+        {"v11", TokenType::SimdReg},
+        {"v12", TokenType::SimdReg},
+        {"v13", TokenType::SimdReg},
+        {"v14", TokenType::SimdReg},
+        {"v15", TokenType::SimdReg},
         // FIXME: Support extensions
     };
 
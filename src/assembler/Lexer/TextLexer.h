@@ -32,6 +32,7 @@ namespace gnilk {
         DataReg,
         AddressReg,
         ControlReg,
+        SimdReg,        // SIMD extension, v0..v15
         // special registers
         sp,ip,
 
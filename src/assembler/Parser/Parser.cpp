@@ -367,9 +367,12 @@ ast::Statement::Ref Parser::ParseArrayDeclaration(vcpu::OperandSize opSize) {
 ast::Statement::Ref Parser::ParseIdentifierOrInstr() {
     // Check if this is a proper instruction
     auto &definition = vcpu::InstructionSetManager::Instance().GetInstructionSet().GetDefinition();
-    if (definition.GetOperandFromStr(At().value).has_value()) {
+    if (definition.GetOperandFromStr(At().value).has_value() || IsCompareBranchAlias()) {
         return ParseInstruction();
     }
+    if (IsSimdInstruction(At().value)) {
+        return ParseSimdInstruction();
+    }
     // This is just an identifier - deal with it...
     auto ident = At().value;
     Eat();
@@ -380,10 +383,37 @@ ast::Statement::Ref Parser::ParseIdentifierOrInstr() {
     return std::make_shared<ast::Identifier>(ident);
 }
 
+// 'beq/bne/blt/bge <reg>,<reg>,label' are the compare and branch instructions (breq/brne/brlt/brge)
+static const std::unordered_map<std::string, std::string> compareBranchAliases = {
+    {"beq", "breq"},
+    {"bne", "brne"},
+    {"blt", "brlt"},
+    {"bge", "brge"},
+};
+
+// The flag based 'beq/bne label' takes a label, compare and branch starts with a register
+bool Parser::IsCompareBranchAlias() {
+    if (!compareBranchAliases.contains(At().value)) {
+        return false;
+    }
+    auto itOperand = it + 1;
+    // skip op.size, '.l'
+    if ((std::distance(itOperand, tokens.end()) > 2) && (itOperand->type == TokenType::Dot)) {
+        itOperand += 2;
+    }
+    if (itOperand == tokens.end()) {
+        return false;
+    }
+    return ((itOperand->type == TokenType::DataReg) || (itOperand->type == TokenType::AddressReg) || (itOperand->type == TokenType::ControlReg));
+}
+
 ast::Statement::Ref Parser::ParseInstruction() {
     auto &instructionSet = vcpu::InstructionSetManager::Instance().GetInstructionSet();
 
     auto operand = At().value;
+    if (IsCompareBranchAlias()) {
+        operand = compareBranchAliases.at(operand);
+    }
     auto opClass = instructionSet.GetDefinition().GetOperandFromStr(operand);
 
     if (!opClass.has_value()) {
@@ -402,7 +432,9 @@ ast::Statement::Ref Parser::ParseInstruction() {
     }
     auto opDesc = *optionalDesc;
     // FIXME: consolidate the op-desc-flags
-    if (opDesc.features & vcpu::OperandFeatureFlags::kFeature_TwoOperands) {
+    if (opDesc.features & vcpu::OperandFeatureFlags::kFeature_ThreeOperands) {
+        return ParseThreeOpInstruction(operand);
+    } else if (opDesc.features & vcpu::OperandFeatureFlags::kFeature_TwoOperands) {
         return ParseTwoOpInstruction(operand);
     } else if (opDesc.features & vcpu::OperandFeatureFlags::kFeature_OneOperand) {
         return ParseOneOpInstruction(operand);
@@ -445,11 +477,8 @@ ast::Statement::Ref Parser::ParseTwoOpInstruction(const std::string &symbol) {
     auto dst = ParseExpression();
     instrStatment->SetDst(dst);
 
-    if (dst->Kind() == ast::NodeType::kRegisterLiteral) {
-        auto dstReg = std::dynamic_pointer_cast<ast::RegisterLiteral>(dst);
-        if (strutil::startsWith(dstReg->Symbol(), "cr")) {
-            instrStatment->SetOpFamily(gnilk::vcpu::OperandFamily::Control);
-        }
+    if (IsControlRegister(dst)) {
+        instrStatment->SetOpFamily(gnilk::vcpu::OperandFamily::Control);
     }
 
     // literal must be separated by ','
@@ -459,11 +488,8 @@ ast::Statement::Ref Parser::ParseTwoOpInstruction(const std::string &symbol) {
     // Fixme: replace with: src = ParseExpression();
     auto src = ParseExpression();
     instrStatment->SetSrc(src);
-    if (src->Kind() == ast::NodeType::kRegisterLiteral) {
-        auto srcReg = std::dynamic_pointer_cast<ast::RegisterLiteral>(src);
-        if (strutil::startsWith(srcReg->Symbol(), "cr")) {
-            instrStatment->SetOpFamily(gnilk::vcpu::OperandFamily::Control);
-        }
+    if (IsControlRegister(src)) {
+        instrStatment->SetOpFamily(gnilk::vcpu::OperandFamily::Control);
     }
 
 
@@ -485,6 +511,103 @@ ast::Statement::Ref Parser::ParseTwoOpInstruction(const std::string &symbol) {
     return instrStatment;
 }
 
+//
+// <instr>.<sz> <regA>,<regB>,label
+//   breq.l d0,d1,label
+//   bne.l d0,zero,label        ; alias for brne
+//
+ast::Statement::Ref Parser::ParseThreeOpInstruction(const std::string &symbol) {
+    auto instrStatement = std::make_shared<ast::ThreeOpInstrStatement>(symbol);
+
+    Eat();
+
+    auto [haveOpSize, opSize] = ParseOpSize();
+    if (haveOpSize) {
+        instrStatement->SetOpSize(opSize);
+    }
+
+    auto first = ParseExpression();
+    Expect(TokenType::Comma, "Operand requires three arguments!");
+    auto second = ParseExpression();
+    Expect(TokenType::Comma, "Operand requires three arguments!");
+    auto third = ParseExpression();
+    if ((first == nullptr) || (second == nullptr) || (third == nullptr)) {
+        return nullptr;
+    }
+    instrStatement->SetFirst(first);
+    instrStatement->SetSecond(second);
+    instrStatement->SetThird(third);
+
+    if (IsControlRegister(first) || IsControlRegister(second)) {
+        instrStatement->SetOpFamily(gnilk::vcpu::OperandFamily::Control);
+    }
+    return instrStatement;
+}
+
+// 'crN' or 'zero' (cr7)
+bool Parser::IsControlRegister(ast::Expression::Ref expression) {
+    if (expression->Kind() != ast::NodeType::kRegisterLiteral) {
+        return false;
+    }
+    auto &symbol = std::dynamic_pointer_cast<ast::RegisterLiteral>(expression)->Symbol();
+    return (strutil::startsWith(symbol, "cr") || (symbol == "zero"));
+}
+
+// SIMD instructions are only available if the extension is registered
+bool Parser::IsSimdInstruction(const std::string &symbol) {
+    auto &instrSetManager = vcpu::InstructionSetManager::Instance();
+    if (!instrSetManager.HaveExtension(vcpu::OperandCode::SIMD)) {
+        return false;
+    }
+    return instrSetManager.GetExtension(vcpu::OperandCode::SIMD).GetDefinition().GetOperandFromStr(symbol).has_value();
+}
+
+//
+// ve_<instr>.<sz> <op>,<op>[,<op>]
+//   ve_load.fp32 v0,(a0)+
+//   ve_store.i16 (a1),v2,0x3
+//   ve_gather.i32 v1,(a0),v2
+//
+// The size is verified by the emitter, dereferenced operands can be followed by '+' (advance)
+//
+ast::Statement::Ref Parser::ParseSimdInstruction() {
+    auto instrStatement = std::make_shared<ast::SimdInstrStatement>(Eat().value);
+
+    if (At().type != TokenType::Dot) {
+        fmt::println(stderr, "SIMD instruction '{}' requires a size (fp8,fp16,fp32,i8,i16,i32,i64)", instrStatement->Symbol());
+        return nullptr;
+    }
+    Eat();
+    instrStatement->SetOpSize(Eat().value);
+
+    do {
+        if (At().type == TokenType::OpenParen) {
+            // Can't go through ParseExpression - the trailing '+' would be taken as an addition
+            auto deref = ParsePrimaryExpression();
+            if (deref == nullptr) {
+                return nullptr;
+            }
+            bool advance = false;
+            if (At().value == "+") {
+                Eat();
+                advance = true;
+            }
+            instrStatement->AddOperand(deref, advance);
+        } else {
+            auto operand = ParseExpression();
+            if (operand == nullptr) {
+                return nullptr;
+            }
+            instrStatement->AddOperand(operand, false);
+        }
+        if (At().type != TokenType::Comma) {
+            break;
+        }
+        Eat();
+    } while(true);
+
+    return instrStatement;
+}
 
 ast::Expression::Ref Parser::ParseExpression() {
     return ParseAdditiveExpression();
@@ -528,6 +651,8 @@ ast::Expression::Ref Parser::ParsePrimaryExpression() {
             return ast::RegisterLiteral::Create(Eat().value);
         case TokenType::ControlReg :
             return ast::RegisterLiteral::Create(Eat().value);
+        case TokenType::SimdReg :
+            return ast::RegisterLiteral::Create(Eat().value);
         case TokenType::Number :
             return ast::NumericLiteral::Create(Eat().value);
         case TokenType::NumberHex :
@@ -88,6 +88,11 @@ namespace gnilk {
             ast::Statement::Ref ParseInstruction();
             ast::Statement::Ref ParseOneOpInstruction(const std::string &symbol);
             ast::Statement::Ref ParseTwoOpInstruction(const std::string &symbol);
+            ast::Statement::Ref ParseThreeOpInstruction(const std::string &symbol);
+            bool IsCompareBranchAlias();
+            bool IsControlRegister(ast::Expression::Ref expression);
+            bool IsSimdInstruction(const std::string &symbol);
+            ast::Statement::Ref ParseSimdInstruction();
             ast::Expression::Ref ParseExpression();
             ast::Expression::Ref ParseAdditiveExpression();
             ast::Expression::Ref ParseMultiplicativeExpression();
@@ -36,6 +36,8 @@ static std::unordered_map<NodeType, std::string> typeToStringMap = {
     {NodeType::kArrayLiteral, "ArrayLiteral"},
     {NodeType::kStructLiteral, "StructLiteral"},
     {NodeType::kExportStatement, "ExportStatement"},
+    {NodeType::kSimdInstrStatement, "SimdInstrStatement"},
+    {NodeType::kThreeOpInstrStatement, "ThreeOpInstrStatement"},
 };
 static const std::string unknownNodeType="<unknown>";
 
@@ -67,6 +67,9 @@ namespace gnilk {
             kBinaryExpression,
             kMemberExpression,
             kCallExpression,
+
+            kSimdInstrStatement,        // SIMD extension instructions, '<instr>.<sz> <op>,<op>[,<op>]'
+            kThreeOpInstrStatement,     // instructions with three operands, compare and branch 'breq.l d0,d1,label'
         };
 
         const std::string &NodeTypeToString(NodeType type);
@@ -105,6 +105,73 @@ namespace gnilk {
 
         };
 
+        // Compare and branch; '<instr>.<sz> <regA>,<regB>,<label>'
+        class ThreeOpInstrStatement : public Statement {
+        public:
+            using Ref = std::shared_ptr<ThreeOpInstrStatement>;
+        public:
+            ThreeOpInstrStatement() = default;
+            explicit ThreeOpInstrStatement(const std::string &instr) : Statement(NodeType::kThreeOpInstrStatement), symbol(instr) {
+
+            }
+            void SetOpSize(gnilk::vcpu::OperandSize newOpSize) {
+                opSize = newOpSize;
+            }
+            void SetOpFamily(gnilk::vcpu::OperandFamily newOpFamily) {
+                opFamily = newOpFamily;
+            }
+            void SetFirst(const Expression::Ref newFirst) {
+                first = newFirst;
+            }
+            void SetSecond(const Expression::Ref newSecond) {
+                second = newSecond;
+            }
+            void SetThird(const Expression::Ref newThird) {
+                third = newThird;
+            }
+
+            const std::string &Symbol() {
+                return symbol;
+            }
+            gnilk::vcpu::OperandSize OpSize() {
+                return opSize;
+            }
+            gnilk::vcpu::OperandFamily OpFamily() {
+                return opFamily;
+            }
+            Expression::Ref First() {
+                return first;
+            }
+            Expression::Ref Second() {
+                return second;
+            }
+            Expression::Ref Third() {
+                return third;
+            }
+
+            void Dump() override {
+                WriteLine("Three Op Instruction");
+                Indent();
+                WriteLine("Symbol: {}", symbol);
+                WriteLine("OpSize: {}", (int)opSize);
+                for(auto &op : {first, second, third}) {
+                    WriteLine("Operand:");
+                    Indent();
+                    op->Dump();
+                    Unindent();
+                }
+                Unindent();
+            }
+
+        protected:
+            std::string symbol = {};
+            gnilk::vcpu::OperandSize opSize = gnilk::vcpu::OperandSize::Long;
+            gnilk::vcpu::OperandFamily opFamily = gnilk::vcpu::OperandFamily::Integer;
+            ast::Expression::Ref first;
+            ast::Expression::Ref second;
+            ast::Expression::Ref third;
+        };
+
         class OneOpInstrStatment : public Statement {
         public:
             using Ref = std::shared_ptr<OneOpInstrStatment>;
@@ -183,6 +250,56 @@ namespace gnilk {
             std::string symbol = {};
         };
 
+        // SIMD extension instruction - the size is kept as written (fp32, i16, etc.) and the operands are
+        // vector registers, dereferenced address registers with optional advance - '(a0)+' - data registers or a mask
+        class SimdInstrStatement : public Statement {
+        public:
+            using Ref = std::shared_ptr<SimdInstrStatement>;
+            struct Operand {
+                ast::Expression::Ref expression;
+                bool advance = false;
+            };
+        public:
+            SimdInstrStatement() = default;
+            explicit SimdInstrStatement(const std::string &instr) : Statement(NodeType::kSimdInstrStatement), symbol(instr) {
+
+            }
+            void SetOpSize(const std::string &newOpSize) {
+                opSize = newOpSize;
+            }
+            void AddOperand(const Expression::Ref expression, bool advance) {
+                operands.push_back({expression, advance});
+            }
+
+            const std::string &Symbol() {
+                return symbol;
+            }
+            const std::string &OpSize() {
+                return opSize;
+            }
+            const std::vector<Operand> &Operands() {
+                return operands;
+            }
+
+            void Dump() override {
+                WriteLine("SIMD Instruction");
+                Indent();
+                WriteLine("Symbol: {}", symbol);
+                WriteLine("OpSize: {}", opSize);
+                for(auto &op : operands) {
+                    WriteLine("Operand{}:", op.advance?" (advance)":"");
+                    Indent();
+                    op.expression->Dump();
+                    Unindent();
+                }
+                Unindent();
+            }
+
+        protected:
+            std::string symbol = {};
+            std::string opSize = {};
+            std::vector<Operand> operands;
+        };
 
 
     }
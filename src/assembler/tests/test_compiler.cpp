@@ -10,6 +10,8 @@
 #include "Compiler/Compiler.h"
 #include "Compiler/CompileUnit.h"
 #include "VirtualCPU.h"
+#include "InstructionSetV1/InstructionSetV1.h"
+#include "InstructionSetV1/InstructionSetV1Fixed.h"
 #include "HexDump.h"
 
 using namespace gnilk::assembler;
@@ -49,6 +51,12 @@ extern "C" {
     DLL_EXPORT int test_compiler_lea_labelseg(ITesting *t);
     DLL_EXPORT int test_compiler_export(ITesting *t);
     DLL_EXPORT int test_compiler_includefile(ITesting *t);
+    DLL_EXPORT int test_compiler_atomics(ITesting *t);
+    DLL_EXPORT int test_compiler_cacheops(ITesting *t);
+    DLL_EXPORT int test_compiler_blockops(ITesting *t);
+    DLL_EXPORT int test_compiler_cmpbranch(ITesting *t);
+    DLL_EXPORT int test_compiler_fixed(ITesting *t);
+    DLL_EXPORT int test_compiler_fixed_invalid(ITesting *t);
 }
 
 static uint8_t ram[512*1024] = {};
@@ -1154,3 +1162,315 @@ DLL_EXPORT int test_compiler_includefile(ITesting *t) {
     return kTR_Pass;
 }
 
+DLL_EXPORT int test_compiler_atomics(ITesting *t) {
+    std::vector<uint8_t> expectedBinary= {
+        0x98,0x03,0x03,0x80,            // ldl.l d0,(a0)
+        0x99,0x03,0x80,0x13,            // stc.l (a0),d1
+        0x9a,0x01,0x88,0x23,0x10,       // cas.w (a0+0x10),d2
+    };
+    std::vector<std::string> codes={
+        {
+            "ldl.l  d0,(a0)\n"\
+            "stc.l  (a0),d1\n"\
+            "cas.w  (a0+0x10),d2\n"
+        },
+        // Atomics must operate on memory
+        {
+            "ldl.l  d0,d1\n"
+        },
+    };
+
+    Parser parser;
+    Compiler compiler;
+    auto ast = parser.ProduceAST(codes[0]);
+    TR_ASSERT(t, ast != nullptr);
+    TR_ASSERT(t, compiler.CompileAndLink(ast));
+    auto binary = compiler.Data();
+    TR_ASSERT(t, binary == expectedBinary);
+
+    Compiler compilerFail;
+    ast = parser.ProduceAST(codes[1]);
+    TR_ASSERT(t, ast != nullptr);
+    TR_ASSERT(t, !compilerFail.CompileAndLink(ast));
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_compiler_cacheops(ITesting *t) {
+    std::vector<uint8_t> expectedBinary= {
+        0x64,                           // fence
+        0xa8,0x03,0x80,                 // cflush (a0)
+        0xa9,0x03,0x80,                 // cinval (a0)
+        0xaa,0x03,0x88,0x10,            // cclean (a0+0x10)
+        0xab,0x03,0x80,                 // prefetch (a0)
+    };
+    std::vector<std::string> codes={
+        {
+            "fence\n"\
+            "cflush (a0)\n"\
+            "cinval (a0)\n"\
+            "cclean (a0+0x10)\n"\
+            "prefetch (a0)\n"
+        },
+        // Operates on an address
+        {
+            "cflush d0\n"
+        },
+    };
+
+    Parser parser;
+    Compiler compiler;
+    auto ast = parser.ProduceAST(codes[0]);
+    TR_ASSERT(t, ast != nullptr);
+    TR_ASSERT(t, compiler.CompileAndLink(ast));
+    auto binary = compiler.Data();
+    TR_ASSERT(t, binary == expectedBinary);
+
+    Compiler compilerFail;
+    ast = parser.ProduceAST(codes[1]);
+    TR_ASSERT(t, ast != nullptr);
+    TR_ASSERT(t, !compilerFail.CompileAndLink(ast));
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_compiler_blockops(ITesting *t) {
+    std::vector<uint8_t> expectedBinary= {
+        0xa4,0x00,0x90,0x80,            // movs.b (a1),(a0)
+        0xa5,0x00,0x90,0x01,0x55,       // fill.b (a1),0x55
+        0xa5,0x01,0x90,0x13,            // fill.w (a1),d1
+    };
+    std::vector<std::string> codes={
+        {
+            "movs.b (a1),(a0)\n"\
+            "fill.b (a1),0x55\n"\
+            "fill.w (a1),d1\n"
+        },
+        // Both are addresses
+        {
+            "movs.b (a1),d0\n"
+        },
+        // The value can't be in memory
+        {
+            "fill.b (a1),(a0)\n"
+        },
+    };
+
+    Parser parser;
+    Compiler compiler;
+    auto ast = parser.ProduceAST(codes[0]);
+    TR_ASSERT(t, ast != nullptr);
+    TR_ASSERT(t, compiler.CompileAndLink(ast));
+    auto binary = compiler.Data();
+    TR_ASSERT(t, binary == expectedBinary);
+
+    for(size_t i=1;i<codes.size();i++) {
+        Compiler compilerFail;
+        ast = parser.ProduceAST(codes[i]);
+        TR_ASSERT(t, ast != nullptr);
+        TR_ASSERT(t, !compilerFail.CompileAndLink(ast));
+    }
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_compiler_cmpbranch(ITesting *t) {
+    const char srcCode[]= {
+        "  .code \n"\
+        "   .org 0x0000 \n"\
+        "   move.l d0, 3\n"\
+        "   move.l d1, 0\n"\
+        // 0x0018
+        "lp: \n"\
+        "   add.l d1, 1\n"\
+        // 0x0024 : 0xd6, 0x03, 0x10, 0xff, 0xef
+        "   blt.l d1, d0, lp\n"\
+        // 0x0029 : 0xd5, 0x03, 0x10, 0x00, 0x05
+        "   bne.l d1, d0, fail\n"\
+        // 0x002e : 0xd4, 0x13, 0x2f, 0x00, 0x0c   <- control family, d2 and cr7
+        "   beq.l d2, zero, out\n"\
+        "fail: \n"\
+        "   move.l d3, 1\n"\
+        "out: \n"\
+        "   brk\n"\
+        ""
+    };
+    std::vector<uint8_t> expectedBranches = {
+        0xd6, 0x03, 0x10, 0xff, 0xef,
+        0xd5, 0x03, 0x10, 0x00, 0x05,
+        0xd4, 0x13, 0x2f, 0x00, 0x0c,
+    };
+
+    Parser parser;
+    Compiler compiler;
+    auto ast = parser.ProduceAST(srcCode);
+    TR_ASSERT(t, ast != nullptr);
+    TR_ASSERT(t, compiler.CompileAndLink(ast));
+
+    auto data = compiler.Data();
+    HexDump::ToConsole(data.data(),data.size());
+    TR_ASSERT(t, data.size() > 0x24 + expectedBranches.size());
+    TR_ASSERT(t, std::equal(expectedBranches.begin(), expectedBranches.end(), data.begin() + 0x24));
+    memcpy(ram, data.data(), data.size());
+
+    gnilk::vcpu::VirtualCPU cpu;
+    cpu.QuickStart(ram, 1024*512);
+    std::string disasmBranch;
+    for(int i=0;i<32;i++) {
+        auto instrPtr = cpu.GetRegisters().instrPointer.data.dword;
+        cpu.Step();
+        fmt::println("{}\t{}", instrPtr, cpu.GetLastDecodedInstr()->ToString());
+        if (instrPtr == 0x24) {
+            disasmBranch = cpu.GetLastDecodedInstr()->ToString();
+        }
+        if (cpu.IsHalted()) {
+            break;
+        }
+    }
+    TR_ASSERT(t, cpu.IsHalted());
+    TR_ASSERT(t, cpu.GetRegisters().dataRegisters[1].data.longword == 3);
+    TR_ASSERT(t, cpu.GetRegisters().dataRegisters[3].data.longword == 0);
+    TR_ASSERT(t, disasmBranch == "brlt.l\td1,d0,0x18");
+
+    return kTR_Pass;
+}
+
+// Puts the v1 root back when the test is done, regardless of how it ends
+struct FixedEncodingScope {
+    FixedEncodingScope() {
+        InstructionSetManager::Instance().SetInstructionSet<InstructionSetV1Fixed>();
+    }
+    ~FixedEncodingScope() {
+        InstructionSetManager::Instance().SetInstructionSet<InstructionSetV1>();
+    }
+};
+
+DLL_EXPORT int test_compiler_fixed(ITesting *t) {
+    const char srcCode[]= {
+        "  .code \n"\
+        "   .org 0x0000 \n"\
+        // 0x0000 : 0x20, 0xc0, 0xc1, 0x00, <long immediate>
+        "   move.l d0, 3\n"\
+        "   move.b d1, 0\n"\
+        "lp: \n"\
+        "   add.l d1, 1\n"\
+        "   blt.l d1, d0, lp\n"\
+        "   move.w d2, 0x1234\n"\
+        "   lea a0, values\n"\
+        "   move.d d3, (a0+4)\n"\
+        "   move.l d4, 2\n"\
+        "   move.b d5, (a0+d4<<1)\n"\
+        "   call func\n"\
+        "   bne.l d1, d0, fail\n"\
+        "   cmp.l d1, d0\n"\
+        "   bne.b fail\n"\
+        "   beq.w out\n"\
+        "fail: \n"\
+        "   move.l d7, 1\n"\
+        "out: \n"\
+        "   brk\n"\
+        "func: \n"\
+        "   move.l d6, 0x55\n"\
+        "   ret\n"\
+        "values: \n"\
+        "   dc.d 0, 0x11223344\n"\
+        ""
+    };
+    std::vector<uint8_t> expectedFirst = {
+        0x20, 0xc0, 0xc1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03,
+    };
+
+    FixedEncodingScope fixedEncoding;
+
+    Parser parser;
+    Compiler compiler;
+    auto ast = parser.ProduceAST(srcCode);
+    TR_ASSERT(t, ast != nullptr);
+    TR_ASSERT(t, compiler.CompileAndLink(ast));
+
+    auto data = compiler.Data();
+    HexDump::ToConsole(data.data(),data.size());
+    TR_ASSERT(t, (data.size() % sizeof(uint32_t)) == 0);
+    TR_ASSERT(t, std::equal(expectedFirst.begin(), expectedFirst.end(), data.begin()));
+    memcpy(ram, data.data(), data.size());
+
+    gnilk::vcpu::VirtualCPU cpu;
+    cpu.QuickStart(ram, 1024*512);
+    for(int i=0;i<64;i++) {
+        auto instrPtr = cpu.GetRegisters().instrPointer.data.dword;
+        cpu.Step();
+        fmt::println("{}\t{}", instrPtr, cpu.GetLastDecodedInstr()->ToString());
+        // all instructions are word aligned
+        TR_ASSERT(t, (instrPtr & 3) == 0);
+        if (cpu.IsHalted()) {
+            break;
+        }
+    }
+    auto &regs = cpu.GetRegisters();
+    TR_ASSERT(t, cpu.IsHalted());
+    TR_ASSERT(t, regs.dataRegisters[1].data.longword == 3);
+    TR_ASSERT(t, regs.dataRegisters[2].data.word == 0x1234);
+    TR_ASSERT(t, regs.dataRegisters[3].data.dword == 0x11223344);
+    TR_ASSERT(t, regs.dataRegisters[5].data.byte == 0x11);
+    TR_ASSERT(t, regs.dataRegisters[6].data.longword == 0x55);
+    TR_ASSERT(t, regs.dataRegisters[7].data.longword == 0);
+
+    return kTR_Pass;
+}
+
+// An invalid op-code resumes at the next word after rte, the stream must stay aligned
+DLL_EXPORT int test_compiler_fixed_invalid(ITesting *t) {
+    const char srcMain[]= {
+        "  .code \n"\
+        "   .org 0x0000 \n"\
+        // op-code 0x01 is not defined, regardless of the byte order
+        "   dc.d 0x01010101 \n"\
+        "   move.l d1, 0x55\n"\
+        "   brk\n"\
+        ""
+    };
+    const char srcHandler[]= {
+        "  .code \n"\
+        "   .org 0x0000 \n"\
+        "   add.l d7, 1\n"\
+        "   rte\n"\
+        ""
+    };
+
+    FixedEncodingScope fixedEncoding;
+
+    Parser parserMain;
+    Compiler compilerMain;
+    TR_ASSERT(t, compilerMain.CompileAndLink(parserMain.ProduceAST(srcMain)));
+    Parser parserHandler;
+    Compiler compilerHandler;
+    TR_ASSERT(t, compilerHandler.CompileAndLink(parserHandler.ProduceAST(srcHandler)));
+
+    ISR_VECTOR_TABLE isrTable = {
+        .exp_illegal_instr = 0x1000,
+    };
+    gnilk::vcpu::VirtualCPU cpu;
+    cpu.Begin(ram, 32*4096);
+    cpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+    cpu.LoadDataToRam(0x1000, compilerHandler.Data().data(), compilerHandler.Data().size());
+    cpu.LoadDataToRam(0x2000, compilerMain.Data().data(), compilerMain.Data().size());
+    cpu.SetInstrPtr(0x2000);
+    cpu.EnableException(CPUKnownExceptions::kInvalidInstruction);
+
+    for(int i=0;i<16;i++) {
+        auto instrPtr = cpu.GetRegisters().instrPointer.data.longword;
+        // all instructions are word aligned
+        TR_ASSERT(t, (instrPtr & 3) == 0);
+        cpu.Step();
+        if (cpu.IsHalted()) {
+            break;
+        }
+    }
+    auto &regs = cpu.GetRegisters();
+    TR_ASSERT(t, cpu.IsHalted());
+    TR_ASSERT(t, !cpu.IsCPUExpActive());
+    TR_ASSERT(t, regs.dataRegisters[7].data.longword == 1);
+    TR_ASSERT(t, regs.dataRegisters[1].data.longword == 0x55);
+
+    return kTR_Pass;
+}
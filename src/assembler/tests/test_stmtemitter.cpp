@@ -10,6 +10,7 @@
 #include "Compiler/CompileUnit.h"
 #include "HexDump.h"
 #include "Compiler/StmtEmitter.h"
+#include "Simd/SIMDInstructionSetDef.h"
 
 using namespace gnilk::assembler;
 using namespace gnilk::vcpu;
@@ -22,6 +23,7 @@ DLL_EXPORT int test_stmtemitter_struct_in_struct(ITesting *t);
 DLL_EXPORT int test_stmtemitter_structref(ITesting *t);
 DLL_EXPORT int test_stmtemitter_call_label(ITesting *t);
 DLL_EXPORT int test_stmtemitter_call_relative_label(ITesting *t);
+DLL_EXPORT int test_stmtemitter_simd(ITesting *t);
 
 }
 
@@ -213,3 +215,43 @@ DLL_EXPORT int test_stmtemitter_struct_in_struct(ITesting *t) {
     TR_ASSERT(t, binary.size() == 15);
     return kTR_Pass;
 }
+
+DLL_EXPORT int test_stmtemitter_simd(ITesting *t) {
+    std::vector<uint8_t> expectedBinary= {
+        OperandCode::SIMD, SimdOpCode::LOAD, uint8_t(kOpSize_Fp32) | uint8_t(kOpAddrMode_SrcReg), kOpLowFlag_Advance | 1, 0x00,
+        OperandCode::SIMD, SimdOpCode::STORE, uint8_t(kOpSize_Fp16) | uint8_t(kOpAddrMode_DstReg), kOpLowFlag_Integer | 2, 0x33,
+        OperandCode::SIMD, SimdOpCode::LOADS, uint8_t(kOpSize_Fp32) | uint8_t(kOpAddrMode_SrcReg), kOpLowFlag_Integer | kOpLowFlag_Advance | 4, 0x13,
+        OperandCode::SIMD, SimdOpCode::GATHER, uint8_t(kOpSize_Fp64) | uint8_t(kOpAddrMode_SrcReg), kOpLowFlag_Integer | 5, 0x26,
+        OperandCode::SIMD, SimdOpCode::SCATTER, uint8_t(kOpSize_Fp8) | uint8_t(kOpAddrMode_DstReg), kOpLowFlag_Integer | 3, 0x78,
+        OperandCode::SIMD, SimdOpCode::VMUL, kOpSize_Fp32, 15, 0xe1,
+    };
+    std::vector<std::string> codes={
+            {
+                "ve_load.fp32 v1,(a0)+\n"\
+                "ve_store.i16 (a2),v3,0x3\n"\
+                "ve_loads.i32 v4,(a1)+,d3\n"\
+                "ve_gather.i64 v5,(a2),v6\n"\
+                "ve_scatter.i8 (a3),v7,v8\n"\
+                "ve_mul.fp32 v15,v14,v1\n"
+            }
+    };
+
+    Parser parser;
+    Compiler compiler;
+    auto ast = parser.ProduceAST(codes[0]);
+    TR_ASSERT(t, ast != nullptr);
+    auto res = compiler.CompileAndLink(ast);
+    TR_ASSERT(t, res == true);
+    auto binary = compiler.Data();
+    TR_ASSERT(t, binary == expectedBinary);
+
+    // two address registers, advance on an op without it and the wrong register class for the third operand
+    for(auto &invalid : {"ve_load.fp32 (a0),(a1)", "ve_gather.i32 v0,(a1)+,v1", "ve_loads.i32 v4,(a1),v2", "ve_mul.fp32 v15,v14,d1"}) {
+        Compiler compilerInvalid;
+        auto astInvalid = parser.ProduceAST(invalid);
+        TR_ASSERT(t, astInvalid != nullptr);
+        TR_ASSERT(t, !compilerInvalid.CompileAndLink(astInvalid));
+    }
+
+    return kTR_Pass;
+}
@@ -6,6 +6,9 @@
 #include "CPUBase.h"
 #include "System.h"
 #include <mutex>
+#include <stddef.h>
+#include <bit>
+#include <limits>
 
 using namespace gnilk;
 using namespace gnilk::vcpu;
@@ -57,6 +60,10 @@ void CPUBase::DoEnd() {
 void CPUBase::Reset() {
     // Everything is zero upon reset...
     memset(&registers, 0, sizeof(registers));
+    pendingInterrupts = 0;
+    flaggedInterrupts = 0;
+    activeISRDepth = 0;
+    extensionStates.fill(nullptr);
 
     // Ah - this is interesting - we need to fix this!
     auto ramregion = SoC::Instance().GetFirstRegionFromBusType<RamBus>();
@@ -134,14 +141,183 @@ MemoryLayout *CPUBase::GetSystemMemoryBlock() {
 }
 
 bool CPUBase::RegisterSysCall(uint16_t id, const std::string &name, SysCallDelegate handler) {
-    if (syscalls.contains(id)) {
+    if (id == kSysCall_SubmitRing) {
+        fmt::println(stderr, "SysCall id {:#x} is reserved", id);
+        return false;
+    }
+    if ((id < syscalls.size()) && syscalls[id].IsValid()) {
         fmt::println(stderr, "SysCall with id {} ({:#x}) already exists",  id,id);
         return false;
     }
-    auto inst = SysCall::Create(id, name, handler);
-    syscalls[id] = inst;
+    if (id >= syscalls.size()) {
+        syscalls.resize(id + 1);
+    }
+    syscalls[id] = SysCall(id, name, std::move(handler));
     return true;
 }
+
+bool CPUBase::InvokeSysCall(uint16_t id) {
+    if (id == kSysCall_SubmitRing) {
+        registers.dataRegisters[0].data.longword = static_cast<uint64_t>(ProcessSysCallRing(registers.addressRegisters[0].data.longword));
+        return true;
+    }
+    if ((id >= syscalls.size()) || !syscalls[id].IsValid()) {
+        return false;
+    }
+    syscalls[id].Invoke(registers, this);
+    return true;
+}
+
+//
+// Drain the guest syscall ring, the handlers work on a copy of the registers so the guest state is left alone
+// (except d0 which holds the number of processed requests, or -1 if the ring is corrupt or outside mapped memory).
+//
+int64_t CPUBase::ProcessSysCallRing(uint64_t ringAddress) {
+    // The ring pointer comes from the guest - translate it and check the header before reading anything
+    auto address = memoryUnit.TranslateAddress(ringAddress);
+    if (!memoryUnit.IsAddressRangeValid(address, sizeof(SysCallRing))) {
+        fmt::println(stderr, "SysCall ring at {:#x} is outside mapped memory", ringAddress);
+        return -1;
+    }
+    auto head = memoryUnit.Read<uint64_t>(address + offsetof(SysCallRing, head));
+    auto tail = memoryUnit.Read<uint64_t>(address + offsetof(SysCallRing, tail));
+    auto numEntries = memoryUnit.Read<uint64_t>(address + offsetof(SysCallRing, numEntries));
+    if ((numEntries == 0) || ((numEntries & (numEntries - 1)) != 0)) {
+        fmt::println(stderr, "SysCall ring at {:#x} has invalid size {}", address, numEntries);
+        return -1;
+    }
+    // The guest owns 'tail' - never trust it to be within the ring, we would spin forever on a bogus one
+    if ((tail - head) > numEntries) {
+        fmt::println(stderr, "SysCall ring at {:#x} is corrupt, head={} tail={} numEntries={}", address, head, tail, numEntries);
+        return -1;
+    }
+    // All entries must be mapped, checked once - the loop below reads/writes them directly
+    static const uint64_t maxEntries = (std::numeric_limits<uint64_t>::max() - sizeof(SysCallRing)) / sizeof(SysCallRequest);
+    if ((numEntries > maxEntries) || !memoryUnit.IsAddressRangeValid(address, sizeof(SysCallRing) + numEntries * sizeof(SysCallRequest))) {
+        fmt::println(stderr, "SysCall ring at {:#x} with {} entries is outside mapped memory", ringAddress, numEntries);
+        return -1;
+    }
+    auto addrEntries = address + sizeof(SysCallRing);
+
+    int64_t nProcessed = 0;
+    for(;head != tail; head++) {
+        auto addrRequest = addrEntries + (head & (numEntries - 1)) * sizeof(SysCallRequest);
+        auto id = memoryUnit.Read<uint64_t>(addrRequest + offsetof(SysCallRequest, id));
+        // Unknown id's and nested ring submissions are skipped, result = 0
+        uint64_t result = 0;
+        if ((id < syscalls.size()) && syscalls[id].IsValid()) {
+            // Each request starts from the guest registers, nothing leaks from the previous handler
+            Registers callRegs = registers;
+            callRegs.dataRegisters[0].data.longword = id;
+            for(size_t i=0;i<4;i++) {
+                auto addrArg = addrRequest + offsetof(SysCallRequest, args) + i * sizeof(uint64_t);
+                callRegs.dataRegisters[i+1].data.longword = memoryUnit.Read<uint64_t>(addrArg);
+            }
+            syscalls[id].Invoke(callRegs, this);
+            result = callRegs.dataRegisters[0].data.longword;
+        }
+        memoryUnit.Write<uint64_t>(addrRequest + offsetof(SysCallRequest, result), result);
+        nProcessed++;
+    }
+    memoryUnit.Write<uint64_t>(address + offsetof(SysCallRing, head), head);
+    return nProcessed;
+}
+//
+// Atomics - the register value holds the operand in the lower bits, the rest is zero-extended on load
+//
+template<typename T>
+static int32_t LoadLinkedAs(MMU &mmu, uint64_t address, RegisterValue &outValue) {
+    T value = {};
+    auto res = mmu.LoadLinked<T>(address, value);
+    outValue.data.longword = value;
+    return res;
+}
+template<typename T>
+static int32_t CompareAndSwapAs(MMU &mmu, uint64_t address, RegisterValue &inOutExpected, const RegisterValue &desired) {
+    T expected = T(inOutExpected.data.longword);
+    auto res = mmu.CompareAndSwap<T>(address, expected, T(desired.data.longword));
+    if (res == 0) {
+        inOutExpected.data.longword = expected;
+    }
+    return res;
+}
+
+int32_t CPUBase::LoadLinkedFromMemoryUnit(OperandSize szOperand, uint64_t address, RegisterValue &outValue) {
+    address = memoryUnit.TranslateAddress(address);
+    switch(szOperand) {
+        case OperandSize::Byte :
+            return LoadLinkedAs<uint8_t>(memoryUnit, address, outValue);
+        case OperandSize::Word :
+            return LoadLinkedAs<uint16_t>(memoryUnit, address, outValue);
+        case OperandSize::DWord :
+            return LoadLinkedAs<uint32_t>(memoryUnit, address, outValue);
+        case OperandSize::Long :
+            return LoadLinkedAs<uint64_t>(memoryUnit, address, outValue);
+    }
+    return -1;
+}
+
+int32_t CPUBase::StoreConditionalToMemoryUnit(OperandSize szOperand, uint64_t address, const RegisterValue &value) {
+    address = memoryUnit.TranslateAddress(address);
+    switch(szOperand) {
+        case OperandSize::Byte :
+            return memoryUnit.StoreConditional<uint8_t>(address, value.data.byte);
+        case OperandSize::Word :
+            return memoryUnit.StoreConditional<uint16_t>(address, value.data.word);
+        case OperandSize::DWord :
+            return memoryUnit.StoreConditional<uint32_t>(address, value.data.dword);
+        case OperandSize::Long :
+            return memoryUnit.StoreConditional<uint64_t>(address, value.data.longword);
+    }
+    return -1;
+}
+
+int32_t CPUBase::CompareAndSwapMemoryUnit(OperandSize szOperand, uint64_t address, RegisterValue &inOutExpected, const RegisterValue &desired) {
+    address = memoryUnit.TranslateAddress(address);
+    switch(szOperand) {
+        case OperandSize::Byte :
+            return CompareAndSwapAs<uint8_t>(memoryUnit, address, inOutExpected, desired);
+        case OperandSize::Word :
+            return CompareAndSwapAs<uint16_t>(memoryUnit, address, inOutExpected, desired);
+        case OperandSize::DWord :
+            return CompareAndSwapAs<uint32_t>(memoryUnit, address, inOutExpected, desired);
+        case OperandSize::Long :
+            return CompareAndSwapAs<uint64_t>(memoryUnit, address, inOutExpected, desired);
+    }
+    return -1;
+}
+
+int32_t CPUBase::CacheLineOpMemoryUnit(MMU::CacheLineOp op, uint64_t address) {
+    address = memoryUnit.TranslateAddress(address);
+    return memoryUnit.CacheLineOperation(op, address);
+}
+
+int32_t CPUBase::CopyBlockMemoryUnit(uint64_t dstAddress, uint64_t srcAddress, size_t nBytes) {
+    dstAddress = memoryUnit.TranslateAddress(dstAddress);
+    srcAddress = memoryUnit.TranslateAddress(srcAddress);
+    return memoryUnit.CopyBlock(dstAddress, srcAddress, nBytes);
+}
+
+int32_t CPUBase::FillBlockMemoryUnit(OperandSize szOperand, uint64_t dstAddress, const RegisterValue &value, size_t nBytes) {
+    dstAddress = memoryUnit.TranslateAddress(dstAddress);
+    uint8_t pattern[sizeof(uint64_t)];
+    switch(szOperand) {
+        case OperandSize::Byte :
+            MMU::ToByteStream<uint8_t>(pattern, value.data.byte);
+            break;
+        case OperandSize::Word :
+            MMU::ToByteStream<uint16_t>(pattern, value.data.word);
+            break;
+        case OperandSize::DWord :
+            MMU::ToByteStream<uint32_t>(pattern, value.data.dword);
+            break;
+        case OperandSize::Long :
+            MMU::ToByteStream<uint64_t>(pattern, value.data.longword);
+            break;
+    }
+    return memoryUnit.FillBlock(dstAddress, pattern, ByteSizeOfOperandSize(szOperand), nBytes);
+}
+
 void CPUBase::UpdateMMU() {
     // FIXME: refactor mmu
     auto mmuControl0 = registers.cntrlRegisters.named.mmuControl;
@@ -162,10 +338,10 @@ bool CPUBase::AddPeripheral(CPUIntFlag intMask, CPUInterruptId interruptId, Peri
         .interruptId = interruptId,
         .peripheral =  peripheral
     };
-    // TMP TMP TMP
-    interruptMapping[interruptId] = intMask;
+    interruptMapping[interruptId & (MAX_INTERRUPTS - 1)] = intMask;
 
     peripheral->SetInterruptController(this);
+    peripheral->SetScheduler(this);
     peripheral->MapToInterrupt(interruptId);
     peripherals.push_back(instance);
 
@@ -178,8 +354,11 @@ void CPUBase::DelPeripherals() {
     for(auto &p : peripherals) {
         p.peripheral->Stop();
     }
-    // FIXME: Clear interrupt mappings..
     peripherals.clear();
+    interruptMapping = {};
+    pendingInterrupts = 0;
+    flaggedInterrupts = 0;
+    eventScheduler.Clear();
 }
 
 void CPUBase::ResetPeripherals() {
@@ -189,13 +368,18 @@ void CPUBase::ResetPeripherals() {
 }
 
 void CPUBase::UpdatePeripherals() {
-    // This makes Peripherals run in sync with the CPU - but that's not quite true what they do
-    // Instead they run based on electrical signals and the CPU samples them
-
-    // Still, keeping this interface in case I did something stupid..
-    for(auto &p : peripherals) {
-        p.peripheral->Update();
+    // Peripherals are event driven - they schedule whatever they need in virtual time (see Timer).
+    // Nothing is polled, unless something is due this is a single compare.
+    if (!eventScheduler.IsDue(cycleCounter)) {
+        return;
     }
+    eventScheduler.RunUntil(cycleCounter);
+}
+
+EventScheduler::EventId CPUBase::SchedulePeripheral(Peripheral *peripheral, uint64_t atCycle) {
+    return eventScheduler.Schedule(atCycle, [peripheral](uint64_t cycle) {
+        peripheral->OnScheduledEvent(cycle);
+    });
 }
 
 void CPUBase::RaiseInterrupt(CPUInterruptId interruptId) {
@@ -205,40 +389,37 @@ void CPUBase::RaiseInterrupt(CPUInterruptId interruptId) {
         return;
     }
 
-    if (GetISRState(interruptId) != CPUISRState::Waiting) {
-        // Already within an ISR - do NOT execute another
-        return;
-    }
-
-
-    //
-    // Let's lock the ISR data
-    //
-    std::lock_guard<std::mutex> guard(isrLock);
-
-    // Is this mapped??
-    if (interruptMapping.find(interruptId) == interruptMapping.end()) {
-        return;
-    }
+    // Just flag it - the core will pick it up (see LatchPendingInterrupts) before the next instruction
+    uint64_t bit = static_cast<uint64_t>(1) << (interruptId & (MAX_INTERRUPTS - 1));
+    pendingInterrupts.fetch_or(bit, std::memory_order_release);
+}
 
-    auto mask = interruptMapping[interruptId];
+//
+// Move pending interrupts over to the core, this is where we check mapping/masking - anything not accepted is dropped.
+// Note: the CPU status register can only hold 1 ISR combo at any given time, interrupts are queued in the control blocks
+//
+void CPUBase::LatchPendingInterrupts() {
+    auto pending = pendingInterrupts.exchange(0, std::memory_order_acquire);
     auto &intCntrl = GetInterruptCntrl();
-
-    // Is this enabled?
-    if (!(intCntrl.data.bits & mask)) {
-        return;
+    while(pending != 0) {
+        auto interruptId = static_cast<CPUInterruptId>(std::countr_zero(pending));
+        pending &= pending - 1;
+
+        auto mask = interruptMapping[interruptId];
+        // Mapped and enabled?
+        if (!(intCntrl.data.bits & mask)) {
+            continue;
+        }
+        auto &isrControlBlock = GetISRControlBlock(interruptId);
+        if (isrControlBlock.isrState != CPUISRState::Waiting) {
+            // Already flagged or within this ISR - do NOT execute another
+            continue;
+        }
+        isrControlBlock.intMask = static_cast<CPUIntFlag>(mask);
+        isrControlBlock.interruptId = interruptId;
+        isrControlBlock.isrState = CPUISRState::Flagged;
+        flaggedInterrupts |= static_cast<uint64_t>(1) << interruptId;
     }
-
-    //
-    // Need to queue interrupts - as the CPU status register can only hold 1 ISR combo at any given time
-    //
-    // the TYPE is mapped to an interrupt level (there are 8) - in total we should be able to handle X ISR handlers
-    // with TYPE <-> INT mappings...
-    //
-    auto &isrControlBlock = GetISRControlBlock(interruptId);
-    isrControlBlock.intMask = mask;
-    isrControlBlock.interruptId = interruptId;
-    isrControlBlock.isrState = CPUISRState::Flagged;
 }
 
 void CPUBase::EnableInterrupt(CPUIntFlag interrupt) {
@@ -248,7 +429,6 @@ void CPUBase::EnableInterrupt(CPUIntFlag interrupt) {
         exit(1);
     }
 
-    std::lock_guard<std::mutex> guard(isrLock);
     auto &intCntrl = GetInterruptCntrl();
     intCntrl.data.bits |= interrupt;
 }
@@ -269,11 +449,22 @@ bool CPUBase::IsCPUISRActive() {
     return (registers.cntrlRegisters.named.intExceptionStatus.intActive==1);
 }
 
+// Leave the active (top most) ISR, if nested the previous one becomes active again
 void CPUBase::ResetActiveISR() {
+    if (activeISRDepth == 0) {
+        return;
+    }
 
     // Reset the control block for the active ISR..
-    auto isrControlBlock = GetActiveISRControlBlock();
-    isrControlBlock->isrState = CPUISRState::Waiting;
+    activeISRDepth--;
+    auto &isrControlBlock = GetISRControlBlock(activeISRStack[activeISRDepth]);
+    isrControlBlock.isrState = CPUISRState::Waiting;
+
+    if (activeISRDepth > 0) {
+        registers.cntrlRegisters.named.intExceptionStatus.interruptId = activeISRStack[activeISRDepth-1];
+        SetCPUISRActiveState(true);
+        return;
+    }
 
     // Reset status register values
     SetCPUISRActiveState(false);
@@ -281,41 +472,71 @@ void CPUBase::ResetActiveISR() {
 }
 
 void CPUBase::SetActiveISR(CPUInterruptId interruptId) {
+    activeISRStack[activeISRDepth++] = interruptId;
     registers.cntrlRegisters.named.intExceptionStatus.interruptId = interruptId;
     SetCPUISRActiveState(true);
 }
 
-bool CPUBase::InvokeISRHandlers() {
+void CPUBase::SaveISRContext(ISRControlBlock &isrControlBlock) {
+    isrControlBlock.contextBefore.instrPointer = registers.instrPointer;
+    isrControlBlock.contextBefore.d0 = registers.dataRegisters[0];
+    isrControlBlock.contextBefore.statusReg = registers.statusReg;
+}
+
+void CPUBase::RestoreISRContext(const ISRControlBlock &isrControlBlock) {
+    registers.instrPointer = isrControlBlock.contextBefore.instrPointer;
+    registers.dataRegisters[0] = isrControlBlock.contextBefore.d0;
+    registers.statusReg = isrControlBlock.contextBefore.statusReg;
+}
+
+bool CPUBase::DoInvokeISRHandlers() {
     if (isrVectorTable == nullptr) {
         return false;
     }
 
-    std::lock_guard<std::mutex> guard(isrLock);
+    LatchPendingInterrupts();
 
+    // Is this enabled and raised?
     auto &intCntrl = GetInterruptCntrl();
-    for(int i=0;i<MAX_INTERRUPTS;i++) {
-        // Is this enabled and raised?
-        auto &isrControlBlock = GetISRControlBlock(i);
-
-        if ((intCntrl.data.bits & (1<<i)) && (isrControlBlock.isrState == CPUISRState::Flagged)) {
-            // Save current registers
-            isrControlBlock.registersBefore = registers;
-            // Move the ISR type to a register...
-            registers.dataRegisters[0].data.longword = isrControlBlock.interruptId;
-
-            // reassign it..
-            registers.instrPointer.data.longword = isrVectorTable->isr0;
-            // Update the state
-            isrControlBlock.isrState = CPUISRState::Executing;
-
-            // Set it active
-            SetActiveISR(isrControlBlock.interruptId);
-
-            // We need to break now, since we will be executing an ISR - and even if there is another pending - we can't have multiple...
-            return true;
+    auto candidates = flaggedInterrupts & intCntrl.data.bits;
+    if (candidates == 0) {
+        return false;
+    }
+
+    // Find the one with highest priority, there are only a handful of bits here
+    int idxInterrupt = -1;
+    while(candidates != 0) {
+        auto idxCandidate = std::countr_zero(candidates);
+        candidates &= candidates - 1;
+        if ((idxInterrupt < 0) || (interruptPriority[idxCandidate] > interruptPriority[idxInterrupt])) {
+            idxInterrupt = idxCandidate;
         }
     }
-    return false;
+
+    // Can only preempt an ISR with lower priority
+    if ((activeISRDepth > 0) && (interruptPriority[idxInterrupt] <= GetISRControlBlock(activeISRStack[activeISRDepth-1]).priority)) {
+        return false;
+    }
+    flaggedInterrupts &= ~(static_cast<uint64_t>(1) << idxInterrupt);
+
+    auto &isrControlBlock = GetISRControlBlock(idxInterrupt);
+    // Save what we change - the ISR is responsible for the rest
+    SaveISRContext(isrControlBlock);
+    isrControlBlock.priority = interruptPriority[idxInterrupt];
+    // Move the ISR type to a register...
+    registers.dataRegisters[0].data.longword = isrControlBlock.interruptId;
+
+    // Vectored, each interrupt has it's own - fall back to isr0 if not set (0 is the vector table, never valid)
+    auto isrVector = (&isrVectorTable->isr0)[idxInterrupt];
+    registers.instrPointer.data.longword = (isrVector != 0)?isrVector:isrVectorTable->isr0;
+    // Update the state
+    isrControlBlock.isrState = CPUISRState::Executing;
+
+    // Set it active
+    SetActiveISR(isrControlBlock.interruptId);
+
+    // Only one at the time - anything else pending stays flagged until next time
+    return true;
 }
 
 //
@@ -325,6 +546,10 @@ bool CPUBase::InvokeISRHandlers() {
 // - in case of exception within an exception handler, we will halt the CPU
 //
 bool CPUBase::RaiseException(CPUExceptionId exceptionId) {
+    return RaiseFault(exceptionId, 0, CPUFaultAccess::None);
+}
+
+bool CPUBase::RaiseFault(CPUExceptionId exceptionId, uint64_t faultAddress, CPUFaultAccess faultAccess) {
     if (systemBlock == nullptr) {
         fmt::println(stderr, "CPUBase, started with 'QuickStart' no exception handling, use 'Begin' to get advanced features");
         return false;
@@ -343,8 +568,8 @@ bool CPUBase::RaiseException(CPUExceptionId exceptionId) {
         return false;
     }
 
-    fmt::println(stderr, "CPUBase, raising exception - {:#x}", (int)exceptionId);
-
+    expControlBlock->faultAddress = faultAddress;
+    expControlBlock->faultAccess = faultAccess;
     expControlBlock->state = CPUExceptionState::Raised;
     return InvokeExceptionHandlers(exceptionId);
 }
@@ -387,23 +612,68 @@ bool CPUBase::IsCPUExpActive() {
 
 void CPUBase::ResetActiveExp() {
     SetCPUExpActiveState(false);
+    registers.cntrlRegisters.named.intExceptionStatus.exceptionId = 0;
     expControlBlock->state = CPUExceptionState::Idle;
 }
 
+void CPUBase::RestoreExceptionContext(const ExceptionControlBlock &exceptionControlBlock) {
+    registers.instrPointer = exceptionControlBlock.contextBefore.instrPointer;
+    registers.dataRegisters[0] = exceptionControlBlock.contextBefore.d0;
+    registers.statusReg = exceptionControlBlock.contextBefore.statusReg;
+}
+
+// Each exception has it's own vector - fall back to 'exp_illegal_instr' (the catch-all handler) if not set
+uint64_t CPUBase::GetExceptionVector(CPUExceptionId exceptionId) const {
+    uint64_t vector = 0;
+    switch(exceptionId) {
+        case CPUKnownExceptions::kHardFault :
+            vector = isrVectorTable->exp_hard_fault;
+            break;
+        case CPUKnownExceptions::kInvalidAddrMode :
+            vector = isrVectorTable->exp_invalid_addrmode;
+            break;
+        case CPUKnownExceptions::kDivisionByZero :
+            vector = isrVectorTable->exp_div_zero;
+            break;
+        case CPUKnownExceptions::kDebugTrap :
+            vector = isrVectorTable->exp_debug_trap;
+            break;
+        case CPUKnownExceptions::kMMUFault :
+            vector = isrVectorTable->exp_mmu_fault;
+            break;
+        case CPUKnownExceptions::kFPUFault :
+            vector = isrVectorTable->exp_fpu_fault;
+            break;
+        default:
+            break;
+    }
+    return (vector != 0) ? vector : isrVectorTable->exp_illegal_instr;
+}
+
 bool CPUBase::InvokeExceptionHandlers(CPUExceptionId exceptionId)  {
     if (systemBlock == nullptr) {
         return false;
     }
-    auto &exceptionControl = GetExceptionCntrl();
 
     // Perhaps not needed..
     expControlBlock->flag = CPUExpIdToFlag(exceptionId);
-    // Save current registers
-    expControlBlock->registersBefore = registers;
-    // Move the ISR type to a register...
+
+    // Save only what we change (see ExceptionContext) - this is on the page fault path so keep it small.
+    // Faults re-execute the instruction, anything else resumes at the instr.ptr. A decoder raising an invalid
+    // instruction moves the instr.ptr past it first, only the decoder knows the size in its encoding.
+    uint64_t resumeAddress = registers.instrPointer.data.longword;
+    if (exceptionId == CPUKnownExceptions::kMMUFault) {
+        resumeAddress = instrStartAddress;
+    }
+    auto &context = expControlBlock->contextBefore;
+    context.instrPointer.data.longword = resumeAddress;
+    context.d0 = registers.dataRegisters[0];
+    context.statusReg = registers.statusReg;
+    expControlBlock->faultInstrPtr = instrStartAddress;
+
+    // Move the exception type to a register...
     registers.dataRegisters[0].data.longword = exceptionId;
-    // Note: take this depending on the exception type...
-    registers.instrPointer.data.longword = isrVectorTable->exp_illegal_instr;
+    registers.instrPointer.data.longword = GetExceptionVector(exceptionId);
     // Update the state
     expControlBlock->state = CPUExceptionState::Executing;
 
@@ -11,10 +11,14 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <atomic>
+#include <array>
+#include <vector>
 
 #include "fmt/format.h"
 #include "MemorySubSys/MemoryUnit.h"
 #include "Peripheral.h"
+#include "EventScheduler.h"
 #include "Interrupt.h"
 #include "RegisterValue.h"
 #include "Dispatch.h"
@@ -136,8 +140,6 @@ namespace gnilk {
             //   - Exception mask register
             //   - Copy of CPU Status Register?
             //   - Other?
-            // Consider:
-            //   - zero-register, fixed register with value 0 (makes 'bnz/bez' type of instructions easier, when/if we change the cmp/branch logic to 'bn<op> <regA>, <regB>, label'
             //
             // Layout:
             //  cr0 - INT Mask, zeroed out on reset (0 - disabled, 1 - enabled)     => gives 64 possible interrupts
@@ -147,7 +149,7 @@ namespace gnilk {
             //  cr4 - mmu page table address
             //  cr5 - CPU ID or similar (feature register)
             //  cr6 - INT ID
-            //  cr7 - reserved, unused
+            //  cr7 - zero register, always reads 0 and writes are discarded (use with 'breq/brne/brlt/brge' for zero tests)
             struct Control {
                 RegisterValue cr0 = {};
                 RegisterValue cr1 = {};
@@ -190,7 +192,7 @@ namespace gnilk {
                 RegisterValue mmuPageTableAddress = {};             // FIXME: could be moved to the 'MemoryLayout' block - no need to take a full register for this (or?)
                 RegisterValue cpuid = {};
                 RegisterValue reservedA = {};
-                RegisterValue reservedB = {};
+                RegisterValue zero = {};
             };
 
             union CntrlRegisters {
@@ -209,17 +211,47 @@ namespace gnilk {
 
 
 
+        // Saved on ISR entry and restored by RTI, this is only what the CPU itself changes when entering an ISR.
+        // Any other register used by the ISR must be saved/restored by the ISR.
+        struct ISRContext {
+            RegisterValue instrPointer = {};
+            RegisterValue d0 = {};              // holds the interrupt id on entry
+            CPUStatusReg statusReg = {};
+        };
+
         struct ISRControlBlock {
             CPUIntFlag intMask = {};
             CPUInterruptId interruptId = {};
-            Registers registersBefore = {};
+            uint8_t priority = {};              // priority at the time of invocation
+            ISRContext contextBefore = {};
             RegisterValue rti = {};  // special register for RTI
             CPUISRState isrState = CPUISRState::Waiting;
         };
 
+        // Access causing a fault, see ExceptionControlBlock
+        enum class CPUFaultAccess : uint8_t {
+            None = 0,
+            Read = 1,
+            Write = 2,
+            Execute = 3,
+        };
+
+        // Like ISRContext - saved on exception entry and restored by RTE, any other register used by the handler must be
+        // saved/restored by the handler. 'instrPointer' is where RTE resumes, the handler can change it.
+        // Faults (kMMUFault) are precise and resume at the faulting instruction, anything else after it.
+        struct ExceptionContext {
+            RegisterValue instrPointer = {};
+            RegisterValue d0 = {};              // holds the exception id on entry
+            CPUStatusReg statusReg = {};
+        };
+
         struct ExceptionControlBlock {
             CPUExceptionFlag flag = {};
-            Registers registersBefore = {};
+            ExceptionContext contextBefore = {};
+            // Fault reason, valid while the handler is executing
+            uint64_t faultInstrPtr = {};        // start of the instruction raising the exception
+            uint64_t faultAddress = {};         // memory address for faults, otherwise 0
+            CPUFaultAccess faultAccess = CPUFaultAccess::None;
             RegisterValue rte = {}; // This is RTI - reusing the same instructions
             CPUExceptionState state = CPUExceptionState::Idle;
         };
@@ -245,6 +277,10 @@ namespace gnilk {
 
         static const uint64_t VCPU_RESERVED_RAM = 0x2000;
         static const uint64_t VCPU_INITIAL_PC = 0x2000;
+        // Emulated clock - there is no cycle model, each executed instruction (or halted step) retires one cycle
+        static const uint64_t VCPU_DEFAULT_CLOCK_HZ = 1'000'000;
+        // Register index of cr7 (the zero register) in the control family
+        static const int kZeroRegisterIndex = 15;
 
         class CPUBase;
 
@@ -252,25 +288,52 @@ namespace gnilk {
 
         //
         // A syscall is a gateway to the real world - for now..
+        // Stored by value in a table indexed by the id, no handler means 'not registered'
         //
         class SysCall {
         public:
-            using Ref = std::shared_ptr<SysCall>;   // this can probably be unique ptr
-        public:
-            SysCall(uint16_t sysId, const std::string &sysName, SysCallDelegate handler) : id(sysId), name(sysName), cbHandler(handler) {
+            SysCall() = default;
+            SysCall(uint16_t sysId, const std::string &sysName, SysCallDelegate handler) : id(sysId), name(sysName), cbHandler(std::move(handler)) {
 
             }
             virtual ~SysCall() = default;
-            static SysCall::Ref Create(uint16_t id, const std::string &name, SysCallDelegate handler) {
-                return std::make_shared<SysCall>(id, name, handler);
+
+            bool IsValid() const {
+                return cbHandler != nullptr;
+            }
+            uint16_t GetId() const {
+                return id;
+            }
+            const std::string &GetName() const {
+                return name;
             }
             void Invoke(Registers &regs, CPUBase *cpu) {
                 cbHandler(regs, cpu);
             }
         protected:
-            uint16_t id;
-            std::string name;
-            SysCallDelegate cbHandler;
+            uint16_t id = 0;
+            std::string name = {};
+            SysCallDelegate cbHandler = nullptr;
+        };
+
+        // Reserved id, process all requests in the syscall ring pointed to by a0 - d0 returns the number processed (-1 on a corrupt ring)
+        static const uint16_t kSysCall_SubmitRing = 0xffff;
+
+        //
+        // Batched syscalls (io_uring style), lives in guest RAM in guest byte order (like MMU::Write).
+        // The guest fills in requests at 'tail % numEntries' and bumps 'tail', one 'syscall' with d0 = kSysCall_SubmitRing
+        // processes everything between 'head' and 'tail' and moves 'head' up to 'tail'.
+        // Each request is invoked with d0 = id and d1..d4 = args, d0 after the call is written back to 'result'.
+        //
+        struct SysCallRequest {
+            uint64_t id = {};
+            uint64_t args[4] = {};
+            uint64_t result = {};
+        };
+        struct SysCallRing {
+            uint64_t head = {};             // written by the host
+            uint64_t tail = {};             // written by the guest
+            uint64_t numEntries = {};       // power of two, the requests follow directly after the header
         };
 
         // CPUBase is more of a 'Core'
@@ -283,10 +346,12 @@ namespace gnilk {
 
         class InstructionDecoderBase;
         // FIXME: the ISR controller should be part of the SOC
-        class CPUBase : public InterruptController {
+        class CPUBase : public InterruptController, public PeripheralScheduler {
             friend InstructionDecoderBase;
         public:
             using Ref = std::shared_ptr<CPUBase>;
+            // Number of distinct extension state/config types (see 'GetExtensionState')
+            static constexpr size_t MAX_EXTENSION_SLOTS = 8;
             enum class kProcessDispatchResult {
                 kExecFailed = -3,
                 kNoInstrSet = -2,
@@ -325,6 +390,8 @@ namespace gnilk {
             kProcessDispatchResult ProcessDispatch();
 
             bool RegisterSysCall(uint16_t id, const std::string &name, SysCallDelegate handler);
+            // Returns false if no syscall is registered with this id
+            bool InvokeSysCall(uint16_t id);
 
             bool IsHalted() const {
                 return registers.statusReg.flags.halt;
@@ -338,6 +405,26 @@ namespace gnilk {
                 return dispatcher;
             }
 
+            // Per core state of an instruction set extension (like the SIMD register file), created on first use
+            // and dropped on reset. Each type owns a fixed slot so this stays cheap on the execute path.
+            template<typename T>
+            T &GetExtensionState() {
+                auto &state = extensionStates[ExtensionSlot<T>()];
+                if (state == nullptr) {
+                    state = std::make_shared<T>();
+                }
+                return *static_cast<T *>(state.get());
+            }
+            // Per core options of an instruction set extension (like the SIMD vector length), kept over reset
+            template<typename T>
+            T &GetExtensionConfig() {
+                auto &config = extensionConfigs[ExtensionSlot<T>()];
+                if (config == nullptr) {
+                    config = std::make_shared<T>();
+                }
+                return *static_cast<T *>(config.get());
+            }
+
             const Registers &GetRegisters() const {
                 return registers;
             }
@@ -393,12 +480,20 @@ namespace gnilk {
 
             __inline const RegisterValue &GetRegisterValue(int idxRegister, OperandFamily family) const {
                 if (family == OperandFamily::Control) {
+                    if (idxRegister == kZeroRegisterIndex) {
+                        static const RegisterValue zeroValue = {};
+                        return zeroValue;
+                    }
                     return idxRegister>7?registers.cntrlRegisters.array[idxRegister-8]:registers.dataRegisters[idxRegister];
                 }
                 return idxRegister>7?registers.addressRegisters[idxRegister-8]:registers.dataRegisters[idxRegister];
             }
             __inline RegisterValue &GetRegisterValue(int idxRegister, OperandFamily family) {
                 if (family == OperandFamily::Control) {
+                    // The zero register is hardwired, clear anything written to it since last time
+                    if (idxRegister == kZeroRegisterIndex) {
+                        registers.cntrlRegisters.named.zero = {};
+                    }
                     return idxRegister>7?registers.cntrlRegisters.array[idxRegister-8]:registers.dataRegisters[idxRegister];
                 }
                return idxRegister>7?registers.addressRegisters[idxRegister-8]:registers.dataRegisters[idxRegister];
@@ -424,48 +519,133 @@ namespace gnilk {
                 return v;
             }
 
-            // Read with address translation
-            RegisterValue ReadFromMemoryUnit(OperandSize szOperand, uint64_t address) {
+            // Read immediate values from the instruction stream (i.e. through the instr. cache)
+            RegisterValue ReadFromInstrStream(OperandSize szOperand, uint64_t address) {
                 RegisterValue v = {};
+                switch(szOperand) {
+                    case OperandSize::Byte :
+                        v.data.byte = FetchFromInstrStream<uint8_t>(address);
+                        break;
+                    case OperandSize::Word :
+                        v.data.word = FetchFromInstrStream<uint16_t>(address);
+                        break;
+                    case OperandSize::DWord :
+                        v.data.dword = FetchFromInstrStream<uint32_t>(address);
+                        break;
+                    case OperandSize::Long :
+                        v.data.longword = FetchFromInstrStream<uint64_t>(address);
+                        break;
+                }
+                return v;
+            }
 
-                address = memoryUnit.TranslateAddress(address);
+            // Read/Write with address translation, an access outside mapped memory raises an MMU fault with the
+            // address and access type (see RaiseFault) and returns false
+            bool ReadFromMemoryUnit(OperandSize szOperand, uint64_t address, RegisterValue &outValue) {
+                if (!TryReadFromMemoryUnit(szOperand, address, outValue)) {
+                    RaiseFault(CPUKnownExceptions::kMMUFault, address, CPUFaultAccess::Read);
+                    return false;
+                }
+                return true;
+            }
+
+            // As above but the caller raises the fault, the decoder defers it until the instruction executes
+            bool TryReadFromMemoryUnit(OperandSize szOperand, uint64_t address, RegisterValue &outValue) {
+                auto physicalAddress = memoryUnit.TranslateAddress(address);
+                if (!memoryUnit.IsAddressRangeValid(physicalAddress, ByteSizeOfOperandSize(szOperand))) {
+                    return false;
+                }
 
                 switch(szOperand) {
                     case OperandSize::Byte :
-                        v.data.byte = FetchFromPhysicalRam<uint8_t>(address);
+                        outValue.data.byte = FetchFromPhysicalRam<uint8_t>(physicalAddress);
                     break;
                     case OperandSize::Word :
-                        v.data.word = FetchFromPhysicalRam<uint16_t>(address);
+                        outValue.data.word = FetchFromPhysicalRam<uint16_t>(physicalAddress);
                     break;
                     case OperandSize::DWord :
-                        v.data.dword = FetchFromPhysicalRam<uint32_t>(address);
+                        outValue.data.dword = FetchFromPhysicalRam<uint32_t>(physicalAddress);
                     break;
                     case OperandSize::Long :
-                        v.data.longword = FetchFromPhysicalRam<uint64_t>(address);
+                        outValue.data.longword = FetchFromPhysicalRam<uint64_t>(physicalAddress);
                     break;
                 }
+                return true;
+            }
+
+            RegisterValue ReadFromMemoryUnit(OperandSize szOperand, uint64_t address) {
+                RegisterValue v = {};
+                ReadFromMemoryUnit(szOperand, address, v);
                 return v;
             }
 
-            void WriteToMemoryUnit(OperandSize szOperand, uint64_t address, RegisterValue value) {
-                address = memoryUnit.TranslateAddress(address);
+            bool WriteToMemoryUnit(OperandSize szOperand, uint64_t address, RegisterValue value) {
+                auto physicalAddress = memoryUnit.TranslateAddress(address);
+                if (!memoryUnit.IsAddressRangeValid(physicalAddress, ByteSizeOfOperandSize(szOperand))) {
+                    RaiseFault(CPUKnownExceptions::kMMUFault, address, CPUFaultAccess::Write);
+                    return false;
+                }
                 switch(szOperand) {
                     case OperandSize::Byte :
-                        WriteToPhysicalRam<uint8_t>(address, value.data.byte);
+                        WriteToPhysicalRam<uint8_t>(physicalAddress, value.data.byte);
                         break;
                     case OperandSize::Word :
-                        WriteToPhysicalRam<uint16_t>(address, value.data.word);
+                        WriteToPhysicalRam<uint16_t>(physicalAddress, value.data.word);
                     break;
                     case OperandSize::DWord :
-                        WriteToPhysicalRam<uint32_t>(address, value.data.dword);
+                        WriteToPhysicalRam<uint32_t>(physicalAddress, value.data.dword);
                     break;
                     case OperandSize::Long :
-                        WriteToPhysicalRam<uint64_t>(address, value.data.longword);
+                        WriteToPhysicalRam<uint64_t>(physicalAddress, value.data.longword);
                     break;
 
                 }
+                return true;
+            }
+
+            // Atomics with address translation, see MMU::LoadLinked/StoreConditional/CompareAndSwap for return values
+            // CompareAndSwap updates 'inOutExpected' with the current memory value on failure
+            int32_t LoadLinkedFromMemoryUnit(OperandSize szOperand, uint64_t address, RegisterValue &outValue);
+            int32_t StoreConditionalToMemoryUnit(OperandSize szOperand, uint64_t address, const RegisterValue &value);
+            int32_t CompareAndSwapMemoryUnit(OperandSize szOperand, uint64_t address, RegisterValue &inOutExpected, const RegisterValue &desired);
+            // Cache maintenance with address translation, see MMU::CacheLineOperation
+            int32_t CacheLineOpMemoryUnit(MMU::CacheLineOp op, uint64_t address);
+            // Bulk copy/fill with address translation, see MMU::CopyBlock/FillBlock - fill repeats 'value' at op.size
+            int32_t CopyBlockMemoryUnit(uint64_t dstAddress, uint64_t srcAddress, size_t nBytes);
+            int32_t FillBlockMemoryUnit(OperandSize szOperand, uint64_t dstAddress, const RegisterValue &value, size_t nBytes);
+
+            // Virtual time
+            uint64_t GetCycleCount() const override {
+                return cycleCounter;
+            }
+            uint64_t GetClockFrequency() const override {
+                return clockFrequency;
+            }
+            void SetClockFrequency(uint64_t newClockFrequency) {
+                clockFrequency = newClockFrequency==0?1:newClockFrequency;
+            }
+            void RetireCycles(uint64_t nCycles) {
+                cycleCounter += nCycles;
+            }
+            EventScheduler::EventId ScheduleEvent(uint64_t atCycle, EventScheduler::EventHandler handler) override {
+                return eventScheduler.Schedule(atCycle, std::move(handler));
+            }
+            bool CancelEvent(EventScheduler::EventId id) override {
+                return eventScheduler.Cancel(id);
+            }
+            EventScheduler::EventId SchedulePeripheral(Peripheral *peripheral, uint64_t atCycle) override;
+            EventScheduler &GetEventScheduler() {
+                return eventScheduler;
+            }
 
+            // Timers created by 'Begin/QuickStart' use this mode, must be set before
+            void SetTimerMode(kTimerMode newTimerMode) {
+                timerMode = newTimerMode;
+            }
+            kTimerMode GetTimerMode() const {
+                return timerMode;
             }
+
             void EnableInterrupt(CPUIntFlag interrupt);
             bool AddPeripheral(CPUIntFlag intMAsk, CPUInterruptId interruptId, Peripheral::Ref peripheral);
             void DelPeripherals();
@@ -476,10 +656,17 @@ namespace gnilk {
             bool IsCPUISRActive();
             bool IsCPUExpActive();
 
+            // Thread safe, can be called from any thread - this just flags the interrupt as pending
             void RaiseInterrupt(CPUInterruptId interruptId) override;
             // Returns
             //   true if any of the ISR handlers changed the current Instr.Ptr in order to execute next
-            bool InvokeISRHandlers();
+            __inline bool InvokeISRHandlers() {
+                // Fast path - one relaxed load when nothing is going on
+                if ((pendingInterrupts.load(std::memory_order_relaxed) == 0) && (flaggedInterrupts == 0)) {
+                    return false;
+                }
+                return DoInvokeISRHandlers();
+            }
 
             CPUISRState GetISRState(CPUInterruptId interruptId) {
                 return GetISRControlBlock(interruptId).isrState;
@@ -490,33 +677,64 @@ namespace gnilk {
                 return isrControlBlocks[blockIndex];
             }
 
+            // Higher value has higher priority, an ISR can only be preempted by one with higher priority.
+            // Default is lowest id has highest priority (i.e. MAX_INTERRUPTS-1 - id)
+            void SetInterruptPriority(CPUInterruptId interruptId, uint8_t priority) {
+                interruptPriority[interruptId & (MAX_INTERRUPTS - 1)] = priority;
+            }
+            uint8_t GetInterruptPriority(CPUInterruptId interruptId) const {
+                return interruptPriority[interruptId & (MAX_INTERRUPTS - 1)];
+            }
+            // Number of nested ISR's currently executing
+            size_t GetISRNestingDepth() const {
+                return activeISRDepth;
+            }
+
             // Exceptions
             void EnableException(CPUExceptionId  exceptionId);
             virtual bool RaiseException(CPUExceptionId exceptionId);
+            // Memory faults, the address and access type are available to the handler in the exception control block
+            bool RaiseFault(CPUExceptionId exceptionId, uint64_t faultAddress, CPUFaultAccess faultAccess);
             bool InvokeExceptionHandlers(CPUExceptionId exceptionId);
 
             // FIXME: Solve this - these are public since instruction set's inherits and friend's can't follow inheritance
         public:
             void DoEnd();
+            bool DoInvokeISRHandlers();
+            void LatchPendingInterrupts();
             ISRControlBlock *GetActiveISRControlBlock();
             void ResetActiveISR();
             void SetActiveISR(CPUInterruptId interruptId);
+            void SaveISRContext(ISRControlBlock &isrControlBlock);
+            void RestoreISRContext(const ISRControlBlock &isrControlBlock);
 
             void SetCPUISRActiveState(bool isActive);
             void SetCPUExpActiveState(bool isActive);
             void SetActiveException(CPUExceptionId exceptionId);
             void ResetActiveExp();
+            void RestoreExceptionContext(const ExceptionControlBlock &exceptionControlBlock);
+            uint64_t GetExceptionVector(CPUExceptionId exceptionId) const;
 
             bool IsExceptionEnabled(CPUExceptionId  exceptionFlag);
 
             template<typename T>
             T FetchFromInstrPtr() {
                 auto address = registers.instrPointer.data.longword;
-                T value = FetchFromPhysicalRam<T>(address);
+                T value = FetchFromInstrStream<T>(address);
                 registers.instrPointer.data.longword = address;
                 return value;
             }
 
+            // Read from the instruction stream, this goes through the instruction cache
+            template<typename T>
+            T FetchFromInstrStream(uint64_t &address) {
+                T result = {};
+                result = memoryUnit.FetchInstr<T>(address);
+
+                address += sizeof(T);
+                return result;
+            }
+
             template<typename T>
             void WriteToPhysicalRam(uint64_t &address, const T &value) {
                 memoryUnit.Write(address, value);
@@ -534,6 +752,7 @@ namespace gnilk {
             }
 
             void UpdateMMU();
+            int64_t ProcessSysCallRing(uint64_t address);
        // FIXME: Solve this - these are public since instruction set's inherits and friend's can't follow inheritance
         public:
             struct ISRPeripheralInstance {
@@ -541,6 +760,7 @@ namespace gnilk {
                 CPUInterruptId interruptId;
                 Peripheral::Ref peripheral;
             };
+
         // FIXME: Solve this - these are public since instruction set's inherits and friend's can't follow inheritance
         public:
             Registers registers = {};
@@ -559,17 +779,61 @@ namespace gnilk {
             // End short cut pointers
 
 
-            std::mutex isrLock;
+            // Interrupts raised but not yet seen by the core, one bit per interrupt id - set by peripherals (any thread)
+            std::atomic<uint64_t> pendingInterrupts = 0;
+            // Accepted (enabled, mapped) but not yet invoked - only touched by the core
+            uint64_t flaggedInterrupts = 0;
 
             std::vector<ISRPeripheralInstance> peripherals;
 
+            // Start of the instruction being executed, set before decoding - exceptions report this
+            uint64_t instrStartAddress = 0;
+
+            // Virtual time
+            uint64_t cycleCounter = 0;
+            uint64_t clockFrequency = VCPU_DEFAULT_CLOCK_HZ;
+            kTimerMode timerMode = kTimerMode::VirtualTime;
+            EventScheduler eventScheduler;
+
             // FIXME: Remove this and let the supplied RAM hold the stack...
             std::stack<RegisterValue> stack;
 
-            std::unordered_map<CPUInterruptId , CPUIntFlag> interruptMapping;
-            std::unordered_map<uint32_t, SysCall::Ref> syscalls;
+            // interrupt id -> interrupt mask, zero if not mapped
+            std::array<uint16_t, MAX_INTERRUPTS> interruptMapping = {};
+            std::array<uint8_t, MAX_INTERRUPTS> interruptPriority = DefaultInterruptPriorities();
+            // Nested ISR's, top is the one executing - priority is strictly increasing so we can't nest deeper than this
+            std::array<CPUInterruptId, MAX_INTERRUPTS> activeISRStack = {};
+            size_t activeISRDepth = 0;
+            // Indexed by id, grows on registration
+            std::vector<SysCall> syscalls;
+            // See 'GetExtensionState', indexed by 'ExtensionSlot'
+            std::array<std::shared_ptr<void>, MAX_EXTENSION_SLOTS> extensionStates = {};
+            std::array<std::shared_ptr<void>, MAX_EXTENSION_SLOTS> extensionConfigs = {};
             // debugging
             // TMP TMP
+        private:
+            static constexpr std::array<uint8_t, MAX_INTERRUPTS> DefaultInterruptPriorities() {
+                std::array<uint8_t, MAX_INTERRUPTS> priorities = {};
+                for(int i=0;i<MAX_INTERRUPTS;i++) {
+                    priorities[i] = MAX_INTERRUPTS - 1 - i;
+                }
+                return priorities;
+            }
+            // Slots are handed out once per type, shared by all cores
+            template<typename T>
+            static size_t ExtensionSlot() {
+                static const size_t slot = NextExtensionSlot();
+                return slot;
+            }
+            static size_t NextExtensionSlot() {
+                static std::atomic<size_t> nextSlot = 0;
+                auto slot = nextSlot.fetch_add(1);
+                if (slot >= MAX_EXTENSION_SLOTS) {
+                    fmt::println(stderr, "CPUBase::NextExtensionSlot, too many extension types - raise MAX_EXTENSION_SLOTS");
+                    exit(1);
+                }
+                return slot;
+            }
         public:
             const std::string &GetLastExecuted() {
                 return lastExecuted;
@@ -0,0 +1,282 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#include <string.h>
+#include <stddef.h>
+#include <algorithm>
+#include "fmt/core.h"
+#include "System.h"
+#include "MemorySubSys/MesiBusBase.h"
+#include "MemorySubSys/MemoryUnit.h"
+#include "DMAController.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+Peripheral::Ref DMAController::Create() {
+    return std::make_shared<DMAController>();
+}
+
+Peripheral::Ref DMAController::Create(const DMAConfig &newConfig) {
+    return std::make_shared<DMAController>(newConfig);
+}
+
+void DMAController::Initialize() {
+    Abort();
+    registers = {};
+}
+
+// Nothing to kick off - transfers are started through the registers
+bool DMAController::Start() {
+    return true;
+}
+
+bool DMAController::Stop() {
+    Abort();
+    return true;
+}
+
+uint64_t DMAController::Read64(uint64_t offset) {
+    switch(offset) {
+        case offsetof(DMARegisters, controlBits) :
+            return registers.controlBits;
+        case offsetof(DMARegisters, status) :
+            return registers.status;
+        case offsetof(DMARegisters, descriptor) :
+            return registers.descriptor;
+        case offsetof(DMARegisters, bytesTransferred) :
+            return registers.bytesTransferred;
+        default:
+            return 0;
+    }
+}
+
+// Status and byte counter are read-only
+void DMAController::Write64(uint64_t offset, uint64_t value) {
+    switch(offset) {
+        case offsetof(DMARegisters, controlBits) :
+            registers.controlBits = value;
+            break;
+        case offsetof(DMARegisters, descriptor) :
+            registers.descriptor = value;
+            return;
+        default:
+            return;
+    }
+
+    if (registers.control.abort) {
+        registers.control.abort = 0;
+        Abort();
+    }
+    if (registers.control.start) {
+        registers.control.start = 0;
+        StartTransfer();
+    }
+}
+
+void DMAController::StartTransfer() {
+    // Already running - the guest must wait or abort first
+    if (IsBusy()) {
+        return;
+    }
+    registers.status = kDMAStatus_Busy;
+    registers.bytesTransferred = 0;
+    nDescriptors = 1;
+    bFinished = false;
+    bFailed = false;
+
+    if (!LoadDescriptor(registers.descriptor)) {
+        Complete(kDMAStatus_Error);
+        return;
+    }
+
+    // No virtual time (not attached to a CPU) - just move it all right away
+    if (scheduler == nullptr) {
+        while(!bFinished) {
+            TransferBurst(config.linesPerBurst);
+        }
+        Complete(bFailed ? kDMAStatus_Error : kDMAStatus_Done);
+        return;
+    }
+    idNextEvent = scheduler->SchedulePeripheral(this, scheduler->GetCycleCount());
+}
+
+void DMAController::Abort() {
+    if (!IsBusy()) {
+        return;
+    }
+    if ((scheduler != nullptr) && (idNextEvent != 0)) {
+        scheduler->CancelEvent(idNextEvent);
+    }
+    idNextEvent = 0;
+    bFinished = true;
+    registers.status = kDMAStatus_Idle;
+}
+
+void DMAController::Complete(uint64_t newStatus) {
+    registers.status = newStatus;
+    if (registers.control.irqEnable) {
+        RaiseInterrupt();
+    }
+}
+
+//
+// One burst per event, the next event is scheduled when the bus would be done with this burst.
+// Note: The data is moved at the start of the burst, the status goes 'Done' once the last burst has 'completed'
+//
+void DMAController::OnScheduledEvent(uint64_t cycle) {
+    idNextEvent = 0;
+    if (!IsBusy()) {
+        return;
+    }
+    if (bFinished) {
+        Complete(bFailed ? kDMAStatus_Error : kDMAStatus_Done);
+        return;
+    }
+    auto nLines = TransferBurst(config.linesPerBurst);
+    // Only the end of the chain was left - nothing moved, we are done now
+    if (bFinished && (nLines == 0)) {
+        Complete(bFailed ? kDMAStatus_Error : kDMAStatus_Done);
+        return;
+    }
+    auto cyclesBurst = std::max(uint64_t(1), nLines * config.cyclesPerLine);
+    stats.bursts++;
+    stats.busyCycles += cyclesBurst;
+    idNextEvent = scheduler->SchedulePeripheral(this, cycle + cyclesBurst);
+}
+
+// Descriptors are in guest byte order, see 'DMADescriptor'
+bool DMAController::LoadDescriptor(uint64_t address) {
+    uint8_t data[sizeof(DMADescriptor)];
+    currentOffset = 0;
+    if (!BusRead(data, address, sizeof(DMADescriptor))) {
+        return false;
+    }
+    current.srcAddress = MMU::FromByteStream<uint64_t>(&data[offsetof(DMADescriptor, srcAddress)]);
+    current.dstAddress = MMU::FromByteStream<uint64_t>(&data[offsetof(DMADescriptor, dstAddress)]);
+    current.numBytes = MMU::FromByteStream<uint64_t>(&data[offsetof(DMADescriptor, numBytes)]);
+    current.next = MMU::FromByteStream<uint64_t>(&data[offsetof(DMADescriptor, next)]);
+    current.flags = MMU::FromByteStream<uint64_t>(&data[offsetof(DMADescriptor, flags)]);
+    return true;
+}
+
+size_t DMAController::TransferBurst(size_t maxLines) {
+    uint8_t buffer[GNK_L1_CACHE_LINE_SIZE];
+    size_t nLines = 0;
+
+    while((nLines < maxLines) && !bFinished) {
+        // End of this descriptor? - move on to the next in the chain
+        if (currentOffset >= current.numBytes) {
+            stats.descriptors++;
+            if (current.flags & kDMADescFlag_Interrupt) {
+                RaiseInterrupt();
+            }
+            if (current.next == 0) {
+                bFinished = true;
+                break;
+            }
+            if (++nDescriptors > config.maxDescriptors) {
+                fmt::println(stderr, "DMAController, descriptor chain longer than {} - loop?", config.maxDescriptors);
+                bFinished = true;
+                bFailed = true;
+                break;
+            }
+            // Fetching a descriptor costs a line
+            nLines++;
+            if (!LoadDescriptor(current.next)) {
+                bFinished = true;
+                bFailed = true;
+                break;
+            }
+            continue;
+        }
+
+        // Never cross a line on either side, when src/dst share alignment this is a full line
+        auto srcAddress = current.srcAddress + currentOffset;
+        auto dstAddress = current.dstAddress + currentOffset;
+        auto nBytes = std::min({
+            current.numBytes - currentOffset,
+            uint64_t(GNK_L1_CACHE_LINE_SIZE - GNK_LINE_OFS_FROM_ADDR(srcAddress)),
+            uint64_t(GNK_L1_CACHE_LINE_SIZE - GNK_LINE_OFS_FROM_ADDR(dstAddress))
+        });
+
+        if (!BusRead(buffer, srcAddress, nBytes) || !BusWrite(dstAddress, buffer, nBytes)) {
+            bFinished = true;
+            bFailed = true;
+            break;
+        }
+        currentOffset += nBytes;
+        registers.bytesTransferred += nBytes;
+        stats.bytesTransferred += nBytes;
+        nLines++;
+    }
+    return nLines;
+}
+
+//
+// The DMA is a bus master without a cache, it uses 'kSenderNone' so every core sees the requests.
+// Reading: BusRd - a dirty line is written back (MESI) or supplied (MOESI/MESIF) before we read it
+// Writing: BusWr - everyone drops the line, partial lines are merged with the current content first
+//
+bool DMAController::BusRead(void *dst, uint64_t address, size_t nBytes) {
+    auto *ptrDst = static_cast<uint8_t *>(dst);
+    uint8_t line[GNK_L1_CACHE_LINE_SIZE];
+
+    while(nBytes) {
+        auto bus = SoC::Instance().GetDataBusForAddress(address);
+        if (bus == nullptr) {
+            return false;
+        }
+        if (!SoC::Instance().IsAddressCacheable(address)) {
+            bus->ReadData(ptrDst, address, nBytes);
+            return true;
+        }
+        auto addrDescriptor = GNK_ADDR_DESC_FROM_ADDR(address);
+        auto offset = GNK_LINE_OFS_FROM_ADDR(address);
+        auto nCopy = std::min(nBytes, size_t(GNK_L1_CACHE_LINE_SIZE - offset));
+
+        bus->BroadCastRead(MesiBusBase::kSenderNone, addrDescriptor);
+        bus->ReadLine(MesiBusBase::kSenderNone, line, addrDescriptor);
+        stats.lineReads++;
+        memcpy(ptrDst, &line[offset], nCopy);
+
+        ptrDst += nCopy;
+        address += nCopy;
+        nBytes -= nCopy;
+    }
+    return true;
+}
+
+bool DMAController::BusWrite(uint64_t address, const void *src, size_t nBytes) {
+    auto *ptrSrc = static_cast<const uint8_t *>(src);
+    uint8_t line[GNK_L1_CACHE_LINE_SIZE];
+
+    while(nBytes) {
+        auto bus = SoC::Instance().GetDataBusForAddress(address);
+        if (bus == nullptr) {
+            return false;
+        }
+        if (!SoC::Instance().IsAddressCacheable(address)) {
+            bus->WriteData(address, ptrSrc, nBytes);
+            return true;
+        }
+        auto addrDescriptor = GNK_ADDR_DESC_FROM_ADDR(address);
+        auto offset = GNK_LINE_OFS_FROM_ADDR(address);
+        auto nCopy = std::min(nBytes, size_t(GNK_L1_CACHE_LINE_SIZE - offset));
+
+        bus->BroadCastWrite(MesiBusBase::kSenderNone, addrDescriptor);
+        if (nCopy < GNK_L1_CACHE_LINE_SIZE) {
+            bus->ReadLine(MesiBusBase::kSenderNone, line, addrDescriptor);
+            stats.lineReads++;
+        }
+        memcpy(&line[offset], ptrSrc, nCopy);
+        bus->WriteLine(MesiBusBase::kSenderNone, addrDescriptor, line);
+        stats.lineWrites++;
+
+        ptrSrc += nCopy;
+        address += nCopy;
+        nBytes -= nCopy;
+    }
+    return true;
+}
@@ -0,0 +1,140 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_DMACONTROLLER_H
+#define VCPU_DMACONTROLLER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Peripheral.h"
+#include "MemorySubSys/BusBase.h"
+#include "MemorySubSys/HWMappedBus.h"
+
+namespace gnilk {
+    namespace vcpu {
+
+        //
+        // DMA controller - moves memory without the CPU, works on bus addresses (no MMU translation).
+        // The guest builds a chain of descriptors in RAM (scatter-gather), points 'descriptor' to the first one and
+        // sets 'start'. The transfer runs in virtual time, one burst of lines per scheduled event.
+        // Cacheable memory is moved a cache line at a time through the coherence protocol - dirty lines held by the
+        // cores are written back (or supplied) before reading and invalidated before writing. Non-cacheable memory
+        // (flash, hw-mapped) goes through the -Data functions of the bus.
+        //
+
+        // Descriptor flags
+        static const uint64_t kDMADescFlag_Interrupt = 1;     // raise an interrupt when this descriptor is done
+
+        // Lives in emulated RAM in guest byte order (like MMU::Write), 'next' = 0 terminates the chain
+        struct DMADescriptor {
+            uint64_t srcAddress = {};
+            uint64_t dstAddress = {};
+            uint64_t numBytes = {};
+            uint64_t next = {};
+            uint64_t flags = {};
+        };
+
+        struct DMAControl {
+            uint8_t start : 1;          // write 1 to start the transfer, self-clearing
+            uint8_t abort : 1;          // write 1 to abort an ongoing transfer, self-clearing
+            uint8_t irqEnable : 1;      // raise an interrupt when the full chain is done (or failed)
+        };
+
+        enum kDMAStatus : uint64_t {
+            kDMAStatus_Idle = 0,
+            kDMAStatus_Busy = 1,
+            kDMAStatus_Done = 2,
+            kDMAStatus_Error = 4,
+        };
+
+        // This is the register layout as seen through the HW mapped bus (64 bit registers)
+        struct DMARegisters {
+            union {
+                DMAControl control;
+                uint64_t controlBits = {};
+            };
+            uint64_t status = {};           // kDMAStatus, read-only
+            uint64_t descriptor = {};       // address of the first descriptor in the chain
+            uint64_t bytesTransferred = {}; // read-only
+        };
+
+        // Bandwidth model, one line transfer (read + write of at most a line) costs 'cyclesPerLine'
+        struct DMAConfig {
+            uint64_t cyclesPerLine = 4;
+            size_t linesPerBurst = 8;
+            // A longer chain is treated as a loop (like a self-linked descriptor) and fails the transfer
+            size_t maxDescriptors = 4096;
+        };
+
+        class DMAController : public Peripheral, public HWMappedDevice {
+        public:
+            struct Statistics {
+                uint64_t lineReads = 0;         // cacheable lines read from the bus
+                uint64_t lineWrites = 0;        // cacheable lines written to the bus
+                uint64_t bursts = 0;
+                uint64_t descriptors = 0;
+                uint64_t bytesTransferred = 0;
+                uint64_t busyCycles = 0;        // virtual time spent transferring
+            };
+        public:
+            DMAController() = default;
+            explicit DMAController(const DMAConfig &newConfig) : config(newConfig) {}
+            virtual ~DMAController() = default;
+
+            static Ref Create();
+            static Ref Create(const DMAConfig &newConfig);
+
+            void Initialize() override;
+            bool Start() override;
+            bool Stop() override;
+            void OnScheduledEvent(uint64_t cycle) override;
+
+            // HWMappedDevice, see 'DMARegisters'
+            uint64_t Read64(uint64_t offset) override;
+            void Write64(uint64_t offset, uint64_t value) override;
+            size_t GetMappedSize() const override {
+                return sizeof(DMARegisters);
+            }
+
+            bool IsBusy() const {
+                return registers.status & kDMAStatus_Busy;
+            }
+            const DMARegisters &GetRegisters() const {
+                return registers;
+            }
+            const Statistics &GetStatistics() const {
+                return stats;
+            }
+            void ResetStatistics() {
+                stats = {};
+            }
+        protected:
+            void StartTransfer();
+            void Abort();
+            void Complete(uint64_t newStatus);
+            bool LoadDescriptor(uint64_t address);
+            // Transfers at most 'maxLines' line pieces, returns number of pieces moved
+            size_t TransferBurst(size_t maxLines);
+
+            // Coherent bus access
+            bool BusRead(void *dst, uint64_t address, size_t nBytes);
+            bool BusWrite(uint64_t address, const void *src, size_t nBytes);
+        private:
+            DMAConfig config = {};
+            DMARegisters registers = {};
+            Statistics stats = {};
+
+            // Internal - current descriptor and how far we have come
+            DMADescriptor current = {};
+            uint64_t currentOffset = 0;
+            size_t nDescriptors = 0;
+            bool bFinished = false;
+            bool bFailed = false;
+            EventScheduler::EventId idNextEvent = 0;
+        };
+    }
+}
+
+#endif //VCPU_DMACONTROLLER_H
@@ -0,0 +1,54 @@
+//
+// Created by gnilk on 19.10.26.
+//
+#include <algorithm>
+#include "EventScheduler.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+EventScheduler::EventId EventScheduler::Schedule(uint64_t atCycle, EventHandler handler) {
+    auto id = nextId++;
+    events.push_back({.atCycle = atCycle, .id = id, .handler = std::move(handler)});
+    std::push_heap(events.begin(), events.end(), Later);
+    return id;
+}
+
+bool EventScheduler::Cancel(EventId id) {
+    if ((id == 0) || (id >= nextId)) {
+        return false;
+    }
+    // Already run?
+    auto it = std::find_if(events.begin(), events.end(), [id](const Event &event) {
+        return event.id == id;
+    });
+    if (it == events.end()) {
+        return false;
+    }
+    return cancelled.insert(id).second;
+}
+
+size_t EventScheduler::RunUntil(uint64_t cycle) {
+    size_t nRun = 0;
+    while(!events.empty() && (events.front().atCycle <= cycle)) {
+        Event event;
+        PopFront(event);
+        if (!cancelled.empty() && cancelled.erase(event.id)) {
+            continue;
+        }
+        event.handler(cycle);
+        nRun++;
+    }
+    return nRun;
+}
+
+void EventScheduler::Clear() {
+    events.clear();
+    cancelled.clear();
+}
+
+void EventScheduler::PopFront(Event &outEvent) {
+    std::pop_heap(events.begin(), events.end(), Later);
+    outEvent = std::move(events.back());
+    events.pop_back();
+}
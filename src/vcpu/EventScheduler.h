@@ -0,0 +1,71 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_EVENTSCHEDULER_H
+#define VCPU_EVENTSCHEDULER_H
+
+#include <stdint.h>
+#include <limits>
+#include <vector>
+#include <functional>
+#include <unordered_set>
+
+namespace gnilk {
+    namespace vcpu {
+
+        //
+        // Discrete event scheduler - time ordered queue (min-heap) of callbacks keyed on the CPU cycle.
+        // Events due at the same cycle are run in the order they were scheduled.
+        // The run loop should only check 'NextEventCycle' per instruction - this is a single compare, nothing is
+        // polled unless something is actually due.
+        //
+        class EventScheduler {
+        public:
+            using EventId = uint64_t;
+            using EventHandler = std::function<void(uint64_t cycle)>;
+            static constexpr uint64_t kNoEvent = std::numeric_limits<uint64_t>::max();
+        public:
+            EventScheduler() = default;
+            virtual ~EventScheduler() = default;
+
+            // Returns an id which can be used to cancel the event
+            EventId Schedule(uint64_t atCycle, EventHandler handler);
+            // Cancelling is lazy, the event is dropped when it reaches the top of the queue
+            bool Cancel(EventId id);
+            // Run all events due at or before 'cycle' - handlers may schedule new events, returns number of events run
+            size_t RunUntil(uint64_t cycle);
+            void Clear();
+
+            __inline uint64_t NextEventCycle() const {
+                return events.empty()?kNoEvent:events.front().atCycle;
+            }
+            __inline bool IsDue(uint64_t cycle) const {
+                return cycle >= NextEventCycle();
+            }
+            size_t GetNumPending() const {
+                return events.size() - cancelled.size();
+            }
+        protected:
+            struct Event {
+                uint64_t atCycle;
+                EventId id;         // monotonic - doubles as sequence number, keeps same-cycle events in order
+                EventHandler handler;
+            };
+            // std heap functions are max-heaps - invert the comparison
+            static bool Later(const Event &a, const Event &b) {
+                if (a.atCycle != b.atCycle) {
+                    return a.atCycle > b.atCycle;
+                }
+                return a.id > b.id;
+            }
+            void PopFront(Event &outEvent);
+        private:
+            std::vector<Event> events;
+            std::unordered_set<EventId> cancelled;
+            EventId nextId = 1;
+        };
+    }
+}
+
+#endif //VCPU_EVENTSCHEDULER_H
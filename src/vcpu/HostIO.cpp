@@ -0,0 +1,404 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#include <errno.h>
+#include <stddef.h>
+#include <utility>
+#include "HostIO.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+static const size_t kMaxPathLength = 4096;
+
+HostIO::HostFile::~HostFile() {
+    if (file == nullptr) {
+        return;
+    }
+    if (bIsPipe) {
+        pclose(file);
+    } else {
+        fclose(file);
+    }
+}
+
+HostIO::~HostIO() {
+    DoStop();
+}
+
+Peripheral::Ref HostIO::Create() {
+    return std::make_shared<HostIO>();
+}
+
+Peripheral::Ref HostIO::Create(const HostIOConfig &newConfig) {
+    return std::make_shared<HostIO>(newConfig);
+}
+
+// CPU reset - queued requests are dropped, in-flight ones are dropped when they finish (no completion ring)
+void HostIO::Initialize() {
+    {
+        std::lock_guard<std::mutex> lock(jobLock);
+        nOutstanding -= jobs.size();
+        jobs.clear();
+    }
+    addrCompletionRing = 0;
+}
+
+bool HostIO::Start() {
+    if (!workers.empty()) {
+        return false;
+    }
+    bStopThreads = false;
+    auto numThreads = (config.numThreads > 0) ? config.numThreads : 1;
+    for(size_t i=0;i<numThreads;i++) {
+        workers.emplace_back([this]() {
+            WorkerThread();
+        });
+    }
+    return true;
+}
+
+bool HostIO::Stop() {
+    return DoStop();
+}
+
+// Called from DTOR - no virtual calls from here
+bool HostIO::DoStop() {
+    if (idPollEvent != 0) {
+        if (scheduler != nullptr) {
+            scheduler->CancelEvent(idPollEvent);
+        }
+        idPollEvent = 0;
+    }
+    if (workers.empty()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobLock);
+        bStopThreads = true;
+    }
+    jobSignal.notify_all();
+    for(auto &worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    jobs.clear();
+    completions.clear();
+    nOutstanding = 0;
+    std::lock_guard<std::mutex> lock(filesLock);
+    files.clear();
+    return true;
+}
+
+bool HostIO::RegisterSysCalls(CPUBase &newCpu, uint16_t baseId) {
+    static const std::pair<kHostIOSysCall, const char *> requests[] = {
+        {kHostIOSysCall_Open, "hostio_open"},
+        {kHostIOSysCall_Close, "hostio_close"},
+        {kHostIOSysCall_Read, "hostio_read"},
+        {kHostIOSysCall_Write, "hostio_write"},
+    };
+
+    cpu = &newCpu;
+    bool bOk = cpu->RegisterSysCall(baseId + kHostIOSysCall_Setup, "hostio_setup", [this](Registers &regs, CPUBase *) {
+        OnSetup(regs);
+    });
+    for(auto &[op, name] : requests) {
+        bOk &= cpu->RegisterSysCall(baseId + op, name, [this, op](Registers &regs, CPUBase *) {
+            OnSubmit(op, regs);
+        });
+    }
+    return bOk;
+}
+
+void HostIO::OnSetup(Registers &regs) {
+    auto address = regs.dataRegisters[1].data.longword;
+    auto numEntries = cpu->memoryUnit.Read<uint64_t>(address + offsetof(HostIOCompletionRing, numEntries));
+    if ((numEntries == 0) || ((numEntries & (numEntries - 1)) != 0)) {
+        regs.dataRegisters[0].data.longword = static_cast<uint64_t>(-EINVAL);
+        return;
+    }
+    addrCompletionRing = address;
+    regs.dataRegisters[0].data.longword = 0;
+}
+
+//
+// Runs on the CPU thread - validate, grab whatever we need from guest memory and hand over to the workers
+//
+void HostIO::OnSubmit(kHostIOSysCall op, Registers &regs) {
+    Request request = {
+        .op = op,
+        .userData = regs.dataRegisters[4].data.longword,
+    };
+
+    int64_t result = 0;
+    if (addrCompletionRing == 0) {
+        result = -EINVAL;
+    } else if (op == kHostIOSysCall_Open) {
+        request.flags = regs.dataRegisters[2].data.longword;
+        bool bPipeReadWrite = (request.flags & kHostIOOpen_Pipe) && (request.flags & kHostIOOpen_Read) && (request.flags & kHostIOOpen_Write);
+        if (!(request.flags & (kHostIOOpen_Read | kHostIOOpen_Write)) || bPipeReadWrite) {
+            result = -EINVAL;
+        } else if (!ReadGuestString(request.path, regs.dataRegisters[1].data.longword)) {
+            result = -EFAULT;
+        }
+    } else {
+        request.handle = regs.dataRegisters[1].data.longword;
+        request.guestBuffer = regs.dataRegisters[2].data.longword;
+        request.nBytes = regs.dataRegisters[3].data.longword;
+        if (GetFile(request.handle) == nullptr) {
+            result = -EBADF;
+        } else if ((op != kHostIOSysCall_Close) && (request.nBytes > config.maxTransfer)) {
+            result = -EINVAL;
+        } else if ((op != kHostIOSysCall_Close) && !cpu->memoryUnit.IsAddressRangeValid(request.guestBuffer, request.nBytes)) {
+            result = -EFAULT;
+        } else if (op == kHostIOSysCall_Write) {
+            request.data.resize(request.nBytes);
+            if (!ReadGuest(request.data.data(), request.guestBuffer, request.nBytes)) {
+                result = -EFAULT;
+            }
+        }
+    }
+
+    regs.dataRegisters[0].data.longword = static_cast<uint64_t>(result);
+    if (result < 0) {
+        stats.rejected++;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobLock);
+        jobs.push_back(std::move(request));
+    }
+    jobSignal.notify_one();
+    nOutstanding++;
+    stats.submitted++;
+    SchedulePoll();
+}
+
+void HostIO::SchedulePoll() {
+    if ((idPollEvent != 0) || (scheduler == nullptr)) {
+        return;
+    }
+    idPollEvent = scheduler->SchedulePeripheral(this, scheduler->GetCycleCount() + config.pollCycles);
+}
+
+void HostIO::OnScheduledEvent(uint64_t cycle) {
+    idPollEvent = 0;
+    Poll();
+    if (nOutstanding > 0) {
+        SchedulePoll();
+    }
+}
+
+//
+// Completions are posted in the order the workers finished them, anything not fitting in the ring stays until the
+// guest has consumed some.
+//
+size_t HostIO::Poll() {
+    stats.polls++;
+    std::lock_guard<std::mutex> lock(completionLock);
+    if (completions.empty()) {
+        return 0;
+    }
+    // Reset while requests were in flight - nowhere to post them
+    if (addrCompletionRing == 0) {
+        nOutstanding -= completions.size();
+        completions.clear();
+        return 0;
+    }
+
+    auto &mmu = cpu->memoryUnit;
+    auto head = mmu.Read<uint64_t>(addrCompletionRing + offsetof(HostIOCompletionRing, head));
+    auto tail = mmu.Read<uint64_t>(addrCompletionRing + offsetof(HostIOCompletionRing, tail));
+    auto numEntries = mmu.Read<uint64_t>(addrCompletionRing + offsetof(HostIOCompletionRing, numEntries));
+    auto addrEntries = addrCompletionRing + sizeof(HostIOCompletionRing);
+
+    size_t nPosted = 0;
+    while(!completions.empty() && ((tail - head) < numEntries)) {
+        auto &completion = completions.front();
+        // Data first, the guest may look at it as soon as the completion is visible
+        if (!completion.data.empty()) {
+            if (WriteGuest(completion.guestBuffer, completion.data.data(), completion.data.size())) {
+                stats.bytesRead += completion.data.size();
+            } else {
+                completion.result = -EFAULT;
+            }
+        } else if ((completion.op == kHostIOSysCall_Write) && (completion.result > 0)) {
+            stats.bytesWritten += static_cast<uint64_t>(completion.result);
+        }
+        auto addrCompletion = addrEntries + (tail & (numEntries - 1)) * sizeof(HostIOCompletion);
+        mmu.Write<uint64_t>(addrCompletion + offsetof(HostIOCompletion, userData), completion.userData);
+        mmu.Write<uint64_t>(addrCompletion + offsetof(HostIOCompletion, result), static_cast<uint64_t>(completion.result));
+        completions.pop_front();
+        tail++;
+        nPosted++;
+    }
+    if (nPosted == 0) {
+        return 0;
+    }
+    mmu.Write<uint64_t>(addrCompletionRing + offsetof(HostIOCompletionRing, tail), tail);
+    nOutstanding -= nPosted;
+    stats.completed += nPosted;
+    RaiseInterrupt();
+    return nPosted;
+}
+
+void HostIO::WorkerThread() {
+    while(true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(jobLock);
+            jobSignal.wait(lock, [this]() {
+                return bStopThreads || !jobs.empty();
+            });
+            if (bStopThreads) {
+                return;
+            }
+            request = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        auto completion = Execute(request);
+        std::lock_guard<std::mutex> lock(completionLock);
+        completions.push_back(std::move(completion));
+    }
+}
+
+//
+// Worker side - host calls only, never touches guest memory
+//
+HostIO::Completion HostIO::Execute(Request &request) {
+    Completion completion = {
+        .op = request.op,
+        .userData = request.userData,
+        .guestBuffer = request.guestBuffer,
+    };
+    if (request.op == kHostIOSysCall_Open) {
+        completion.result = ExecuteOpen(request);
+        return completion;
+    }
+    if (request.op == kHostIOSysCall_Close) {
+        completion.result = ExecuteClose(request);
+        return completion;
+    }
+
+    auto hostFile = GetFile(request.handle);
+    if (hostFile == nullptr) {
+        completion.result = -EBADF;
+        return completion;
+    }
+    if (request.op == kHostIOSysCall_Read) {
+        completion.data.resize(request.nBytes);
+        auto nRead = fread(completion.data.data(), 1, request.nBytes, hostFile->file);
+        if ((nRead == 0) && ferror(hostFile->file)) {
+            clearerr(hostFile->file);
+            completion.data.clear();
+            completion.result = -EIO;
+            return completion;
+        }
+        completion.data.resize(nRead);
+        completion.result = static_cast<int64_t>(nRead);
+        return completion;
+    }
+    // Write
+    auto nWritten = fwrite(request.data.data(), 1, request.data.size(), hostFile->file);
+    fflush(hostFile->file);
+    if (nWritten < request.data.size() && ferror(hostFile->file)) {
+        clearerr(hostFile->file);
+        completion.result = -EIO;
+        return completion;
+    }
+    completion.result = static_cast<int64_t>(nWritten);
+    return completion;
+}
+
+int64_t HostIO::ExecuteOpen(const Request &request) {
+    bool bRead = request.flags & kHostIOOpen_Read;
+    bool bWrite = request.flags & kHostIOOpen_Write;
+    bool bPipe = request.flags & kHostIOOpen_Pipe;
+
+    const char *mode = "rb";
+    if (bPipe) {
+        mode = bWrite ? "w" : "r";
+    } else if (bRead && bWrite) {
+        mode = (request.flags & kHostIOOpen_Create) ? "w+b" : ((request.flags & kHostIOOpen_Append) ? "a+b" : "r+b");
+    } else if (bWrite) {
+        mode = (request.flags & kHostIOOpen_Append) ? "ab" : "wb";
+    }
+
+    auto file = bPipe ? popen(request.path.c_str(), mode) : fopen(request.path.c_str(), mode);
+    if (file == nullptr) {
+        return -((errno != 0) ? errno : EIO);
+    }
+
+    auto hostFile = std::make_shared<HostFile>(file, bPipe);
+    std::lock_guard<std::mutex> lock(filesLock);
+    for(size_t i=0;i<files.size();i++) {
+        if (files[i] == nullptr) {
+            files[i] = hostFile;
+            return static_cast<int64_t>(i);
+        }
+    }
+    files.push_back(hostFile);
+    return static_cast<int64_t>(files.size() - 1);
+}
+
+// The file is closed when the last request using it is done
+int64_t HostIO::ExecuteClose(const Request &request) {
+    std::lock_guard<std::mutex> lock(filesLock);
+    if ((request.handle >= files.size()) || (files[request.handle] == nullptr)) {
+        return -EBADF;
+    }
+    files[request.handle] = nullptr;
+    return 0;
+}
+
+std::shared_ptr<HostIO::HostFile> HostIO::GetFile(uint64_t handle) {
+    std::lock_guard<std::mutex> lock(filesLock);
+    if (handle >= files.size()) {
+        return nullptr;
+    }
+    return files[handle];
+}
+
+//
+// Guest memory goes through the MMU of the CPU - i.e. coherent with its caches, a byte at the time is slow but these
+// transfers are dwarfed by the host I/O anyway.
+//
+bool HostIO::ReadGuest(void *dst, uint64_t address, size_t nBytes) {
+    if (!cpu->memoryUnit.IsAddressRangeValid(address, nBytes)) {
+        return false;
+    }
+    auto *ptrDst = static_cast<uint8_t *>(dst);
+    for(size_t i=0;i<nBytes;i++) {
+        ptrDst[i] = cpu->memoryUnit.Read<uint8_t>(address + i);
+    }
+    return true;
+}
+
+bool HostIO::WriteGuest(uint64_t address, const void *src, size_t nBytes) {
+    if (!cpu->memoryUnit.IsAddressRangeValid(address, nBytes)) {
+        return false;
+    }
+    auto *ptrSrc = static_cast<const uint8_t *>(src);
+    for(size_t i=0;i<nBytes;i++) {
+        cpu->memoryUnit.Write<uint8_t>(address + i, ptrSrc[i]);
+    }
+    return true;
+}
+
+bool HostIO::ReadGuestString(std::string &outString, uint64_t address) {
+    outString.clear();
+    for(size_t i=0;i<kMaxPathLength;i++) {
+        if (!cpu->memoryUnit.IsAddressValid(address + i)) {
+            return false;
+        }
+        auto ch = cpu->memoryUnit.Read<uint8_t>(address + i);
+        if (ch == 0) {
+            return true;
+        }
+        outString.push_back(static_cast<char>(ch));
+    }
+    return false;
+}
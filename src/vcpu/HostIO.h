@@ -0,0 +1,179 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_HOSTIO_H
+#define VCPU_HOSTIO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+#include "Peripheral.h"
+#include "CPUBase.h"
+
+namespace gnilk {
+    namespace vcpu {
+
+        //
+        // Asynchronous host I/O - file and pipe access through syscalls that return right away. The work is done by a
+        // pool of host threads, the guest keeps executing. Finished requests are posted to a completion ring in guest
+        // RAM and the interrupt of this peripheral is raised.
+        // Completions are delivered on the CPU thread (polled in virtual time while requests are outstanding), the
+        // host threads never touch guest memory.
+        //
+        // All syscalls take their arguments in d1..d4 (so they work through kSysCall_SubmitRing as well) and return
+        // 0 in d0 if the request was queued, -errno otherwise. The completion holds the user data and the result,
+        // which is the handle (open), number of bytes (read/write), 0 (close) or -errno.
+        //
+        // Requests on the same handle are not ordered, wait for the completion before issuing a dependent request.
+        //
+
+        // Syscall ids, relative to the base given to 'RegisterSysCalls'
+        enum kHostIOSysCall : uint16_t {
+            kHostIOSysCall_Setup = 0,       // d1 = address of HostIOCompletionRing
+            kHostIOSysCall_Open = 1,        // d1 = path (zero terminated), d2 = kHostIOOpenFlags, d4 = user data
+            kHostIOSysCall_Close = 2,       // d1 = handle, d4 = user data
+            kHostIOSysCall_Read = 3,        // d1 = handle, d2 = buffer, d3 = number of bytes, d4 = user data
+            kHostIOSysCall_Write = 4,       // d1 = handle, d2 = buffer, d3 = number of bytes, d4 = user data
+            kHostIOSysCall_NumSysCalls,
+        };
+        static const uint16_t kHostIOSysCallBase = 0x100;
+
+        enum kHostIOOpenFlags : uint64_t {
+            kHostIOOpen_Read = 1,
+            kHostIOOpen_Write = 2,
+            kHostIOOpen_Create = 4,         // create/truncate, with 'Write'
+            kHostIOOpen_Append = 8,         // with 'Write'
+            kHostIOOpen_Pipe = 16,          // path is a command, 'Read' or 'Write' - not both
+        };
+
+        // In guest RAM, guest byte order (like MMU::Write)
+        struct HostIOCompletion {
+            uint64_t userData = {};
+            int64_t result = {};
+        };
+        struct HostIOCompletionRing {
+            uint64_t head = {};             // written by the guest when a completion has been consumed
+            uint64_t tail = {};             // written by the host
+            uint64_t numEntries = {};       // power of two, the completions follow directly after the header
+        };
+
+        struct HostIOConfig {
+            size_t numThreads = 2;
+            // Virtual time between polls for finished requests (only while something is outstanding)
+            uint64_t pollCycles = 64;
+            // Largest read/write accepted in one request
+            size_t maxTransfer = 64 * 1024;
+        };
+
+        class HostIO : public Peripheral {
+        public:
+            struct Statistics {
+                uint64_t submitted = 0;
+                uint64_t completed = 0;     // posted to the guest
+                uint64_t rejected = 0;      // failed already at submission
+                uint64_t bytesRead = 0;
+                uint64_t bytesWritten = 0;
+                uint64_t polls = 0;
+            };
+        public:
+            HostIO() = default;
+            explicit HostIO(const HostIOConfig &newConfig) : config(newConfig) {}
+            virtual ~HostIO();
+
+            static Ref Create();
+            static Ref Create(const HostIOConfig &newConfig);
+
+            void Initialize() override;
+            // Starts the worker threads
+            bool Start() override;
+            // Stops the worker threads and closes all handles, anything not yet delivered is dropped
+            bool Stop() override;
+            void OnScheduledEvent(uint64_t cycle) override;
+
+            // Register the syscalls at 'baseId + kHostIOSysCall_xxx', guest memory is accessed through this CPU
+            bool RegisterSysCalls(CPUBase &newCpu, uint16_t baseId = kHostIOSysCallBase);
+
+            // Post finished requests to the completion ring - returns number posted
+            // Called from the scheduler, call it yourself if the CPU has no peripheral scheduler
+            size_t Poll();
+
+            size_t GetOutstanding() const {
+                return nOutstanding;
+            }
+            const Statistics &GetStatistics() const {
+                return stats;
+            }
+        protected:
+            struct HostFile {
+                HostFile(FILE *newFile, bool newIsPipe) : file(newFile), bIsPipe(newIsPipe) {}
+                ~HostFile();
+                FILE *file = nullptr;
+                bool bIsPipe = false;
+            };
+
+            struct Request {
+                kHostIOSysCall op = {};
+                uint64_t handle = 0;
+                uint64_t flags = 0;
+                uint64_t guestBuffer = 0;
+                uint64_t nBytes = 0;
+                uint64_t userData = 0;
+                std::string path = {};
+                std::vector<uint8_t> data = {};     // write: copied from the guest at submission
+            };
+            struct Completion {
+                kHostIOSysCall op = {};
+                uint64_t userData = 0;
+                int64_t result = 0;
+                uint64_t guestBuffer = 0;
+                std::vector<uint8_t> data = {};     // read: copied to the guest when posted
+            };
+
+            void OnSetup(Registers &regs);
+            void OnSubmit(kHostIOSysCall op, Registers &regs);
+            bool DoStop();
+            void WorkerThread();
+            Completion Execute(Request &request);
+            int64_t ExecuteOpen(const Request &request);
+            int64_t ExecuteClose(const Request &request);
+            std::shared_ptr<HostFile> GetFile(uint64_t handle);
+
+            bool ReadGuest(void *dst, uint64_t address, size_t nBytes);
+            bool WriteGuest(uint64_t address, const void *src, size_t nBytes);
+            bool ReadGuestString(std::string &outString, uint64_t address);
+            void SchedulePoll();
+        private:
+            HostIOConfig config = {};
+            CPUBase *cpu = nullptr;
+            uint64_t addrCompletionRing = 0;
+            Statistics stats = {};
+            EventScheduler::EventId idPollEvent = 0;
+
+            std::vector<std::thread> workers;
+            std::atomic<bool> bStopThreads = false;
+            std::mutex jobLock;
+            std::condition_variable jobSignal;
+            std::deque<Request> jobs;
+
+            std::mutex completionLock;
+            std::deque<Completion> completions;
+            // Submitted but not yet posted to the guest - only touched by the CPU thread
+            size_t nOutstanding = 0;
+
+            // Handle is the index
+            std::mutex filesLock;
+            std::vector<std::shared_ptr<HostFile>> files;
+        };
+    }
+}
+
+#endif //VCPU_HOSTIO_H
@@ -22,7 +22,7 @@ bool InstructionDecoderBase::Decode(CPUBase &cpu) {
 }
 
 uint8_t InstructionDecoderBase::NextByte(CPUBase &cpu) {
-    // Note: FetchFromRam will modifiy the address!!!!
-    auto nextByte = cpu.FetchFromPhysicalRam<uint8_t>(memoryOffset);
+    // Note: FetchFromInstrStream will modifiy the address!!!!
+    auto nextByte = cpu.FetchFromInstrStream<uint8_t>(memoryOffset);
     return nextByte;
 }
@@ -74,6 +74,18 @@ namespace gnilk {
             //   false - the decoder is not done
             virtual bool IsFinished() { return false; }
 
+            // Branches which don't depend on the status flags, the pipeline resolves these without executing them
+            virtual bool IsResolvableBranch() { return false; }
+            // Returns true if the branch is taken, 'outTarget' is where execution continues
+            virtual bool ResolveBranch(CPUBase &cpu, uint64_t &outTarget) { return false; }
+
+            // Fence/cache maintenance, the pipeline drains before executing these and holds younger instructions back
+            virtual bool IsSerializing() { return false; }
+
+            // A memory operand faulted while decoding, the fault is raised by 'Finalize' - an instruction which never
+            // executes (fetched past a taken branch) never faults
+            virtual bool HavePendingFault() { return false; }
+
         protected:
             // Proxy into CPU base
             uint8_t NextByte(CPUBase &cpu);
@@ -56,9 +56,10 @@ namespace gnilk {
             virtual ~InstructionSetManager() = default;
             static InstructionSetManager &Instance();
 
+            // Replaces any previous root instruction set
             template<typename T>
             void SetInstructionSet() {
-                RegisterExtension<T>(kRootInstrSet);
+                extensions[kRootInstrSet] = std::make_unique<T>();
             }
 
             InstructionSet &GetInstructionSet();
@@ -6,7 +6,9 @@
 #define VCPU_INSTRUCTIONSETDEFBASE_H
 
 #include <string>
+#include <string_view>
 #include <stdint.h>
+#include <array>
 #include <unordered_map>
 #include <optional>
 
@@ -18,8 +20,9 @@ namespace gnilk {
         // These are shared by all types of instructions..
         //
         struct OperandDescriptionBase {
-            std::string name = {};
+            std::string_view name = {};
             uint32_t features = {};
+            bool isDefined = false;     // set when the table is built, see BuildOperandDescriptionTable
         };
         typedef uint8_t OperandCodeBase;
 
@@ -103,6 +106,13 @@ namespace gnilk {
             // Various extension flags
             kFeature_Mask    = 0x1000,
             kFeature_Advance = 0x2000,
+
+            // Atomic memory access - the decoder does NOT read memory operands, the instruction does it during execution
+            kFeature_Atomic = 0x4000,
+            // All older instructions complete before this executes and nothing younger is decoded until it has
+            kFeature_Serializing = 0x8000,
+            // The memory operand is only an address (cache maintenance, prefetch) - the decoder does NOT read it
+            kFeature_AddressOnly = 0x10000,
         } OperandFeatureFlags;
 
         template<>
@@ -125,11 +135,100 @@ namespace gnilk {
         }
 
 
+        //
+        // Instruction tables are built at compile time and indexed directly by the op code byte.
+        //
+        using OperandDescriptionTable = std::array<OperandDescriptionBase, 256>;
+
+        struct OperandDefinition {
+            OperandCodeBase opCode;
+            OperandDescriptionBase description;
+        };
+
+        template<size_t N>
+        constexpr OperandDescriptionTable BuildOperandDescriptionTable(const OperandDefinition (&definitions)[N]) {
+            OperandDescriptionTable table = {};
+            for(auto &def : definitions) {
+                if (table[def.opCode].isDefined) {
+                    // not a constant expression - fails the build
+                    throw "op code defined twice";
+                }
+                table[def.opCode] = def.description;
+                table[def.opCode].isDefined = true;
+            }
+            return table;
+        }
+
+        //
+        // Perfect hash of the mnemonics for the assembler - the seed is searched at compile time so that no two
+        // mnemonics share a slot, a lookup is one hash and one compare. Op codes without a name are left out.
+        //
+        class MnemonicHash {
+        public:
+            static constexpr size_t kNumSlots = 1024;
+            static constexpr uint16_t kEmptySlot = 0xffff;
+        public:
+            static constexpr MnemonicHash Build(const OperandDescriptionTable &table) {
+                MnemonicHash hash;
+                for(hash.seed = 0; hash.seed < kMaxSeed; hash.seed++) {
+                    if (hash.TryFill(table)) {
+                        return hash;
+                    }
+                }
+                throw "no perfect hash seed found";
+            }
+
+            constexpr std::optional<OperandCodeBase> Find(const OperandDescriptionTable &table, std::string_view str) const {
+                auto opCode = slots[Slot(str, seed)];
+                if ((opCode == kEmptySlot) || (table[opCode].name != str)) {
+                    return {};
+                }
+                return static_cast<OperandCodeBase>(opCode);
+            }
+        private:
+            static constexpr uint32_t kMaxSeed = 100000;
+
+            // FNV-1a
+            static constexpr size_t Slot(std::string_view str, uint32_t seed) {
+                uint32_t h = 2166136261u ^ seed;
+                for(auto ch : str) {
+                    h ^= static_cast<uint8_t>(ch);
+                    h *= 16777619u;
+                }
+                return (h ^ (h >> 16)) & (kNumSlots - 1);
+            }
+
+            constexpr bool TryFill(const OperandDescriptionTable &table) {
+                slots.fill(kEmptySlot);
+                for(size_t opCode = 0; opCode < table.size(); opCode++) {
+                    if (!table[opCode].isDefined || table[opCode].name.empty()) {
+                        continue;
+                    }
+                    auto &slot = slots[Slot(table[opCode].name, seed)];
+                    if (slot != kEmptySlot) {
+                        return false;
+                    }
+                    slot = static_cast<uint16_t>(opCode);
+                }
+                return true;
+            }
+        private:
+            uint32_t seed = 0;
+            std::array<uint16_t, kNumSlots> slots = {};
+        };
+
         //typedef uint8_t OperandCode;
 
+        // How instructions are laid out in memory, the assembler emits code accordingly
+        enum class InstructionEncoding : uint8_t {
+            kVariableLength,        // v1 - 1..n bytes depending on the operands
+            kFixed32,               // 32 bit words, see InstructionSetV1FixedDef
+        };
+
         class InstructionSetDefBase {
         public:
-            virtual const std::unordered_map<OperandCodeBase , OperandDescriptionBase> &GetInstructionSet() = 0;
+            virtual InstructionEncoding GetEncoding() { return InstructionEncoding::kVariableLength; }
+            virtual const OperandDescriptionTable &GetInstructionSet() = 0;
             virtual std::optional<OperandDescriptionBase> GetOpDescFromClass(OperandCodeBase opClass) = 0;
             virtual std::optional<OperandCodeBase> GetOperandFromStr(const std::string &str) = 0;
 //            virtual uint8_t EncodeOpSizeAndFamily(OperandSize opSize, OperandFamily opFamily) {
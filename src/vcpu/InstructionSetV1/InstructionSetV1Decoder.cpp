@@ -46,6 +46,9 @@ void InstructionSetV1Decoder::Reset() {
     opArgSrc = {};
     primaryValue = {};
     secondaryValue = {};
+    immediateValue = {};
+    havePendingFault = false;
+    pendingFaultAddress = 0;
 
     ChangeState(State::kStateIdle);
 }
@@ -54,28 +57,7 @@ void InstructionSetV1Decoder::Reset() {
 //        See (for a simplified picture): https://upload.wikimedia.org/wikipedia/commons/b/b0/AMD_Bulldozer_block_diagram_%28CPU_core_block%29.png
 //
 bool InstructionSetV1Decoder::Tick(CPUBase &cpu) {
-    bool res = false;
-    switch(state) {
-        case State::kStateIdle :
-            res = ExecuteTickFromIdle(cpu);
-            break;
-        case State::kStateDecodeAddrMode :
-            res = ExecuteTickDecodeAddrMode(cpu);
-            break;
-        case State::kStateReadMem :
-            res =  ExecuteTickReadMem(cpu);
-            break;
-        case State::kStateTwoOpDstReadMem :
-            res = ExecuteTickReadDstMem(cpu);
-            break;
-        case State::kStateDecodeExtension :
-            res = ExecuteTickDecodeExt(cpu);
-            break;
-        case State::kStateFinished :
-            return true;
-    }
-
-    return res;
+    return TickAs<InstructionSetV1Decoder>(cpu);
 }
 
 
@@ -86,6 +68,10 @@ bool InstructionSetV1Decoder::Finalize(gnilk::vcpu::CPUBase &cpu) {
     if (state != State::kStateFinished) {
         return false;
     }
+    if (havePendingFault) {
+        cpu.RaiseFault(CPUKnownExceptions::kMMUFault, pendingFaultAddress, CPUFaultAccess::Read);
+        return false;
+    }
     if (IsExtension(code.opCodeByte) && (currentExtDecoder != nullptr)) {
         // Note: The extension has already automatically on changing to finished - we just check if we had a valid extension...
         currentExtDecoder->Finalize(cpu);
@@ -135,7 +121,11 @@ bool InstructionSetV1Decoder::ExecuteTickFromIdle(CPUBase &cpu) {
     // Decode the op-code
     code.opCode =  static_cast<OperandCode>(code.opCodeByte);
     // check if we have this instruction defined
-    if (!instrSetDefinition.GetInstructionSet().contains(code.opCode)) {
+    auto &opDesc = instrSetDefinition.GetInstructionSet()[code.opCode];
+    if (!opDesc.isDefined) {
+        // Resume after the op-code byte
+        instrSize = 1;
+        cpu.AdvanceInstrPtr(instrSize);
         cpu.RaiseException(CPUKnownExceptions::kInvalidInstruction);
         return false;
     }
@@ -160,7 +150,7 @@ bool InstructionSetV1Decoder::ExecuteTickFromIdle(CPUBase &cpu) {
     }
 
 
-    code.features = instrSetDefinition.GetInstructionSet().at(code.opCode).features;
+    code.features = opDesc.features;
 
     //
     // Decode addressing
@@ -183,21 +173,27 @@ bool InstructionSetV1Decoder::ExecuteTickFromIdle(CPUBase &cpu) {
     } else if (code.features & OperandFeatureFlags::kFeature_TwoOperands) {
         DecodeOperandArg(cpu, opArgDst);
         DecodeOperandArg(cpu, opArgSrc);
-    } else {
+    } else if (code.features & OperandFeatureFlags::kFeature_ThreeOperands) {
+        DecodeCompareBranch(cpu);
     }
 
     ofsEndInstr = memoryOffset;
 
-    auto szComputed = ComputeInstrSize();
+    instrSize = ComputeInstrSize();
 
     // now we know how much data to consume for this instruction - advance to next - which allows us to proceed next tick
     // and the Pipeline to grab a new instruction..
-    cpu.AdvanceInstrPtr(szComputed);
+    cpu.AdvanceInstrPtr(instrSize);
 
     if ((code.features & OperandFeatureFlags::kFeature_OneOperand) || (code.features & OperandFeatureFlags::kFeature_TwoOperands)) {
         ChangeState(State::kStateDecodeAddrMode);
         return true;
     }
+    // Fixed size, nothing more to decode - just the registers to read
+    if (code.features & OperandFeatureFlags::kFeature_ThreeOperands) {
+        ChangeState(State::kStateReadMem);
+        return true;
+    }
 
     ChangeState(State::kStateFinished);
     return true;
@@ -222,6 +218,12 @@ bool InstructionSetV1Decoder::ExecuteTickDecodeAddrMode(CPUBase &cpu) {
     if (code.features & OperandFeatureFlags::kFeature_TwoOperands) {
         DecodeOperandArgAddrMode(cpu, opArgSrc);
     }
+    // The immediate is last in the instruction - the source, or the destination for one operand instructions
+    auto &opArgImmediate = (code.features & OperandFeatureFlags::kFeature_TwoOperands) ? opArgSrc : opArgDst;
+    if (opArgImmediate.addrMode == AddressMode::Immediate) {
+        immediateValue = cpu.ReadFromInstrStream(code.opSize, memoryOffset);
+        memoryOffset += ByteSizeOfOperandSize(code.opSize);
+    }
     ChangeState(State::kStateReadMem);
     return true;
 }
@@ -230,10 +232,29 @@ bool InstructionSetV1Decoder::ExecuteTickDecodeAddrMode(CPUBase &cpu) {
 // This is the third tick, here we fetch any data from from RAM - not following the instr. pointer
 //
 bool InstructionSetV1Decoder::ExecuteTickReadMem(CPUBase &cpu) {
+    // Atomics access memory during execution (through the cache controller), only register values are read here
+    // Cache maintenance/prefetch and block operations only use the address, which is computed during execution
+    if (code.features & (OperandFeatureFlags::kFeature_Atomic | OperandFeatureFlags::kFeature_AddressOnly)) {
+        if ((opArgSrc.addrMode == AddressMode::Register) || (opArgSrc.addrMode == AddressMode::Immediate)) {
+            ReadSrcValue(cpu, primaryValue);
+        }
+        ChangeState(State::kStateFinished);
+        return true;
+    }
+    if (code.features & OperandFeatureFlags::kFeature_ThreeOperands) {
+        ReadDstValue(cpu, primaryValue);
+        ReadSrcValue(cpu, secondaryValue);
+        ChangeState(State::kStateFinished);
+        return true;
+    }
+    // A faulting read finishes the instruction, the fault is raised when it is finalized (see 'HavePendingFault')
     if (code.features & OperandFeatureFlags::kFeature_OneOperand) {
-        primaryValue = ReadDstValue(cpu); //ReadFrom(cpu, opSize, dstAddrMode, dstAbsoluteAddr, dstRelAddrMode, dstRegIndex);
+        ReadDstValue(cpu, primaryValue);
     } else if (code.features & OperandFeatureFlags::kFeature_TwoOperands) {
-        primaryValue = ReadSrcValue(cpu); //value = ReadFrom(cpu, opSize, srcAddrMode, srcAbsoluteAddr, srcRelAddrMode, srcRegIndex);
+        if (!ReadSrcValue(cpu, primaryValue)) {
+            ChangeState(State::kStateFinished);
+            return true;
+        }
         if (code.features & OperandFeatureFlags::kFeature_TwoOpReadSecondary) {
             ChangeState(State::kStateTwoOpDstReadMem);
             return true;
@@ -247,7 +268,7 @@ bool InstructionSetV1Decoder::ExecuteTickReadMem(CPUBase &cpu) {
 // Some two operand instr. requires two read-mem ticks to fetch all values
 //
 bool InstructionSetV1Decoder::ExecuteTickReadDstMem(CPUBase &cpu) {
-    secondaryValue = ReadDstValue(cpu);
+    ReadDstValue(cpu, secondaryValue);
     ChangeState(State::kStateFinished);
     return true;
 }
@@ -308,7 +329,7 @@ void InstructionSetV1Decoder::DecodeOperandArgAddrMode(CPUBase &cpu, Instruction
         // Do nothing - this is decoded from the data about - details will be decoded further down...
     } else if (inOutOpArg.addrMode == AddressMode::Absolute) {
         // moving to an absolute address..
-        inOutOpArg.absoluteAddr = cpu.FetchFromPhysicalRam<uint64_t>(memoryOffset);
+        inOutOpArg.absoluteAddr = cpu.FetchFromInstrStream<uint64_t>(memoryOffset);
     } else if (inOutOpArg.addrMode == AddressMode::Register) {
         // nothing to do here
     } else if (inOutOpArg.addrMode == AddressMode::Immediate) {
@@ -334,6 +355,45 @@ void InstructionSetV1Decoder::DecodeOperandArgAddrMode(CPUBase &cpu, Instruction
 
 }
 
+//
+// Compare and branch, 'RegA|RegB' in one byte followed by the offset - this is everything, the instruction has a fixed size
+// The registers are kept as Register operands (RegA => dst, RegB => src) and the branch target in 'opArgDst.absoluteAddr'
+//
+void InstructionSetV1Decoder::DecodeCompareBranch(CPUBase &cpu) {
+    auto regs = NextByte(cpu);
+    opArgDst.regAndFlags = regs;
+    opArgDst.regIndex = (regs >> 4) & 15;
+    opArgDst.addrMode = AddressMode::Register;
+    opArgSrc.regIndex = regs & 15;
+    opArgSrc.addrMode = AddressMode::Register;
+
+    auto offset = static_cast<int16_t>(cpu.FetchFromInstrStream<uint16_t>(memoryOffset));
+    // relative to the end of the instruction
+    opArgDst.absoluteAddr = memoryOffset + offset;
+}
+
+bool InstructionSetV1Decoder::IsResolvableBranch() {
+    if (!IsFinished() || IsExtension(code.opCodeByte)) {
+        return false;
+    }
+    return ((code.features & OperandFeatureFlags::kFeature_ThreeOperands) && (code.features & OperandFeatureFlags::kFeature_Branching));
+}
+
+bool InstructionSetV1Decoder::IsSerializing() {
+    if (IsIdle() || IsExtension(code.opCodeByte)) {
+        return false;
+    }
+    return (code.features & OperandFeatureFlags::kFeature_Serializing);
+}
+
+bool InstructionSetV1Decoder::ResolveBranch(CPUBase &cpu, uint64_t &outTarget) {
+    // Read the registers again - older instructions might have changed them after they were read by the decoder
+    ReadDstValue(cpu, primaryValue);
+    ReadSrcValue(cpu, secondaryValue);
+    outTarget = opArgDst.absoluteAddr;
+    return InstructionSetV1Def::IsCompareBranchTaken(code.opCode, code.opSize, primaryValue, secondaryValue);
+}
+
 uint64_t InstructionSetV1Decoder::ComputeRelativeAddress(CPUBase &cpuBase, const InstructionSetV1Def::RelativeAddressing &relAddrMode) const {
     uint64_t relativeAddrOfs = 0;
     // Break out to own function - this is also used elsewhere..
@@ -353,36 +413,46 @@ uint64_t InstructionSetV1Decoder::ComputeRelativeAddress(CPUBase &cpuBase, const
 
 
 // Returns a value based on src op decoding
-RegisterValue InstructionSetV1Decoder::ReadSrcValue(CPUBase &cpu) {
-    return ReadFrom(cpu, code.opSize, opArgSrc.addrMode, opArgSrc.absoluteAddr, opArgSrc.relAddrMode, opArgSrc.regIndex);
+bool InstructionSetV1Decoder::ReadSrcValue(CPUBase &cpu, RegisterValue &outValue) {
+    return ReadFrom(cpu, code.opSize, opArgSrc.addrMode, opArgSrc.absoluteAddr, opArgSrc.relAddrMode, opArgSrc.regIndex, outValue);
 }
 
 // Returns a value based on dst op decoding
-RegisterValue InstructionSetV1Decoder::ReadDstValue(CPUBase &cpu) {
-    return ReadFrom(cpu, code.opSize, opArgDst.addrMode, opArgDst.absoluteAddr, opArgDst.relAddrMode, opArgDst.regIndex);
+bool InstructionSetV1Decoder::ReadDstValue(CPUBase &cpu, RegisterValue &outValue) {
+    return ReadFrom(cpu, code.opSize, opArgDst.addrMode, opArgDst.absoluteAddr, opArgDst.relAddrMode, opArgDst.regIndex, outValue);
 //    return ReadFrom(cpu, opSize, dstAddrMode, dstAbsoluteAddr, dstRelAddrMode, dstRegIndex);
 }
 
 
-RegisterValue InstructionSetV1Decoder::ReadFrom(CPUBase &cpuBase, OperandSize szOperand, AddressMode addrMode, uint64_t absAddress, InstructionSetV1Def::RelativeAddressing relAddrMode, int idxRegister) {
-    RegisterValue v = {};
+// A memory operand that faults returns false, the first fault is kept and raised by 'Finalize'
+bool InstructionSetV1Decoder::ReadFrom(CPUBase &cpuBase, OperandSize szOperand, AddressMode addrMode, uint64_t absAddress, InstructionSetV1Def::RelativeAddressing relAddrMode, int idxRegister, RegisterValue &outValue) {
+    outValue = {};
 
-    // This should be performed by instr. decoder...
     if (addrMode == AddressMode::Immediate) {
-        v = cpuBase.ReadFromMemoryUnit(szOperand, memoryOffset);
-        memoryOffset += ByteSizeOfOperandSize(szOperand);
+        outValue = immediateValue;
     } else if (addrMode == AddressMode::Register) {
         auto &reg = cpuBase.GetRegisterValue(idxRegister, code.opFamily);
-        v.data = reg.data;
+        outValue.data = reg.data;
     } else if (addrMode == AddressMode::Absolute) {
-        v = cpuBase.ReadFromMemoryUnit(szOperand, absAddress);
+        return ReadFromMemory(cpuBase, szOperand, absAddress, outValue);
         //memoryOffset += ByteSizeOfOperandSize(szOperand);
     } else if (addrMode == AddressMode::Indirect) {
         auto relativeAddrOfs = ComputeRelativeAddress(cpuBase, relAddrMode);
         auto &reg = cpuBase.GetRegisterValue(idxRegister, code.opFamily);
-        v = cpuBase.ReadFromMemoryUnit(szOperand, reg.data.longword + relativeAddrOfs);
+        return ReadFromMemory(cpuBase, szOperand, reg.data.longword + relativeAddrOfs, outValue);
+    }
+    return true;
+}
+
+bool InstructionSetV1Decoder::ReadFromMemory(CPUBase &cpuBase, OperandSize szOperand, uint64_t address, RegisterValue &outValue) {
+    if (cpuBase.TryReadFromMemoryUnit(szOperand, address, outValue)) {
+        return true;
+    }
+    if (!havePendingFault) {
+        havePendingFault = true;
+        pendingFaultAddress = address;
     }
-    return v;
+    return false;
 }
 
 
@@ -392,7 +462,7 @@ RegisterValue InstructionSetV1Decoder::ReadFrom(CPUBase &cpuBase, OperandSize sz
 std::string InstructionSetV1Decoder::ToString() const {
     auto &instrSetDefinition = InstructionSetManager::Instance().GetInstructionSet().GetDefinition(); //glb_InstructionSetV1.definition;
 
-    if (!instrSetDefinition.GetInstructionSet().contains(code.opCode)) {
+    if (!instrSetDefinition.GetInstructionSet()[code.opCode].isDefined) {
         // Note, we don't raise an exception - this is a helper for SW - not an actual HW type of function
         std::string invalid;
         fmt::format_to(std::back_inserter(invalid), "invalid instr. {:#x} @ {:#x}", (int)code.opCode, ofsStartInstr);
@@ -433,6 +503,14 @@ std::string InstructionSetV1Decoder::ToString() const {
 
     }
 
+    if (desc->features & OperandFeatureFlags::kFeature_ThreeOperands) {
+        opString += "\t";
+        opString += DisasmOperand(opArgDst.addrMode, opArgDst.absoluteAddr, opArgDst.regIndex, opArgDst.relAddrMode);
+        opString += ",";
+        opString += DisasmOperand(opArgSrc.addrMode, opArgSrc.absoluteAddr, opArgSrc.regIndex, opArgSrc.relAddrMode);
+        opString += fmt::format(",{:#x}", opArgDst.absoluteAddr);
+    }
+
     return opString;
 }
 
@@ -440,7 +518,9 @@ std::string InstructionSetV1Decoder::DisasmOperand(AddressMode addrMode, uint64_
     std::string opString = "";
     if (addrMode == AddressMode::Register) {
         if (regIndex > 7) {
-            if (code.opFamily == OperandFamily::Control) {
+            if ((code.opFamily == OperandFamily::Control) && (regIndex == kZeroRegisterIndex)) {
+                opString += "zero";
+            } else if (code.opFamily == OperandFamily::Control) {
                 opString += "cr" + fmt::format("{}", regIndex-8);
             } else {
                 opString += "a" + fmt::format("{}", regIndex-8);
@@ -45,6 +45,7 @@ namespace gnilk {
 
 
             // Make this private when it works
+            // Not virtual, the fixed width decoder has it's own - see 'TickAs'
             bool ExecuteTickFromIdle(CPUBase &cpu);
             bool ExecuteTickDecodeAddrMode(CPUBase &cpu);
             bool ExecuteTickReadMem(CPUBase &cpu);
@@ -55,6 +56,11 @@ namespace gnilk {
             bool IsIdle() override { return (state == State::kStateIdle); }
             bool IsFinished() override { return (state == State::kStateFinished); }
 
+            bool IsResolvableBranch() override;
+            bool IsSerializing() override;
+            bool HavePendingFault() override { return havePendingFault; }
+            bool ResolveBranch(CPUBase &cpu, uint64_t &outTarget) override;
+
 
             const std::string &StateString() const override {
                 return StateToString(state);
@@ -72,10 +78,10 @@ namespace gnilk {
 
             // Remove these
             size_t GetInstrSizeInBytes() {
-                return ComputeInstrSize();
+                return instrSize;
             }
             size_t GetInstrSizeInBytes() const {
-                return ComputeInstrSize();
+                return instrSize;
             }
             uint64_t GetInstrStartOfs() {
                 return ofsStartInstr;
@@ -90,18 +96,43 @@ namespace gnilk {
                 return ofsEndInstr;
             }
 
-            RegisterValue ReadSrcValue(CPUBase &cpu);
-            RegisterValue ReadDstValue(CPUBase &cpu);
+            // Returns false if the read faulted (see 'HavePendingFault')
+            bool ReadSrcValue(CPUBase &cpu, RegisterValue &outValue);
+            bool ReadDstValue(CPUBase &cpu, RegisterValue &outValue);
 
 
         protected:
+            // The state machine, shared with the fixed width decoder (CRTP style) - the per encoding ticks are
+            // resolved at compile time, this is called for every tick of every instruction.
+            template<typename TDecoder>
+            bool TickAs(CPUBase &cpu) {
+                auto &decoder = static_cast<TDecoder &>(*this);
+                switch(state) {
+                    case State::kStateIdle :
+                        return decoder.ExecuteTickFromIdle(cpu);
+                    case State::kStateDecodeAddrMode :
+                        return decoder.ExecuteTickDecodeAddrMode(cpu);
+                    case State::kStateReadMem :
+                        return ExecuteTickReadMem(cpu);
+                    case State::kStateTwoOpDstReadMem :
+                        return ExecuteTickReadDstMem(cpu);
+                    case State::kStateDecodeExtension :
+                        return ExecuteTickDecodeExt(cpu);
+                    case State::kStateFinished :
+                        return true;
+                }
+                return false;
+            }
+
             // Helper for 'ToString'
             std::string DisasmOperand(AddressMode addrMode, uint64_t absAddress, uint8_t regIndex, InstructionSetV1Def::RelativeAddressing relAddr) const;
             // Perhaps move to base class
-            RegisterValue ReadFrom(CPUBase &cpuBase, OperandSize szOperand, AddressMode addrMode, uint64_t absAddress, InstructionSetV1Def::RelativeAddressing relAddr, int idxRegister);
+            bool ReadFrom(CPUBase &cpuBase, OperandSize szOperand, AddressMode addrMode, uint64_t absAddress, InstructionSetV1Def::RelativeAddressing relAddr, int idxRegister, RegisterValue &outValue);
+            bool ReadFromMemory(CPUBase &cpuBase, OperandSize szOperand, uint64_t address, RegisterValue &outValue);
 
             void DecodeOperandArg(CPUBase &cpu, InstructionSetV1Def::DecodedOperandArg &inOutOpArg);
             void DecodeOperandArgAddrMode(CPUBase &cpu, InstructionSetV1Def::DecodedOperandArg &inOutOpArg);
+            void DecodeCompareBranch(CPUBase &cpu);
 
             size_t ComputeInstrSize() const;
             size_t ComputeOpArgSize(const InstructionSetV1Def::DecodedOperandArg &opArg) const;
@@ -130,6 +161,14 @@ namespace gnilk {
             // Note: This is _ALWAYS_ the destination
             RegisterValue secondaryValue;
 
+            // Immediate operand, fetched with the rest of the instruction (see ExecuteTickDecodeAddrMode)
+            RegisterValue immediateValue;
+            // Full size of the instruction, known once the first tick is done
+            size_t instrSize = 0;
+            // First memory operand that faulted while decoding, raised by 'Finalize'
+            bool havePendingFault = false;
+            uint64_t pendingFaultAddress = 0;
+
             InstructionDecoderBase::Ref currentExtDecoder = nullptr;
         };
 
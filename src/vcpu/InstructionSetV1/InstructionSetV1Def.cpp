@@ -6,7 +6,6 @@
 // This defines the instruction set for v1 - the base instruction set (integer arithmetic)
 // It mainly serves as the data definition for data structures used within the decoder / execution part..
 //
-#include <unordered_map>
 #include <optional>
 #include "InstructionSetDefBase.h"
 #include "InstructionSetV1Def.h"
@@ -22,15 +21,25 @@ using namespace gnilk::vcpu;
 // This holds the full instruction set definition
 // I probably want the features to specifify valid SRC/DST combos
 //
-static std::unordered_map<OperandCodeBase, OperandDescriptionBase> instructionSet = {
+static constexpr OperandDefinition instructionDefinitions[] = {
     {OperandCode::SYS,{.name="syscall", .features = {} }},
     {OperandCode::NOP,{.name="nop", .features = {} }},
     {OperandCode::BRK,{.name="brk", .features = {} }},
     {OperandCode::RET,{.name="ret", .features = {} }},
     {OperandCode::RTI,{.name="rti", .features = {} }},
     {OperandCode::RTE,{.name="rte", .features = {} }},
+    {OperandCode::CLC,{.name="clc", .features = {} }},
+    {OperandCode::SEC,{.name="sec", .features = {} }},
+    {OperandCode::FENCE,{.name="fence", .features = OperandFeatureFlags::kFeature_Serializing }},
 {OperandCode::BEQ,{.name="beq", .features = OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_OneOperand | OperandFeatureFlags::kFeature_Immediate | OperandFeatureFlags::kFeature_Branching}},
 {OperandCode::BNE,{.name="bne", .features = OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_OneOperand | OperandFeatureFlags::kFeature_Immediate | OperandFeatureFlags::kFeature_Branching}},
+{OperandCode::BCC,{.name="bcc", .features = OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_OneOperand | OperandFeatureFlags::kFeature_Immediate | OperandFeatureFlags::kFeature_Branching}},
+{OperandCode::BCS,{.name="bcs", .features = OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_OneOperand | OperandFeatureFlags::kFeature_Immediate | OperandFeatureFlags::kFeature_Branching}},
+    // Compare and branch, the assembler also accepts 'beq/bne/blt/bge <reg>,<reg>,label'
+{OperandCode::BREQ,{.name="breq", .features = OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_ThreeOperands | OperandFeatureFlags::kFeature_Control | OperandFeatureFlags::kFeature_Branching}},
+{OperandCode::BRNE,{.name="brne", .features = OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_ThreeOperands | OperandFeatureFlags::kFeature_Control | OperandFeatureFlags::kFeature_Branching}},
+{OperandCode::BRLT,{.name="brlt", .features = OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_ThreeOperands | OperandFeatureFlags::kFeature_Control | OperandFeatureFlags::kFeature_Branching}},
+{OperandCode::BRGE,{.name="brge", .features = OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_ThreeOperands | OperandFeatureFlags::kFeature_Control | OperandFeatureFlags::kFeature_Branching}},
 
 {OperandCode::LSL, {.name="lsl", .features = OperandFeatureFlags::kFeature_OperandSize |
                                              OperandFeatureFlags::kFeature_TwoOperands |
@@ -83,53 +92,145 @@ static std::unordered_map<OperandCodeBase, OperandDescriptionBase> instructionSe
 {OperandCode::MUL,{.name="mul", .features = OperandFeatureFlags::kFeature_OperandSize |
                                             OperandFeatureFlags::kFeature_TwoOperands |
                                             OperandFeatureFlags::kFeature_Immediate |
+                                            OperandFeatureFlags::kFeature_TwoOpReadSecondary |
                                             OperandFeatureFlags::kFeature_AnyRegister |
                                             OperandFeatureFlags::kFeature_Addressing}},
 {OperandCode::DIV,{.name="div", .features = OperandFeatureFlags::kFeature_OperandSize |
                                             OperandFeatureFlags::kFeature_TwoOperands |
                                             OperandFeatureFlags::kFeature_Immediate |
+                                            OperandFeatureFlags::kFeature_TwoOpReadSecondary |
+                                            OperandFeatureFlags::kFeature_AnyRegister |
+                                            OperandFeatureFlags::kFeature_Addressing}},
+{OperandCode::AND,{.name="and", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                            OperandFeatureFlags::kFeature_TwoOperands |
+                                            OperandFeatureFlags::kFeature_Immediate |
+                                            OperandFeatureFlags::kFeature_TwoOpReadSecondary |
+                                            OperandFeatureFlags::kFeature_AnyRegister |
+                                            OperandFeatureFlags::kFeature_Addressing}},
+{OperandCode::OR,{.name="or", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                            OperandFeatureFlags::kFeature_TwoOperands |
+                                            OperandFeatureFlags::kFeature_Immediate |
+                                            OperandFeatureFlags::kFeature_TwoOpReadSecondary |
+                                            OperandFeatureFlags::kFeature_AnyRegister |
+                                            OperandFeatureFlags::kFeature_Addressing}},
+{OperandCode::XOR,{.name="xor", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                            OperandFeatureFlags::kFeature_TwoOperands |
+                                            OperandFeatureFlags::kFeature_Immediate |
+                                            OperandFeatureFlags::kFeature_TwoOpReadSecondary |
                                             OperandFeatureFlags::kFeature_AnyRegister |
                                             OperandFeatureFlags::kFeature_Addressing}},
 
+    // Atomics - one operand is a register and the other memory
+{OperandCode::LDL,{.name="ldl", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                            OperandFeatureFlags::kFeature_TwoOperands |
+                                            OperandFeatureFlags::kFeature_AnyRegister |
+                                            OperandFeatureFlags::kFeature_Addressing |
+                                            OperandFeatureFlags::kFeature_Atomic}},
+{OperandCode::STC,{.name="stc", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                            OperandFeatureFlags::kFeature_TwoOperands |
+                                            OperandFeatureFlags::kFeature_AnyRegister |
+                                            OperandFeatureFlags::kFeature_Addressing |
+                                            OperandFeatureFlags::kFeature_Atomic}},
+{OperandCode::CAS,{.name="cas", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                            OperandFeatureFlags::kFeature_TwoOperands |
+                                            OperandFeatureFlags::kFeature_AnyRegister |
+                                            OperandFeatureFlags::kFeature_Addressing |
+                                            OperandFeatureFlags::kFeature_Atomic}},
+
+    // Block operations - the memory operands are addresses, memory is accessed during execution
+{OperandCode::MOVS,{.name="movs", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                              OperandFeatureFlags::kFeature_TwoOperands |
+                                              OperandFeatureFlags::kFeature_Addressing |
+                                              OperandFeatureFlags::kFeature_AddressOnly |
+                                              OperandFeatureFlags::kFeature_Serializing}},
+{OperandCode::FILL,{.name="fill", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                              OperandFeatureFlags::kFeature_TwoOperands |
+                                              OperandFeatureFlags::kFeature_Immediate |
+                                              OperandFeatureFlags::kFeature_AnyRegister |
+                                              OperandFeatureFlags::kFeature_Addressing |
+                                              OperandFeatureFlags::kFeature_AddressOnly |
+                                              OperandFeatureFlags::kFeature_Serializing}},
+
+    // Cache maintenance - the operand is the address, memory is not read
+{OperandCode::CFLUSH,{.name="cflush", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                                  OperandFeatureFlags::kFeature_OneOperand |
+                                                  OperandFeatureFlags::kFeature_Addressing |
+                                                  OperandFeatureFlags::kFeature_AddressOnly |
+                                                  OperandFeatureFlags::kFeature_Serializing}},
+{OperandCode::CINVAL,{.name="cinval", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                                  OperandFeatureFlags::kFeature_OneOperand |
+                                                  OperandFeatureFlags::kFeature_Addressing |
+                                                  OperandFeatureFlags::kFeature_AddressOnly |
+                                                  OperandFeatureFlags::kFeature_Serializing}},
+{OperandCode::CCLEAN,{.name="cclean", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                                  OperandFeatureFlags::kFeature_OneOperand |
+                                                  OperandFeatureFlags::kFeature_Addressing |
+                                                  OperandFeatureFlags::kFeature_AddressOnly |
+                                                  OperandFeatureFlags::kFeature_Serializing}},
+{OperandCode::PREFETCH,{.name="prefetch", .features = OperandFeatureFlags::kFeature_OperandSize |
+                                                      OperandFeatureFlags::kFeature_OneOperand |
+                                                      OperandFeatureFlags::kFeature_Addressing |
+                                                      OperandFeatureFlags::kFeature_AddressOnly}},
+
     // Push can be from many sources
   {OperandCode::PUSH,{.name="push", .features = OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_OneOperand | OperandFeatureFlags::kFeature_AnyRegister | OperandFeatureFlags::kFeature_Immediate | OperandFeatureFlags::kFeature_Addressing}},
     // Pop can only be to register...
   {OperandCode::POP,{.name="pop", .features = OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_OneOperand | OperandFeatureFlags::kFeature_AnyRegister}},
 
     {OperandCode::CALL, {.name="call", .features = OperandFeatureFlags::kFeature_Branching | OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_OneOperand | OperandFeatureFlags::kFeature_Immediate | OperandFeatureFlags::kFeature_AnyRegister | OperandFeatureFlags::kFeature_Addressing}},
+    {OperandCode::JMP, {.name="jmp", .features = OperandFeatureFlags::kFeature_Branching | OperandFeatureFlags::kFeature_OperandSize | OperandFeatureFlags::kFeature_OneOperand | OperandFeatureFlags::kFeature_Immediate | OperandFeatureFlags::kFeature_AnyRegister | OperandFeatureFlags::kFeature_Addressing}},
     // Extension byte - nothing, no name - not available to the assembler
     {OperandCode::SIMD, {.name="", .features = OperandFeatureFlags::kFeature_Extension }},
 };
 
-const std::unordered_map<OperandCodeBase, OperandDescriptionBase> &InstructionSetV1Def::GetInstructionSet() {
+// Indexed by the op code byte, used by the decoder
+static constexpr OperandDescriptionTable instructionSet = BuildOperandDescriptionTable(instructionDefinitions);
+// Mnemonic to op code, used by the assembler
+static constexpr MnemonicHash mnemonicHash = MnemonicHash::Build(instructionSet);
+
+const OperandDescriptionTable &InstructionSetV1Def::GetInstructionSet() {
     return instructionSet;
 }
 
 
 std::optional<OperandDescriptionBase> InstructionSetV1Def::GetOpDescFromClass(OperandCodeBase opClass) {
-    if (!instructionSet.contains(opClass)) {
+    if (!instructionSet[opClass].isDefined) {
         return{};
     }
-    return instructionSet.at(opClass);
+    return instructionSet[opClass];
 }
 
-// Look up table is built when an operand from str is first called
-static std::unordered_map<std::string, OperandCodeBase> strToOpClassMap;
-
 std::optional<OperandCodeBase> InstructionSetV1Def::GetOperandFromStr(const std::string &str) {
-    // Lazy create on first request
-    static bool haveNameOpClassTable = false;
-    if (!haveNameOpClassTable) {
-        for(auto [opClass, desc] : instructionSet) {
-            strToOpClassMap[desc.name] = opClass;
-        }
-        haveNameOpClassTable = true;
+    return mnemonicHash.Find(instructionSet, str);
+}
+
+template<typename T>
+static bool CompareForBranch(OperandCodeBase opCode, T a, T b) {
+    switch(opCode) {
+        case OperandCode::BREQ :
+            return (a == b);
+        case OperandCode::BRNE :
+            return (a != b);
+        case OperandCode::BRLT :
+            return (a < b);
+        case OperandCode::BRGE :
+            return (a >= b);
     }
+    return false;
+}
 
-    if (!strToOpClassMap.contains(str)) {
-        return {};
+bool InstructionSetV1Def::IsCompareBranchTaken(OperandCodeBase opCode, OperandSize opSize, const RegisterValue &regA, const RegisterValue &regB) {
+    switch(opSize) {
+        case OperandSize::Byte :
+            return CompareForBranch<int8_t>(opCode, regA.data.byte, regB.data.byte);
+        case OperandSize::Word :
+            return CompareForBranch<int16_t>(opCode, regA.data.word, regB.data.word);
+        case OperandSize::DWord :
+            return CompareForBranch<int32_t>(opCode, regA.data.dword, regB.data.dword);
+        case OperandSize::Long :
+            return CompareForBranch<int64_t>(opCode, regA.data.longword, regB.data.longword);
     }
-    return strToOpClassMap.at(str);
+    return false;
 }
 
 // Helper to encode this according to spec - called from assembler StateEmitter when generating binary code..
@@ -26,9 +26,7 @@ namespace gnilk {
         //
 
         // TO-DO:
-        // - extend this with atomic stuff (use lc/sr or cas?; https://en.wikipedia.org/wiki/Load-link/store-conditional)
-        //      - do I need atomic swap and such?
-        // - 'fence' to sync pipeline
+        // - atomics; ldl/stc (load-linked/store-conditional) and cas are in, do I need atomic swap/add and such?
         // - 'hint' or other instructions to read performance values or update them; see RISC-V ISA
         // - Need to verify my core control block - most likely must extend this (see RISC-V ISA, Chapter 10 - they have 4096 CSR reg's)
         //   also see: file:///home/gnilk/Downloads/priv-isa-asciidoc.pdf
@@ -153,15 +151,37 @@ namespace gnilk {
             NOP = 0x61,
             RTI = 0x62, // Return from Interrupt
             RTE = 0x63, // Return from Exception
+            FENCE = 0x64, // Serialize - all older instructions (incl. memory access) complete before any younger starts
 
 
             PUSH = 0x70,
             POP = 0x80,
             CMP = 0x90,
 
+            // Atomics, memory must be cacheable and the access can't cross a cache line (raises MMU fault)
+            // Result of 'stc' and 'cas' are in the zero flag, set on success
+            LDL = 0x98,     // Load Linked; ldl.l d0,(a0) - loads and reserves the cache line
+            STC = 0x99,     // Store Conditional; stc.l (a0),d1 - stores only if the reservation is still valid
+            CAS = 0x9A,     // Compare and Swap; cas.l (a0),d1 - if (a0) == d0 => (a0) = d1, else d0 = (a0)
+
             CLC = 0xA0,
             SEC = 0xA1,
 
+            // Block copy/fill, the count (elements of op.size) is in d0 - 'movs.l (a1),(a0)', 'fill.b (a1),d1'
+            // Executed in chunks of whole cache lines, the address registers and d0 are updated and the instruction
+            // re-executes until d0 is zero - interrupts and faults are taken in between. Serializing.
+            // movs handles overlap like memmove, a destination above the source is copied backwards chunk by chunk from
+            // the tail - only d0 is updated, the address registers keep pointing at the start of the blocks
+            MOVS = 0xA4,
+            FILL = 0xA5,
+
+            // Cache maintenance on the line holding the address - 'cflush (a0)', serializing
+            // No-op for non-cacheable memory, raises MMU fault if there is no memory at the address
+            CFLUSH = 0xA8,      // write back (if dirty) and drop the line, also drops the instruction cache blocks
+            CINVAL = 0xA9,      // drop the line WITHOUT write back, also drops the instruction cache blocks
+            CCLEAN = 0xAA,      // write back (if dirty), the line stays in the cache
+            PREFETCH = 0xAB,    // hint - load the line unless present, never faults
+
             AND = 0xB0,
             OR = 0xB1,
             XOR = 0xB2,
@@ -178,6 +198,19 @@ namespace gnilk {
             BCC = 0xD2, // Branch Carry Clear
             BCS = 0xD3, // Branch Carry Set
 
+            // Compare and branch, don't touch the status flags - 'breq.l d0,d1,label' => if (d0 == d1) goto label
+            // Compares at op.size, lt/ge are signed. Compare with the zero register (cr7) for zero tests.
+            //  byte | What
+            //  ----------------------------
+            //    0  | Op Code
+            //    1  | OpSizeAndFamily (family Control => index 8..15 are cr0..cr7)
+            //    2  | RegA | RegB, upper 4 bits RegA
+            //  3..4 | int16 offset, relative to the end of the instruction
+            BREQ = 0xD4,
+            BRNE = 0xD5,
+            BRLT = 0xD6,
+            BRGE = 0xD7,
+
             // The Ex family is special - their dst operand is also the src operand is the operate value
             // the operate value is also locked to byte-access...
             // Thus,
@@ -261,10 +294,13 @@ namespace gnilk {
 
 
         public:
-            const std::unordered_map<OperandCodeBase, OperandDescriptionBase> &GetInstructionSet() override;
+            const OperandDescriptionTable &GetInstructionSet() override;
             std::optional<OperandDescriptionBase> GetOpDescFromClass(OperandCodeBase opClass) override;
             std::optional<OperandCodeBase> GetOperandFromStr(const std::string &str) override;
 
+            // Evaluates a compare and branch (BREQ..BRGE) - true if the branch is taken
+            static bool IsCompareBranchTaken(OperandCodeBase opCode, OperandSize opSize, const RegisterValue &regA, const RegisterValue &regB);
+
             // uint8_t EncodeOpSizeAndFamily(OperandSize opSize, OperandFamily opFamily) override;
         };
 
@@ -11,7 +11,7 @@ using namespace gnilk::vcpu;
 std::string InstructionSetV1Disasm::FromDecoded(const InstructionSetV1Def::DecoderOutput &decoderOutput) {
     auto &instrSetDefinition = InstructionSetManager::Instance().GetInstructionSet().GetDefinition();
 
-    if (!instrSetDefinition.GetInstructionSet().contains(decoderOutput.operand.opCode)) {
+    if (!instrSetDefinition.GetInstructionSet()[decoderOutput.operand.opCode].isDefined) {
         // Note, we don't raise an exception - this is a helper for SW - not an actual HW type of function
         std::string invalid;
         fmt::format_to(std::back_inserter(invalid), "invalid instr. {:#x}", (int)decoderOutput.operand.opCode);
@@ -52,6 +52,14 @@ std::string InstructionSetV1Disasm::FromDecoded(const InstructionSetV1Def::Decod
 
     }
 
+    if (desc->features & OperandFeatureFlags::kFeature_ThreeOperands) {
+        opString += "\t";
+        opString += DisasmOperand(decoderOutput, decoderOutput.opArgDst.addrMode, decoderOutput.opArgDst.absoluteAddr, decoderOutput.opArgDst.regIndex, decoderOutput.opArgDst.relAddrMode);
+        opString += ",";
+        opString += DisasmOperand(decoderOutput, decoderOutput.opArgSrc.addrMode, decoderOutput.opArgSrc.absoluteAddr, decoderOutput.opArgSrc.regIndex, decoderOutput.opArgSrc.relAddrMode);
+        opString += fmt::format(",{:#x}", decoderOutput.opArgDst.absoluteAddr);
+    }
+
     return opString;
 }
 
@@ -61,7 +69,9 @@ std::string InstructionSetV1Disasm::DisasmOperand(const InstructionSetV1Def::Dec
     std::string opString = "";
     if (addrMode == AddressMode::Register) {
         if (regIndex > 7) {
-            if (decoderOutput.operand.opFamily == OperandFamily::Control) {
+            if ((decoderOutput.operand.opFamily == OperandFamily::Control) && (regIndex == kZeroRegisterIndex)) {
+                opString += "zero";
+            } else if (decoderOutput.operand.opFamily == OperandFamily::Control) {
                 opString += "cr" + fmt::format("{}", regIndex-8);
             } else {
                 opString += "a" + fmt::format("{}", regIndex-8);
@@ -0,0 +1,12 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#include "InstructionSetV1Fixed.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+InstructionDecoderBase::Ref InstructionSetV1Fixed::CreateDecoder(uint8_t instrTypeId) {
+    return std::make_shared<InstructionSetV1FixedDecoder>();
+}
@@ -0,0 +1,28 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_INSTRUCTIONSETV1FIXED_H
+#define VCPU_INSTRUCTIONSETV1FIXED_H
+
+#include "InstructionSet.h"
+#include "InstructionSetV1FixedDecoder.h"
+#include "InstructionSetV1FixedDef.h"
+#include "InstructionSetV1Impl.h"
+
+namespace gnilk {
+    namespace vcpu {
+
+        //
+        // Instruction set v1 with the fixed width encoding, replaces the v1 root:
+        //   InstructionSetManager::Instance().SetInstructionSet<InstructionSetV1Fixed>();
+        //
+        class InstructionSetV1Fixed : public
+                InstructionSetInst<InstructionSetV1FixedDecoder, InstructionSetV1FixedDef, InstructionSetV1Impl> {
+        public:
+            InstructionDecoderBase::Ref CreateDecoder(uint8_t instrTypeId) override;
+        };
+    }
+}
+
+#endif //VCPU_INSTRUCTIONSETV1FIXED_H
@@ -0,0 +1,171 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+//
+// Decoder for the fixed width encoding of instruction set v1, see InstructionSetV1FixedDef for the layout.
+// Same states as the v1 decoder, but the first tick reads exactly one word and knows the full size of the instruction
+// from it - no per-operand byte fetches.
+//
+
+#include "InstructionSetV1FixedDecoder.h"
+#include "fmt/core.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+using Fixed = InstructionSetV1FixedDef;
+
+InstructionSetV1FixedDecoder::Ref InstructionSetV1FixedDecoder::Create() {
+    auto inst = std::make_shared<InstructionSetV1FixedDecoder>();
+    return inst;
+}
+
+void InstructionSetV1FixedDecoder::Reset() {
+    instrWord = 0;
+    InstructionSetV1Decoder::Reset();
+}
+
+bool InstructionSetV1FixedDecoder::Tick(CPUBase &cpu) {
+    return TickAs<InstructionSetV1FixedDecoder>(cpu);
+}
+
+bool InstructionSetV1FixedDecoder::ExecuteTickFromIdle(CPUBase &cpu) {
+    memoryOffset = cpu.GetInstrPtr().data.longword;
+    ofsStartInstr = memoryOffset;
+    ofsEndInstr = memoryOffset;
+
+    instrWord = cpu.FetchFromInstrStream<uint32_t>(memoryOffset);
+    code.opCodeByte = instrWord >> Fixed::kShiftOpCode;
+    if (code.opCodeByte == 0xff) {
+        return false;
+    }
+
+    auto &instrSetDefinition = InstructionSetManager::Instance().GetInstructionSet().GetDefinition();
+    code.opCode = static_cast<OperandCode>(code.opCodeByte);
+    auto &opDesc = instrSetDefinition.GetInstructionSet()[code.opCode];
+    // Extensions can't be encoded - the size is unknown, resume at the next word to stay aligned
+    if (!opDesc.isDefined || IsExtension(code.opCodeByte)) {
+        instrSize = Fixed::kWordSize;
+        cpu.AdvanceInstrPtr(instrSize);
+        cpu.RaiseException(CPUKnownExceptions::kInvalidInstruction);
+        return false;
+    }
+
+    code.features = opDesc.features;
+    code.opSize = static_cast<OperandSize>((instrWord >> Fixed::kShiftOpSize) & 0x03);
+    code.opFamily = (instrWord & Fixed::kBitControlFamily) ? OperandFamily::Control : OperandFamily::Integer;
+    // Keep the raw v1 byte, it is part of the decoder output
+    code.opSizeAndFamilyCode = static_cast<uint8_t>(code.opSize) | (static_cast<uint8_t>(code.opFamily) << 4);
+
+    opArgDst = {};
+    opArgSrc = {};
+
+    size_t nExtWords = 0;
+    bool haveOperands = true;
+    if (code.features & OperandFeatureFlags::kFeature_OneOperand) {
+        DecodeOperandArg(opArgDst, (instrWord >> Fixed::kShiftDstReg) & 15, static_cast<AddressMode>((instrWord >> Fixed::kShiftDstAddrMode) & 0x03));
+        nExtWords += Fixed::NumOperandExtWords(opArgDst.addrMode, code.opSize);
+    } else if (code.features & OperandFeatureFlags::kFeature_TwoOperands) {
+        DecodeOperandArg(opArgDst, (instrWord >> Fixed::kShiftDstReg) & 15, static_cast<AddressMode>((instrWord >> Fixed::kShiftDstAddrMode) & 0x03));
+        DecodeOperandArg(opArgSrc, (instrWord >> Fixed::kShiftSrcReg) & 15, static_cast<AddressMode>((instrWord >> Fixed::kShiftSrcAddrMode) & 0x03));
+        nExtWords += Fixed::NumOperandExtWords(opArgDst.addrMode, code.opSize);
+        nExtWords += Fixed::NumOperandExtWords(opArgSrc.addrMode, code.opSize);
+    } else if (code.features & OperandFeatureFlags::kFeature_ThreeOperands) {
+        // Compare and branch, registers only - the offset is in the extension word
+        DecodeOperandArg(opArgDst, (instrWord >> Fixed::kShiftDstReg) & 15, AddressMode::Register);
+        DecodeOperandArg(opArgSrc, (instrWord >> Fixed::kShiftSrcReg) & 15, AddressMode::Register);
+        nExtWords += 1;
+    } else {
+        haveOperands = false;
+    }
+    if (instrWord & Fixed::kBitRelativeExt) {
+        nExtWords += 1;
+    }
+    immediateValue.data.byte = instrWord & Fixed::kMaskImmediate;
+
+    // The full size is known from the first word
+    ofsEndInstr = ofsStartInstr + (1 + nExtWords) * Fixed::kWordSize;
+    instrSize = ofsEndInstr - ofsStartInstr;
+    cpu.AdvanceInstrPtr(instrSize);
+
+    if (nExtWords > 0) {
+        ChangeState(State::kStateDecodeAddrMode);
+    } else if (haveOperands) {
+        ChangeState(State::kStateReadMem);
+    } else {
+        ChangeState(State::kStateFinished);
+    }
+    return true;
+}
+
+//
+// Fetches the extension words
+//
+bool InstructionSetV1FixedDecoder::ExecuteTickDecodeAddrMode(CPUBase &cpu) {
+    if (instrWord & Fixed::kBitRelativeExt) {
+        auto relWord = cpu.FetchFromInstrStream<uint32_t>(memoryOffset);
+        DecodeRelativeAddressing(cpu, opArgDst, (relWord >> Fixed::kShiftDstRelMode) & 0x03, (relWord >> Fixed::kShiftDstRelByte) & 0xff);
+        DecodeRelativeAddressing(cpu, opArgSrc, (relWord >> Fixed::kShiftSrcRelMode) & 0x03, (relWord >> Fixed::kShiftSrcRelByte) & 0xff);
+    }
+
+    if (code.features & OperandFeatureFlags::kFeature_ThreeOperands) {
+        auto offset = static_cast<int32_t>(cpu.FetchFromInstrStream<uint32_t>(memoryOffset));
+        // relative to the end of the instruction
+        opArgDst.absoluteAddr = ofsEndInstr + offset;
+        ChangeState(State::kStateReadMem);
+        return true;
+    }
+
+    FetchOperandExt(cpu, opArgDst);
+    if (code.features & OperandFeatureFlags::kFeature_TwoOperands) {
+        FetchOperandExt(cpu, opArgSrc);
+    }
+    ChangeState(State::kStateReadMem);
+    return true;
+}
+
+void InstructionSetV1FixedDecoder::DecodeOperandArg(InstructionSetV1Def::DecodedOperandArg &outOpArg, uint8_t regIndex, AddressMode addrMode) {
+    outOpArg.regIndex = regIndex;
+    outOpArg.addrMode = addrMode;
+    // Same layout as the v1 byte, for anyone looking at the raw bits
+    outOpArg.regAndFlags = (regIndex << 4) | static_cast<uint8_t>(addrMode);
+}
+
+void InstructionSetV1FixedDecoder::DecodeRelativeAddressing(CPUBase &cpu, InstructionSetV1Def::DecodedOperandArg &inOutOpArg, uint8_t relMode, uint8_t relByte) {
+    inOutOpArg.relAddrMode.mode = static_cast<RelativeAddressMode>(relMode);
+    if (inOutOpArg.relAddrMode.mode == RelativeAddressMode::AbsRelative) {
+        inOutOpArg.relAddrMode.relativeAddress.absoulte = relByte;
+    } else if (inOutOpArg.relAddrMode.mode == RelativeAddressMode::RegRelative) {
+        inOutOpArg.relAddrMode.relativeAddress.reg.index = (relByte & 0xf0) >> 4;
+        inOutOpArg.relAddrMode.relativeAddress.reg.shift = (relByte & 0x0f);
+    } else {
+        return;
+    }
+    inOutOpArg.regAndFlags |= relMode << 2;
+    inOutOpArg.relativeAddressOfs = ComputeRelativeAddress(cpu, inOutOpArg.relAddrMode);
+}
+
+void InstructionSetV1FixedDecoder::FetchOperandExt(CPUBase &cpu, InstructionSetV1Def::DecodedOperandArg &inOutOpArg) {
+    if (inOutOpArg.addrMode == AddressMode::Absolute) {
+        inOutOpArg.absoluteAddr = cpu.FetchFromInstrStream<uint64_t>(memoryOffset);
+        return;
+    }
+    if (inOutOpArg.addrMode != AddressMode::Immediate) {
+        return;
+    }
+    switch(code.opSize) {
+        case OperandSize::Byte :
+            // already in the instruction word
+            break;
+        case OperandSize::Word :
+            immediateValue.data.word = cpu.FetchFromInstrStream<uint32_t>(memoryOffset) & 0xffff;
+            break;
+        case OperandSize::DWord :
+            immediateValue.data.dword = cpu.FetchFromInstrStream<uint32_t>(memoryOffset);
+            break;
+        case OperandSize::Long :
+            immediateValue.data.longword = cpu.FetchFromInstrStream<uint64_t>(memoryOffset);
+            break;
+    }
+}
@@ -0,0 +1,47 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_INSTRUCTIONSETV1FIXEDDECODER_H
+#define VCPU_INSTRUCTIONSETV1FIXEDDECODER_H
+
+#include "InstructionSetV1Decoder.h"
+#include "InstructionSetV1FixedDef.h"
+
+namespace gnilk {
+    namespace vcpu {
+
+        //
+        // Decoder for the fixed width encoding (see InstructionSetV1FixedDef).
+        // The first word holds the op code, operands and the number of extension words - the instruction pointer is
+        // advanced after a single fetch. Extension words are fetched in the addr.mode tick, memory is read like for v1.
+        // The output is the same as for the v1 decoder, so the v1 implementation executes it.
+        // The ticks shadow the v1 ones, 'TickAs' binds them statically.
+        //
+        class InstructionSetV1FixedDecoder final : public InstructionSetV1Decoder {
+        public:
+            using Ref = std::shared_ptr<InstructionSetV1FixedDecoder>;
+        public:
+            InstructionSetV1FixedDecoder() = default;
+            virtual ~InstructionSetV1FixedDecoder() = default;
+            static InstructionSetV1FixedDecoder::Ref Create();
+
+            void Reset() override;
+            bool Tick(CPUBase &cpu) override;
+
+            bool ExecuteTickFromIdle(CPUBase &cpu);
+            bool ExecuteTickDecodeAddrMode(CPUBase &cpu);
+
+        protected:
+
+            void DecodeOperandArg(InstructionSetV1Def::DecodedOperandArg &outOpArg, uint8_t regIndex, AddressMode addrMode);
+            void DecodeRelativeAddressing(CPUBase &cpu, InstructionSetV1Def::DecodedOperandArg &inOutOpArg, uint8_t relMode, uint8_t relByte);
+            void FetchOperandExt(CPUBase &cpu, InstructionSetV1Def::DecodedOperandArg &inOutOpArg);
+
+        private:
+            uint32_t instrWord = 0;
+        };
+    }
+}
+
+#endif //VCPU_INSTRUCTIONSETV1FIXEDDECODER_H
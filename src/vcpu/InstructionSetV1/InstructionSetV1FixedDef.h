@@ -0,0 +1,83 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_INSTRUCTIONSETV1FIXEDDEF_H
+#define VCPU_INSTRUCTIONSETV1FIXEDDEF_H
+
+#include "InstructionSetV1Def.h"
+
+namespace gnilk {
+    namespace vcpu {
+
+        //
+        // Fixed width encoding of instruction set v1 - same op codes, features and execution, only the layout differs.
+        // Everything the decoder needs to know (incl. the size of the instruction) is in the first word, big-endian:
+        //
+        //   31..24  op code
+        //   23..22  op.size
+        //   21      op.family, 0 - integer, 1 - control (there are no float instructions)
+        //   20      a relative addressing extension word follows
+        //   19..16  dst register
+        //   15..14  dst address mode
+        //   13..10  src register
+        //    9.. 8  src address mode
+        //    7.. 0  byte immediate (incl. byte branch offsets), otherwise zero
+        //
+        // Followed by extension words, in this order:
+        //   relative addressing - 25..24 dst rel.mode, 23..16 dst rel.byte, 9..8 src rel.mode, 7..0 src rel.byte
+        //   dst operand - immediates wider than a byte, word/dword in one word (low bits) and long in two
+        //                 absolute addresses in two words
+        //   src operand - as dst
+        //
+        // Compare and branch: the registers are dst/src (register mode) and the branch offset is a dword extension word,
+        // relative to the end of the instruction.
+        // Extensions (SIMD) are not available in this encoding.
+        //
+        class InstructionSetV1FixedDef : public InstructionSetV1Def {
+        public:
+            static constexpr size_t kWordSize = sizeof(uint32_t);
+
+            static constexpr uint32_t kShiftOpCode = 24;
+            static constexpr uint32_t kShiftOpSize = 22;
+            static constexpr uint32_t kBitControlFamily = 1 << 21;
+            static constexpr uint32_t kBitRelativeExt = 1 << 20;
+            static constexpr uint32_t kShiftDstReg = 16;
+            static constexpr uint32_t kShiftDstAddrMode = 14;
+            static constexpr uint32_t kShiftSrcReg = 10;
+            static constexpr uint32_t kShiftSrcAddrMode = 8;
+            static constexpr uint32_t kMaskImmediate = 0xff;
+
+            // relative addressing extension word
+            static constexpr uint32_t kShiftDstRelMode = 24;
+            static constexpr uint32_t kShiftDstRelByte = 16;
+            static constexpr uint32_t kShiftSrcRelMode = 8;
+            static constexpr uint32_t kShiftSrcRelByte = 0;
+
+        public:
+            InstructionEncoding GetEncoding() override { return InstructionEncoding::kFixed32; }
+
+            // Number of extension words needed by an operand
+            static constexpr size_t NumOperandExtWords(AddressMode addrMode, OperandSize opSize) {
+                if (addrMode == AddressMode::Absolute) {
+                    return 2;
+                }
+                if (addrMode != AddressMode::Immediate) {
+                    return 0;
+                }
+                switch(opSize) {
+                    case OperandSize::Byte :
+                        return 0;
+                    case OperandSize::Word :
+                    case OperandSize::DWord :
+                        return 1;
+                    case OperandSize::Long :
+                    default:
+                        return 2;
+                }
+            }
+        };
+    }
+}
+
+#endif //VCPU_INSTRUCTIONSETV1FIXEDDEF_H
@@ -4,6 +4,11 @@
 // This implements the instruction execution for instruction-set v1
 //
 
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <type_traits>
+
 #include "InstructionSetV1Impl.h"
 #include "InstructionSetV1Def.h"
 #include "InstructionSetV1Decoder.h"
@@ -12,6 +17,15 @@
 using namespace gnilk;
 using namespace gnilk::vcpu;
 
+// ALU operations, see ExecuteAluInstr
+struct AluAdd;
+struct AluSub;
+struct AluMul;
+struct AluDiv;
+struct AluAnd;
+struct AluOr;
+struct AluXor;
+
 //
 bool InstructionSetV1Impl::ExecuteInstruction(CPUBase &cpu) {
 
@@ -51,7 +65,25 @@ bool InstructionSetV1Impl::ExecuteInstruction(CPUBase &cpu) {
             ExecuteMoveInstr(cpu, decoderOutput);
             break;
         case ADD :
-            ExecuteAddInstr(cpu, decoderOutput);
+            ExecuteAluInstr<AluAdd>(cpu, decoderOutput);
+            break;
+        case SUB :
+            ExecuteAluInstr<AluSub>(cpu, decoderOutput);
+            break;
+        case MUL :
+            ExecuteAluInstr<AluMul>(cpu, decoderOutput);
+            break;
+        case DIV :
+            ExecuteAluInstr<AluDiv>(cpu, decoderOutput);
+            break;
+        case AND :
+            ExecuteAluInstr<AluAnd>(cpu, decoderOutput);
+            break;
+        case OR :
+            ExecuteAluInstr<AluOr>(cpu, decoderOutput);
+            break;
+        case XOR :
+            ExecuteAluInstr<AluXor>(cpu, decoderOutput);
             break;
         case PUSH :
             ExecutePushInstr(cpu, decoderOutput);
@@ -75,10 +107,61 @@ bool InstructionSetV1Impl::ExecuteInstruction(CPUBase &cpu) {
             ExecuteCmpInstr(cpu, decoderOutput);
             break;
         case BEQ :
-            ExecuteBeqInstr(cpu, decoderOutput);
+            ExecuteBranchInstr(cpu, decoderOutput, cpu.registers.statusReg.flags.zero);
             break;
         case BNE :
-            ExecuteBneInstr(cpu, decoderOutput);
+            ExecuteBranchInstr(cpu, decoderOutput, !cpu.registers.statusReg.flags.zero);
+            break;
+        case BCC :
+            ExecuteBranchInstr(cpu, decoderOutput, !cpu.registers.statusReg.flags.carry);
+            break;
+        case BCS :
+            ExecuteBranchInstr(cpu, decoderOutput, cpu.registers.statusReg.flags.carry);
+            break;
+        case JMP :
+            ExecuteJmpInstr(cpu, decoderOutput);
+            break;
+        case CLC :
+            cpu.registers.statusReg.flags.carry = false;
+            break;
+        case SEC :
+            cpu.registers.statusReg.flags.carry = true;
+            break;
+        case BREQ :
+        case BRNE :
+        case BRLT :
+        case BRGE :
+            ExecuteCompareBranchInstr(cpu, decoderOutput);
+            break;
+        case LDL :
+            ExecuteLdlInstr(cpu, decoderOutput);
+            break;
+        case STC :
+            ExecuteStcInstr(cpu, decoderOutput);
+            break;
+        case CAS :
+            ExecuteCasInstr(cpu, decoderOutput);
+            break;
+        case MOVS :
+            ExecuteMovsInstr(cpu, decoderOutput);
+            break;
+        case FILL :
+            ExecuteFillInstr(cpu, decoderOutput);
+            break;
+        case FENCE :
+            // Nothing to do here - the ordering is handled by the pipeline, see InstructionPipeline
+            break;
+        case CFLUSH :
+            ExecuteCacheLineInstr(cpu, decoderOutput, MMU::CacheLineOp::Flush);
+            break;
+        case CINVAL :
+            ExecuteCacheLineInstr(cpu, decoderOutput, MMU::CacheLineOp::Invalidate);
+            break;
+        case CCLEAN :
+            ExecuteCacheLineInstr(cpu, decoderOutput, MMU::CacheLineOp::Clean);
+            break;
+        case PREFETCH :
+            ExecutePrefetchInstr(cpu, decoderOutput);
             break;
         default:
             fmt::println(stderr, "Invalid operand: {} - raising exception handler (if available)", decoderOutput.operand.opCodeByte);
@@ -143,66 +226,49 @@ static void UpdateCPUFlagsCMP(CPUStatusReg &statusReg, uint64_t numRes, uint64_t
     statusReg.flags.overflow = (ovflow >> (std::numeric_limits<T>::digits-1)) & 1;
 }
 
-void InstructionSetV1Impl::ExecuteBneInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
-    if (decoderOutput.opArgDst.addrMode != AddressMode::Immediate) {
-        cpu.RaiseException(CPUKnownExceptions::kInvalidAddrMode);
-        return;
-    }
-    // zero must not be set in order to jump
-    if (cpu.registers.statusReg.flags.zero == 1) {
-        return;
+// Target of a branch/jump - byte/word/dword are signed and relative to the instruction pointer, long is absolute
+template<typename T>
+static uint64_t BranchTarget(uint64_t instrPtr, const RegisterValue &v) {
+    if constexpr (std::is_same_v<T, uint64_t>) {
+        return v.data.longword;
+    } else {
+        return instrPtr + static_cast<int64_t>(static_cast<std::make_signed_t<T>>(v.data.longword));
     }
+}
 
-    // FIXME: This is same as for BEQ - we could keep these..
-
-    auto &v = decoderOutput.primaryValue;
-    int64_t relativeOffset = 0;
-
-    switch(decoderOutput.operand.opSize) {
-        case OperandSize::Byte :
-            relativeOffset = (int8_t)(v.data.byte);
-            break;
-        case OperandSize::Word :
-            relativeOffset = (int16_t)(v.data.word);
-            break;
-        case OperandSize::DWord :
-            relativeOffset = (int32_t)(v.data.dword);
-            break;
-        case OperandSize::Long :    // in case of long - this is an absolute address...
-            cpu.registers.instrPointer.data.longword = v.data.longword;
-            return;
-    }
-    cpu.registers.instrPointer.data.longword += relativeOffset;
+using BranchTargetFunc = uint64_t (*)(uint64_t instrPtr, const RegisterValue &v);
+static constexpr std::array<BranchTargetFunc, 4> branchTargets = {
+    &BranchTarget<uint8_t>,
+    &BranchTarget<uint16_t>,
+    &BranchTarget<uint32_t>,
+    &BranchTarget<uint64_t>,
+};
 
-}
-void InstructionSetV1Impl::ExecuteBeqInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
-    auto &v = decoderOutput.primaryValue;
+// beq/bne/bcc/bcs - 'isTaken' is the condition from the status register
+void InstructionSetV1Impl::ExecuteBranchInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput, bool isTaken) {
     if (decoderOutput.opArgDst.addrMode != AddressMode::Immediate) {
         cpu.RaiseException(CPUKnownExceptions::kInvalidAddrMode);
         return;
     }
-    // zero must be in order to jump
-    if (cpu.registers.statusReg.flags.zero == 0) {
+    if (!isTaken) {
         return;
     }
+    auto &ip = cpu.registers.instrPointer.data.longword;
+    ip = branchTargets[static_cast<size_t>(decoderOutput.operand.opSize)](ip, decoderOutput.primaryValue);
+}
 
-    int64_t relativeOffset = 0;
+void InstructionSetV1Impl::ExecuteJmpInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
+    auto &ip = cpu.registers.instrPointer.data.longword;
+    ip = branchTargets[static_cast<size_t>(decoderOutput.operand.opSize)](ip, decoderOutput.primaryValue);
+}
 
-    switch(decoderOutput.operand.opSize) {
-        case OperandSize::Byte :
-            relativeOffset = (int8_t)(v.data.byte);
-            break;
-        case OperandSize::Word :
-            relativeOffset = (int16_t)(v.data.word);
-            break;
-        case OperandSize::DWord :
-            relativeOffset = (int32_t)(v.data.dword);
-            break;
-        case OperandSize::Long :    // in case of long - this is an absolute address...
-            cpu.registers.instrPointer.data.longword = v.data.longword;
-            return;
+// The register values are read by the decoder and the target is resolved - no status flags involved
+void InstructionSetV1Impl::ExecuteCompareBranchInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
+    auto &op = decoderOutput.operand;
+    if (!InstructionSetV1Def::IsCompareBranchTaken(op.opCode, op.opSize, decoderOutput.primaryValue, decoderOutput.secondaryValue)) {
+        return;
     }
-    cpu.registers.instrPointer.data.longword += relativeOffset;
+    cpu.registers.instrPointer.data.longword = decoderOutput.opArgDst.absoluteAddr;
 }
 
 void InstructionSetV1Impl::ExecuteCmpInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
@@ -467,9 +533,7 @@ void InstructionSetV1Impl::ExecuteLsrInstr(CPUBase &cpu, InstructionSetV1Def::De
 //
 void InstructionSetV1Impl::ExecuteSysCallInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
     auto id = cpu.registers.dataRegisters[0].data.word;
-    if (cpu.syscalls.contains(id)) {
-        cpu.syscalls.at(id)->Invoke(cpu.registers, &cpu);
-    }
+    cpu.InvokeSysCall(id);
 }
 
 void InstructionSetV1Impl::ExecutePushInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
@@ -559,59 +623,125 @@ static void SubtractValues(CPUStatusReg &statusReg, RegisterValue &dst, const Re
 }
 
 
-void InstructionSetV1Impl::ExecuteAddInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
-    auto &v = decoderOutput.primaryValue;
-
-
-    //RegisterValue tmpReg = instrDecoder.ReadDstValue(cpu);
-    RegisterValue tmpReg = decoderOutput.secondaryValue;        // Check if we really want a copy here or a reference
-    switch(decoderOutput.operand.opSize) {
-        case OperandSize::Byte :
-            AddValues<uint8_t>(cpu.registers.statusReg, tmpReg, v);
-            break;
-        case OperandSize::Word :
-            AddValues<uint16_t>(cpu.registers.statusReg, tmpReg, v);
-            break;
-        case OperandSize::DWord :
-            AddValues<uint32_t>(cpu.registers.statusReg, tmpReg, v);
-            break;
-        case OperandSize::Long :
-            AddValues<uint64_t>(cpu.registers.statusReg, tmpReg, v);
-            break;
-    }
-    WriteToDst(cpu, decoderOutput, tmpReg);
+//
+// Integer ALU - each operation has an Apply which is instantiated per op.size, the handler picks the instance
+// through a table indexed by the op.size (see AluOp) - no switching on the op.size while executing.
+// Apply returns false if the result should not be written (an exception was raised).
+// Operands are unsigned, bits above the op.size are preserved in the destination.
+//
+template<typename T>
+static void StoreResult(RegisterValue &dst, uint64_t numRes) {
+    uint64_t mask = (std::numeric_limits<uint64_t>::max()) ^ (std::numeric_limits<T>::max());
+    dst.data.longword = (dst.data.longword & mask) | (numRes & (std::numeric_limits<T>::max()));
 }
 
-void InstructionSetV1Impl::ExecuteSubInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
-    auto &v = decoderOutput.primaryValue;
-
-
-    //RegisterValue tmpReg = instrDecoder.ReadDstValue(cpu);
+// n/z from the result, carry/overflow cleared
+template<typename T>
+static void UpdateCPUFlagsLogic(CPUStatusReg &statusReg, uint64_t numRes) {
+    statusReg.flags.negative = (numRes >> (std::numeric_limits<T>::digits-1)) & 1;
+    statusReg.flags.zero = !(numRes & (std::numeric_limits<T>::max()));
+    statusReg.flags.carry = false;
+    statusReg.flags.overflow = false;
+}
+
+struct AluAdd {
+    template<typename T>
+    static bool Apply(CPUBase &cpu, RegisterValue &dst, const RegisterValue &src) {
+        AddValues<T>(cpu.registers.statusReg, dst, src);
+        return true;
+    }
+};
+
+struct AluSub {
+    template<typename T>
+    static bool Apply(CPUBase &cpu, RegisterValue &dst, const RegisterValue &src) {
+        SubtractValues<T>(cpu.registers.statusReg, dst, src);
+        return true;
+    }
+};
+
+// carry and overflow are set if the product doesn't fit the op.size
+struct AluMul {
+    template<typename T>
+    static bool Apply(CPUBase &cpu, RegisterValue &dst, const RegisterValue &src) {
+        T numRes;
+        bool isOverflow = __builtin_mul_overflow(static_cast<T>(dst.data.longword), static_cast<T>(src.data.longword), &numRes);
+        UpdateCPUFlagsLogic<T>(cpu.registers.statusReg, numRes);
+        cpu.registers.statusReg.flags.carry = isOverflow;
+        cpu.registers.statusReg.flags.overflow = isOverflow;
+        StoreResult<T>(dst, numRes);
+        return true;
+    }
+};
+
+struct AluDiv {
+    template<typename T>
+    static bool Apply(CPUBase &cpu, RegisterValue &dst, const RegisterValue &src) {
+        auto numSrc = static_cast<T>(src.data.longword);
+        if (numSrc == 0) {
+            cpu.RaiseException(CPUKnownExceptions::kDivisionByZero);
+            return false;
+        }
+        T numRes = static_cast<T>(dst.data.longword) / numSrc;
+        UpdateCPUFlagsLogic<T>(cpu.registers.statusReg, numRes);
+        StoreResult<T>(dst, numRes);
+        return true;
+    }
+};
+
+struct AluAnd {
+    template<typename T>
+    static bool Apply(CPUBase &cpu, RegisterValue &dst, const RegisterValue &src) {
+        auto numRes = dst.data.longword & src.data.longword;
+        UpdateCPUFlagsLogic<T>(cpu.registers.statusReg, numRes);
+        StoreResult<T>(dst, numRes);
+        return true;
+    }
+};
+
+struct AluOr {
+    template<typename T>
+    static bool Apply(CPUBase &cpu, RegisterValue &dst, const RegisterValue &src) {
+        auto numRes = dst.data.longword | src.data.longword;
+        UpdateCPUFlagsLogic<T>(cpu.registers.statusReg, numRes);
+        StoreResult<T>(dst, numRes);
+        return true;
+    }
+};
+
+struct AluXor {
+    template<typename T>
+    static bool Apply(CPUBase &cpu, RegisterValue &dst, const RegisterValue &src) {
+        auto numRes = dst.data.longword ^ src.data.longword;
+        UpdateCPUFlagsLogic<T>(cpu.registers.statusReg, numRes);
+        StoreResult<T>(dst, numRes);
+        return true;
+    }
+};
+
+// Instances of an operation, indexed by OperandSize (Byte, Word, DWord, Long)
+template<typename TOp>
+struct AluOp {
+    using ApplyFunc = bool (*)(CPUBase &cpu, RegisterValue &dst, const RegisterValue &src);
+    static constexpr std::array<ApplyFunc, 4> apply = {
+        &TOp::template Apply<uint8_t>,
+        &TOp::template Apply<uint16_t>,
+        &TOp::template Apply<uint32_t>,
+        &TOp::template Apply<uint64_t>,
+    };
+};
+
+template<typename TOp>
+void InstructionSetV1Impl::ExecuteAluInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
+    // dst is read by the decoder (TwoOpReadSecondary)
     RegisterValue tmpReg = decoderOutput.secondaryValue;
-    switch(decoderOutput.operand.opSize) {
-        case OperandSize::Byte :
-            SubtractValues<uint8_t>(cpu.registers.statusReg, tmpReg, v);
-            break;
-        case OperandSize::Word :
-            SubtractValues<uint16_t>(cpu.registers.statusReg, tmpReg, v);
-            break;
-        case OperandSize::DWord :
-            SubtractValues<uint32_t>(cpu.registers.statusReg, tmpReg, v);
-            break;
-        case OperandSize::Long :
-            SubtractValues<uint64_t>(cpu.registers.statusReg, tmpReg, v);
-            break;
+    auto apply = AluOp<TOp>::apply[static_cast<size_t>(decoderOutput.operand.opSize)];
+    if (!apply(cpu, tmpReg, decoderOutput.primaryValue)) {
+        return;
     }
     WriteToDst(cpu, decoderOutput, tmpReg);
 }
 
-void InstructionSetV1Impl::ExecuteMulInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
-
-}
-void InstructionSetV1Impl::ExecuteDivInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
-
-}
-
 void InstructionSetV1Impl::ExecuteCallInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
     auto &v = decoderOutput.primaryValue;
 
@@ -664,10 +794,9 @@ void InstructionSetV1Impl::ExecuteRtiInstr(CPUBase &cpu, InstructionSetV1Def::De
         cpu.RaiseException(CPUKnownExceptions::kHardFault);
         return;
     }
-    // Restore registers, this will restore ALL incl. status and interrupt masks
-    // is this what we want?
-    cpu.registers = isrControlBlock->registersBefore;
-    // This will reset the state and a few other things
+    // Restore what the CPU changed on entry (instr.ptr, status and d0) - the ISR must restore anything else it used
+    cpu.RestoreISRContext(*isrControlBlock);
+    // This will reset the state and a few other things, if nested the previous ISR becomes active
     cpu.ResetActiveISR();
 }
 
@@ -677,16 +806,182 @@ void InstructionSetV1Impl::ExecuteRteInstr(CPUBase &cpu, InstructionSetV1Def::De
         cpu.RaiseException(CPUKnownExceptions::kHardFault);
         return;
     }
-    // Restore registers, this will restore ALL incl. status and interrupt masks
-    cpu.registers = cpu.expControlBlock->registersBefore;
-
-    // We are pointing to the instruction causing the illegal instruction - let's point on next..
-    cpu.registers.instrPointer.data.longword += 1;
+    // Restore what the CPU changed on entry (instr.ptr, status and d0) - the handler must restore anything else it used
+    // The resume address was decided when the exception was raised, see ExceptionContext
+    cpu.RestoreExceptionContext(*cpu.expControlBlock);
 
-    // Reset the ISR State
+    // Reset the exception State
     cpu.ResetActiveExp();
 }
 
+//
+// Atomics and cache maintenance - the decoder doesn't touch memory for these, we compute the address and do the access here
+//
+static bool AddressFromOperandArg(CPUBase &cpu, const InstructionSetV1Def::DecodedOperandArg &opArg, uint64_t &outAddress) {
+    if (opArg.addrMode == AddressMode::Absolute) {
+        outAddress = opArg.absoluteAddr;
+        return true;
+    }
+    if (opArg.addrMode == AddressMode::Indirect) {
+        auto &reg = cpu.GetRegisterValue(opArg.regIndex, OperandFamily::Integer);
+        outAddress = reg.data.longword + opArg.relativeAddressOfs;
+        return true;
+    }
+    return false;
+}
+
+// ldl <reg>, <mem>
+void InstructionSetV1Impl::ExecuteLdlInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
+    uint64_t address = 0;
+    if ((decoderOutput.opArgDst.addrMode != AddressMode::Register) || !AddressFromOperandArg(cpu, decoderOutput.opArgSrc, address)) {
+        cpu.RaiseException(CPUKnownExceptions::kInvalidAddrMode);
+        return;
+    }
+    RegisterValue v = {};
+    if (cpu.LoadLinkedFromMemoryUnit(decoderOutput.operand.opSize, address, v) < 0) {
+        cpu.RaiseFault(CPUKnownExceptions::kMMUFault, address, CPUFaultAccess::Read);
+        return;
+    }
+    WriteToDst(cpu, decoderOutput, v);
+}
+
+// stc <mem>, <reg>
+void InstructionSetV1Impl::ExecuteStcInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
+    uint64_t address = 0;
+    if ((decoderOutput.opArgSrc.addrMode != AddressMode::Register) || !AddressFromOperandArg(cpu, decoderOutput.opArgDst, address)) {
+        cpu.RaiseException(CPUKnownExceptions::kInvalidAddrMode);
+        return;
+    }
+    auto res = cpu.StoreConditionalToMemoryUnit(decoderOutput.operand.opSize, address, decoderOutput.primaryValue);
+    if (res < 0) {
+        cpu.RaiseFault(CPUKnownExceptions::kMMUFault, address, CPUFaultAccess::Write);
+        return;
+    }
+    cpu.registers.statusReg.flags.zero = (res > 0);
+}
+
+// cas <mem>, <reg>, compares with d0 - on failure d0 gets the current value
+void InstructionSetV1Impl::ExecuteCasInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
+    uint64_t address = 0;
+    if ((decoderOutput.opArgSrc.addrMode != AddressMode::Register) || !AddressFromOperandArg(cpu, decoderOutput.opArgDst, address)) {
+        cpu.RaiseException(CPUKnownExceptions::kInvalidAddrMode);
+        return;
+    }
+    auto &regExpected = cpu.GetRegisterValue(0, OperandFamily::Integer);
+    auto res = cpu.CompareAndSwapMemoryUnit(decoderOutput.operand.opSize, address, regExpected, decoderOutput.primaryValue);
+    if (res < 0) {
+        cpu.RaiseFault(CPUKnownExceptions::kMMUFault, address, CPUFaultAccess::Write);
+        return;
+    }
+    cpu.registers.statusReg.flags.zero = (res > 0);
+}
+
+// cflush/cinval/cclean <mem>
+void InstructionSetV1Impl::ExecuteCacheLineInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput, MMU::CacheLineOp op) {
+    uint64_t address = 0;
+    if (!AddressFromOperandArg(cpu, decoderOutput.opArgDst, address)) {
+        cpu.RaiseException(CPUKnownExceptions::kInvalidAddrMode);
+        return;
+    }
+    if (cpu.CacheLineOpMemoryUnit(op, address) < 0) {
+        cpu.RaiseFault(CPUKnownExceptions::kMMUFault, address, CPUFaultAccess::Read);
+    }
+}
+
+// prefetch <mem> - a hint, bad addresses are ignored
+void InstructionSetV1Impl::ExecutePrefetchInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
+    uint64_t address = 0;
+    if (!AddressFromOperandArg(cpu, decoderOutput.opArgDst, address)) {
+        cpu.RaiseException(CPUKnownExceptions::kInvalidAddrMode);
+        return;
+    }
+    cpu.CacheLineOpMemoryUnit(MMU::CacheLineOp::Prefetch, address);
+}
+
+//
+// Block operations - executed in chunks, while d0 (count) is non-zero the instruction re-executes
+//
+static constexpr size_t kBlockOpMaxBytes = 64 * GNK_L1_CACHE_LINE_SIZE;
+
+static void RepeatBlockInstr(CPUBase &cpu, const RegisterValue &regCount) {
+    if (regCount.data.longword != 0) {
+        cpu.registers.instrPointer.data.longword = cpu.instrStartAddress;
+    }
+}
+
+// movs <mem>, <mem>
+void InstructionSetV1Impl::ExecuteMovsInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
+    auto &opArgDst = decoderOutput.opArgDst;
+    auto &opArgSrc = decoderOutput.opArgSrc;
+    if ((opArgDst.addrMode != AddressMode::Indirect) || (opArgSrc.addrMode != AddressMode::Indirect)) {
+        cpu.RaiseException(CPUKnownExceptions::kInvalidAddrMode);
+        return;
+    }
+    auto &regCount = cpu.GetRegisterValue(0, OperandFamily::Integer);
+    if (regCount.data.longword == 0) {
+        return;
+    }
+    auto &regDst = cpu.GetRegisterValue(opArgDst.regIndex, OperandFamily::Integer);
+    auto &regSrc = cpu.GetRegisterValue(opArgSrc.regIndex, OperandFamily::Integer);
+
+    auto szElement = ByteSizeOfOperandSize(decoderOutput.operand.opSize);
+    auto dstAddress = regDst.data.longword + opArgDst.relativeAddressOfs;
+    auto srcAddress = regSrc.data.longword + opArgSrc.relativeAddressOfs;
+    auto nElements = std::min(regCount.data.longword, uint64_t(kBlockOpMaxBytes / szElement));
+    auto nBytes = nElements * szElement;
+    // Destination overlapping the end of the source is copied backwards, chunks are taken from the tail so the
+    // remaining source is never overwritten. The address registers stay at the start, only d0 is decremented.
+    bool bFromTail = (dstAddress > srcAddress) && (((dstAddress - srcAddress) / szElement) < regCount.data.longword);
+    if (bFromTail) {
+        auto tailOfs = (regCount.data.longword - nElements) * szElement;
+        dstAddress += tailOfs;
+        srcAddress += tailOfs;
+    }
+    auto result = cpu.CopyBlockMemoryUnit(dstAddress, srcAddress, nBytes);
+    if (result == MMU::kBlockOp_SrcFault) {
+        cpu.RaiseFault(CPUKnownExceptions::kMMUFault, srcAddress, CPUFaultAccess::Read);
+        return;
+    }
+    if (result < 0) {
+        cpu.RaiseFault(CPUKnownExceptions::kMMUFault, dstAddress, CPUFaultAccess::Write);
+        return;
+    }
+    if (!bFromTail) {
+        regDst.data.longword += nBytes;
+        if (&regSrc != &regDst) {
+            regSrc.data.longword += nBytes;
+        }
+    }
+    regCount.data.longword -= nElements;
+    RepeatBlockInstr(cpu, regCount);
+}
+
+// fill <mem>, <reg/imm>
+void InstructionSetV1Impl::ExecuteFillInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput) {
+    auto &opArgDst = decoderOutput.opArgDst;
+    if (opArgDst.addrMode != AddressMode::Indirect) {
+        cpu.RaiseException(CPUKnownExceptions::kInvalidAddrMode);
+        return;
+    }
+    auto &regCount = cpu.GetRegisterValue(0, OperandFamily::Integer);
+    if (regCount.data.longword == 0) {
+        return;
+    }
+    auto &regDst = cpu.GetRegisterValue(opArgDst.regIndex, OperandFamily::Integer);
+
+    auto szElement = ByteSizeOfOperandSize(decoderOutput.operand.opSize);
+    auto nElements = std::min(regCount.data.longword, uint64_t(kBlockOpMaxBytes / szElement));
+    auto nBytes = nElements * szElement;
+    auto dstAddress = regDst.data.longword + opArgDst.relativeAddressOfs;
+    if (cpu.FillBlockMemoryUnit(decoderOutput.operand.opSize, dstAddress, decoderOutput.primaryValue, nBytes) < 0) {
+        cpu.RaiseFault(CPUKnownExceptions::kMMUFault, dstAddress, CPUFaultAccess::Write);
+        return;
+    }
+    regDst.data.longword += nBytes;
+    regCount.data.longword -= nElements;
+    RepeatBlockInstr(cpu, regCount);
+}
+
 //
 // Could be moved to base class
 //
@@ -28,10 +28,9 @@ namespace gnilk {
 
             // two operand instr.
             void ExecuteMoveInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
-            void ExecuteAddInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
-            void ExecuteSubInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
-            void ExecuteMulInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
-            void ExecuteDivInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
+            // add/sub/mul/div/and/or/xor - TOp is one of the Alu ops in the implementation
+            template<typename TOp>
+            void ExecuteAluInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
             void ExecuteCallInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
             void ExecuteRetInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
             void ExecuteRtiInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
@@ -42,8 +41,16 @@ namespace gnilk {
             void ExecuteAslInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
             void ExecuteAsrInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
             void ExecuteCmpInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
-            void ExecuteBeqInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
-            void ExecuteBneInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
+            void ExecuteBranchInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput, bool isTaken);
+            void ExecuteJmpInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
+            void ExecuteCompareBranchInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
+            void ExecuteLdlInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
+            void ExecuteStcInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
+            void ExecuteCasInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
+            void ExecuteMovsInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
+            void ExecuteFillInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
+            void ExecuteCacheLineInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput, MMU::CacheLineOp op);
+            void ExecutePrefetchInstr(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput);
 
             void WriteToDst(CPUBase &cpu, InstructionSetV1Def::DecoderOutput &decoderOutput, const RegisterValue &v);
 
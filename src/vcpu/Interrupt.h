@@ -6,6 +6,7 @@
 #define INTERRUPT_H
 
 #include<stdint.h>
+#include <stddef.h>
 #include <memory>
 
 namespace gnilk {
@@ -54,6 +55,8 @@ namespace gnilk {
             uint64_t reserved[16];
         };
 #pragma pack(pop)
+        // ISR vectors are indexed by the interrupt id
+        static_assert(offsetof(ISR_VECTOR_TABLE, isr7) - offsetof(ISR_VECTOR_TABLE, isr0) == (MAX_INTERRUPTS - 1) * sizeof(ISR_FUNC));
 
         // This should go into the CPUIntCntrlRegister as a mask...
         struct CPUExceptionControlBits {
@@ -33,6 +33,8 @@ namespace gnilk {
             kMesi_Exclusive = 0x02,
             kMesi_Shared = 0x04,
             kMesi_Invalid = 0x08,
+            kMesi_Owned = 0x10,     // MOESI only, dirty but shared - the owner is responsible for the write back
+            kMesi_Forward = 0x20,   // MESIF only, clean and shared - this is the one responding to a BusRd
         };
         static const std::string &MESIStateToString(kMESIState state) {
             static std::unordered_map<kMESIState, std::string> stateNames = {
@@ -40,9 +42,22 @@ namespace gnilk {
                     {kMesi_Exclusive, "Exclusive"},
                     {kMesi_Shared, "Shared"},
                     {kMesi_Invalid, "Invalid"},
+                    {kMesi_Owned, "Owned"},
+                    {kMesi_Forward, "Forward"},
             };
             return stateNames[state];
         }
+        // Dirty lines must be written back before they are dropped
+        static inline bool IsMESIStateDirty(kMESIState state) {
+            return (state & (kMesi_Modified | kMesi_Owned));
+        }
+
+        // Selected at SoC configuration time, see: SoC::SetCoherenceProtocol
+        enum class kCoherenceProtocol {
+            MESI,
+            MOESI,      // Adds 'Owned' - modified lines are shared without writing back to memory
+            MESIF,      // Adds 'Forward' - one designated clean sharer supplies the data instead of memory
+        };
 
         // BusBase - base class for all bus classes - overload what is important
         // in case of actual manipulation you either must overwrite Write/Read-Line or Write/Read-Data
@@ -62,7 +77,8 @@ namespace gnilk {
                 kProcWr,    // Processor Write Request
                 kBusRd,     // Bus requesting to read memory
                 kBusWr,     // Bus requesting to write memory
-                kBusRdX,    // Bus requesting to write memory to cache
+                kBusRdX,    // Bus requesting exclusive ownership of a line (read with intent to modify)
+                kBusInv,    // Lower level (L2) dropped the line - write back if modified and invalidate
             };
 
             using MessageHandler = std::function<kMESIState(kMemOp op, uint8_t sender, uint64_t addrDescriptor)>;
@@ -76,14 +92,25 @@ namespace gnilk {
                 return kMesi_Invalid;
             }
             virtual void BroadCastWrite(uint8_t idCore, uint64_t addrDescriptor) {}
+            // Read with intent to modify - everyone else drops the line (used by atomics)
+            // Returns kMesi_Modified if the line was handed over dirty, the requester must then keep it dirty
+            virtual kMESIState BroadCastReadExclusive(uint8_t idCore, uint64_t addrDescriptor) {
+                return kMesi_Invalid;
+            }
+            // A line held exclusively was modified without a bus write (atomics), only tells the instruction caches
+            virtual void NotifyWrite(uint8_t idCore, uint64_t addrDescriptor) {}
 
 
             // Reads and Writes data relative to the offset of the virtual start address...
             virtual void ReadData(void *dst, uint64_t addrDescriptor, size_t nBytes) {}
             virtual void WriteData(uint64_t addrDescriptor, const void *src, size_t nBytes) {}
 
-            virtual void WriteLine(uint64_t addrDescriptor, const void *src) {};
-            virtual void ReadLine(void *dst, uint64_t addrDescriptor) {};
+            // The core id is passed along so lower levels (like the L2) can keep track of who is doing what
+            virtual void WriteLine(uint8_t idCore, uint64_t addrDescriptor, const void *src) {};
+            virtual void ReadLine(uint8_t idCore, void *dst, uint64_t addrDescriptor) {};
+
+            // Cache-to-cache transfer, called by a snooping cache when it supplies the line for the ongoing request
+            virtual void SupplyLine(uint64_t addrDescriptor, const void *src) {};
 
         };
     }
@@ -5,7 +5,14 @@
 // Very small and simple MESI SMP cache coherency implementation
 // see: https://en.wikipedia.org/wiki/MESI_protocol
 //
+// Optionally MOESI or MESIF (see SoC::SetCoherenceProtocol)
+// MOESI: A modified line read by someone else goes to 'Owned' and supplies the data, no write back to memory.
+//        The owner writes back when the line is evicted.
+// MESIF: The last core reading a shared line holds it in 'Forward' and supplies the data to the next reader.
+//        Nothing is dirty-shared, this saves memory reads - not writes.
+//
 
+#include <string.h>
 #include "System.h"
 #include "CacheController.h"
 
@@ -19,6 +26,7 @@ using namespace gnilk::vcpu;
 // Note: This should not go to the CTOR as we call the global SoC object - subject to change
 void CacheController::Initialize(uint8_t coreIdentifier) {
     idCore = coreIdentifier;
+    protocol = SoC::Instance().GetCoherenceProtocol();
 
     // FIXME: Not quite sure I want this to automatically map cacheable regions, better to supply them in the initializer
     std::vector<MemoryRegion *> regions;
@@ -39,7 +47,11 @@ kMESIState CacheController::OnDataBusMessage(BusBase::kMemOp op, uint8_t sender,
         case MesiBusBase::kMemOp::kBusRd :
             return OnMsgBusRd(addrDescriptor);
         case MesiBusBase::kMemOp::kBusWr :
-            OnMsgBusWr(addrDescriptor);
+        case MesiBusBase::kMemOp::kBusRdX :
+            // Same thing for us - someone else takes the line
+            return OnMsgBusWr(addrDescriptor);
+        case MesiBusBase::kMemOp::kBusInv :
+            OnMsgBusInv(addrDescriptor);
             return kMesi_Invalid;
         default:
             printf("Unknown data bus operation!");
@@ -53,25 +65,72 @@ kMESIState CacheController::OnMsgBusRd(uint64_t addrDescriptor) {
     if (idxLine < 0) {
         return kMesi_Invalid;
     }
-    if (cache.GetLineState(idxLine) == kMesi_Modified) {
-        auto bus = SoC::Instance().GetDataBusForAddress(addrDescriptor);
-        WriteMemory(bus, idxLine);
+    auto state = cache.GetLineState(idxLine);
+    auto bus = SoC::Instance().GetDataBusForAddress(addrDescriptor);
+    switch(protocol) {
+        case kCoherenceProtocol::MOESI :
+            // Dirty sharing - hand over the data directly, memory is updated when we evict the line
+            if (IsMESIStateDirty(state)) {
+                SupplyLine(bus, idxLine);
+                return cache.SetLineState(idxLine, kMesi_Owned);
+            }
+            break;
+        case kCoherenceProtocol::MESIF :
+            // Whoever holds it alone (or forwards it) supplies the data, the requester becomes the forwarder
+            if (state == kMesi_Modified) {
+                WriteMemory(bus, idxLine);
+            }
+            if (state & (kMesi_Modified | kMesi_Exclusive | kMesi_Forward)) {
+                SupplyLine(bus, idxLine);
+            }
+            break;
+        default :
+            if (state == kMesi_Modified) {
+                WriteMemory(bus, idxLine);
+            }
+            break;
     }
     return cache.SetLineState(idxLine, kMesi_Shared);
 }
 
-void CacheController::OnMsgBusWr(uint64_t addrDescriptor) {
+// Returns kMesi_Modified if the dirty line was handed over to the writer instead of written to memory
+kMESIState CacheController::OnMsgBusWr(uint64_t addrDescriptor) {
     auto idxLine = cache.GetLineIndex(addrDescriptor);
 
     if (idxLine < 0) {
-        return;
+        return kMesi_Invalid;
+    }
+
+    auto result = kMesi_Invalid;
+    if (IsMESIStateDirty(cache.GetLineState(idxLine))) {
+        auto bus = SoC::Instance().GetDataBusForAddress(addrDescriptor);
+        // MOESI/MESIF; the writer takes the dirty line from us - no need to update memory
+        if (protocol == kCoherenceProtocol::MESI) {
+            WriteMemory(bus, idxLine);
+        } else {
+            SupplyLine(bus, idxLine);
+            result = kMesi_Modified;
+        }
     }
+    // Someone else is writing to this line - our copy is stale regardless of state
+    cache.ResetLine(idxLine);
+    DropReservation(addrDescriptor);
+    return result;
+}
+
+// The L2 (inclusive) is evicting this line - we must let go of it as well
+void CacheController::OnMsgBusInv(uint64_t addrDescriptor) {
+    auto idxLine = cache.GetLineIndex(addrDescriptor);
 
-    if (cache.GetLineState(idxLine) == kMesi_Modified) {
+    if (idxLine < 0) {
+        return;
+    }
+    if (IsMESIStateDirty(cache.GetLineState(idxLine))) {
         auto bus = SoC::Instance().GetDataBusForAddress(addrDescriptor);
         WriteMemory(bus, idxLine);
-        cache.ResetLine(idxLine);
     }
+    cache.ResetLine(idxLine);
+    DropReservation(addrDescriptor);
 }
 
 // Touch will ensure is in the cache
@@ -83,12 +142,18 @@ void CacheController::Touch(const uint64_t address) {
 
     auto res = bus->BroadCastRead(idCore, addrDescriptor);
     if (res != kMesi_Invalid) {
-        // Shared
-        state = kMesi_Shared;
+        state = SharedStateFromResponse(res);
     }
     ReadLine(bus, addrDescriptor, state);
 }
 
+void CacheController::Prefetch(const uint64_t address) {
+    if (cache.GetLineIndex(GNK_ADDR_DESC_FROM_ADDR(address)) >= 0) {
+        return;
+    }
+    Touch(address);
+}
+
 // Private - this is called from 'Write<T>' - which is a wrapper so we can copy absolute values to the
 // emulate cache RAM...
 int32_t CacheController::WriteInternalFromExternal(uint64_t address, const void *src, size_t nBytes) {
@@ -129,8 +194,7 @@ void CacheController::ReadInternalToExternal(void *dst, const uint64_t address,
         auto bus = SoC::Instance().GetDataBusForAddress(readAddress);
         auto res = bus->BroadCastRead(idCore, addrDescriptor);
         if (res != kMesi_Invalid) {
-            // Shared
-            state = kMesi_Shared;
+            state = SharedStateFromResponse(res);
         }
         // pass the bus here - avoid lookup twice...
         auto idxLine = ReadLine(bus, addrDescriptor, state);
@@ -144,25 +208,145 @@ void CacheController::ReadInternalToExternal(void *dst, const uint64_t address,
     }
 }
 
+int32_t CacheController::WriteLineMasked(uint64_t addrDescriptor, const uint8_t *src, uint64_t byteMask) {
+    auto bus = SoC::Instance().GetDataBusForAddress(addrDescriptor);
+    bus->BroadCastWrite(idCore, addrDescriptor);
+    // Nothing of the old contents survive, don't read it
+    if (byteMask == ~uint64_t(0)) {
+        AllocateLine(bus, addrDescriptor, src);
+        return GNK_L1_CACHE_LINE_SIZE;
+    }
+    auto idxLine = ReadLine(bus, addrDescriptor, kMESIState::kMesi_Exclusive);
+
+    // copy each run of selected bytes
+    int32_t nWritten = 0;
+    uint16_t offset = 0;
+    while(byteMask != 0) {
+        auto nSkip = __builtin_ctzll(byteMask);
+        offset += nSkip;
+        byteMask >>= nSkip;
+        auto nRun = (byteMask == ~uint64_t(0)) ? 64 : __builtin_ctzll(~byteMask);
+        nWritten += cache.CopyToLineFromExternal(idxLine, offset, src + offset, nRun);
+        offset += nRun;
+        byteMask = (nRun < 64) ? (byteMask >> nRun) : 0;
+    }
+    return nWritten;
+}
+
+//
+// Atomics
+//
+int32_t CacheController::LoadLinked(uint64_t address, void *dst, size_t nBytes) {
+    if ((GNK_LINE_OFS_FROM_ADDR(address) + nBytes) > GNK_L1_CACHE_LINE_SIZE) {
+        return -1;
+    }
+    auto addrDescriptor = GNK_ADDR_DESC_FROM_ADDR(address);
+    auto bus = SoC::Instance().GetDataBusForAddress(address);
+
+    auto idxLine = AcquireLineExclusive(bus, addrDescriptor);
+    cache.CopyFromLineToExternal(dst, idxLine, GNK_LINE_OFS_FROM_ADDR(address), nBytes);
+
+    reservation.isValid = true;
+    reservation.addrDescriptor = addrDescriptor;
+    return (int32_t)nBytes;
+}
+
+int32_t CacheController::StoreConditional(uint64_t address, const void *src, size_t nBytes) {
+    if ((GNK_LINE_OFS_FROM_ADDR(address) + nBytes) > GNK_L1_CACHE_LINE_SIZE) {
+        return -1;
+    }
+    auto addrDescriptor = GNK_ADDR_DESC_FROM_ADDR(address);
+    if (!HaveReservation(address)) {
+        reservation = {};
+        return 0;
+    }
+    reservation = {};
+
+    // Someone might have read the line since we linked it (making it shared), so we need to own it again.
+    // Note: The reservation is cleared on any write from someone else - so the data is still what we loaded
+    auto bus = SoC::Instance().GetDataBusForAddress(address);
+    auto idxLine = AcquireLineExclusive(bus, addrDescriptor);
+    cache.CopyToLineFromExternal(idxLine, GNK_LINE_OFS_FROM_ADDR(address), src, nBytes);
+    bus->NotifyWrite(idCore, addrDescriptor);
+    return 1;
+}
+
+int32_t CacheController::CompareAndSwap(uint64_t address, void *expected, const void *desired, size_t nBytes) {
+    uint8_t current[sizeof(uint64_t)];
+    if ((nBytes > sizeof(current)) || ((GNK_LINE_OFS_FROM_ADDR(address) + nBytes) > GNK_L1_CACHE_LINE_SIZE)) {
+        return -1;
+    }
+    auto addrDescriptor = GNK_ADDR_DESC_FROM_ADDR(address);
+    auto bus = SoC::Instance().GetDataBusForAddress(address);
+    auto idxLine = AcquireLineExclusive(bus, addrDescriptor);
+
+    auto offset = GNK_LINE_OFS_FROM_ADDR(address);
+    cache.CopyFromLineToExternal(current, idxLine, offset, nBytes);
+    if (memcmp(current, expected, nBytes) != 0) {
+        memcpy(expected, current, nBytes);
+        return 0;
+    }
+    cache.CopyToLineFromExternal(idxLine, offset, desired, nBytes);
+    bus->NotifyWrite(idCore, addrDescriptor);
+    return 1;
+}
+
+// Make sure we are the only one having the line, nobody else is bothered if we already have it exclusively
+int32_t CacheController::AcquireLineExclusive(const BusBase::Ref &bus, uint64_t addrDescriptor) {
+    auto idxLine = cache.GetLineIndex(addrDescriptor);
+    if ((idxLine >= 0) && (cache.GetLineState(idxLine) & (kMesi_Modified | kMesi_Exclusive))) {
+        return idxLine;
+    }
+    auto busState = bus->BroadCastReadExclusive(idCore, addrDescriptor);
+    idxLine = ReadLine(bus, addrDescriptor, kMesi_Exclusive);
+
+    // We might have had it before the broadcast, an owned line is still dirty. If the owner handed over a dirty
+    // line we are now the only one having the data, memory is stale - so it must stay dirty even if never written.
+    auto state = cache.GetLineState(idxLine);
+    if ((state == kMesi_Owned) || (busState == kMesi_Modified)) {
+        cache.SetLineState(idxLine, kMesi_Modified);
+    } else if (state != kMesi_Modified) {
+        cache.SetLineState(idxLine, kMesi_Exclusive);
+    }
+    return idxLine;
+}
 
 int32_t CacheController::ReadLine(BusBase::Ref bus, uint64_t addrDescriptor, kMESIState state) {
     auto idxLine = cache.GetLineIndex(addrDescriptor);
-    auto idxNext = cache.NextLineIndex();
     // Miss?
     if (idxLine < 0) {
-        if (cache.GetLineState(idxNext) == kMesi_Modified) {
-            WriteMemory(bus, idxNext);
-        }
-        ReadMemory(bus, idxNext, addrDescriptor, state);
-        idxLine = idxNext;
+        idxLine = EvictLine(bus);
+        ReadMemory(bus, idxLine, addrDescriptor, state);
+    }
+    return idxLine;
+}
+
+// Like ReadLine but the full line is overwritten - the contents come from 'src' instead of memory
+int32_t CacheController::AllocateLine(const BusBase::Ref &bus, uint64_t addrDescriptor, const uint8_t *src) {
+    auto idxLine = cache.GetLineIndex(addrDescriptor);
+    if (idxLine < 0) {
+        idxLine = EvictLine(bus);
     }
+    cache.WriteLineData(idxLine, src, addrDescriptor, kMesi_Modified);
     return idxLine;
 }
 
+// Make room for another line, the victim is written back if dirty
+int32_t CacheController::EvictLine(const BusBase::Ref &bus) {
+    auto idxNext = cache.NextLineIndex();
+    if (IsMESIStateDirty(cache.GetLineState(idxNext))) {
+        WriteMemory(bus, idxNext);
+    }
+    if (cache.GetLineState(idxNext) != kMesi_Invalid) {
+        DropReservation(cache.GetLineAddrDescriptor(idxNext));
+    }
+    return idxNext;
+}
+
 size_t CacheController::Flush() {
     size_t nLinesFlushed = 0;
     for (auto i = 0; i<cache.GetNumLines();i++) {
-        if (cache.GetLineState(i) == kMesi_Modified) {
+        if (IsMESIStateDirty(cache.GetLineState(i))) {
             // All lines in the cache MUST come from a MESI compatible bus...
             auto bus = SoC::Instance().GetDataBusForAddress(cache.lines[i].addrDescriptor);
             WriteMemory(bus, i);
@@ -171,19 +355,85 @@ size_t CacheController::Flush() {
         // Need the reset call here otherwise cached but not modified lines will still be present
         cache.ResetLine(i);
     }
+    reservation = {};
     return nLinesFlushed;
 }
 
+bool CacheController::WriteBack(uint64_t addrDescriptor) {
+    auto idxLine = cache.GetLineIndex(addrDescriptor);
+    if (idxLine < 0) {
+        return false;
+    }
+    auto state = cache.GetLineState(idxLine);
+    if (!IsMESIStateDirty(state)) {
+        return false;
+    }
+    auto bus = SoC::Instance().GetDataBusForAddress(addrDescriptor);
+    WriteMemory(bus, idxLine);
+    // Memory is now in sync - a modified line is still ours exclusively, an owned line is shared
+    cache.SetLineState(idxLine, (state == kMesi_Modified) ? kMesi_Exclusive : kMesi_Shared);
+    return true;
+}
+
+bool CacheController::FlushLine(uint64_t addrDescriptor) {
+    auto idxLine = cache.GetLineIndex(addrDescriptor);
+    if (idxLine < 0) {
+        return false;
+    }
+    if (IsMESIStateDirty(cache.GetLineState(idxLine))) {
+        auto bus = SoC::Instance().GetDataBusForAddress(addrDescriptor);
+        WriteMemory(bus, idxLine);
+    }
+    cache.ResetLine(idxLine);
+    DropReservation(addrDescriptor);
+    return true;
+}
+
+bool CacheController::InvalidateLine(uint64_t addrDescriptor) {
+    auto idxLine = cache.GetLineIndex(addrDescriptor);
+    if (idxLine < 0) {
+        return false;
+    }
+    cache.ResetLine(idxLine);
+    DropReservation(addrDescriptor);
+    return true;
+}
+
+void CacheController::SetCoherenceProtocol(kCoherenceProtocol newProtocol) {
+    if (newProtocol == protocol) {
+        return;
+    }
+    Flush();
+    protocol = newProtocol;
+}
+
+// State for a line we read while someone else has it
+kMESIState CacheController::SharedStateFromResponse(kMESIState response) const {
+    // MESIF - the last reader is the forwarder
+    if (protocol == kCoherenceProtocol::MESIF) {
+        return kMesi_Forward;
+    }
+    return kMesi_Shared;
+}
+
 void CacheController::WriteMemory(const BusBase::Ref &bus, int idxLine) {
     uint8_t tmp[GNK_L1_CACHE_LINE_SIZE];
 
     cache.ReadLineData(tmp, idxLine);
-    bus->WriteLine(cache.GetLineAddrDescriptor(idxLine), tmp);
+    bus->WriteLine(idCore, cache.GetLineAddrDescriptor(idxLine), tmp);
+}
+
+// Cache-to-cache transfer, the requester picks this up instead of reading memory
+void CacheController::SupplyLine(const BusBase::Ref &bus, int idxLine) {
+    uint8_t tmp[GNK_L1_CACHE_LINE_SIZE];
+
+    cache.ReadLineData(tmp, idxLine);
+    bus->SupplyLine(cache.GetLineAddrDescriptor(idxLine), tmp);
 }
 
 void CacheController::ReadMemory(const BusBase::Ref &bus, int idxLine, uint64_t addrDescriptor, kMESIState state) {
     uint8_t tmp[GNK_L1_CACHE_LINE_SIZE];
-    bus->ReadLine(tmp, addrDescriptor);
+    bus->ReadLine(idCore, tmp, addrDescriptor);
     cache.WriteLineData(idxLine, tmp, addrDescriptor, state);
 }
 
@@ -28,6 +28,8 @@ namespace gnilk {
             void Initialize(uint8_t coreIdentifier);
 
             void Touch(const uint64_t address);
+            // Touch, unless the line is already present - nothing is broadcast on a hit
+            void Prefetch(const uint64_t address);
 
             template<typename T>
             int32_t Write(uint64_t address, const T &value) {
@@ -43,7 +45,34 @@ namespace gnilk {
                 return value;
             }
 
+            // Atomics - the line is owned exclusively (BusRdX) while operating on it, the access can't cross a line.
+            // LoadLinked places a reservation on the line, any write from another core (or losing the line) clears it.
+            // Returns: LoadLinked; <0 on error, StoreConditional/CompareAndSwap; 1 on success, 0 on failure, <0 on error
+            // CompareAndSwap will update 'expected' with the current value on failure
+            int32_t LoadLinked(uint64_t address, void *dst, size_t nBytes);
+            int32_t StoreConditional(uint64_t address, const void *src, size_t nBytes);
+            int32_t CompareAndSwap(uint64_t address, void *expected, const void *desired, size_t nBytes);
+            bool HaveReservation(uint64_t address) const {
+                return reservation.isValid && (reservation.addrDescriptor == GNK_ADDR_DESC_FROM_ADDR(address));
+            }
+
+            // Write the bytes selected by 'byteMask' (bit n => byte n of the line) of a full line image in one line
+            // access - used to coalesce scattered writes to the same line. A full mask doesn't read the line first.
+            int32_t WriteLineMasked(uint64_t addrDescriptor, const uint8_t *src, uint64_t byteMask);
+
             size_t Flush();
+            // Write back a single modified/owned line (if present) - the line stays in the cache but is no longer dirty
+            bool WriteBack(uint64_t addrDescriptor);
+            // Write back (if dirty) and drop a single line, returns true if the line was present
+            bool FlushLine(uint64_t addrDescriptor);
+            // Drop a single line WITHOUT writing it back - any modifications are lost, returns true if the line was present
+            bool InvalidateLine(uint64_t addrDescriptor);
+
+            // Switching protocol flushes the cache - states are not compatible between protocols
+            void SetCoherenceProtocol(kCoherenceProtocol newProtocol);
+            kCoherenceProtocol GetCoherenceProtocol() const {
+                return protocol;
+            }
 
             const Cache& GetCache() {
                 return cache;
@@ -54,8 +83,17 @@ namespace gnilk {
 
             kMESIState OnDataBusMessage(BusBase::kMemOp op, uint8_t sender, uint64_t addrDescriptor);
             int32_t ReadLine(BusBase::Ref bus, uint64_t addrDescriptor, kMESIState state);
+            int32_t AllocateLine(const BusBase::Ref &bus, uint64_t addrDescriptor, const uint8_t *src);
+            int32_t EvictLine(const BusBase::Ref &bus);
             kMESIState OnMsgBusRd(uint64_t addrDescriptor);
-            void OnMsgBusWr(uint64_t addrDescriptor);
+            kMESIState OnMsgBusWr(uint64_t addrDescriptor);
+            void OnMsgBusInv(uint64_t addrDescriptor);
+            int32_t AcquireLineExclusive(const BusBase::Ref &bus, uint64_t addrDescriptor);
+            __inline void DropReservation(uint64_t addrDescriptor) {
+                if (reservation.isValid && (reservation.addrDescriptor == addrDescriptor)) {
+                    reservation = {};
+                }
+            }
 
         private:
             int32_t WriteInternalFromExternal(uint64_t address, const void *src, size_t nBytes);
@@ -63,9 +101,17 @@ namespace gnilk {
 
             void WriteMemory(const BusBase::Ref &bus, int idxLine);
             void ReadMemory(const BusBase::Ref &bus, int idxLine, uint64_t addrDescriptor, kMESIState state);
+            void SupplyLine(const BusBase::Ref &bus, int idxLine);
+            kMESIState SharedStateFromResponse(kMESIState response) const;
 
         private:
             uint8_t idCore = 0;
+            kCoherenceProtocol protocol = kCoherenceProtocol::MESI;
+            // Load-linked reservation, one per core
+            struct {
+                bool isValid = false;
+                uint64_t addrDescriptor = 0;
+            } reservation;
             Cache cache;
         };
 
@@ -0,0 +1,81 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#include <bit>
+#include "DirectoryRamBus.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+MesiBusBase::Ref DirectoryRamBus::Create(size_t szRam) {
+    auto instance = std::make_shared<DirectoryRamBus>();
+    instance->SetRamMemory(new RamMemory(szRam));
+    return instance;
+}
+MesiBusBase::Ref DirectoryRamBus::Create(RamMemory *ptrRam) {
+    auto instance = std::make_shared<DirectoryRamBus>();
+    instance->SetRamMemory(ptrRam);
+    return instance;
+}
+
+uint64_t DirectoryRamBus::GetSharers(uint64_t addrDescriptor) const {
+    auto it = directory.find(addrDescriptor);
+    if (it == directory.end()) {
+        return 0;
+    }
+    return it->second;
+}
+
+kMESIState DirectoryRamBus::SendMessage(kMemOp op, uint8_t sender, uint64_t addrDescriptor) {
+    stats.messages++;
+    BeginRequest(op, sender);
+
+    auto senderBit = CoreBit(sender);
+    auto targets = GetSharers(addrDescriptor) & ~senderBit;
+    uint64_t staleSharers = 0;
+
+    kMESIState result = kMESIState::kMesi_Invalid;
+    while(targets) {
+        auto idxCore = std::countr_zero(targets);
+        targets &= (targets - 1);
+
+        auto &snooper = subscribers[idxCore];
+        if (snooper.cbOnMessage == nullptr) {
+            // Core went away - drop it from the directory
+            staleSharers |= CoreBit(idxCore);
+            continue;
+        }
+        stats.snoops++;
+        auto res = snooper.cbOnMessage(op, sender, addrDescriptor);
+        // Same as the broadcast - all sharers see it, first one having the line decides the result
+        if ((res != kMesi_Invalid) && (result == kMesi_Invalid)) {
+            result = res;
+        }
+    }
+
+    // Note: Don't hold on to the entry while calling the snoopers - a write back can cause an L2 eviction which
+    //       comes back here..
+    auto &sharers = directory[addrDescriptor];
+    sharers &= ~staleSharers;
+    switch(op) {
+        case kMemOp::kBusRd :
+            sharers |= senderBit;
+            break;
+        case kMemOp::kBusWr :
+        case kMemOp::kBusRdX :
+            // Everyone else has invalidated the line, the writer is the only one left
+            sharers = senderBit;
+            break;
+        case kMemOp::kBusInv :
+            sharers = 0;
+            break;
+        default:
+            break;
+    }
+    if (sharers == 0) {
+        directory.erase(addrDescriptor);
+    }
+
+    return result;
+}
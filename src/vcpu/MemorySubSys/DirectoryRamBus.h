@@ -0,0 +1,52 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_DIRECTORYRAMBUS_H
+#define VCPU_DIRECTORYRAMBUS_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <memory>
+
+#include "RamBus.h"
+
+namespace gnilk {
+    namespace vcpu {
+
+        static_assert(GNK_CPU_NUM_CORES <= 64, "Directory sharer mask is 64 bits");
+
+        //
+        // RAM bus with directory based coherence.
+        // Instead of broadcasting every BusRd/BusWr to all cores, the bus keeps track of which cores share a line
+        // (bitmask per line) and only messages those.
+        //
+        // Note: Clean lines are dropped silently by the L1, so the sharer mask can contain cores that no longer hold
+        //       the line - this only costs an extra message, never correctness.
+        //
+        class DirectoryRamBus : public RamBus {
+        public:
+            DirectoryRamBus() = default;
+            virtual ~DirectoryRamBus() = default;
+
+            static MesiBusBase::Ref Create(RamMemory *ptrRam);
+            static MesiBusBase::Ref Create(size_t szRam);
+
+            // Returns the bitmask of cores sharing the line
+            uint64_t GetSharers(uint64_t addrDescriptor) const;
+            size_t GetNumDirectoryEntries() const {
+                return directory.size();
+            }
+        protected:
+            kMESIState SendMessage(kMemOp op, uint8_t sender, uint64_t addrDescriptor) override;
+
+            static __inline uint64_t CoreBit(uint8_t idCore) {
+                return (idCore < GNK_CPU_NUM_CORES) ? (uint64_t(1) << idCore) : 0;
+            }
+        protected:
+            std::unordered_map<uint64_t, uint64_t> directory;
+        };
+    }
+}
+
+#endif //VCPU_DIRECTORYRAMBUS_H
@@ -3,26 +3,171 @@
 //
 
 #include <memory>
+#include <algorithm>
 #include "System.h"
 #include "HWMappedBus.h"
 #include "MemoryRegion.h"
+#include "MemoryUnit.h"
 
 using namespace gnilk;
 using namespace gnilk::vcpu;
 
+HWMappedDevice::~HWMappedDevice() {
+    UnmapFromBus();
+}
+
+bool HWMappedDevice::MapToBus(const std::shared_ptr<HWMappedBus> &bus, uint64_t address) {
+    UnmapFromBus();
+    if (!bus->MapDevice(address, GetMappedSize(), this)) {
+        return false;
+    }
+    mappedBus = bus;
+    return true;
+}
+
+void HWMappedDevice::UnmapFromBus() {
+    auto bus = mappedBus.lock();
+    if (bus != nullptr) {
+        bus->UnmapDevice(this);
+    }
+    mappedBus.reset();
+}
+
+///////////
 BusBase::Ref HWMappedBus::Create() {
     auto instance = std::make_shared<HWMappedBus>();
     return instance;
 }
 
+bool HWMappedBus::MapDevice(uint64_t address, size_t nBytes, HWMappedDevice *device) {
+    if ((device == nullptr) || (nBytes == 0)) {
+        return false;
+    }
+    auto pageFirst = address >> VCPU_HWBUS_PAGE_SHIFT;
+    auto pageLast = (address + nBytes - 1) >> VCPU_HWBUS_PAGE_SHIFT;
+    for(auto page = pageFirst; (page <= pageLast) && (page < pageTable.size()); page++) {
+        if (pageTable[page] != 0) {
+            return false;
+        }
+    }
+    devices.push_back({.address = address, .nBytes = nBytes, .device = device});
+    RebuildPageTable();
+    return true;
+}
+
+void HWMappedBus::UnmapDevice(HWMappedDevice *device) {
+    std::erase_if(devices, [device](const DeviceRange &range) {
+        return range.device == device;
+    });
+    RebuildPageTable();
+}
+
+void HWMappedBus::RebuildPageTable() {
+    pageTable.clear();
+    for(size_t i=0;i<devices.size();i++) {
+        auto &range = devices[i];
+        auto pageFirst = range.address >> VCPU_HWBUS_PAGE_SHIFT;
+        auto pageLast = (range.address + range.nBytes - 1) >> VCPU_HWBUS_PAGE_SHIFT;
+        if (pageLast >= pageTable.size()) {
+            pageTable.resize(pageLast + 1, 0);
+        }
+        for(auto page = pageFirst; page <= pageLast; page++) {
+            pageTable[page] = static_cast<uint16_t>(i + 1);
+        }
+    }
+}
+
+HWMappedDevice *HWMappedBus::GetDeviceForAddress(uint64_t address) const {
+    auto range = FindDevice(address & VCPU_MEM_ADDR_MASK, 1);
+    return (range != nullptr) ? range->device : nullptr;
+}
+
+// O(1) - one table lookup and a range check
+const HWMappedBus::DeviceRange *HWMappedBus::FindDevice(uint64_t address, size_t nBytes) const {
+    auto page = address >> VCPU_HWBUS_PAGE_SHIFT;
+    if ((page >= pageTable.size()) || (pageTable[page] == 0)) {
+        return nullptr;
+    }
+    auto &range = devices[pageTable[page] - 1];
+    if ((address < range.address) || ((address + nBytes) > (range.address + range.nBytes))) {
+        return nullptr;
+    }
+    return &range;
+}
+
 void HWMappedBus::ReadData(void *dst, uint64_t addrDescriptor, size_t nBytes) {
+    auto address = addrDescriptor & VCPU_MEM_ADDR_MASK;
+    auto range = FindDevice(address, nBytes);
+    if (range != nullptr) {
+        ReadDevice(range->device, dst, address - range->address, nBytes);
+        return;
+    }
     if (onRead != nullptr) {
-        onRead(dst, addrDescriptor & VCPU_MEM_ADDR_MASK, nBytes);
+        onRead(dst, address, nBytes);
     }
 }
 void HWMappedBus::WriteData(uint64_t addrDescriptor, const void *src, size_t nBytes) {
+    auto address = addrDescriptor & VCPU_MEM_ADDR_MASK;
+    auto range = FindDevice(address, nBytes);
+    if (range != nullptr) {
+        WriteDevice(range->device, address - range->address, src, nBytes);
+        return;
+    }
     if (onWrite != nullptr) {
-        onWrite(addrDescriptor & VCPU_MEM_ADDR_MASK, src, nBytes);
+        onWrite(address, src, nBytes);
     }
+}
 
-}
\ No newline at end of file
+//
+// Accesses within a 64 bit register go straight to the handler of that size, anything else (odd sizes, crossing
+// a register) is split in bytes.
+//
+void HWMappedBus::ReadDevice(HWMappedDevice *device, void *dst, uint64_t offset, size_t nBytes) {
+    auto *ptrDst = static_cast<uint8_t *>(dst);
+    if (((offset & 7) + nBytes) <= sizeof(uint64_t)) {
+        switch(nBytes) {
+            case 1 :
+                ptrDst[0] = device->Read8(offset);
+                return;
+            case 2 :
+                MMU::ToByteStream<uint16_t>(ptrDst, device->Read16(offset));
+                return;
+            case 4 :
+                MMU::ToByteStream<uint32_t>(ptrDst, device->Read32(offset));
+                return;
+            case 8 :
+                MMU::ToByteStream<uint64_t>(ptrDst, device->Read64(offset));
+                return;
+            default:
+                break;
+        }
+    }
+    for(size_t i=0;i<nBytes;i++) {
+        ptrDst[i] = device->Read8(offset + i);
+    }
+}
+
+void HWMappedBus::WriteDevice(HWMappedDevice *device, uint64_t offset, const void *src, size_t nBytes) {
+    auto *ptrSrc = static_cast<const uint8_t *>(src);
+    if (((offset & 7) + nBytes) <= sizeof(uint64_t)) {
+        switch(nBytes) {
+            case 1 :
+                device->Write8(offset, ptrSrc[0]);
+                return;
+            case 2 :
+                device->Write16(offset, MMU::FromByteStream<uint16_t>(ptrSrc));
+                return;
+            case 4 :
+                device->Write32(offset, MMU::FromByteStream<uint32_t>(ptrSrc));
+                return;
+            case 8 :
+                device->Write64(offset, MMU::FromByteStream<uint64_t>(ptrSrc));
+                return;
+            default:
+                break;
+        }
+    }
+    for(size_t i=0;i<nBytes;i++) {
+        device->Write8(offset + i, ptrSrc[i]);
+    }
+}
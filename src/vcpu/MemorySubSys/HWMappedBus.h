@@ -5,17 +5,86 @@
 #ifndef VCPU_HWMAPPEDBUS_H
 #define VCPU_HWMAPPEDBUS_H
 
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
 #include "BusBase.h"
 
 namespace gnilk {
     namespace vcpu {
+        class HWMappedBus;
+
+        // Devices are routed per page, a page belongs to at most one device
+        #ifndef VCPU_HWBUS_PAGE_SHIFT
+        #define VCPU_HWBUS_PAGE_SHIFT 8
+        #endif
+        static const uint64_t VCPU_HWBUS_PAGE_SIZE = uint64_t(1) << VCPU_HWBUS_PAGE_SHIFT;
+
+        //
+        // A device mapped to a range of the HW mapped bus. The bus does the byte order conversion, registers are in
+        // guest byte order (MSB first, like the MMU) - the device only deals with native values.
+        // The offset is relative to the start of the device range.
+        // Narrow accesses default to the 64 bit register containing them (read-modify-write for writes), override
+        // them if a register has side effects on read. Narrow writes merge with 'ReadRaw64', override it as well if
+        // reading a register has side effects (like clearing a status flag).
+        //
+        class HWMappedDevice {
+        public:
+            HWMappedDevice() = default;
+            virtual ~HWMappedDevice();
+
+            virtual uint64_t Read64(uint64_t offset) = 0;
+            virtual void Write64(uint64_t offset, uint64_t value) = 0;
+
+            virtual uint32_t Read32(uint64_t offset) { return ReadNarrow<uint32_t>(offset); }
+            virtual uint16_t Read16(uint64_t offset) { return ReadNarrow<uint16_t>(offset); }
+            virtual uint8_t Read8(uint64_t offset) { return ReadNarrow<uint8_t>(offset); }
+            virtual void Write32(uint64_t offset, uint32_t value) { WriteNarrow<uint32_t>(offset, value); }
+            virtual void Write16(uint64_t offset, uint16_t value) { WriteNarrow<uint16_t>(offset, value); }
+            virtual void Write8(uint64_t offset, uint8_t value) { WriteNarrow<uint8_t>(offset, value); }
+
+            // Register value without side effects, used to merge narrow writes - read-only registers can return 0
+            virtual uint64_t ReadRaw64(uint64_t offset) { return Read64(offset); }
+
+            // Size of the register block
+            virtual size_t GetMappedSize() const = 0;
+
+            // Map this device at 'address' (relative to the start of the region), only one bus at a time.
+            // The device is unmapped when destroyed.
+            bool MapToBus(const std::shared_ptr<HWMappedBus> &bus, uint64_t address);
+            void UnmapFromBus();
+        protected:
+            // Bit position of a narrow value within the containing 64 bit register, MSB first
+            template<typename T>
+            static uint64_t NarrowShift(uint64_t offset) {
+                return (sizeof(uint64_t) - sizeof(T) - (offset & 7)) * 8;
+            }
+            template<typename T>
+            T ReadNarrow(uint64_t offset) {
+                return static_cast<T>(Read64(offset & ~uint64_t(7)) >> NarrowShift<T>(offset));
+            }
+            template<typename T>
+            void WriteNarrow(uint64_t offset, T value) {
+                auto shift = NarrowShift<T>(offset);
+                uint64_t mask = uint64_t(static_cast<T>(~T(0))) << shift;
+                auto reg = ReadRaw64(offset & ~uint64_t(7));
+                reg = (reg & ~mask) | (uint64_t(value) << shift);
+                Write64(offset & ~uint64_t(7), reg);
+            }
+        private:
+            std::weak_ptr<HWMappedBus> mappedBus = {};
+        };
+
         //
         // This (by default) assigned to memory regions with 'HWMapping' flag set
         // It is a callback based bus - i.e. the emulator/caller defines what goes where..
-        // As such, you must assign the Read/Write handlers
+        // Devices (see HWMappedDevice) are routed through a page table, anything not hitting a device goes to the
+        // Read/Write handlers (if assigned).
         //
         class HWMappedBus : public BusBase {
         public:
+            using Ref = std::shared_ptr<HWMappedBus>;
             using ReadHandler = std::function<void(void *dst, uint64_t address, size_t nBytes)>;
             using WriteHandler = std::function<void(uint64_t address, const void *src, size_t nBytes)>;
         public:
@@ -29,12 +98,31 @@ namespace gnilk {
                 onWrite = newOnWrite;
             }
 
+            // Returns false if any of the pages are already taken by another device
+            bool MapDevice(uint64_t address, size_t nBytes, HWMappedDevice *device);
+            void UnmapDevice(HWMappedDevice *device);
+            HWMappedDevice *GetDeviceForAddress(uint64_t address) const;
+
             // I need this!
-            void ReadData(void *dst, uint64_t addrDescriptor, size_t nBytes);
-            void WriteData(uint64_t addrDescriptor, const void *src, size_t nBytes);
+            void ReadData(void *dst, uint64_t addrDescriptor, size_t nBytes) override;
+            void WriteData(uint64_t addrDescriptor, const void *src, size_t nBytes) override;
+        protected:
+            struct DeviceRange {
+                uint64_t address;
+                size_t nBytes;
+                HWMappedDevice *device;
+            };
+            const DeviceRange *FindDevice(uint64_t address, size_t nBytes) const;
+            void RebuildPageTable();
+            static void ReadDevice(HWMappedDevice *device, void *dst, uint64_t offset, size_t nBytes);
+            static void WriteDevice(HWMappedDevice *device, uint64_t offset, const void *src, size_t nBytes);
         protected:
             ReadHandler  onRead = nullptr;
             WriteHandler onWrite = nullptr;
+
+            std::vector<DeviceRange> devices;
+            // Index+1 into 'devices' per page, 0 = no device
+            std::vector<uint16_t> pageTable;
         };
 
     }
@@ -0,0 +1,163 @@
+//
+// Created by gnilk on 19.10.26.
+//
+//
+// Read-only instruction cache, filled in fetch-blocks on a miss.
+// Coherency is handled by snooping writes on the data bus - any write touching a cached block invalidates it
+//
+
+#include <string.h>
+#include <stdio.h>
+
+#include "System.h"
+#include "CacheController.h"
+#include "InstructionCache.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+InstructionCache::~InstructionCache() {
+    Unsubscribe();
+}
+
+// Note: Like the CacheController - this depends on the SoC instance for the cacheable regions
+void InstructionCache::Initialize(uint8_t coreIdentifier, CacheController *dataCacheController) {
+    // In case we are re-initialized
+    Unsubscribe();
+
+    idCore = coreIdentifier;
+    dataCache = dataCacheController;
+
+    Invalidate();
+    ResetStatistics();
+
+    std::vector<MemoryRegion *> regions;
+    SoC::Instance().GetCacheableRegions(regions);
+
+    for(auto r : regions) {
+        if (r->bus == nullptr) {
+            continue;
+        }
+        // Only MESI busses broadcast writes - anything else we can't snoop..
+        auto mesiBus = std::dynamic_pointer_cast<MesiBusBase>(r->bus);
+        if (mesiBus == nullptr) {
+            continue;
+        }
+        mesiBus->SubscribeWriteSnoop(idCore, this, [this](BusBase::kMemOp op, uint8_t sender, uint64_t addrDescriptor) {
+            return OnDataBusMessage(op, sender, addrDescriptor);
+        });
+        snoopedBusses.push_back(mesiBus);
+    }
+}
+
+void InstructionCache::Unsubscribe() {
+    for(auto &bus : snoopedBusses) {
+        bus->UnsubscribeWriteSnoop(idCore, this);
+    }
+    snoopedBusses.clear();
+}
+
+kMESIState InstructionCache::OnDataBusMessage(BusBase::kMemOp op, uint8_t sender, uint64_t addrDescriptor) {
+    if (op == BusBase::kMemOp::kBusWr) {
+        // The descriptor is a data cache line - which can hold more than one fetch block
+        Invalidate(addrDescriptor, GNK_L1_CACHE_LINE_SIZE);
+    }
+    // We never hold anything in a MESI state
+    return kMesi_Invalid;
+}
+
+void InstructionCache::Invalidate() {
+    for(auto &line : lines) {
+        line.isValid = false;
+    }
+}
+
+void InstructionCache::Invalidate(uint64_t address, size_t nBytes) {
+    auto addrDesc = GNK_ICACHE_DESC_FROM_ADDR(address);
+    auto addrEnd = address + nBytes;
+    while(addrDesc < addrEnd) {
+        auto &line = lines[LineIndexFromAddress(addrDesc)];
+        if (line.isValid && (line.addrDescriptor == addrDesc)) {
+            line.isValid = false;
+            stats.invalidations++;
+        }
+        addrDesc += GNK_L1_ICACHE_BLOCK_SIZE;
+    }
+}
+
+int InstructionCache::GetNumLines() const {
+    return (int)lines.size();
+}
+
+// Returns the index of the line holding the address or -1 if not cached
+int InstructionCache::GetLineIndex(uint64_t address) const {
+    auto idxLine = LineIndexFromAddress(address);
+    if (!lines[idxLine].isValid) {
+        return -1;
+    }
+    if (lines[idxLine].addrDescriptor != GNK_ICACHE_DESC_FROM_ADDR(address)) {
+        return -1;
+    }
+    return idxLine;
+}
+
+bool InstructionCache::IsLineValid(int idxLine) const {
+    return lines[idxLine].isValid;
+}
+
+void InstructionCache::ReadInternalToExternal(void *dst, uint64_t address, size_t nBytes) {
+    auto *ptrDstData = static_cast<uint8_t *>(dst);
+    // Instructions are not aligned - a read can span two fetch blocks
+    while(nBytes) {
+        auto idxLine = GetLineIndex(address);
+        if (idxLine < 0) {
+            stats.misses++;
+            idxLine = FetchBlock(address);
+        } else {
+            stats.hits++;
+        }
+
+        auto offset = GNK_ICACHE_OFS_FROM_ADDR(address);
+        size_t nRead = GNK_L1_ICACHE_BLOCK_SIZE - offset;
+        if (nRead > nBytes) {
+            nRead = nBytes;
+        }
+        memcpy(ptrDstData, &lines[idxLine].data[offset], nRead);
+
+        nBytes -= nRead;
+        ptrDstData += nRead;
+        address += nRead;
+    }
+}
+
+int InstructionCache::FetchBlock(uint64_t address) {
+    auto addrDesc = GNK_ICACHE_DESC_FROM_ADDR(address);
+    auto dataAddrDesc = GNK_ADDR_DESC_FROM_ADDR(address);
+    auto bus = SoC::Instance().GetDataBusForAddress(address);
+
+    // Make sure we see the latest data, first our own data cache and then any other core
+    // Note: The broadcast will make other cores write back (MESI) or supply (MOESI/MESIF) any modified line
+    if (dataCache != nullptr) {
+        dataCache->WriteBack(dataAddrDesc);
+    }
+    bus->BroadCastRead(idCore, dataAddrDesc);
+
+    auto idxLine = LineIndexFromAddress(address);
+    auto &line = lines[idxLine];
+    // Fetch the full data line - this picks up any line supplied by another cache
+    uint8_t tmp[GNK_L1_CACHE_LINE_SIZE];
+    bus->ReadLine(idCore, tmp, dataAddrDesc);
+    memcpy(line.data, &tmp[addrDesc - dataAddrDesc], GNK_L1_ICACHE_BLOCK_SIZE);
+    line.addrDescriptor = addrDesc;
+    line.isValid = true;
+
+    return idxLine;
+}
+
+void InstructionCache::Dump() const {
+    printf("InstructionCache, id=%d, hits=%d, misses=%d, invalidations=%d\n", idCore,
+           (int)stats.hits, (int)stats.misses, (int)stats.invalidations);
+    for(size_t i=0;i<lines.size();i++) {
+        printf("  %d  valid=%s, desc=0x%x\n", (int)i, lines[i].isValid?"yes":"no", (int)lines[i].addrDescriptor);
+    }
+}
@@ -0,0 +1,108 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_INSTRUCTIONCACHE_H
+#define VCPU_INSTRUCTIONCACHE_H
+
+#include <stdint.h>
+#include <array>
+#include <type_traits>
+#include <vector>
+
+#include "MesiBusBase.h"
+
+namespace gnilk {
+    namespace vcpu {
+
+// The instruction cache has its own geometry - the fetch block is what the decoder pulls in on a miss
+#ifndef GNK_L1_ICACHE_BLOCK_SIZE
+#define GNK_L1_ICACHE_BLOCK_SIZE 32
+#endif
+#ifndef GNK_L1_ICACHE_NUM_LINES
+#define GNK_L1_ICACHE_NUM_LINES 16
+#endif
+
+#define GNK_ICACHE_DESC_FROM_ADDR(__addr__) (uint64_t(__addr__) & ~(GNK_L1_ICACHE_BLOCK_SIZE-1))
+#define GNK_ICACHE_OFS_FROM_ADDR(__addr__) (uint64_t(__addr__) & (GNK_L1_ICACHE_BLOCK_SIZE-1))
+
+        static_assert((GNK_L1_ICACHE_BLOCK_SIZE & (GNK_L1_ICACHE_BLOCK_SIZE-1)) == 0, "ICache block size must be a power of two");
+        static_assert(GNK_L1_ICACHE_BLOCK_SIZE <= GNK_L1_CACHE_LINE_SIZE, "ICache block can't be larger than a data cache line");
+        static_assert((GNK_L1_ICACHE_NUM_LINES & (GNK_L1_ICACHE_NUM_LINES-1)) == 0, "ICache number of lines must be a power of two");
+
+        class MMU;
+        class CacheController;
+
+        //
+        // Read-only instruction cache, one per core (owned by the MMU).
+        // This is NOT a MESI participant - the decoder only reads from it. Instead it snoops writes on the bus
+        // and invalidates any block touched by a write (self-modifying code, other cores writing code, etc..)
+        //
+        // Direct mapped - the decoder hammers this for every byte, a linear search (like the data cache) is too slow
+        //
+        class InstructionCache {
+            friend MMU;
+        public:
+            struct CacheLine {
+                bool isValid = false;
+                uint64_t addrDescriptor = 0;    // this is the ptr & ~(GNK_L1_ICACHE_BLOCK_SIZE-1)
+                uint8_t data[GNK_L1_ICACHE_BLOCK_SIZE];
+            };
+            struct Statistics {
+                uint64_t hits = 0;
+                uint64_t misses = 0;
+                uint64_t invalidations = 0;
+            };
+        public:
+            InstructionCache() = default;
+            virtual ~InstructionCache();
+
+            // The data cache controller is needed to write back any dirty line before we fetch a block
+            void Initialize(uint8_t coreIdentifier, CacheController *dataCacheController);
+
+            template<typename T>
+            T Read(uint64_t address) {
+                static_assert(std::is_integral_v<T> == true);
+                T value;
+                ReadInternalToExternal(&value, address, sizeof(T));
+                return value;
+            }
+
+            // Invalidate the full cache
+            void Invalidate();
+            // Invalidate all blocks overlapping the range
+            void Invalidate(uint64_t address, size_t nBytes);
+
+            int GetNumLines() const;
+            int GetLineIndex(uint64_t address) const;
+            bool IsLineValid(int idxLine) const;
+
+            const Statistics &GetStatistics() const {
+                return stats;
+            }
+            void ResetStatistics() {
+                stats = {};
+            }
+
+            void Dump() const;
+        protected:
+            kMESIState OnDataBusMessage(BusBase::kMemOp op, uint8_t sender, uint64_t addrDescriptor);
+            void ReadInternalToExternal(void *dst, uint64_t address, size_t nBytes);
+            int FetchBlock(uint64_t address);
+
+            __inline int LineIndexFromAddress(uint64_t address) const {
+                return (int)((address / GNK_L1_ICACHE_BLOCK_SIZE) & (GNK_L1_ICACHE_NUM_LINES-1));
+            }
+            void Unsubscribe();
+        private:
+            uint8_t idCore = 0;
+            CacheController *dataCache = nullptr;
+            Statistics stats = {};
+            std::array<CacheLine, GNK_L1_ICACHE_NUM_LINES> lines = {};
+            // The busses we snoop, we must unsubscribe when going away
+            std::vector<MesiBusBase::Ref> snoopedBusses;
+        };
+    }
+}
+
+#endif //VCPU_INSTRUCTIONCACHE_H
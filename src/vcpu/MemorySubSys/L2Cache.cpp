@@ -0,0 +1,226 @@
+//
+// Created by gnilk on 19.10.26.
+//
+//
+// Shared, n-way set associative, write-back L2 cache.
+// The L1 caches talk MESI on the bus, the bus (RamBus) talks to the L2 and the L2 talks to RAM.
+//
+
+#include <string.h>
+#include <stdio.h>
+
+#include "RamBus.h"
+#include "MemoryRegion.h"
+#include "L2Cache.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+L2Cache::L2Cache(const L2CacheConfig &newConfig) : config(newConfig) {
+    if (config.associativity == 0) {
+        config.associativity = 1;
+    }
+    auto numLines = config.sizeBytes / GNK_L1_CACHE_LINE_SIZE;
+    if (numLines < config.associativity) {
+        numLines = config.associativity;
+    }
+    numSets = numLines / config.associativity;
+    // Make sure we have full sets...
+    numLines = numSets * config.associativity;
+
+    lines.resize(numLines);
+    data.resize(numLines * GNK_L1_CACHE_LINE_SIZE);
+}
+
+L2Cache::Ref L2Cache::Create(const L2CacheConfig &config) {
+    return std::make_shared<L2Cache>(config);
+}
+
+void L2Cache::ReadLine(uint8_t idCore, void *dst, uint64_t addrDescriptor, RamMemory &ram) {
+    auto &coreStats = CoreStats(idCore);
+    coreStats.reads++;
+    coreStats.cycles += config.hitLatency;
+
+    auto idxLine = GetLineIndex(addrDescriptor);
+    if (idxLine >= 0) {
+        coreStats.hits++;
+        memcpy(dst, LineData(idxLine), GNK_L1_CACHE_LINE_SIZE);
+        lines[idxLine].time = ++timeCounter;
+
+        // Exclusive - the line moves up to the L1, the L1 will give it back to us when evicted (if modified)
+        if (config.policy == kL2Policy::Exclusive) {
+            if (lines[idxLine].isDirty) {
+                WriteLineToMemory(idxLine, ram);
+                coreStats.cycles += config.memoryLatency;
+            }
+            lines[idxLine].isValid = false;
+        }
+        return;
+    }
+
+    coreStats.misses++;
+    coreStats.cycles += config.memoryLatency;
+
+    // Exclusive - we never fill on read, only on eviction from L1
+    if (config.policy == kL2Policy::Exclusive) {
+        ram.Read(dst, addrDescriptor & VCPU_MEM_ADDR_MASK);
+        return;
+    }
+
+    idxLine = AllocateLine(addrDescriptor, ram);
+    ram.Read(LineData(idxLine), addrDescriptor & VCPU_MEM_ADDR_MASK);
+    memcpy(dst, LineData(idxLine), GNK_L1_CACHE_LINE_SIZE);
+}
+
+void L2Cache::WriteLine(uint8_t idCore, uint64_t addrDescriptor, const void *src, RamMemory &ram) {
+    auto &coreStats = CoreStats(idCore);
+    coreStats.writes++;
+    coreStats.cycles += config.hitLatency;
+
+    auto idxLine = GetLineIndex(addrDescriptor);
+    if (idxLine >= 0) {
+        coreStats.hits++;
+    } else {
+        // We always write the full line - no need to fetch anything from RAM
+        coreStats.misses++;
+        idxLine = AllocateLine(addrDescriptor, ram);
+    }
+    memcpy(LineData(idxLine), src, GNK_L1_CACHE_LINE_SIZE);
+    lines[idxLine].isDirty = true;
+    lines[idxLine].time = ++timeCounter;
+}
+
+void L2Cache::WriteBack(uint64_t address, size_t nBytes, RamMemory &ram) {
+    auto addrDesc = GNK_ADDR_DESC_FROM_ADDR(address);
+    auto addrEnd = address + nBytes;
+    while(addrDesc < addrEnd) {
+        auto idxLine = GetLineIndex(addrDesc);
+        if ((idxLine >= 0) && lines[idxLine].isDirty) {
+            WriteLineToMemory(idxLine, ram);
+        }
+        addrDesc += GNK_L1_CACHE_LINE_SIZE;
+    }
+}
+
+void L2Cache::Invalidate(uint64_t address, size_t nBytes, RamMemory &ram) {
+    auto addrDesc = GNK_ADDR_DESC_FROM_ADDR(address);
+    auto addrEnd = address + nBytes;
+    while(addrDesc < addrEnd) {
+        auto idxLine = GetLineIndex(addrDesc);
+        if (idxLine >= 0) {
+            // Same as an eviction - the L1's write back to us while the line is still here
+            if ((config.policy == kL2Policy::Inclusive) && (cbBackInvalidate != nullptr)) {
+                stats.backInvalidations++;
+                cbBackInvalidate(addrDesc);
+            }
+            if (lines[idxLine].isDirty) {
+                WriteLineToMemory(idxLine, ram);
+            }
+            lines[idxLine] = {};
+        }
+        addrDesc += GNK_L1_CACHE_LINE_SIZE;
+    }
+}
+
+void L2Cache::Invalidate() {
+    for(auto &line : lines) {
+        line = {};
+    }
+}
+
+size_t L2Cache::Flush(RamMemory &ram) {
+    size_t nFlushed = 0;
+    for(size_t i=0;i<lines.size();i++) {
+        if (lines[i].isValid && lines[i].isDirty) {
+            WriteLineToMemory((int)i, ram);
+            nFlushed++;
+        }
+    }
+    return nFlushed;
+}
+
+bool L2Cache::IsLineCached(uint64_t addrDescriptor) const {
+    return (GetLineIndex(addrDescriptor) >= 0);
+}
+
+size_t L2Cache::GetNumValidLines() const {
+    size_t nValid = 0;
+    for(auto &line : lines) {
+        if (line.isValid) {
+            nValid++;
+        }
+    }
+    return nValid;
+}
+
+const L2Cache::CoreStatistics &L2Cache::GetCoreStatistics(uint8_t idCore) const {
+    if (idCore >= GNK_CPU_NUM_CORES) {
+        return coreStats[GNK_CPU_NUM_CORES];
+    }
+    return coreStats[idCore];
+}
+
+void L2Cache::ResetStatistics() {
+    stats = {};
+    coreStats = {};
+}
+
+L2Cache::CoreStatistics &L2Cache::CoreStats(uint8_t idCore) {
+    if (idCore >= GNK_CPU_NUM_CORES) {
+        return coreStats[GNK_CPU_NUM_CORES];
+    }
+    return coreStats[idCore];
+}
+
+int L2Cache::GetLineIndex(uint64_t addrDescriptor) const {
+    auto idxFirst = SetIndexFromAddress(addrDescriptor) * config.associativity;
+    for(size_t i=0;i<config.associativity;i++) {
+        auto &line = lines[idxFirst + i];
+        if (line.isValid && (line.addrDescriptor == addrDescriptor)) {
+            return (int)(idxFirst + i);
+        }
+    }
+    return -1;
+}
+
+// Find a free way in the set or evict the least recently used
+int L2Cache::AllocateLine(uint64_t addrDescriptor, RamMemory &ram) {
+    auto idxFirst = SetIndexFromAddress(addrDescriptor) * config.associativity;
+    auto idxVictim = idxFirst;
+    for(size_t i=0;i<config.associativity;i++) {
+        auto &line = lines[idxFirst + i];
+        if (!line.isValid) {
+            idxVictim = idxFirst + i;
+            break;
+        }
+        if (line.time < lines[idxVictim].time) {
+            idxVictim = idxFirst + i;
+        }
+    }
+
+    auto &victim = lines[idxVictim];
+    if (victim.isValid) {
+        stats.evictions++;
+        // Inclusive; the L1's must drop the line - any modified data is written back to us while the victim is still here
+        if ((config.policy == kL2Policy::Inclusive) && (cbBackInvalidate != nullptr)) {
+            stats.backInvalidations++;
+            cbBackInvalidate(victim.addrDescriptor);
+        }
+        if (victim.isDirty) {
+            WriteLineToMemory((int)idxVictim, ram);
+        }
+    }
+
+    victim.isValid = true;
+    victim.isDirty = false;
+    victim.addrDescriptor = addrDescriptor;
+    victim.time = ++timeCounter;
+
+    return (int)idxVictim;
+}
+
+void L2Cache::WriteLineToMemory(int idxLine, RamMemory &ram) {
+    ram.Write(lines[idxLine].addrDescriptor & VCPU_MEM_ADDR_MASK, LineData(idxLine));
+    lines[idxLine].isDirty = false;
+    stats.writeBacks++;
+}
@@ -0,0 +1,130 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_L2CACHE_H
+#define VCPU_L2CACHE_H
+
+#include <stdint.h>
+#include <memory>
+#include <array>
+#include <vector>
+#include <functional>
+
+#include "BusBase.h"
+
+namespace gnilk {
+    namespace vcpu {
+
+        class RamMemory;
+
+        enum class kL2Policy {
+            Inclusive,      // Every line in any L1 is also in L2, evicting from L2 will back-invalidate the L1's
+            Exclusive,      // L2 is a victim cache; holds lines written back from L1 - a hit moves the line to L1
+        };
+
+        struct L2CacheConfig {
+            size_t sizeBytes = 64 * 1024;
+            size_t associativity = 8;       // number of ways per set
+            kL2Policy policy = kL2Policy::Inclusive;
+            // Latency model, in cycles - there is no clock in the emulation so this is just accounting
+            uint32_t hitLatency = 12;
+            uint32_t memoryLatency = 100;
+        };
+
+        //
+        // Shared L2 cache - sits between the MESI bus and the RAM (see RamBus)
+        // The line size is the same as the L1 (GNK_L1_CACHE_LINE_SIZE)
+        //
+        class L2Cache {
+        public:
+            using Ref = std::shared_ptr<L2Cache>;
+            // Called when a line is evicted in inclusive mode - the upper level must drop the line (write back if modified)
+            using BackInvalidateHandler = std::function<void(uint64_t addrDescriptor)>;
+
+            struct CoreStatistics {
+                uint64_t reads = 0;
+                uint64_t writes = 0;
+                uint64_t hits = 0;
+                uint64_t misses = 0;
+                uint64_t cycles = 0;
+            };
+            struct Statistics {
+                uint64_t evictions = 0;
+                uint64_t writeBacks = 0;        // dirty lines written to RAM
+                uint64_t backInvalidations = 0;
+            };
+        public:
+            explicit L2Cache(const L2CacheConfig &newConfig);
+            virtual ~L2Cache() = default;
+
+            static Ref Create(const L2CacheConfig &config);
+
+            void SetBackInvalidateHandler(BackInvalidateHandler handler) {
+                cbBackInvalidate = std::move(handler);
+            }
+
+            // Line operations, called by the bus on behalf of a core
+            void ReadLine(uint8_t idCore, void *dst, uint64_t addrDescriptor, RamMemory &ram);
+            void WriteLine(uint8_t idCore, uint64_t addrDescriptor, const void *src, RamMemory &ram);
+
+            // Write back any dirty line overlapping the range (used before non-cached access to RAM)
+            void WriteBack(uint64_t address, size_t nBytes, RamMemory &ram);
+            // Drop any line overlapping the range, dirty lines are written back first
+            // Inclusive; the L1's drop the lines as well, anything they modified is written back with it
+            void Invalidate(uint64_t address, size_t nBytes, RamMemory &ram);
+            void Invalidate();
+            // Write back everything dirty
+            size_t Flush(RamMemory &ram);
+
+            bool IsLineCached(uint64_t addrDescriptor) const;
+            size_t GetNumValidLines() const;
+
+            const L2CacheConfig &GetConfig() const {
+                return config;
+            }
+            size_t GetNumSets() const {
+                return numSets;
+            }
+            const CoreStatistics &GetCoreStatistics(uint8_t idCore) const;
+            const Statistics &GetStatistics() const {
+                return stats;
+            }
+            void ResetStatistics();
+        protected:
+            struct CacheLine {
+                bool isValid = false;
+                bool isDirty = false;
+                uint64_t time = 0;
+                uint64_t addrDescriptor = 0;
+            };
+
+            __inline size_t SetIndexFromAddress(uint64_t addrDescriptor) const {
+                return (addrDescriptor / GNK_L1_CACHE_LINE_SIZE) % numSets;
+            }
+            __inline uint8_t *LineData(int idxLine) {
+                return &data[idxLine * GNK_L1_CACHE_LINE_SIZE];
+            }
+
+            int GetLineIndex(uint64_t addrDescriptor) const;
+            int AllocateLine(uint64_t addrDescriptor, RamMemory &ram);
+            void WriteLineToMemory(int idxLine, RamMemory &ram);
+            CoreStatistics &CoreStats(uint8_t idCore);
+        private:
+            L2CacheConfig config;
+            size_t numSets = 1;
+            uint64_t timeCounter = 0;
+
+            std::vector<CacheLine> lines;
+            std::vector<uint8_t> data;
+
+            BackInvalidateHandler cbBackInvalidate = nullptr;
+
+            Statistics stats = {};
+            // One extra - any access not coming from a core ends up here (like back-invalidation write backs)
+            std::array<CoreStatistics, GNK_CPU_NUM_CORES+1> coreStats = {};
+        };
+    }
+}
+
+#endif //VCPU_L2CACHE_H
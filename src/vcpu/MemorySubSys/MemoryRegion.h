@@ -40,11 +40,18 @@ namespace gnilk {
         static const auto kMemRegion_Default_Flash = kRegionFlag_Valid | kRegionFlag_Read | kRegionFlag_Execute |  kRegionFlag_NonVolatile;
         static const auto kMemRegion_Default_HWMapped = kRegionFlag_Valid | kRegionFlag_Read | kRegionFlag_Write | kRegionFlag_HWMapping;
 
+        // How cache coherency messages are distributed on a cacheable region's bus
+        enum class kCoherenceMode : uint8_t {
+            Snooping,       // Broadcast to all cores (MesiBusBase)
+            Directory,      // Only message the cores sharing the line (DirectoryRamBus)
+        };
+
         // Structure used to configure the internals for a memory region...
         struct MemoryRegionConfiguration {
             uint8_t regionFlags;
             uint64_t vAddrStart;
             uint64_t sizeBytes;
+            kCoherenceMode coherence = kCoherenceMode::Snooping;
         };
 
         using MemoryAccessHandler = std::function<void(BusBase::kMemOp op, uint64_t address)>;
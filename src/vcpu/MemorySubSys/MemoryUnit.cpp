@@ -3,6 +3,7 @@
 //
 
 #include <string.h>
+#include <algorithm>
 #include "MemoryUnit.h"
 #include "FlashBus.h"
 #include "System.h"
@@ -21,6 +22,7 @@ static uint8_t empty_cache_line[GNK_L1_CACHE_LINE_SIZE] = {};
 void MMU::Initialize(uint8_t newCoreId) {
     coreId = newCoreId;
     cacheController.Initialize(coreId);
+    instrCache.Initialize(coreId, &cacheController);
 }
 
 
@@ -32,6 +34,10 @@ bool MMU::IsAddressValid(uint64_t address) {
     return true;
 }
 
+bool MMU::IsAddressRangeValid(uint64_t address, size_t nBytes) {
+    return SoC::Instance().HaveRegionForRange(address, nBytes);
+}
+
 
 void MMU::SetMMUControl(const RegisterValue &newControl) {
     mmuControl = newControl;
@@ -60,7 +66,7 @@ void MMU::SetMMUPageTableAddress(const gnilk::vcpu::RegisterValue &newPageTblAdd
 
     // Reset everything to zero...
     while(nBytesToWrite) {
-        databus->WriteLine(physicalAddr, empty_cache_line);
+        databus->WriteLine(coreId, physicalAddr, empty_cache_line);
         nBytesToWrite -= GNK_L1_CACHE_LINE_SIZE;
         if (nBytesToWrite < 0) {
             nBytesToWrite = 0;
@@ -89,6 +95,34 @@ void MMU::Touch(const uint64_t address) {
     cacheController.Touch(address);
 }
 
+int32_t MMU::CacheLineOperation(CacheLineOp op, uint64_t virtualAddress) {
+    // FIXME: Address translation
+    if (SoC::Instance().GetDataBusForAddress(virtualAddress) == nullptr) {
+        return -1;
+    }
+    if (!SoC::Instance().IsAddressCacheable(virtualAddress)) {
+        return 0;
+    }
+    auto addrDescriptor = GNK_ADDR_DESC_FROM_ADDR(virtualAddress);
+    switch(op) {
+        case CacheLineOp::Flush :
+            cacheController.FlushLine(addrDescriptor);
+            instrCache.Invalidate(addrDescriptor, GNK_L1_CACHE_LINE_SIZE);
+            break;
+        case CacheLineOp::Invalidate :
+            cacheController.InvalidateLine(addrDescriptor);
+            instrCache.Invalidate(addrDescriptor, GNK_L1_CACHE_LINE_SIZE);
+            break;
+        case CacheLineOp::Clean :
+            cacheController.WriteBack(addrDescriptor);
+            break;
+        case CacheLineOp::Prefetch :
+            cacheController.Prefetch(virtualAddress);
+            break;
+    }
+    return 0;
+}
+
 int32_t MMU::WriteInternalFromExternal(uint64_t virtualAddress, const void *src, size_t nBytes) {
     // FIXME: Address translation
     if (!SoC::Instance().IsAddressCacheable(virtualAddress)) {
@@ -116,6 +150,155 @@ void MMU::ReadInternalToExternal(void *dst, uint64_t virtualAddress, size_t nByt
     cacheController.ReadInternalToExternal(dst, virtualAddress, nBytes);
 }
 
+bool MMU::ReadLine(uint64_t lineAddress, uint8_t *dst) {
+    // FIXME: Address translation
+    if (!SoC::Instance().IsAddressCacheable(lineAddress)) {
+        return false;
+    }
+    cacheController.ReadInternalToExternal(dst, lineAddress, GNK_L1_CACHE_LINE_SIZE);
+    return true;
+}
+bool MMU::WriteLineMasked(uint64_t lineAddress, const uint8_t *src, uint64_t byteMask) {
+    // FIXME: Address translation
+    if (!SoC::Instance().IsAddressCacheable(lineAddress)) {
+        return false;
+    }
+    cacheController.WriteLineMasked(lineAddress, src, byteMask);
+    return true;
+}
+
+// Every region the range touches must be mapped and have a bus
+static bool HaveMemoryForRange(uint64_t address, size_t nBytes) {
+    auto &soc = SoC::Instance();
+    if (!soc.HaveRegionForRange(address, nBytes)) {
+        return false;
+    }
+    auto last = address + nBytes - 1;
+    while(true) {
+        auto &region = soc.GetMemoryRegionFromAddress(address);
+        if (region.bus == nullptr) {
+            return false;
+        }
+        if (last <= region.vAddrEnd) {
+            return true;
+        }
+        address = region.vAddrEnd + 1;
+    }
+}
+
+// Bytes [ofs, ofs+nBytes) of a line
+static uint64_t LineByteMask(size_t ofs, size_t nBytes) {
+    if (nBytes == GNK_L1_CACHE_LINE_SIZE) {
+        return ~uint64_t(0);
+    }
+    return ((uint64_t(1) << nBytes) - 1) << ofs;
+}
+
+int32_t MMU::CopyBlock(uint64_t dstAddress, uint64_t srcAddress, size_t nBytes) {
+    // FIXME: Address translation
+    if (nBytes == 0) {
+        return kBlockOp_Ok;
+    }
+    if (!HaveMemoryForRange(srcAddress, nBytes)) {
+        return kBlockOp_SrcFault;
+    }
+    if (!HaveMemoryForRange(dstAddress, nBytes)) {
+        return kBlockOp_DstFault;
+    }
+
+    // One destination line at the time, the source chunk is read completely before it is written
+    uint8_t line[GNK_L1_CACHE_LINE_SIZE];
+    auto copyChunk = [this, &line](uint64_t dst, uint64_t src, size_t nChunk) {
+        auto ofs = GNK_LINE_OFS_FROM_ADDR(dst);
+        ReadInternalToExternal(&line[ofs], src, nChunk);
+        if (!WriteLineMasked(GNK_ADDR_DESC_FROM_ADDR(dst), line, LineByteMask(ofs, nChunk))) {
+            WriteInternalFromExternal(dst, &line[ofs], nChunk);
+        }
+    };
+
+    // Destination overlaps the end of the source - going forward would overwrite source bytes before they are read
+    if ((dstAddress > srcAddress) && ((dstAddress - srcAddress) < nBytes)) {
+        auto dstEnd = dstAddress + nBytes;
+        auto srcEnd = srcAddress + nBytes;
+        while(dstEnd > dstAddress) {
+            auto nChunk = std::min(size_t(dstEnd - dstAddress), size_t(GNK_LINE_OFS_FROM_ADDR(dstEnd - 1) + 1));
+            dstEnd -= nChunk;
+            srcEnd -= nChunk;
+            copyChunk(dstEnd, srcEnd, nChunk);
+        }
+    } else {
+        for(size_t ofs = 0; ofs < nBytes;) {
+            auto nChunk = std::min(nBytes - ofs, size_t(GNK_L1_CACHE_LINE_SIZE - GNK_LINE_OFS_FROM_ADDR(dstAddress + ofs)));
+            copyChunk(dstAddress + ofs, srcAddress + ofs, nChunk);
+            ofs += nChunk;
+        }
+    }
+    // The non-cacheable path bypasses the bus snooping, drop anything we have fetched from here
+    instrCache.Invalidate(dstAddress, nBytes);
+    return kBlockOp_Ok;
+}
+
+int32_t MMU::FillBlock(uint64_t dstAddress, const uint8_t *pattern, size_t szPattern, size_t nBytes) {
+    // FIXME: Address translation
+    if (nBytes == 0) {
+        return kBlockOp_Ok;
+    }
+    if (!HaveMemoryForRange(dstAddress, nBytes)) {
+        return kBlockOp_DstFault;
+    }
+    uint8_t line[GNK_L1_CACHE_LINE_SIZE];
+    for(size_t ofsFill = 0; ofsFill < nBytes;) {
+        auto address = dstAddress + ofsFill;
+        auto ofs = GNK_LINE_OFS_FROM_ADDR(address);
+        auto nChunk = std::min(nBytes - ofsFill, size_t(GNK_L1_CACHE_LINE_SIZE - ofs));
+        for(size_t i=0;i<nChunk;i++) {
+            line[ofs + i] = pattern[(ofsFill + i) % szPattern];
+        }
+        if (!WriteLineMasked(GNK_ADDR_DESC_FROM_ADDR(address), line, LineByteMask(ofs, nChunk))) {
+            WriteInternalFromExternal(address, &line[ofs], nChunk);
+        }
+        ofsFill += nChunk;
+    }
+    instrCache.Invalidate(dstAddress, nBytes);
+    return kBlockOp_Ok;
+}
+
+// Atomics need the coherence protocol - only cacheable memory is supported
+int32_t MMU::LoadLinkedInternal(uint64_t virtualAddress, void *dst, size_t nBytes) {
+    // FIXME: Address translation
+    if (!SoC::Instance().IsAddressCacheable(virtualAddress)) {
+        return -1;
+    }
+    return cacheController.LoadLinked(virtualAddress, dst, nBytes);
+}
+int32_t MMU::StoreConditionalInternal(uint64_t virtualAddress, const void *src, size_t nBytes) {
+    // FIXME: Address translation
+    if (!SoC::Instance().IsAddressCacheable(virtualAddress)) {
+        return -1;
+    }
+    return cacheController.StoreConditional(virtualAddress, src, nBytes);
+}
+int32_t MMU::CompareAndSwapInternal(uint64_t virtualAddress, void *expected, const void *desired, size_t nBytes) {
+    // FIXME: Address translation
+    if (!SoC::Instance().IsAddressCacheable(virtualAddress)) {
+        return -1;
+    }
+    return cacheController.CompareAndSwap(virtualAddress, expected, desired, nBytes);
+}
+
+void MMU::FetchInternalToExternal(void *dst, uint64_t virtualAddress, size_t nBytes) {
+    // FIXME: Address translation
+    if (!SoC::Instance().IsAddressCacheable(virtualAddress)) {
+        auto bus = SoC::Instance().GetDataBusForAddress(virtualAddress);
+        if (bus == nullptr) {
+            return;
+        }
+        bus->ReadData(dst, virtualAddress, nBytes);
+        return;
+    }
+    instrCache.ReadInternalToExternal(dst, virtualAddress, nBytes);
+}
+
 
 // Copy to external (native) RAM from the emulated RAM...
 int32_t MMU::CopyToExtFromRam(void *dstPtr, const uint64_t srcVirtualAddress, size_t nBytes) {
@@ -190,6 +373,9 @@ int32_t MMU::CopyToRamFromExt(uint64_t dstVirtualAddr, const void *srcAddress, s
 
     auto ramAddress = TranslateAddress(dstVirtualAddr);
     ram->bus->WriteData(ramAddress, srcAddress, nBytes);
+    // This bypasses the bus snooping - so drop anything we have in the instr. cache for this range
+    // FIXME: Other cores won't see this...
+    instrCache.Invalidate(dstVirtualAddr, nBytes);
 
     return nBytes;
 }
@@ -10,6 +10,7 @@
 #include <unordered_map>
 
 #include "CacheController.h"
+#include "InstructionCache.h"
 #include "RegisterValue.h"
 #include "MemoryRegion.h"
 
@@ -151,6 +152,7 @@ namespace gnilk {
             void Initialize(uint8_t newCoreId);
 
             bool IsAddressValid(uint64_t address);
+            bool IsAddressRangeValid(uint64_t address, size_t nBytes);
 
 
             __inline uint8_t constexpr RegionFromAddress(uint64_t virtualAddress) {
@@ -191,6 +193,96 @@ namespace gnilk {
                 static_assert(std::is_integral_v<T> == true);
 
                 uint8_t data[sizeof(T)];
+                ToByteStream<T>(data, value);
+
+                return WriteInternalFromExternal(virtualAddress, data, sizeof(T));
+            }
+
+            template<typename T>
+            T Read(uint64_t virtualAddress) {
+                static_assert(std::is_integral_v<T> == true);
+                uint8_t data[sizeof(T)];
+                //T value;
+                ReadInternalToExternal(data, virtualAddress, sizeof(T));
+
+                // Not sure if this actually should be here!
+                return FromByteStream<T>(data);
+            }
+
+            // Instruction fetch - goes through the instruction cache instead of the data cache
+            template<typename T>
+            T FetchInstr(uint64_t virtualAddress) {
+                static_assert(std::is_integral_v<T> == true);
+                uint8_t data[sizeof(T)];
+                FetchInternalToExternal(data, virtualAddress, sizeof(T));
+                return FromByteStream<T>(data);
+            }
+
+            // Raw bytes, no byte order conversion - goes through the cache in one request, a block within a cache line
+            // is a single line transaction (see CacheController)
+            void ReadBlock(uint64_t virtualAddress, void *dst, size_t nBytes) {
+                ReadInternalToExternal(dst, virtualAddress, nBytes);
+            }
+            int32_t WriteBlock(uint64_t virtualAddress, const void *src, size_t nBytes) {
+                return WriteInternalFromExternal(virtualAddress, src, nBytes);
+            }
+
+            // A full cache line in one line access ('lineAddress' is line aligned), used to coalesce lane accesses.
+            // Returns false if the memory isn't cacheable, go through Read/Write per element instead.
+            bool ReadLine(uint64_t lineAddress, uint8_t *dst);
+            bool WriteLineMasked(uint64_t lineAddress, const uint8_t *src, uint64_t byteMask);
+
+            // Bulk copy/fill (movs/fill instructions), one transaction per destination line - full lines are written
+            // without reading them first. Overlapping ranges are fine (memmove), dst above src is copied backwards.
+            // The fill pattern is 'szPattern' bytes in guest byte order, it starts at 'dstAddress'.
+            // Returns <0 (which side) if any part of a range has no memory, nothing is written in that case.
+            enum kBlockOpResult : int32_t {
+                kBlockOp_Ok = 0,
+                kBlockOp_SrcFault = -1,
+                kBlockOp_DstFault = -2,
+            };
+            int32_t CopyBlock(uint64_t dstAddress, uint64_t srcAddress, size_t nBytes);
+            int32_t FillBlock(uint64_t dstAddress, const uint8_t *pattern, size_t szPattern, size_t nBytes);
+
+            // Atomics, see CacheController - only for cacheable memory and the access can't cross a cache line
+            // Returns: LoadLinked; <0 on error, StoreConditional/CompareAndSwap; 1 on success, 0 on failure, <0 on error
+            template<typename T>
+            int32_t LoadLinked(uint64_t virtualAddress, T &outValue) {
+                static_assert(std::is_integral_v<T> == true);
+                uint8_t data[sizeof(T)];
+                auto res = LoadLinkedInternal(virtualAddress, data, sizeof(T));
+                if (res < 0) {
+                    return res;
+                }
+                outValue = FromByteStream<T>(data);
+                return res;
+            }
+
+            template<typename T>
+            int32_t StoreConditional(uint64_t virtualAddress, const T &value) {
+                static_assert(std::is_integral_v<T> == true);
+                uint8_t data[sizeof(T)];
+                ToByteStream<T>(data, value);
+                return StoreConditionalInternal(virtualAddress, data, sizeof(T));
+            }
+
+            template<typename T>
+            int32_t CompareAndSwap(uint64_t virtualAddress, T &expected, const T &desired) {
+                static_assert(std::is_integral_v<T> == true);
+                uint8_t dataExpected[sizeof(T)];
+                uint8_t dataDesired[sizeof(T)];
+                ToByteStream<T>(dataExpected, expected);
+                ToByteStream<T>(dataDesired, desired);
+                auto res = CompareAndSwapInternal(virtualAddress, dataExpected, dataDesired, sizeof(T));
+                if (res == 0) {
+                    expected = FromByteStream<T>(dataExpected);
+                }
+                return res;
+            }
+
+            // MSB first, see 'FromByteStream'
+            template<typename T>
+            static void ToByteStream(uint8_t *data, const T &value) {
                 size_t index = 0;
                 auto numToWrite = sizeof(T);
                 auto bitShift = (numToWrite-1)<<3;
@@ -202,19 +294,10 @@ namespace gnilk {
                     index++;
                     numToWrite -= 1;
                 }
-
-                return WriteInternalFromExternal(virtualAddress, data, sizeof(T));
             }
 
             template<typename T>
-            T Read(uint64_t virtualAddress) {
-                static_assert(std::is_integral_v<T> == true);
-                uint8_t data[sizeof(T)];
-                //T value;
-                ReadInternalToExternal(data, virtualAddress, sizeof(T));
-
-                // Not sure if this actually should be here!
-
+            static T FromByteStream(const uint8_t *data) {
                 T result = {};
 
                 size_t index = 0;
@@ -234,13 +317,23 @@ namespace gnilk {
                     // nBits += 8;
                     numToFetch -= 1;
                 }
-
-
                 return result;
             }
 
             void Touch(const uint64_t address);
 
+            // Cache maintenance on the line holding 'virtualAddress' (fence/cflush/cinval/cclean/prefetch instructions)
+            //   Flush - write back if dirty and drop the line, Invalidate - drop without write back, Clean - write back only
+            //   Flush/Invalidate also drop the overlapping instruction cache blocks (self-modifying code)
+            // Non-cacheable memory is a no-op, returns <0 if there is no memory at the address
+            enum class CacheLineOp : uint8_t {
+                Flush,
+                Invalidate,
+                Clean,
+                Prefetch,
+            };
+            int32_t CacheLineOperation(CacheLineOp op, uint64_t virtualAddress);
+
 
             // These two functions will bypass the cache!!!
             // External RAM <-> Emulated RAM functions - this will stall the bus!
@@ -263,9 +356,19 @@ namespace gnilk {
             CacheController &GetCacheController() {
                 return cacheController;
             }
+            const InstructionCache &GetInstructionCache() const {
+                return instrCache;
+            }
+            InstructionCache &GetInstructionCache() {
+                return instrCache;
+            }
         protected:
             int32_t WriteInternalFromExternal(uint64_t address, const void *src, size_t nBytes);
             void ReadInternalToExternal(void *dst, uint64_t address, size_t nBytes);
+            void FetchInternalToExternal(void *dst, uint64_t address, size_t nBytes);
+            int32_t LoadLinkedInternal(uint64_t address, void *dst, size_t nBytes);
+            int32_t StoreConditionalInternal(uint64_t address, const void *src, size_t nBytes);
+            int32_t CompareAndSwapInternal(uint64_t address, void *expected, const void *desired, size_t nBytes);
 
         protected:
             uint8_t coreId = 0;
@@ -273,6 +376,8 @@ namespace gnilk {
             RegisterValue mmuPageTableAddress;
             // This cache controller has ability to cache any kind of memory access...
             CacheController cacheController;
+            // Read-only, fed to the instruction decoder
+            InstructionCache instrCache;
         };
 
 
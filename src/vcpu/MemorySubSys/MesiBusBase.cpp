@@ -2,6 +2,7 @@
 // Created by gnilk on 09.04.24.
 //
 
+#include <string.h>
 #include "MesiBusBase.h"
 
 using namespace gnilk;
@@ -16,17 +17,51 @@ void MesiBusBase::Subscribe(uint8_t idCore, MessageHandler cbOnMessage) {
     nextSubscriber++;
 }
 
+void MesiBusBase::SubscribeWriteSnoop(uint8_t idCore, const void *owner, MessageHandler cbOnMessage) {
+    if (idCore >= GNK_CPU_NUM_CORES) {
+        return;
+    }
+    writeSnoopers[idCore].idCore = idCore;
+    writeSnoopers[idCore].cbOnMessage = std::move(cbOnMessage);
+    writeSnoopers[idCore].owner = owner;
+}
+
+// Only remove if we are still the owner - someone else might have subscribed for the same core after us
+void MesiBusBase::UnsubscribeWriteSnoop(uint8_t idCore, const void *owner) {
+    if (idCore >= GNK_CPU_NUM_CORES) {
+        return;
+    }
+    if (writeSnoopers[idCore].owner != owner) {
+        return;
+    }
+    writeSnoopers[idCore] = {};
+}
+
 kMESIState MesiBusBase::BroadCastRead(uint8_t idCore, uint64_t addrDescriptor) {
     return SendMessage(kMemOp::kBusRd, idCore, addrDescriptor);
 }
 void MesiBusBase::BroadCastWrite(uint8_t idCore, uint64_t addrDescriptor) {
     SendMessage(kMemOp::kBusWr, idCore, addrDescriptor);
+    NotifyWriteSnoopers(idCore, addrDescriptor);
+}
+
+// Note: No write snoopers here - nothing has been modified yet, the actual write will notify them
+kMESIState MesiBusBase::BroadCastReadExclusive(uint8_t idCore, uint64_t addrDescriptor) {
+    return SendMessage(kMemOp::kBusRdX, idCore, addrDescriptor);
+}
+void MesiBusBase::NotifyWrite(uint8_t idCore, uint64_t addrDescriptor) {
+    NotifyWriteSnoopers(idCore, addrDescriptor);
 }
 
 kMESIState MesiBusBase::SendMessage(kMemOp op, uint8_t sender, uint64_t addrDescriptor) {
     // We just want the top bits - the rest is the same regardless, we drag in a full line..
     // Ergo - it makes sense to align array's to CACHE_LINE_SIZE...
+    stats.messages++;
+    BeginRequest(op, sender);
 
+    // Note: Everyone must see the message - with MOESI/MESIF the one supplying the data might not be the first
+    //       one having the line. First one having the line decides the result.
+    kMESIState result = kMESIState::kMesi_Invalid;
     for(auto &snooper : subscribers) {
         if (snooper.idCore == sender) {
             continue;
@@ -34,15 +69,46 @@ kMESIState MesiBusBase::SendMessage(kMemOp op, uint8_t sender, uint64_t addrDesc
         if (snooper.cbOnMessage == nullptr) {
             continue;
         }
+        stats.snoops++;
         auto res = snooper.cbOnMessage(op, sender, addrDescriptor);
-        // FIXME: Need to verify this a bit more
-        if (res != kMesi_Invalid) {
-            return res;
+        if ((res != kMesi_Invalid) && (result == kMesi_Invalid)) {
+            result = res;
         }
     }
-    // No one had this memory block!
-    //subscribers[sender].cbOnMessage()
+    return result;
+}
+
+void MesiBusBase::BeginRequest(kMemOp op, uint8_t idRequester) {
+    // The L2 evicting a line while the requester fills (kSenderNone) must not drop what an owner just supplied
+    if (op == kMemOp::kBusInv) {
+        return;
+    }
+    suppliedLine.isValid = false;
+    suppliedLine.idRequester = idRequester;
+}
+
+void MesiBusBase::SupplyLine(uint64_t addrDescriptor, const void *src) {
+    suppliedLine.isValid = true;
+    suppliedLine.addrDescriptor = addrDescriptor;
+    memcpy(suppliedLine.data, src, GNK_L1_CACHE_LINE_SIZE);
+}
 
+bool MesiBusBase::TakeSuppliedLine(uint8_t idRequester, void *dst, uint64_t addrDescriptor) {
+    if (!suppliedLine.isValid || (suppliedLine.idRequester != idRequester) || (suppliedLine.addrDescriptor != addrDescriptor)) {
+        return false;
+    }
+    memcpy(dst, suppliedLine.data, GNK_L1_CACHE_LINE_SIZE);
+    suppliedLine.isValid = false;
+    stats.cacheToCache++;
+    return true;
+}
 
-    return kMESIState::kMesi_Invalid;
+// Note: The sender is NOT skipped here - a core writing to its own code must invalidate its own instruction cache
+void MesiBusBase::NotifyWriteSnoopers(uint8_t sender, uint64_t addrDescriptor) {
+    for(auto &snooper : writeSnoopers) {
+        if (snooper.cbOnMessage == nullptr) {
+            continue;
+        }
+        snooper.cbOnMessage(kMemOp::kBusWr, sender, addrDescriptor);
+    }
 }
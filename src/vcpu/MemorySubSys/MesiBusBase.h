@@ -20,10 +20,21 @@ namespace gnilk {
         class MesiBusBase : public BusBase {
         public:
             using Ref = std::shared_ptr<MesiBusBase>;
+            // Sender id for messages not originating from a core (like L2 back-invalidation)
+            static const uint8_t kSenderNone = 0xff;
+
+            struct Statistics {
+                uint64_t messages = 0;      // number of bus transactions
+                uint64_t snoops = 0;        // number of snooper callbacks invoked
+                uint64_t lineReads = 0;     // lines read from memory (L2/RAM)
+                uint64_t lineWrites = 0;    // lines written to memory (L2/RAM)
+                uint64_t cacheToCache = 0;  // lines supplied by another cache instead of memory
+            };
 
             struct MemBusSnooper {
                 uint8_t idCore = 0;
                 MessageHandler cbOnMessage = nullptr;
+                const void *owner = nullptr;
             };
 
         public:
@@ -31,15 +42,47 @@ namespace gnilk {
             virtual ~MesiBusBase() = default;
 
             void Subscribe(uint8_t idCore, MessageHandler cbOnMessage) override;
+            // Instruction caches are not part of the MESI protocol, they only snoop writes so they can invalidate
+            // code that has been modified (self-modifying code, loaders, etc..)
+            void SubscribeWriteSnoop(uint8_t idCore, const void *owner, MessageHandler cbOnMessage);
+            void UnsubscribeWriteSnoop(uint8_t idCore, const void *owner);
 
             kMESIState BroadCastRead(uint8_t idCore, uint64_t addrDescriptor) override;
             void BroadCastWrite(uint8_t idCore, uint64_t addrDescriptor) override;
+            kMESIState BroadCastReadExclusive(uint8_t idCore, uint64_t addrDescriptor) override;
+            void NotifyWrite(uint8_t idCore, uint64_t addrDescriptor) override;
+            void SupplyLine(uint64_t addrDescriptor, const void *src) override;
+
+            const Statistics &GetStatistics() const {
+                return stats;
+            }
+            void ResetStatistics() {
+                stats = {};
+            }
 
         protected:
-            kMESIState SendMessage(kMemOp, uint8_t sender, uint64_t addrDescriptor);
+            // Default is to broadcast to all subscribers, override for other coherence strategies (see DirectoryRamBus)
+            virtual kMESIState SendMessage(kMemOp, uint8_t sender, uint64_t addrDescriptor);
+            void NotifyWriteSnoopers(uint8_t sender, uint64_t addrDescriptor);
+            // Starts a new request, any line supplied by a snooping cache is for this requester only
+            // A back-invalidation (kBusInv) is not a request, it can arrive in the middle of one and keeps the line
+            void BeginRequest(kMemOp op, uint8_t idRequester);
+            // Returns true if a snooper supplied the line for this requester - the supplied line is consumed
+            bool TakeSuppliedLine(uint8_t idRequester, void *dst, uint64_t addrDescriptor);
         protected:
+            // Cache-to-cache transfer buffer, only valid during a request (one request at a time on the bus)
+            struct SuppliedLine {
+                bool isValid = false;
+                uint8_t idRequester = kSenderNone;
+                uint64_t addrDescriptor = 0;
+                uint8_t data[GNK_L1_CACHE_LINE_SIZE] = {};
+            };
+
             size_t nextSubscriber = 0;
+            Statistics stats = {};
             std::array<MemBusSnooper, GNK_CPU_NUM_CORES> subscribers = {};
+            std::array<MemBusSnooper, GNK_CPU_NUM_CORES> writeSnoopers = {};
+            SuppliedLine suppliedLine = {};
         };
 
     }
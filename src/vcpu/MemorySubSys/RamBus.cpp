@@ -56,21 +56,56 @@ MesiBusBase::Ref RamBus::Create(RamMemory *ptrRam) {
     return instance;
 }
 
+void RamBus::SetL2Cache(L2Cache::Ref newL2Cache) {
+    if (l2Cache != nullptr) {
+        l2Cache->Flush(*ram);
+        l2Cache->SetBackInvalidateHandler(nullptr);
+    }
+    l2Cache = std::move(newL2Cache);
+    if (l2Cache == nullptr) {
+        return;
+    }
+    l2Cache->SetBackInvalidateHandler([this](uint64_t addrDescriptor) {
+        SendMessage(kMemOp::kBusInv, kSenderNone, addrDescriptor);
+    });
+}
+
+// Data functions bypass the caches - so we need to keep the L2 in sync
 void RamBus::ReadData(void *dst, uint64_t addrDescriptor, size_t nBytes) {
+    if (l2Cache != nullptr) {
+        l2Cache->WriteBack(addrDescriptor, nBytes, *ram);
+    }
     ram->ReadVolatile(dst, addrDescriptor, nBytes);
 }
 void RamBus::WriteData(uint64_t addrDescriptor, const void *src, size_t nBytes) {
+    if (l2Cache != nullptr) {
+        l2Cache->Invalidate(addrDescriptor, nBytes, *ram);
+    }
     ram->WriteVolatile(addrDescriptor, src, nBytes);
 }
 
 
 
-void RamBus::ReadLine(void *dst, uint64_t addrDescriptor) {
+void RamBus::ReadLine(uint8_t idCore, void *dst, uint64_t addrDescriptor) {
+    // Another cache supplied the line during the snoop (MOESI/MESIF) - no need to go to memory
+    if (TakeSuppliedLine(idCore, dst, addrDescriptor)) {
+        return;
+    }
+    stats.lineReads++;
+    if (l2Cache != nullptr) {
+        l2Cache->ReadLine(idCore, dst, addrDescriptor, *ram);
+        return;
+    }
     // FIXME: Not sure this should be done here...
     ram->Read(dst, addrDescriptor & VCPU_MEM_ADDR_MASK);
 }
 
-void RamBus::WriteLine(uint64_t addrDescriptor, const void *src) {
+void RamBus::WriteLine(uint8_t idCore, uint64_t addrDescriptor, const void *src) {
+    stats.lineWrites++;
+    if (l2Cache != nullptr) {
+        l2Cache->WriteLine(idCore, addrDescriptor, src, *ram);
+        return;
+    }
     // FIXME: Not sure this should be done here...
     ram->Write(addrDescriptor & VCPU_MEM_ADDR_MASK, src);
 }
@@ -12,6 +12,7 @@
 #include <memory>
 
 #include "MesiBusBase.h"
+#include "L2Cache.h"
 
 namespace gnilk {
     namespace vcpu {
@@ -71,8 +72,14 @@ namespace gnilk {
             void WriteData(uint64_t addrDescriptor, const void *src, size_t nBytes) override;
 
 
-            void WriteLine(uint64_t addrDescriptor, const void *src) override;
-            void ReadLine(void *dst, uint64_t addrDescriptor) override;
+            void WriteLine(uint8_t idCore, uint64_t addrDescriptor, const void *src) override;
+            void ReadLine(uint8_t idCore, void *dst, uint64_t addrDescriptor) override;
+
+            // Attach a shared L2 cache between the bus and the RAM, nullptr will detach (and flush) any attached L2
+            void SetL2Cache(L2Cache::Ref newL2Cache);
+            L2Cache::Ref GetL2Cache() {
+                return l2Cache;
+            }
 
             // Emulation helpers
             void *RamPtr(uint64_t address) const {
@@ -81,6 +88,7 @@ namespace gnilk {
         protected:
             // ???
             RamMemory *ram;
+            L2Cache::Ref l2Cache = nullptr;
         };
 
     }
@@ -17,12 +17,18 @@ DLL_EXPORT int test_cache_touch(ITesting *t);
 DLL_EXPORT int test_cache_read(ITesting *t);
 DLL_EXPORT int test_cache_write(ITesting *t);
 DLL_EXPORT int test_cache_sync(ITesting *t);
+DLL_EXPORT int test_cache_moesi(ITesting *t);
+DLL_EXPORT int test_cache_mesif(ITesting *t);
+DLL_EXPORT int test_cache_llsc(ITesting *t);
+DLL_EXPORT int test_cache_cas(ITesting *t);
+DLL_EXPORT int test_cache_moesi_cas(ITesting *t);
 }
 
 #define RAM_SIZE 65536
 
 DLL_EXPORT int test_cache(ITesting *t) {
     t->SetPreCaseCallback([](ITesting *) {
+        SoC::Instance().SetCoherenceProtocol(kCoherenceProtocol::MESI);
         SoC::Instance().Reset();
     });
     return kTR_Pass;
@@ -203,3 +209,185 @@ DLL_EXPORT int test_cache_sync(ITesting *t) {
     return kTR_Pass;
 }
 
+static int CountLinesInState(const Cache &cache, kMESIState state) {
+    int nLines = 0;
+    for(int i=0;i<cache.GetNumLines();i++) {
+        if (cache.GetLineState(i) == state) {
+            nLines++;
+        }
+    }
+    return nLines;
+}
+
+DLL_EXPORT int test_cache_moesi(ITesting *t) {
+    SoC::Instance().SetCoherenceProtocol(kCoherenceProtocol::MOESI);
+    auto &region = SoC::Instance().GetMemoryRegionFromAddress(0x4711);
+    auto ramBus = std::static_pointer_cast<RamBus>(region.bus);
+
+    CacheController cacheControllerA;
+    CacheController cacheControllerB;
+    cacheControllerA.Initialize(0);
+    cacheControllerB.Initialize(1);
+    TR_ASSERT(t, cacheControllerA.GetCoherenceProtocol() == kCoherenceProtocol::MOESI);
+
+    cacheControllerA.Write<int>(0x4711, 0x1234);
+    ramBus->ResetStatistics();
+
+    // 'A' supplies the line directly - memory is not updated
+    TR_ASSERT(t, cacheControllerB.Read<int>(0x4711) == 0x1234);
+    TR_ASSERT(t, CountLinesInState(cacheControllerA.GetCache(), kMesi_Owned) == 1);
+    TR_ASSERT(t, CountLinesInState(cacheControllerB.GetCache(), kMesi_Shared) == 1);
+    TR_ASSERT(t, ramBus->GetStatistics().lineWrites == 0);
+    TR_ASSERT(t, ramBus->GetStatistics().lineReads == 0);
+    TR_ASSERT(t, ramBus->GetStatistics().cacheToCache == 1);
+    int ramValue = 0;
+    memcpy(&ramValue, ramBus->RamPtr(0x4711), sizeof(int));
+    TR_ASSERT(t, ramValue != 0x1234);
+
+    // 'B' writes, takes the dirty line from 'A' - still no memory write
+    cacheControllerB.Write<int>(0x4711, 0x4711);
+    TR_ASSERT(t, cacheControllerA.GetInvalidLineCount() == GNK_L1_CACHE_NUM_LINES);
+    TR_ASSERT(t, ramBus->GetStatistics().lineWrites == 0);
+    TR_ASSERT(t, cacheControllerA.Read<int>(0x4711) == 0x4711);
+    TR_ASSERT(t, CountLinesInState(cacheControllerB.GetCache(), kMesi_Owned) == 1);
+
+    // The owner writes back when the line is dropped
+    cacheControllerA.Flush();
+    cacheControllerB.Flush();
+    TR_ASSERT(t, ramBus->GetStatistics().lineWrites == 1);
+    memcpy(&ramValue, ramBus->RamPtr(0x4711), sizeof(int));
+    TR_ASSERT(t, ramValue == 0x4711);
+
+    SoC::Instance().SetCoherenceProtocol(kCoherenceProtocol::MESI);
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_cache_mesif(ITesting *t) {
+    SoC::Instance().SetCoherenceProtocol(kCoherenceProtocol::MESIF);
+    auto &region = SoC::Instance().GetMemoryRegionFromAddress(0x4711);
+    auto ramBus = std::static_pointer_cast<RamBus>(region.bus);
+
+    CacheController cacheControllerA;
+    CacheController cacheControllerB;
+    CacheController cacheControllerC;
+    cacheControllerA.Initialize(0);
+    cacheControllerB.Initialize(1);
+    cacheControllerC.Initialize(2);
+
+    ramBus->ResetStatistics();
+    cacheControllerA.Read<int>(0x4711);
+    TR_ASSERT(t, ramBus->GetStatistics().lineReads == 1);
+
+    // 'A' holds it exclusive and supplies it, 'B' becomes the forwarder
+    cacheControllerB.Read<int>(0x4711);
+    TR_ASSERT(t, CountLinesInState(cacheControllerA.GetCache(), kMesi_Shared) == 1);
+    TR_ASSERT(t, CountLinesInState(cacheControllerB.GetCache(), kMesi_Forward) == 1);
+
+    // 'B' forwards, 'C' is the new forwarder
+    cacheControllerC.Read<int>(0x4711);
+    TR_ASSERT(t, CountLinesInState(cacheControllerB.GetCache(), kMesi_Shared) == 1);
+    TR_ASSERT(t, CountLinesInState(cacheControllerC.GetCache(), kMesi_Forward) == 1);
+
+    // Only the first read went to memory
+    TR_ASSERT(t, ramBus->GetStatistics().lineReads == 1);
+    TR_ASSERT(t, ramBus->GetStatistics().cacheToCache == 2);
+
+    SoC::Instance().SetCoherenceProtocol(kCoherenceProtocol::MESI);
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_cache_llsc(ITesting *t) {
+    CacheController cacheControllerA;
+    CacheController cacheControllerB;
+    cacheControllerA.Initialize(0);
+    cacheControllerB.Initialize(1);
+
+    cacheControllerB.Read<int>(0x4711);
+
+    // Load linked takes the line exclusively
+    int value = 0;
+    TR_ASSERT(t, cacheControllerA.LoadLinked(0x4710, &value, sizeof(value)) == sizeof(value));
+    TR_ASSERT(t, cacheControllerA.HaveReservation(0x4710));
+    TR_ASSERT(t, CountLinesInState(cacheControllerA.GetCache(), kMesi_Exclusive) == 1);
+    TR_ASSERT(t, cacheControllerB.GetInvalidLineCount() == GNK_L1_CACHE_NUM_LINES);
+
+    // Someone reading doesn't break the reservation
+    cacheControllerB.Read<int>(0x4710);
+    value = 1;
+    TR_ASSERT(t, cacheControllerA.StoreConditional(0x4710, &value, sizeof(value)) == 1);
+    TR_ASSERT(t, !cacheControllerA.HaveReservation(0x4710));
+    TR_ASSERT(t, cacheControllerB.Read<int>(0x4710) == 1);
+
+    // Someone writing does
+    TR_ASSERT(t, cacheControllerA.LoadLinked(0x4710, &value, sizeof(value)) > 0);
+    cacheControllerB.Write<int>(0x4714, 4711);
+    TR_ASSERT(t, !cacheControllerA.HaveReservation(0x4710));
+    value = 2;
+    TR_ASSERT(t, cacheControllerA.StoreConditional(0x4710, &value, sizeof(value)) == 0);
+    TR_ASSERT(t, cacheControllerB.Read<int>(0x4710) == 1);
+
+    // Store conditional without load linked always fails
+    TR_ASSERT(t, cacheControllerA.StoreConditional(0x4710, &value, sizeof(value)) == 0);
+
+    // Crossing a line is not allowed
+    TR_ASSERT(t, cacheControllerA.LoadLinked(GNK_L1_CACHE_LINE_SIZE - 2, &value, sizeof(value)) < 0);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_cache_cas(ITesting *t) {
+    CacheController cacheControllerA;
+    CacheController cacheControllerB;
+    cacheControllerA.Initialize(0);
+    cacheControllerB.Initialize(1);
+
+    cacheControllerB.Write<int>(0x4710, 10);
+
+    int expected = 10;
+    int desired = 11;
+    TR_ASSERT(t, cacheControllerA.CompareAndSwap(0x4710, &expected, &desired, sizeof(int)) == 1);
+    TR_ASSERT(t, cacheControllerB.GetInvalidLineCount() == GNK_L1_CACHE_NUM_LINES);
+    TR_ASSERT(t, cacheControllerB.Read<int>(0x4710) == 11);
+
+    // Fails - and gives back the current value
+    expected = 10;
+    desired = 12;
+    TR_ASSERT(t, cacheControllerA.CompareAndSwap(0x4710, &expected, &desired, sizeof(int)) == 0);
+    TR_ASSERT(t, expected == 11);
+    TR_ASSERT(t, cacheControllerB.Read<int>(0x4710) == 11);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_cache_moesi_cas(ITesting *t) {
+    SoC::Instance().SetCoherenceProtocol(kCoherenceProtocol::MOESI);
+    auto &region = SoC::Instance().GetMemoryRegionFromAddress(0x4710);
+    auto ramBus = std::static_pointer_cast<RamBus>(region.bus);
+
+    CacheController cacheControllerA;
+    CacheController cacheControllerB;
+    cacheControllerA.Initialize(0);
+    cacheControllerB.Initialize(1);
+
+    // 'A' owns the dirty line, 'B' shares it
+    cacheControllerA.Write<int>(0x4710, 5);
+    TR_ASSERT(t, cacheControllerB.Read<int>(0x4710) == 5);
+    TR_ASSERT(t, CountLinesInState(cacheControllerA.GetCache(), kMesi_Owned) == 1);
+
+    // 'B' takes the line from the owner but never writes it - it is the only dirty copy left
+    int expected = 4;
+    int desired = 6;
+    TR_ASSERT(t, cacheControllerB.CompareAndSwap(0x4710, &expected, &desired, sizeof(int)) == 0);
+    TR_ASSERT(t, expected == 5);
+    TR_ASSERT(t, cacheControllerA.GetInvalidLineCount() == GNK_L1_CACHE_NUM_LINES);
+    TR_ASSERT(t, CountLinesInState(cacheControllerB.GetCache(), kMesi_Modified) == 1);
+
+    cacheControllerA.Flush();
+    cacheControllerB.Flush();
+    int ramValue = 0;
+    memcpy(&ramValue, ramBus->RamPtr(0x4710), sizeof(int));
+    TR_ASSERT(t, ramValue == 5);
+
+    SoC::Instance().SetCoherenceProtocol(kCoherenceProtocol::MESI);
+    return kTR_Pass;
+}
@@ -0,0 +1,111 @@
+//
+// Created by gnilk on 19.10.26.
+//
+#include <string.h>
+#include <testinterface.h>
+#include "System.h"
+#include "MemorySubSys/CacheController.h"
+#include "MemorySubSys/DirectoryRamBus.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+
+extern "C" {
+DLL_EXPORT int test_dirbus(ITesting *t);
+DLL_EXPORT int test_dirbus_sharers(ITesting *t);
+DLL_EXPORT int test_dirbus_write(ITesting *t);
+}
+
+// Replaces the default RAM region with one using directory based coherence
+static MemoryRegionConfiguration dirRamConfig[] = {
+        {
+                .regionFlags = kMemRegion_Default_Ram,
+                .vAddrStart = 0x00,
+                .sizeBytes = 65535,
+                .coherence = kCoherenceMode::Directory,
+        },
+};
+static MemoryRegionConfiguration defaultRamConfig[] = {
+        {
+                .regionFlags = kMemRegion_Default_Ram,
+                .vAddrStart = 0x00,
+                .sizeBytes = 65535,
+        },
+};
+
+// Swap in the directory bus for the duration of a test case
+struct DirectoryRegionScope {
+    DirectoryRegionScope() {
+        SoC::Instance().CreateMemoryRegionsFromConfig(dirRamConfig);
+    }
+    ~DirectoryRegionScope() {
+        SoC::Instance().CreateMemoryRegionsFromConfig(defaultRamConfig);
+    }
+    DirectoryRamBus *GetBus() {
+        auto &region = SoC::Instance().GetMemoryRegionFromAddress(0);
+        return dynamic_cast<DirectoryRamBus *>(region.bus.get());
+    }
+};
+
+DLL_EXPORT int test_dirbus(ITesting *t) {
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_dirbus_sharers(ITesting *t) {
+    DirectoryRegionScope scope;
+    auto bus = scope.GetBus();
+    TR_ASSERT(t, bus != nullptr);
+
+    CacheController cacheControllerA;
+    CacheController cacheControllerB;
+    CacheController cacheControllerC;
+    cacheControllerA.Initialize(0);
+    cacheControllerB.Initialize(1);
+    cacheControllerC.Initialize(2);
+
+    bus->ResetStatistics();
+
+    // Nobody has this - nobody should be messaged
+    cacheControllerA.Read<int>(0x1000);
+    TR_ASSERT(t, bus->GetSharers(0x1000) == 0x01);
+    TR_ASSERT(t, bus->GetStatistics().snoops == 0);
+
+    // Only 'A' should be messaged
+    cacheControllerB.Read<int>(0x1000);
+    TR_ASSERT(t, bus->GetSharers(0x1000) == 0x03);
+    TR_ASSERT(t, bus->GetStatistics().snoops == 1);
+
+    // 'C' reads something else - no one is messaged
+    cacheControllerC.Read<int>(0x2000);
+    TR_ASSERT(t, bus->GetSharers(0x2000) == 0x04);
+    TR_ASSERT(t, bus->GetStatistics().snoops == 1);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_dirbus_write(ITesting *t) {
+    DirectoryRegionScope scope;
+    auto bus = scope.GetBus();
+    TR_ASSERT(t, bus != nullptr);
+
+    CacheController cacheControllerA;
+    CacheController cacheControllerB;
+    cacheControllerA.Initialize(0);
+    cacheControllerB.Initialize(1);
+
+    cacheControllerA.Read<int>(0x1000);
+    cacheControllerB.Read<int>(0x1000);
+    TR_ASSERT(t, bus->GetSharers(0x1000) == 0x03);
+
+    // 'B' writes, 'A' must drop the line and 'B' is now the only sharer
+    cacheControllerB.Write<int>(0x1000, 0x4711);
+    TR_ASSERT(t, bus->GetSharers(0x1000) == 0x02);
+    TR_ASSERT(t, cacheControllerA.GetInvalidLineCount() == GNK_L1_CACHE_NUM_LINES);
+
+    // And 'A' should see the new value
+    TR_ASSERT(t, cacheControllerA.Read<int>(0x1000) == 0x4711);
+    TR_ASSERT(t, bus->GetSharers(0x1000) == 0x03);
+
+    return kTR_Pass;
+}
@@ -0,0 +1,129 @@
+//
+// Created by gnilk on 19.10.26.
+//
+#include <string.h>
+#include <testinterface.h>
+#include "System.h"
+#include "MemorySubSys/MemoryUnit.h"
+#include "MemorySubSys/InstructionCache.h"
+#include "MemorySubSys/RamBus.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+
+extern "C" {
+DLL_EXPORT int test_icache(ITesting *t);
+DLL_EXPORT int test_icache_fetch(ITesting *t);
+DLL_EXPORT int test_icache_fetch_unaligned(ITesting *t);
+DLL_EXPORT int test_icache_selfmod(ITesting *t);
+DLL_EXPORT int test_icache_snoop(ITesting *t);
+}
+
+DLL_EXPORT int test_icache(ITesting *t) {
+    t->SetPreCaseCallback([](ITesting *) {
+        SoC::Instance().Reset();
+    });
+    return kTR_Pass;
+}
+
+static uint8_t *PtrToRam(uint64_t address) {
+    auto &region = SoC::Instance().GetMemoryRegionFromAddress(address);
+    auto ramBus = std::reinterpret_pointer_cast<RamBus>(region.bus);
+    return static_cast<uint8_t *>(ramBus->RamPtr(address));
+}
+
+DLL_EXPORT int test_icache_fetch(ITesting *t) {
+    MMU mmu;
+    mmu.Initialize(0);
+
+    auto ptrRam = PtrToRam(0x100);
+    for(int i=0;i<GNK_L1_ICACHE_BLOCK_SIZE;i++) {
+        ptrRam[i] = i;
+    }
+
+    auto &icache = mmu.GetInstructionCache();
+    TR_ASSERT(t, icache.GetLineIndex(0x100) < 0);
+
+    // First fetch pulls in the full block
+    TR_ASSERT(t, mmu.FetchInstr<uint8_t>(0x100) == 0);
+    TR_ASSERT(t, icache.GetLineIndex(0x100) >= 0);
+    TR_ASSERT(t, icache.GetStatistics().misses == 1);
+    TR_ASSERT(t, icache.GetStatistics().hits == 0);
+
+    // The rest of the block should be hits
+    for(int i=1;i<GNK_L1_ICACHE_BLOCK_SIZE;i++) {
+        TR_ASSERT(t, mmu.FetchInstr<uint8_t>(0x100 + i) == i);
+    }
+    TR_ASSERT(t, icache.GetStatistics().misses == 1);
+    TR_ASSERT(t, icache.GetStatistics().hits == GNK_L1_ICACHE_BLOCK_SIZE-1);
+
+    // Instruction fetches should not touch the data cache
+    TR_ASSERT(t, mmu.GetCacheController().GetInvalidLineCount() == GNK_L1_CACHE_NUM_LINES);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_icache_fetch_unaligned(ITesting *t) {
+    MMU mmu;
+    mmu.Initialize(0);
+
+    // Plant a value crossing the fetch block boundary
+    uint64_t address = 0x200 + GNK_L1_ICACHE_BLOCK_SIZE - 2;
+    auto ptrRam = PtrToRam(address);
+    ptrRam[0] = 0x12;
+    ptrRam[1] = 0x34;
+    ptrRam[2] = 0x56;
+    ptrRam[3] = 0x78;
+
+    auto value = mmu.FetchInstr<uint32_t>(address);
+    TR_ASSERT(t, value == 0x12345678);
+    // Two blocks, two misses
+    TR_ASSERT(t, mmu.GetInstructionCache().GetStatistics().misses == 2);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_icache_selfmod(ITesting *t) {
+    MMU mmu;
+    mmu.Initialize(0);
+
+    auto ptrRam = PtrToRam(0x300);
+    ptrRam[0] = 0x61;   // nop
+
+    TR_ASSERT(t, mmu.FetchInstr<uint8_t>(0x300) == 0x61);
+
+    // Write through the data cache - the line is now modified in L1D and the block must be invalidated
+    mmu.Write<uint8_t>(0x300, 0x00);
+    auto &icache = mmu.GetInstructionCache();
+    TR_ASSERT(t, icache.GetLineIndex(0x300) < 0);
+    TR_ASSERT(t, icache.GetStatistics().invalidations == 1);
+
+    // The fetch must see the modified data (i.e. L1D written back before fetch)
+    TR_ASSERT(t, mmu.FetchInstr<uint8_t>(0x300) == 0x00);
+    TR_ASSERT(t, icache.GetStatistics().misses == 2);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_icache_snoop(ITesting *t) {
+    MMU mmuA;
+    MMU mmuB;
+    mmuA.Initialize(0);
+    mmuB.Initialize(1);
+
+    auto ptrRam = PtrToRam(0x400);
+    ptrRam[0] = 0x61;
+
+    TR_ASSERT(t, mmuA.FetchInstr<uint8_t>(0x400) == 0x61);
+    TR_ASSERT(t, mmuA.GetInstructionCache().GetLineIndex(0x400) >= 0);
+
+    // Core 1 writes to the code core 0 is executing
+    mmuB.Write<uint8_t>(0x400, 0x60);
+    TR_ASSERT(t, mmuA.GetInstructionCache().GetLineIndex(0x400) < 0);
+
+    // Core 1 still holds this as modified, the fetch must pull it from there
+    TR_ASSERT(t, mmuA.FetchInstr<uint8_t>(0x400) == 0x60);
+
+    return kTR_Pass;
+}
@@ -0,0 +1,181 @@
+//
+// Created by gnilk on 19.10.26.
+//
+#include <string.h>
+#include <testinterface.h>
+#include "System.h"
+#include "MemorySubSys/CacheController.h"
+#include "MemorySubSys/L2Cache.h"
+#include "MemorySubSys/RamBus.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+
+extern "C" {
+DLL_EXPORT int test_l2cache(ITesting *t);
+DLL_EXPORT int test_l2cache_readhit(ITesting *t);
+DLL_EXPORT int test_l2cache_shared(ITesting *t);
+DLL_EXPORT int test_l2cache_backinvalidate(ITesting *t);
+DLL_EXPORT int test_l2cache_exclusive(ITesting *t);
+DLL_EXPORT int test_l2cache_moesi(ITesting *t);
+}
+
+DLL_EXPORT int test_l2cache(ITesting *t) {
+    t->SetPreCaseCallback([](ITesting *) {
+        SoC::Instance().DisableL2Cache();
+        SoC::Instance().Reset();
+    });
+    return kTR_Pass;
+}
+
+static RamBus *GetRamBus(uint64_t address) {
+    auto &region = SoC::Instance().GetMemoryRegionFromAddress(address);
+    return static_cast<RamBus *>(region.bus.get());
+}
+
+DLL_EXPORT int test_l2cache_readhit(ITesting *t) {
+    SoC::Instance().EnableL2Cache({.sizeBytes = 4096, .associativity = 4});
+    auto l2 = GetRamBus(0x1000)->GetL2Cache();
+    TR_ASSERT(t, l2 != nullptr);
+    TR_ASSERT(t, l2->GetNumSets() == 16);
+
+    int plantedValue = 4711;
+    memcpy(GetRamBus(0x1000)->RamPtr(0x1000), &plantedValue, sizeof(int));
+
+    CacheController cacheControllerA;
+    cacheControllerA.Initialize(0);
+
+    // First read misses in both L1 and L2
+    TR_ASSERT(t, cacheControllerA.Read<int>(0x1000) == plantedValue);
+    TR_ASSERT(t, l2->GetCoreStatistics(0).misses == 1);
+    TR_ASSERT(t, l2->IsLineCached(0x1000));
+
+    // Drop the L1, we should now hit in the L2
+    cacheControllerA.Flush();
+    TR_ASSERT(t, cacheControllerA.Read<int>(0x1000) == plantedValue);
+    TR_ASSERT(t, l2->GetCoreStatistics(0).hits == 1);
+    TR_ASSERT(t, l2->GetCoreStatistics(0).reads == 2);
+
+    auto &config = l2->GetConfig();
+    TR_ASSERT(t, l2->GetCoreStatistics(0).cycles == (2 * config.hitLatency + config.memoryLatency));
+
+    SoC::Instance().DisableL2Cache();
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_l2cache_shared(ITesting *t) {
+    SoC::Instance().EnableL2Cache({.sizeBytes = 4096, .associativity = 4});
+    auto l2 = GetRamBus(0x1000)->GetL2Cache();
+
+    CacheController cacheControllerA;
+    CacheController cacheControllerB;
+    cacheControllerA.Initialize(0);
+    cacheControllerB.Initialize(1);
+
+    cacheControllerA.Read<int>(0x1000);
+    cacheControllerB.Read<int>(0x1000);
+
+    // Core 0 brought it in, core 1 should find it in the L2
+    TR_ASSERT(t, l2->GetCoreStatistics(0).misses == 1);
+    TR_ASSERT(t, l2->GetCoreStatistics(0).hits == 0);
+    TR_ASSERT(t, l2->GetCoreStatistics(1).misses == 0);
+    TR_ASSERT(t, l2->GetCoreStatistics(1).hits == 1);
+
+    SoC::Instance().DisableL2Cache();
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_l2cache_backinvalidate(ITesting *t) {
+    // One set, two ways - the third line will evict the first
+    SoC::Instance().EnableL2Cache({.sizeBytes = 2 * GNK_L1_CACHE_LINE_SIZE, .associativity = 2});
+    auto ramBus = GetRamBus(0x1000);
+    auto l2 = ramBus->GetL2Cache();
+    TR_ASSERT(t, l2->GetNumSets() == 1);
+
+    CacheController cacheControllerA;
+    cacheControllerA.Initialize(0);
+
+    int value = 0x1234;
+    cacheControllerA.Write<int>(0x1000, value);
+    cacheControllerA.Read<int>(0x2000);
+    TR_ASSERT(t, memcmp(ramBus->RamPtr(0x1000), &value, sizeof(int)) != 0);
+
+    // This evicts 0x1000 from the L2, which must pull the modified line out of the L1 and write it to RAM
+    cacheControllerA.Read<int>(0x3000);
+    TR_ASSERT(t, l2->GetStatistics().backInvalidations == 1);
+    TR_ASSERT(t, !l2->IsLineCached(0x1000));
+    TR_ASSERT(t, memcmp(ramBus->RamPtr(0x1000), &value, sizeof(int)) == 0);
+    // Only 0x2000 and 0x3000 left in L1
+    TR_ASSERT(t, cacheControllerA.GetInvalidLineCount() == GNK_L1_CACHE_NUM_LINES - 2);
+
+    SoC::Instance().DisableL2Cache();
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_l2cache_exclusive(ITesting *t) {
+    SoC::Instance().EnableL2Cache({.sizeBytes = 4096, .associativity = 4, .policy = kL2Policy::Exclusive});
+    auto ramBus = GetRamBus(0x1000);
+    auto l2 = ramBus->GetL2Cache();
+
+    CacheController cacheControllerA;
+    cacheControllerA.Initialize(0);
+
+    int value = 0x4711;
+    cacheControllerA.Write<int>(0x1000, value);
+    // Exclusive - nothing is filled on a miss
+    TR_ASSERT(t, l2->GetNumValidLines() == 0);
+
+    // Evicting from L1 puts the line in the L2 - RAM is still not updated
+    cacheControllerA.Flush();
+    TR_ASSERT(t, l2->IsLineCached(0x1000));
+    TR_ASSERT(t, memcmp(ramBus->RamPtr(0x1000), &value, sizeof(int)) != 0);
+
+    // Reading moves it back to L1
+    TR_ASSERT(t, cacheControllerA.Read<int>(0x1000) == value);
+    TR_ASSERT(t, l2->GetCoreStatistics(0).hits == 1);
+    TR_ASSERT(t, l2->GetNumValidLines() == 0);
+    TR_ASSERT(t, memcmp(ramBus->RamPtr(0x1000), &value, sizeof(int)) == 0);
+
+    SoC::Instance().DisableL2Cache();
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_l2cache_moesi(ITesting *t) {
+    SoC::Instance().SetCoherenceProtocol(kCoherenceProtocol::MOESI);
+    // One set, two ways
+    SoC::Instance().EnableL2Cache({.sizeBytes = 2 * GNK_L1_CACHE_LINE_SIZE, .associativity = 2});
+    auto ramBus = GetRamBus(0x1000);
+    auto l2 = ramBus->GetL2Cache();
+
+    CacheController cacheControllerA;
+    CacheController cacheControllerB;
+    cacheControllerA.Initialize(0);
+    cacheControllerB.Initialize(1);
+
+    // Non-cached writes drop the L2 line, the L1 must let go of it as well - keeping what it had modified
+    cacheControllerA.Write<int>(0x1000, 0x1234);
+    int hostValue = 0x4711;
+    ramBus->WriteData(0x1000 + sizeof(int), &hostValue, sizeof(int));
+    TR_ASSERT(t, l2->GetStatistics().backInvalidations == 1);
+    TR_ASSERT(t, cacheControllerA.GetInvalidLineCount() == GNK_L1_CACHE_NUM_LINES);
+    TR_ASSERT(t, cacheControllerA.Read<int>(0x1000) == 0x1234);
+    TR_ASSERT(t, cacheControllerA.Read<int>(0x1000 + sizeof(int)) == hostValue);
+
+    // 'A' owns 0x2000 and supplies it to 'B', the L2 evicting 0x1000 before 'B' has read the line must not drop it
+    cacheControllerA.Write<int>(0x2000, 0x5678);
+    TR_ASSERT(t, ramBus->BroadCastRead(1, 0x2000) == kMesi_Owned);
+    uint8_t line[GNK_L1_CACHE_LINE_SIZE];
+    ramBus->ReadLine(MesiBusBase::kSenderNone, line, 0x3000);
+    TR_ASSERT(t, l2->GetStatistics().backInvalidations == 2);
+    TR_ASSERT(t, !l2->IsLineCached(0x1000));
+    ramBus->ReadLine(1, line, 0x2000);
+    int value = 0;
+    memcpy(&value, line, sizeof(int));
+    TR_ASSERT(t, value == 0x5678);
+    TR_ASSERT(t, ramBus->GetStatistics().cacheToCache == 1);
+
+    SoC::Instance().DisableL2Cache();
+    SoC::Instance().SetCoherenceProtocol(kCoherenceProtocol::MESI);
+    return kTR_Pass;
+}
@@ -8,9 +8,29 @@
 #include <memory>
 
 #include "Interrupt.h"
+#include "EventScheduler.h"
 
 namespace gnilk {
     namespace vcpu {
+        class Peripheral;
+
+        //
+        // Virtual time, implemented by the CPU. Time is counted in retired cycles - a peripheral can ask to be
+        // called back once the CPU has reached a specific cycle, either through a handler or through
+        // Peripheral::OnScheduledEvent.
+        //
+        class PeripheralScheduler {
+        public:
+            PeripheralScheduler() = default;
+            virtual ~PeripheralScheduler() = default;
+
+            virtual uint64_t GetCycleCount() const = 0;
+            virtual uint64_t GetClockFrequency() const = 0;
+            virtual EventScheduler::EventId ScheduleEvent(uint64_t atCycle, EventScheduler::EventHandler handler) = 0;
+            virtual bool CancelEvent(EventScheduler::EventId id) = 0;
+            virtual EventScheduler::EventId SchedulePeripheral(Peripheral *peripheral, uint64_t atCycle) = 0;
+        };
+
         class Peripheral {
         public:
             using Ref = std::shared_ptr<Peripheral>;
@@ -21,7 +41,10 @@ namespace gnilk {
             virtual void Initialize() {}
             virtual bool Start() { return false; }
             virtual bool Stop() { return false; }
+            // NOTE: Not called by the CPU - peripherals are event driven, schedule what you need with the scheduler
             virtual bool Update() { return false; }
+            // Called by the scheduler when a cycle requested through 'SchedulePeripheral' has been reached
+            virtual void OnScheduledEvent(uint64_t cycle) {}
 
             void SetInterruptController(InterruptController *newCntrl) {
                 intController = newCntrl;
@@ -29,6 +52,9 @@ namespace gnilk {
             void MapToInterrupt(CPUInterruptId newInterruptId) {
                 interruptId = newInterruptId;
             }
+            void SetScheduler(PeripheralScheduler *newScheduler) {
+                scheduler = newScheduler;
+            }
         protected:
             void RaiseInterrupt() {
                 if (intController == nullptr) {
@@ -38,6 +64,7 @@ namespace gnilk {
             }
         protected:
             InterruptController *intController =nullptr;
+            PeripheralScheduler *scheduler = nullptr;
             CPUInterruptId interruptId = {};
         };
     }
@@ -9,6 +9,8 @@
 #include <stdint.h>
 #include <string.h>
 #include <mutex>
+#include <atomic>
+#include <algorithm>
 
 namespace gnilk {
     namespace vcpu {
@@ -181,6 +183,74 @@ namespace gnilk {
             size_t idxRead = 0;
             size_t idxWrite = 0;
         };
+
+        //
+        // Lock-free single-producer/single-consumer ring buffer, one thread writes and one thread reads.
+        // The indices run freely and are masked on access, which is why the size must be a power of two.
+        // Unlike 'Ringbuffer' partial reads/writes are allowed - returns the number of bytes actually copied.
+        //
+        template<size_t szBuffer>
+        class LockFreeRingbuffer {
+            static_assert((szBuffer & (szBuffer - 1)) == 0, "LockFreeRingbuffer size must be a power of two");
+        public:
+            LockFreeRingbuffer() = default;
+            virtual ~LockFreeRingbuffer() = default;
+
+            size_t BytesAvailable() const {
+                return idxWrite.load(std::memory_order_acquire) - idxRead.load(std::memory_order_acquire);
+            }
+            size_t BytesFree() const {
+                return szBuffer - BytesAvailable();
+            }
+            bool IsEmpty() const {
+                return BytesAvailable() == 0;
+            }
+            bool IsFull() const {
+                return BytesAvailable() == szBuffer;
+            }
+
+            // Producer side
+            size_t Write(const void *src, size_t len) {
+                auto idxW = idxWrite.load(std::memory_order_relaxed);
+                auto idxR = idxRead.load(std::memory_order_acquire);
+                len = std::min(len, szBuffer - (idxW - idxR));
+                CopyIn(idxW, static_cast<const uint8_t *>(src), len);
+                idxWrite.store(idxW + len, std::memory_order_release);
+                return len;
+            }
+
+            // Consumer side
+            size_t Read(void *out, size_t num) {
+                auto idxR = idxRead.load(std::memory_order_relaxed);
+                auto idxW = idxWrite.load(std::memory_order_acquire);
+                num = std::min(num, idxW - idxR);
+                CopyOut(static_cast<uint8_t *>(out), idxR, num);
+                idxRead.store(idxR + num, std::memory_order_release);
+                return num;
+            }
+
+            void Clear() {
+                idxRead.store(idxWrite.load(std::memory_order_acquire), std::memory_order_release);
+            }
+        protected:
+            void CopyIn(size_t idx, const uint8_t *src, size_t len) {
+                auto ofs = idx & (szBuffer - 1);
+                auto nFirst = std::min(len, szBuffer - ofs);
+                memcpy(&data[ofs], src, nFirst);
+                memcpy(data, src + nFirst, len - nFirst);
+            }
+            void CopyOut(uint8_t *out, size_t idx, size_t num) {
+                auto ofs = idx & (szBuffer - 1);
+                auto nFirst = std::min(num, szBuffer - ofs);
+                memcpy(out, &data[ofs], nFirst);
+                memcpy(out + nFirst, data, num - nFirst);
+            }
+        private:
+            uint8_t data[szBuffer] = {};
+            // Separate lines - the producer and consumer would otherwise fight over the line holding both
+            alignas(64) std::atomic<size_t> idxWrite = 0;
+            alignas(64) std::atomic<size_t> idxRead = 0;
+        };
     }
 }
 
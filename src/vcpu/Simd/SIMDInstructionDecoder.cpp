@@ -37,9 +37,6 @@ bool SIMDInstructionDecoder::Tick(CPUBase &cpu) {
         case State::kStateIdle :
             res = ExecuteTickFromIdle(cpu);
             break;
-        case State::kStateReadWriteMem :
-            res = ExecuteTickReadWriteMem(cpu);
-            break;
         case State::kStateFinished :
             return true;
     }
@@ -69,16 +66,18 @@ bool SIMDInstructionDecoder::ExecuteTickFromIdle(CPUBase &cpu) {
     auto &instructionSet = glb_InstructionSetSIMD.GetDefinition();
 
     auto opCodeByte = NextByte(cpu);
-    if (!instructionSet.GetInstructionSet().contains(static_cast<SimdOpCode>(opCodeByte))) {
+    auto &opDesc = instructionSet.GetInstructionSet()[opCodeByte];
+    if (!opDesc.isDefined) {
         // We failed..
         cpu.AdvanceInstrPtr(1);
+        cpu.RaiseException(CPUKnownExceptions::kInvalidInstruction);
         return false;
     }
 
     // this is valid - so begin
     operand.opCodeByte = opCodeByte;
     operand.opCode = static_cast<SimdOpCode>(opCodeByte);
-    operand.features = instructionSet.GetInstructionSet().at(operand.opCode).features;
+    operand.features = opDesc.features;
 
     operand.opFlagsHighByte = NextByte(cpu);
     operand.opSize = static_cast<kSimdOpSize>(operand.opFlagsHighByte &  kSimdFlagOpSizeBitMask);
@@ -91,7 +90,7 @@ bool SIMDInstructionDecoder::ExecuteTickFromIdle(CPUBase &cpu) {
 
     // Decode src A index
     operand.opSrcAAndMaskOrSrcB = NextByte(cpu);
-    operand.opSrcAIndex = operand.opSrcAAndMaskOrSrcB & 0xf0;
+    operand.opSrcAIndex = (operand.opSrcAAndMaskOrSrcB >> 4) & 0x0f;
 
     // One is enough - it's a union...
     operand.opSrcBIndex = operand.opSrcAAndMaskOrSrcB & 0x0f;
@@ -109,41 +108,12 @@ bool SIMDInstructionDecoder::ExecuteTickFromIdle(CPUBase &cpu) {
     // and the Pipeline to grab a new instruction..
     cpu.AdvanceInstrPtr(szComputed);
 
-    // IF we have an address register - we should do a read/write mem operation
-    if (operand.opAddrMode != kSimdAddrMode::kOpAddrMode_Simd) {
-
-        // Execute directly?
-        ChangeState(State::kStateFinished);
-    } else {
-        ChangeState(State::kStateReadWriteMem);
-    }
-
-    return true;
-}
-
-bool SIMDInstructionDecoder::ExecuteTickReadWriteMem(CPUBase &cpu) {
-    if (operand.opAddrMode == kSimdAddrMode::kOpAddrMode_SrcReg) {
-        ReadMem(cpu);
-    }
-
-    // Execute
-
-    if (operand.opAddrMode == kSimdAddrMode::kOpAddrMode_DstReg) {
-        WriteMem(cpu);
-    }
+    // Memory is accessed when executing (like the V1 load/store instructions) - so we are done here
     ChangeState(State::kStateFinished);
-    return true;
-}
-
-void SIMDInstructionDecoder::ReadMem(CPUBase &cpu) {
-
-}
-void SIMDInstructionDecoder::WriteMem(CPUBase &cpu) {
 
+    return true;
 }
 
-
-
 // SIMD instructions are fixed size...
 size_t SIMDInstructionDecoder::ComputeInstrSize() const {
     size_t opSize = ofsEndInstr - ofsStartInstr;    // Start here - as operands have different sizes..
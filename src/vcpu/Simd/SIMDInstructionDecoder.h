@@ -44,15 +44,11 @@ namespace gnilk {
         protected:
 
             bool ExecuteTickFromIdle(CPUBase &cpu);
-            bool ExecuteTickReadWriteMem(CPUBase &cpu);
 
-            void ReadMem(CPUBase &cpu);
-            void WriteMem(CPUBase &cpu);
             size_t ComputeInstrSize() const;
         protected:
             enum class State : uint8_t {
                 kStateIdle,
-                kStateReadWriteMem,
                 kStateFinished,
             };
             State state = {};
@@ -7,7 +7,7 @@
 using namespace gnilk;
 using namespace gnilk::vcpu;
 
-std::unordered_map<OperandCodeBase , OperandDescriptionBase> SIMDInstructionSetDef::instructionSet = {
+static constexpr OperandDefinition instructionDefinitions[] = {
         {SimdOpCode::LOAD,
             {
                  .name = "ve_load",
@@ -26,6 +26,36 @@ std::unordered_map<OperandCodeBase , OperandDescriptionBase> SIMDInstructionSetD
                              | OperandFeatureFlags::kFeature_Advance,
                 },
         },
+        {SimdOpCode::LOADS,
+                {
+                        .name = "ve_loads",
+                        .features = OperandFeatureFlags::kFeature_OperandSize \
+                             | OperandFeatureFlags::kFeature_AddressRegister \
+                             | OperandFeatureFlags::kFeature_Advance,
+                },
+        },
+        {SimdOpCode::STORES,
+                {
+                        .name = "ve_stores",
+                        .features = OperandFeatureFlags::kFeature_OperandSize \
+                             | OperandFeatureFlags::kFeature_AddressRegister \
+                             | OperandFeatureFlags::kFeature_Advance,
+                },
+        },
+        {SimdOpCode::GATHER,
+                {
+                        .name = "ve_gather",
+                        .features = OperandFeatureFlags::kFeature_OperandSize \
+                             | OperandFeatureFlags::kFeature_AddressRegister,
+                },
+        },
+        {SimdOpCode::SCATTER,
+                {
+                        .name = "ve_scatter",
+                        .features = OperandFeatureFlags::kFeature_OperandSize \
+                             | OperandFeatureFlags::kFeature_AddressRegister,
+                },
+        },
         {SimdOpCode::VMUL,
                 {
                         .name = "ve_mul",
@@ -40,6 +70,24 @@ std::unordered_map<OperandCodeBase , OperandDescriptionBase> SIMDInstructionSetD
                              | OperandFeatureFlags::kFeature_Mask,
                 },
         },
+        {SimdOpCode::DP3,
+                {
+                        .name = "ve_dp3",
+                        .features = OperandFeatureFlags::kFeature_OperandSize,
+                },
+        },
+        {SimdOpCode::DP4,
+                {
+                        .name = "ve_dp4",
+                        .features = OperandFeatureFlags::kFeature_OperandSize,
+                },
+        },
+        {SimdOpCode::MAD,
+                {
+                        .name = "ve_mad",
+                        .features = OperandFeatureFlags::kFeature_OperandSize,
+                },
+        },
         {SimdOpCode::UNPCKFP8,
                 {
                         .name = "ve_unpckfp8",
@@ -71,13 +119,19 @@ std::unordered_map<OperandCodeBase , OperandDescriptionBase> SIMDInstructionSetD
 
 };
 
-const std::unordered_map<OperandCodeBase, OperandDescriptionBase> &SIMDInstructionSetDef::GetInstructionSet() {
+static constexpr OperandDescriptionTable instructionSet = BuildOperandDescriptionTable(instructionDefinitions);
+static constexpr MnemonicHash mnemonicHash = MnemonicHash::Build(instructionSet);
+
+const OperandDescriptionTable &SIMDInstructionSetDef::GetInstructionSet() {
     return instructionSet;
 }
 std::optional<OperandDescriptionBase> SIMDInstructionSetDef::GetOpDescFromClass(OperandCodeBase opClass) {
-    return {};
+    if (!instructionSet[opClass].isDefined) {
+        return {};
+    }
+    return instructionSet[opClass];
 }
 std::optional<OperandCodeBase> SIMDInstructionSetDef::GetOperandFromStr(const std::string &str) {
-    return {};
+    return mnemonicHash.Find(instructionSet, str);
 }
 
@@ -35,7 +35,8 @@ namespace gnilk {
         //
         // 128 bits makes it perhaps easier to implement in HW - lesser lines
         //
-        // => Need discussion!!
+        // => Both! The register is 512 bits but the vector length is an option of the core (128/256/512), see the
+        //    control register. 128 bits is the default, lanes beyond the vector length are not touched.
         //
         // a float is either
         // 1 posit 32 bit float
@@ -45,17 +46,45 @@ namespace gnilk {
             // Need this CTOR otherwise I get 'implicitly deleted due to...'
             // Something in the posit class makes this - and I have no intention of fixing it...
             SIMDRegisterData() {};
+            // The first 128 bits
             struct {
                 SIMDFloat a, b, c, d;
             } value;
-            fp32 values[4] = {};
+            fp32 values[16] = {};
+            // Same bits as lanes of the other sizes, lane 0 is 'a'
+            fp16 fp16Values[32];
+            fp8 fp8Values[64];
+            // Integer lanes (see kOpLowFlag_Integer) - also used to move the raw bits of the floats
+            int8_t i8[64];
+            int16_t i16[32];
+            int32_t i32[16];
+            int64_t i64[8];
         };
-        // FIXME: define bit flags
+        static_assert(sizeof(fp8) == sizeof(int8_t) && sizeof(fp16) == sizeof(int16_t) && sizeof(fp32) == sizeof(int32_t));
+        static_assert(sizeof(SIMDRegisterData) == 64);
+
+        // Lower bits are the active vector length, the features tell which lengths the core supports (read only)
+        typedef enum : uint64_t {
+            kSimdControl_VL128 = 0b00,
+            kSimdControl_VL256 = 0b01,
+            kSimdControl_VL512 = 0b10,
+            kSimdControl_VLMask = 0b11,
+
+            kSimdFeature_VL128 = 0x0100,
+            kSimdFeature_VL256 = 0x0200,
+            kSimdFeature_VL512 = 0x0400,
+        } kSimdControlBits;
+
         struct SIMDControlRegister {
             // Features are also here
             // TBD: rounding, exceptions, sz-support bits (4 bits - fp8, fp16, fp32, fp64) etc...
             //
-            uint64_t bits;
+            uint64_t bits = 0;
+
+            // Active vector length in bytes
+            size_t VectorBytes() const {
+                return size_t(16) << (bits & kSimdControl_VLMask);
+            }
         };
         // FIXME: define bit flags
         struct SIMDStatusRegister {
@@ -72,6 +101,11 @@ namespace gnilk {
             SIMDControlRegister control;                // status register
         };
 
+        // Per core options (see CPUBase::GetExtensionConfig), the control register is set up from these
+        struct SIMDConfig {
+            kSimdControlBits vectorLength = kSimdControl_VL128;
+        };
+
         // This is the SIMD/CU instruction set extension for VCPU
         // One can use this 'as-is' with a RAW instruction stream or through the generic CPU InstructionBase
         // which will then be mapped through one of the 15 extensions (0xf0..0xfe)
@@ -123,6 +157,12 @@ namespace gnilk {
         //      ve_store.<sz>   (<dst>),<ve_src>,<mask>   ; store according to mask
         //      ve_store.<sz>   (<dst>)+,<ve_src>,<mask>   ; store according to mask, with advance
         //
+        //  strided and indexed load/store - lanes hitting the same cache line are coalesced into one line access
+        //      ve_loads.<sz>   <ve_dst>,(<src>)[+],<dreg>     ; lane[i] = mem[src + i*dreg], advance by the lanes*stride
+        //      ve_stores.<sz>  (<dst>)[+],<ve_src>,<dreg>     ; mem[dst + i*dreg] = lane[i]
+        //      ve_gather.<sz>  <ve_dst>,(<src>),<ve_idx>      ; lane[i] = mem[src + idx[i]*sizeof(lane)]
+        //      ve_scatter.<sz> (<dst>),<ve_src>,<ve_idx>      ; mem[dst + idx[i]*sizeof(lane)] = lane[i]
+        //
         //  converting
         //      ve_unpckfp8.fp32    <ve_dst>,<ve_src_fp8>, mask <- unpack fp8 to fp32 - mask selects which group of 4 fp8 values
         //      ve_unpckfp16.fp32   <ve_dst>,<ve_src_fp16>, mask <- unpack fp16 to fp32 - mask selects which group of 2 fp16 values
@@ -132,6 +172,9 @@ namespace gnilk {
         //  operations
         //      ve_mul.<sz>     <dst>,<srcA>,<srcB>     ; dst should not be same as source
         //      ve_hadd.<sz>    <dst>,<srcA>,<srcB>     ; dst and source may be same
+        //      ve_dp3.<sz>     <dst>,<srcA>,<srcB>     ; dot product of each group of 4 lanes (first 3), result in all 4
+        //      ve_dp4.<sz>     <dst>,<srcA>,<srcB>     ; dot product of each group of 4 lanes, result in all 4
+        //      ve_mad.<sz>     <dst>,<srcA>,<srcB>     ; dst = srcA * srcB + dst
         //
         //
         //
@@ -188,6 +231,12 @@ namespace gnilk {
             kOpFlag_SrcAddrReg = 0b0001'0000,
         } kSimdOpFlags;
 
+        // Upper nibble of the third byte, the lower nibble is the destination register
+        typedef enum : uint8_t {
+            kOpLowFlag_Integer = 0b0001'0000,   // lanes are signed integers of op.size bits (8,16,32,64) - otherwise posits
+            kOpLowFlag_Advance = 0b0010'0000,   // load/store - advance the address register by the vector length
+        } kSimdOpLowFlags;
+
         static const uint8_t kSimdFlagOpSizeBitMask = 0b1100'0000;
         static const uint8_t kSimdFlagAddrRegBitMask = 0b0011'0000;
 
@@ -201,9 +250,16 @@ namespace gnilk {
             // Place these at 'MOV' for regular instr. set
             LOAD = 0x20,           // load
             STORE,          // store
+            LOADS = 0x22,          // strided load, stride in bytes from a data register
+            STORES = 0x23,         // strided store
+            GATHER = 0x24,         // indexed load, element indices from a vector register
+            SCATTER = 0x25,        // indexed store
             //
             HADD = 0x30,           // horizontal add
             VMUL = 0x31,           // vector multiplication
+            DP3 = 0x32,            // 3-component dot product, per group of 4 lanes
+            DP4 = 0x33,            // 4-component dot product, per group of 4 lanes
+            MAD = 0x34,            // multiply and add
             //
             UNPCKFP8  = 0x40,      // Unpack FP8
             UNPCKFP16 = 0x41,      // Unpack FP16
@@ -222,8 +278,6 @@ namespace gnilk {
 //            DIV,            // divide
 //            DP2,            // 2-component dot product
 //            DP2A,           // 2-component dot product w/scalar add
-//            DP3,            // 3-component dot product
-//            DP4,            // 4-component dot product
 //            DPH,            // homogeneous dot product
 //            DST,            // distance vector
 //            EX2,            // exponential base 2
@@ -232,7 +286,6 @@ namespace gnilk {
 //            I2F,            // int 2 float
 //            LG2,            // lograithm base 2
 //            LRP,            // lerp - linerar interpolation
-//            MAD,            // multiply and add
 //            MAX,            // max
 //            MIN,            // min
 //            MOD,            // modulus per component by scalar
@@ -306,7 +359,7 @@ namespace gnilk {
         class SIMDInstructionSetDef : public InstructionSetDefBase {
         public:
             //std::unordered_map<SimdOpCode, SimdOperandDescription> &GetInstructionSet();
-            const std::unordered_map<OperandCodeBase, OperandDescriptionBase> &GetInstructionSet() override;
+            const OperandDescriptionTable &GetInstructionSet() override;
             std::optional<OperandDescriptionBase> GetOpDescFromClass(OperandCodeBase opClass) override;
             std::optional<OperandCodeBase> GetOperandFromStr(const std::string &str) override;
         public:
@@ -332,8 +385,6 @@ namespace gnilk {
                 };
 
             };
-        private:
-            static std::unordered_map<OperandCodeBase, OperandDescriptionBase> instructionSet;
         };
 
 
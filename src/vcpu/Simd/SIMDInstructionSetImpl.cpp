@@ -2,12 +2,266 @@
 // Created by gnilk on 24.05.24.
 //
 
+#include <string.h>
+#include <type_traits>
+
 #include "SIMDInstructionSetImpl.h"
 #include "SIMDInstructionDecoder.h"
 #include "SIMDInstructionSetDef.h"
 
 using namespace gnilk;
 using namespace gnilk::vcpu;
+
+static const size_t kMaxVectorBytes = sizeof(SIMDRegisterData);
+// The integer and fp8 kernels work on 128 bits at a time
+static const size_t kKernelBytes = 16;
+static const size_t kNumAddressRegisters = sizeof(Registers::addressRegisters) / sizeof(RegisterValue);
+static const size_t kNumDataRegisters = sizeof(Registers::dataRegisters) / sizeof(RegisterValue);
+
+static size_t LaneBytes(kSimdOpSize opSize) {
+    return size_t(1) << (opSize >> 6);
+}
+static size_t NumLanes(size_t vectorBytes, kSimdOpSize opSize) {
+    return vectorBytes / LaneBytes(opSize);
+}
+
+// One mask bit per quarter of the vector, MSB is lane 0
+static bool IsLaneEnabled(uint8_t mask, size_t lane, size_t numLanes) {
+    if (mask == 0) {
+        return true;
+    }
+    auto quarter = (lane * 4) / numLanes;
+    return (mask & (0x08 >> quarter)) != 0;
+}
+
+// Lanes <-> memory bytes, each lane in guest byte order
+template<typename T>
+static void LanesFromBytes(T *lanes, const uint8_t *data, size_t numLanes, uint8_t mask) {
+    for(size_t i=0;i<numLanes;i++) {
+        if (IsLaneEnabled(mask, i, numLanes)) {
+            lanes[i] = static_cast<T>(MMU::FromByteStream<std::make_unsigned_t<T>>(data + i * sizeof(T)));
+        }
+    }
+}
+
+template<typename T>
+static void LanesToBytes(uint8_t *data, const T *lanes, size_t numLanes) {
+    for(size_t i=0;i<numLanes;i++) {
+        MMU::ToByteStream<std::make_unsigned_t<T>>(data + i * sizeof(T), static_cast<std::make_unsigned_t<T>>(lanes[i]));
+    }
+}
+
+//
+// Lanes at arbitrary addresses, lanes hitting the same cache line are read/written with one line access.
+// Lanes crossing a line and memory which isn't cacheable are accessed one by one.
+//
+static const uint64_t kLineMask = GNK_L1_CACHE_LINE_SIZE - 1;
+
+static bool IsWithinLine(uint64_t address, size_t nBytes) {
+    return ((address & kLineMask) + nBytes) <= GNK_L1_CACHE_LINE_SIZE;
+}
+
+template<typename T>
+static void GatherLanes(MMU &mmu, T *lanes, const uint64_t *addresses, size_t numLanes, uint8_t mask) {
+    using TU = std::make_unsigned_t<T>;
+    bool isDone[kMaxVectorBytes] = {};
+    uint8_t line[GNK_L1_CACHE_LINE_SIZE];
+    for(size_t i=0;i<numLanes;i++) {
+        if (isDone[i] || !IsLaneEnabled(mask, i, numLanes)) {
+            continue;
+        }
+        auto lineAddress = addresses[i] & ~kLineMask;
+        if (!IsWithinLine(addresses[i], sizeof(T)) || !mmu.ReadLine(lineAddress, line)) {
+            lanes[i] = static_cast<T>(mmu.Read<TU>(addresses[i]));
+            continue;
+        }
+        for(size_t j=i;j<numLanes;j++) {
+            if (isDone[j] || !IsLaneEnabled(mask, j, numLanes)) {
+                continue;
+            }
+            if (((addresses[j] & ~kLineMask) != lineAddress) || !IsWithinLine(addresses[j], sizeof(T))) {
+                continue;
+            }
+            lanes[j] = static_cast<T>(MMU::FromByteStream<TU>(line + (addresses[j] & kLineMask)));
+            isDone[j] = true;
+        }
+    }
+}
+
+// If lanes overlap the highest lane wins
+template<typename T>
+static void ScatterLanes(MMU &mmu, const uint64_t *addresses, const T *lanes, size_t numLanes, uint8_t mask) {
+    using TU = std::make_unsigned_t<T>;
+    bool isDone[kMaxVectorBytes] = {};
+    uint8_t line[GNK_L1_CACHE_LINE_SIZE];
+    for(size_t i=0;i<numLanes;i++) {
+        if (isDone[i] || !IsLaneEnabled(mask, i, numLanes)) {
+            continue;
+        }
+        auto lineAddress = addresses[i] & ~kLineMask;
+        if (!IsWithinLine(addresses[i], sizeof(T))) {
+            mmu.Write<TU>(addresses[i], static_cast<TU>(lanes[i]));
+            continue;
+        }
+        uint64_t byteMask = 0;
+        size_t lastLane = i;
+        for(size_t j=i;j<numLanes;j++) {
+            if (isDone[j] || !IsLaneEnabled(mask, j, numLanes)) {
+                continue;
+            }
+            if (((addresses[j] & ~kLineMask) != lineAddress) || !IsWithinLine(addresses[j], sizeof(T))) {
+                continue;
+            }
+            auto offset = addresses[j] & kLineMask;
+            MMU::ToByteStream<TU>(line + offset, static_cast<TU>(lanes[j]));
+            byteMask |= ((uint64_t(1) << sizeof(T)) - 1) << offset;
+            isDone[j] = true;
+            lastLane = j;
+        }
+        if (mmu.WriteLineMasked(lineAddress, line, byteMask)) {
+            continue;
+        }
+        // Not cacheable, write the lanes of this line in order
+        for(size_t j=i;j<=lastLane;j++) {
+            if (isDone[j] && ((addresses[j] & ~kLineMask) == lineAddress) && IsWithinLine(addresses[j], sizeof(T))) {
+                mmu.Write<TU>(addresses[j], static_cast<TU>(lanes[j]));
+            }
+        }
+    }
+}
+
+template<typename T>
+static void MoveLanes(T *dst, const T *src, size_t numLanes, uint8_t mask) {
+    for(size_t i=0;i<numLanes;i++) {
+        if (IsLaneEnabled(mask, i, numLanes)) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+// Lane addresses for the strided and indexed load/store
+static void StridedAddresses(uint64_t *addresses, uint64_t base, int64_t stride, size_t numLanes) {
+    for(size_t i=0;i<numLanes;i++) {
+        addresses[i] = base + static_cast<uint64_t>(stride * static_cast<int64_t>(i));
+    }
+}
+
+template<typename T>
+static void IndexedAddresses(uint64_t *addresses, uint64_t base, const T *indices, size_t numLanes) {
+    for(size_t i=0;i<numLanes;i++) {
+        addresses[i] = base + static_cast<uint64_t>(static_cast<int64_t>(indices[i]) * static_cast<int64_t>(sizeof(T)));
+    }
+}
+
+template<typename T>
+static void Mul(void (*kernel)(T *, const T *, const T *), T *dst, const T *a, const T *b, size_t vectorBytes) {
+    for(size_t i=0;i<vectorBytes / sizeof(T);i+=kKernelBytes / sizeof(T)) {
+        kernel(dst + i, a + i, b + i);
+    }
+}
+
+// The pair-add kernels take both registers back to back
+template<typename T>
+static void PairAdd(void (*kernel)(T *, const T *), T *dst, const T *a, const T *b, size_t vectorBytes) {
+    static const size_t maxLanes = kMaxVectorBytes / sizeof(T);
+    T src[2 * maxLanes];
+    auto numLanes = vectorBytes / sizeof(T);
+    memcpy(src, a, vectorBytes);
+    memcpy(src + numLanes, b, vectorBytes);
+    for(size_t i=0;i<numLanes;i+=kKernelBytes / sizeof(T)) {
+        kernel(dst + i, src + 2 * i);
+    }
+}
+
+// Integer lanes wrap around, the arithmetic is done unsigned
+template<typename T>
+static void DotInt(T *dst, const T *a, const T *b, size_t numLanes, size_t numComponents) {
+    for(size_t group=0;group<numLanes;group+=4) {
+        uint64_t sum = 0;
+        for(size_t i=0;i<numComponents;i++) {
+            sum += static_cast<uint64_t>(a[group + i]) * static_cast<uint64_t>(b[group + i]);
+        }
+        for(size_t i=0;i<4;i++) {
+            dst[group + i] = static_cast<T>(sum);
+        }
+    }
+}
+
+template<typename T>
+static void MadInt(T *dst, const T *a, const T *b, size_t numLanes) {
+    for(size_t i=0;i<numLanes;i++) {
+        dst[i] = static_cast<T>(static_cast<uint64_t>(a[i]) * static_cast<uint64_t>(b[i]) + static_cast<uint64_t>(dst[i]));
+    }
+}
+
+// Lanes [first, first+n) as host floats - fp8/fp16 go through the tables (see SIMDPositTables), n is a multiple of 4
+static void DecodeLanes(const SIMDKernels &kernels, float *dst, const SIMDRegisterData &reg, kSimdOpSize opSize, size_t first, size_t n) {
+    switch(opSize) {
+        case kSimdOpSize::kOpSize_Fp8 :
+            kernels.Fp8ToF32(dst, reg.i8 + first, n);
+            break;
+        case kSimdOpSize::kOpSize_Fp16 :
+            kernels.Fp16ToF32(dst, reg.i16 + first, n);
+            break;
+        default:
+            for(size_t i=0;i<n;i++) {
+                dst[i] = static_cast<float>(reg.values[first + i]);
+            }
+            break;
+    }
+}
+
+static void EncodeLanes(const SIMDKernels &kernels, SIMDRegisterData &reg, kSimdOpSize opSize, size_t first, const float *src, size_t n) {
+    switch(opSize) {
+        case kSimdOpSize::kOpSize_Fp8 :
+            kernels.F32ToFp8(reg.i8 + first, src, n);
+            break;
+        case kSimdOpSize::kOpSize_Fp16 :
+            kernels.F32ToFp16(reg.i16 + first, src, n);
+            break;
+        default:
+            for(size_t i=0;i<n;i++) {
+                reg.values[first + i] = fp32(src[i]);
+            }
+            break;
+    }
+}
+
+// Returns number of lanes, 0 if there is no float type of this size
+static size_t ToFloats(const SIMDKernels &kernels, float *dst, const SIMDRegisterData &reg, kSimdOpSize opSize, size_t vectorBytes) {
+    if (opSize == kSimdOpSize::kOpSize_Fp64) {
+        return 0;
+    }
+    auto numLanes = NumLanes(vectorBytes, opSize);
+    DecodeLanes(kernels, dst, reg, opSize, 0, numLanes);
+    return numLanes;
+}
+
+static void FromFloats(const SIMDKernels &kernels, SIMDRegisterData &reg, const float *src, kSimdOpSize opSize, size_t vectorBytes) {
+    EncodeLanes(kernels, reg, opSize, 0, src, NumLanes(vectorBytes, opSize));
+}
+
+static uint64_t ControlFromVectorLength(kSimdControlBits vectorLength) {
+    // a core supports all the shorter lengths as well
+    uint64_t features = kSimdControlBits::kSimdFeature_VL128;
+    if (vectorLength >= kSimdControlBits::kSimdControl_VL256) {
+        features |= kSimdControlBits::kSimdFeature_VL256;
+    }
+    if (vectorLength >= kSimdControlBits::kSimdControl_VL512) {
+        features |= kSimdControlBits::kSimdFeature_VL512;
+    }
+    return features | vectorLength;
+}
+
+void SIMDInstructionSetImpl::SetVectorLength(CPUBase &cpu, kSimdControlBits vectorLength) {
+    cpu.GetExtensionConfig<SIMDConfig>().vectorLength = vectorLength;
+    cpu.GetExtensionState<SIMDRegisters>().control.bits = ControlFromVectorLength(vectorLength);
+}
+
+static bool RaiseInvalidInstruction(CPUBase &cpu) {
+    return cpu.RaiseException(CPUKnownExceptions::kInvalidInstruction);
+}
+
 bool SIMDInstructionSetImpl::ExecuteInstruction(CPUBase &cpu) {
 
     SIMDInstructionSetDef::Operand decoderOutput;
@@ -16,17 +270,456 @@ bool SIMDInstructionSetImpl::ExecuteInstruction(CPUBase &cpu) {
         return false;
     }
 
+    auto &simdRegisters = cpu.GetExtensionState<SIMDRegisters>();
+    // First instruction after reset, the features are never zero
+    if (simdRegisters.control.bits == 0) {
+        simdRegisters.control.bits = ControlFromVectorLength(cpu.GetExtensionConfig<SIMDConfig>().vectorLength);
+    }
+
     switch(decoderOutput.opCode) {
         case SimdOpCode::LOAD :
-            ExecuteLoad(cpu, decoderOutput);
-            break;
+            return ExecuteLoad(cpu, simdRegisters, decoderOutput);
+        case SimdOpCode::STORE :
+            return ExecuteStore(cpu, simdRegisters, decoderOutput);
+        case SimdOpCode::LOADS :
+            return ExecuteLoadStrided(cpu, simdRegisters, decoderOutput);
+        case SimdOpCode::STORES :
+            return ExecuteStoreStrided(cpu, simdRegisters, decoderOutput);
+        case SimdOpCode::GATHER :
+            return ExecuteGather(cpu, simdRegisters, decoderOutput);
+        case SimdOpCode::SCATTER :
+            return ExecuteScatter(cpu, simdRegisters, decoderOutput);
+        case SimdOpCode::VMUL :
+            return ExecuteMul(cpu, simdRegisters, decoderOutput);
+        case SimdOpCode::HADD :
+            return ExecuteHAdd(cpu, simdRegisters, decoderOutput);
+        case SimdOpCode::DP3 :
+            return ExecuteDot(cpu, simdRegisters, decoderOutput, 3);
+        case SimdOpCode::DP4 :
+            return ExecuteDot(cpu, simdRegisters, decoderOutput, 4);
+        case SimdOpCode::MAD :
+            return ExecuteMad(cpu, simdRegisters, decoderOutput);
+        case SimdOpCode::UNPCKFP8 :
+            return ExecuteUnpack(cpu, simdRegisters, decoderOutput, kSimdOpSize::kOpSize_Fp8);
+        case SimdOpCode::UNPCKFP16 :
+            return ExecuteUnpack(cpu, simdRegisters, decoderOutput, kSimdOpSize::kOpSize_Fp16);
+        case SimdOpCode::PACKFP16 :
+            return ExecutePack(cpu, simdRegisters, decoderOutput, kSimdOpSize::kOpSize_Fp16);
+        case SimdOpCode::PACKFP32 :
+            return ExecutePack(cpu, simdRegisters, decoderOutput, kSimdOpSize::kOpSize_Fp32);
         default:
-            return false;
+            fmt::println(stderr, "[SIMD] Invalid operand: {} - raising exception handler (if available)", decoderOutput.opCodeByte);
+            return RaiseInvalidInstruction(cpu);
+    }
+}
+
+//
+// ve_load.<sz> v<dst>,(a<srcA>)[+],<mask>
+// ve_load.<sz> v<dst>,v<srcA>,<mask>       ; without the address register flag this is a move
+//
+// The whole vector is read in one go, an aligned 512 bit vector is exactly one cache line
+//
+bool SIMDInstructionSetImpl::ExecuteLoad(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand) {
+    auto &dst = simdRegisters.registers[operand.opDstRegIndex];
+    auto vectorBytes = simdRegisters.control.VectorBytes();
+    auto numLanes = NumLanes(vectorBytes, operand.opSize);
+
+    if (operand.opAddrMode != kSimdAddrMode::kOpAddrMode_SrcReg) {
+        auto &src = simdRegisters.registers[operand.opSrcAIndex];
+        switch(LaneBytes(operand.opSize)) {
+            case 1 : MoveLanes(dst.i8, src.i8, numLanes, operand.opMask); break;
+            case 2 : MoveLanes(dst.i16, src.i16, numLanes, operand.opMask); break;
+            case 4 : MoveLanes(dst.i32, src.i32, numLanes, operand.opMask); break;
+            default : MoveLanes(dst.i64, src.i64, numLanes, operand.opMask); break;
+        }
+        return true;
+    }
+
+    if (operand.opSrcAIndex >= kNumAddressRegisters) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    auto &addrReg = cpu.GetRegisters().addressRegisters[operand.opSrcAIndex];
+    uint8_t data[kMaxVectorBytes];
+    cpu.memoryUnit.ReadBlock(addrReg.data.longword, data, vectorBytes);
+    switch(LaneBytes(operand.opSize)) {
+        case 1 : LanesFromBytes(dst.i8, data, numLanes, operand.opMask); break;
+        case 2 : LanesFromBytes(dst.i16, data, numLanes, operand.opMask); break;
+        case 4 : LanesFromBytes(dst.i32, data, numLanes, operand.opMask); break;
+        default : LanesFromBytes(dst.i64, data, numLanes, operand.opMask); break;
+    }
+    if (operand.opFlagsLowBits & kSimdOpLowFlags::kOpLowFlag_Advance) {
+        addrReg.data.longword += vectorBytes;
     }
-    // Now we can proceed...
     return true;
 }
 
-void SIMDInstructionSetImpl::ExecuteLoad(CPUBase &cpu, SIMDInstructionSetDef::Operand &operand) {
-    printf("Execute Load\n");
-}
\ No newline at end of file
+//
+// ve_store.<sz> (a<dst>)[+],v<srcA>,<mask>
+//
+// Without mask the whole vector is written in one go, a masked store only writes the enabled lanes (still one
+// access per cache line)
+//
+bool SIMDInstructionSetImpl::ExecuteStore(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand) {
+    if ((operand.opAddrMode != kSimdAddrMode::kOpAddrMode_DstReg) || (operand.opDstRegIndex >= kNumAddressRegisters)) {
+        return RaiseInvalidInstruction(cpu);
+    }
+
+    auto &src = simdRegisters.registers[operand.opSrcAIndex];
+    auto &addrReg = cpu.GetRegisters().addressRegisters[operand.opDstRegIndex];
+    auto address = addrReg.data.longword;
+    auto vectorBytes = simdRegisters.control.VectorBytes();
+    auto numLanes = NumLanes(vectorBytes, operand.opSize);
+
+    if (operand.opMask == 0) {
+        uint8_t data[kMaxVectorBytes];
+        switch(LaneBytes(operand.opSize)) {
+            case 1 : LanesToBytes(data, src.i8, numLanes); break;
+            case 2 : LanesToBytes(data, src.i16, numLanes); break;
+            case 4 : LanesToBytes(data, src.i32, numLanes); break;
+            default : LanesToBytes(data, src.i64, numLanes); break;
+        }
+        cpu.memoryUnit.WriteBlock(address, data, vectorBytes);
+    } else {
+        uint64_t addresses[kMaxVectorBytes];
+        StridedAddresses(addresses, address, static_cast<int64_t>(LaneBytes(operand.opSize)), numLanes);
+        switch(LaneBytes(operand.opSize)) {
+            case 1 : ScatterLanes(cpu.memoryUnit, addresses, src.i8, numLanes, operand.opMask); break;
+            case 2 : ScatterLanes(cpu.memoryUnit, addresses, src.i16, numLanes, operand.opMask); break;
+            case 4 : ScatterLanes(cpu.memoryUnit, addresses, src.i32, numLanes, operand.opMask); break;
+            default : ScatterLanes(cpu.memoryUnit, addresses, src.i64, numLanes, operand.opMask); break;
+        }
+    }
+    if (operand.opFlagsLowBits & kSimdOpLowFlags::kOpLowFlag_Advance) {
+        addrReg.data.longword += vectorBytes;
+    }
+    return true;
+}
+
+//
+// ve_loads.<sz> v<dst>,(a<srcA>)[+],d<srcB>    ; dst[i] = mem[a + i * d], advance by the lanes times the stride
+//
+bool SIMDInstructionSetImpl::ExecuteLoadStrided(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand) {
+    auto &registers = cpu.GetRegisters();
+    if ((operand.opAddrMode != kSimdAddrMode::kOpAddrMode_SrcReg) || (operand.opSrcAIndex >= kNumAddressRegisters) ||
+        (operand.opSrcBIndex >= kNumDataRegisters)) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    auto &dst = simdRegisters.registers[operand.opDstRegIndex];
+    auto &addrReg = registers.addressRegisters[operand.opSrcAIndex];
+    auto stride = static_cast<int64_t>(registers.dataRegisters[operand.opSrcBIndex].data.longword);
+    auto numLanes = NumLanes(simdRegisters.control.VectorBytes(), operand.opSize);
+
+    uint64_t addresses[kMaxVectorBytes];
+    StridedAddresses(addresses, addrReg.data.longword, stride, numLanes);
+    switch(LaneBytes(operand.opSize)) {
+        case 1 : GatherLanes(cpu.memoryUnit, dst.i8, addresses, numLanes, 0); break;
+        case 2 : GatherLanes(cpu.memoryUnit, dst.i16, addresses, numLanes, 0); break;
+        case 4 : GatherLanes(cpu.memoryUnit, dst.i32, addresses, numLanes, 0); break;
+        default : GatherLanes(cpu.memoryUnit, dst.i64, addresses, numLanes, 0); break;
+    }
+    if (operand.opFlagsLowBits & kSimdOpLowFlags::kOpLowFlag_Advance) {
+        addrReg.data.longword += static_cast<uint64_t>(stride * static_cast<int64_t>(numLanes));
+    }
+    return true;
+}
+
+//
+// ve_stores.<sz> (a<dst>)[+],v<srcA>,d<srcB>   ; mem[a + i * d] = srcA[i]
+//
+bool SIMDInstructionSetImpl::ExecuteStoreStrided(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand) {
+    auto &registers = cpu.GetRegisters();
+    if ((operand.opAddrMode != kSimdAddrMode::kOpAddrMode_DstReg) || (operand.opDstRegIndex >= kNumAddressRegisters) ||
+        (operand.opSrcBIndex >= kNumDataRegisters)) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    auto &src = simdRegisters.registers[operand.opSrcAIndex];
+    auto &addrReg = registers.addressRegisters[operand.opDstRegIndex];
+    auto stride = static_cast<int64_t>(registers.dataRegisters[operand.opSrcBIndex].data.longword);
+    auto numLanes = NumLanes(simdRegisters.control.VectorBytes(), operand.opSize);
+
+    uint64_t addresses[kMaxVectorBytes];
+    StridedAddresses(addresses, addrReg.data.longword, stride, numLanes);
+    switch(LaneBytes(operand.opSize)) {
+        case 1 : ScatterLanes(cpu.memoryUnit, addresses, src.i8, numLanes, 0); break;
+        case 2 : ScatterLanes(cpu.memoryUnit, addresses, src.i16, numLanes, 0); break;
+        case 4 : ScatterLanes(cpu.memoryUnit, addresses, src.i32, numLanes, 0); break;
+        default : ScatterLanes(cpu.memoryUnit, addresses, src.i64, numLanes, 0); break;
+    }
+    if (operand.opFlagsLowBits & kSimdOpLowFlags::kOpLowFlag_Advance) {
+        addrReg.data.longword += static_cast<uint64_t>(stride * static_cast<int64_t>(numLanes));
+    }
+    return true;
+}
+
+//
+// ve_gather.<sz> v<dst>,(a<srcA>),v<srcB>      ; dst[i] = mem[a + srcB[i] * sizeof(lane)]
+// The indices are signed integers of the lane size
+//
+bool SIMDInstructionSetImpl::ExecuteGather(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand) {
+    if ((operand.opAddrMode != kSimdAddrMode::kOpAddrMode_SrcReg) || (operand.opSrcAIndex >= kNumAddressRegisters)) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    auto &dst = simdRegisters.registers[operand.opDstRegIndex];
+    auto &indices = simdRegisters.registers[operand.opSrcBIndex];
+    auto base = cpu.GetRegisters().addressRegisters[operand.opSrcAIndex].data.longword;
+    auto numLanes = NumLanes(simdRegisters.control.VectorBytes(), operand.opSize);
+
+    // dst and the indices may be the same register
+    uint64_t addresses[kMaxVectorBytes];
+    switch(LaneBytes(operand.opSize)) {
+        case 1 :
+            IndexedAddresses(addresses, base, indices.i8, numLanes);
+            GatherLanes(cpu.memoryUnit, dst.i8, addresses, numLanes, 0);
+            break;
+        case 2 :
+            IndexedAddresses(addresses, base, indices.i16, numLanes);
+            GatherLanes(cpu.memoryUnit, dst.i16, addresses, numLanes, 0);
+            break;
+        case 4 :
+            IndexedAddresses(addresses, base, indices.i32, numLanes);
+            GatherLanes(cpu.memoryUnit, dst.i32, addresses, numLanes, 0);
+            break;
+        default :
+            IndexedAddresses(addresses, base, indices.i64, numLanes);
+            GatherLanes(cpu.memoryUnit, dst.i64, addresses, numLanes, 0);
+            break;
+    }
+    return true;
+}
+
+//
+// ve_scatter.<sz> (a<dst>),v<srcA>,v<srcB>     ; mem[a + srcB[i] * sizeof(lane)] = srcA[i]
+//
+bool SIMDInstructionSetImpl::ExecuteScatter(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand) {
+    if ((operand.opAddrMode != kSimdAddrMode::kOpAddrMode_DstReg) || (operand.opDstRegIndex >= kNumAddressRegisters)) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    auto &src = simdRegisters.registers[operand.opSrcAIndex];
+    auto &indices = simdRegisters.registers[operand.opSrcBIndex];
+    auto base = cpu.GetRegisters().addressRegisters[operand.opDstRegIndex].data.longword;
+    auto numLanes = NumLanes(simdRegisters.control.VectorBytes(), operand.opSize);
+
+    uint64_t addresses[kMaxVectorBytes];
+    switch(LaneBytes(operand.opSize)) {
+        case 1 :
+            IndexedAddresses(addresses, base, indices.i8, numLanes);
+            ScatterLanes(cpu.memoryUnit, addresses, src.i8, numLanes, 0);
+            break;
+        case 2 :
+            IndexedAddresses(addresses, base, indices.i16, numLanes);
+            ScatterLanes(cpu.memoryUnit, addresses, src.i16, numLanes, 0);
+            break;
+        case 4 :
+            IndexedAddresses(addresses, base, indices.i32, numLanes);
+            ScatterLanes(cpu.memoryUnit, addresses, src.i32, numLanes, 0);
+            break;
+        default :
+            IndexedAddresses(addresses, base, indices.i64, numLanes);
+            ScatterLanes(cpu.memoryUnit, addresses, src.i64, numLanes, 0);
+            break;
+    }
+    return true;
+}
+
+//
+// ve_mul.<sz> v<dst>,v<srcA>,v<srcB>   ; dst[i] = srcA[i] * srcB[i]
+//
+bool SIMDInstructionSetImpl::ExecuteMul(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand) {
+    auto &kernels = SIMDKernels::Get();
+    auto &dst = simdRegisters.registers[operand.opDstRegIndex];
+    auto &srcA = simdRegisters.registers[operand.opSrcAIndex];
+    auto &srcB = simdRegisters.registers[operand.opSrcBIndex];
+    auto vectorBytes = simdRegisters.control.VectorBytes();
+
+    if (operand.opFlagsLowBits & kSimdOpLowFlags::kOpLowFlag_Integer) {
+        switch(LaneBytes(operand.opSize)) {
+            case 1 : Mul(kernels.MulI8, dst.i8, srcA.i8, srcB.i8, vectorBytes); break;
+            case 2 : Mul(kernels.MulI16, dst.i16, srcA.i16, srcB.i16, vectorBytes); break;
+            case 4 : Mul(kernels.MulI32, dst.i32, srcA.i32, srcB.i32, vectorBytes); break;
+            default : Mul(kernels.MulI64, dst.i64, srcA.i64, srcB.i64, vectorBytes); break;
+        }
+        return true;
+    }
+
+    // fp8 has a table for the whole operation
+    if (operand.opSize == kSimdOpSize::kOpSize_Fp8) {
+        Mul(kernels.MulFp8, dst.i8, srcA.i8, srcB.i8, vectorBytes);
+        return true;
+    }
+
+    float a[kMaxVectorBytes], b[kMaxVectorBytes], result[kMaxVectorBytes];
+    auto numLanes = ToFloats(kernels, a, srcA, operand.opSize, vectorBytes);
+    if (numLanes == 0) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    ToFloats(kernels, b, srcB, operand.opSize, vectorBytes);
+    kernels.MulF32(result, a, b, numLanes);
+    FromFloats(kernels, dst, result, operand.opSize, vectorBytes);
+    return true;
+}
+
+//
+// ve_hadd.<sz> v<dst>,v<srcA>,v<srcB>  ; pairwise sums, srcA in the lower half of dst and srcB in the upper
+//                                        i.e. fp32 => dst = {a0+a1, a2+a3, b0+b1, b2+b3}
+//
+bool SIMDInstructionSetImpl::ExecuteHAdd(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand) {
+    auto &kernels = SIMDKernels::Get();
+    auto &dst = simdRegisters.registers[operand.opDstRegIndex];
+    auto &srcA = simdRegisters.registers[operand.opSrcAIndex];
+    auto &srcB = simdRegisters.registers[operand.opSrcBIndex];
+    auto vectorBytes = simdRegisters.control.VectorBytes();
+
+    if (operand.opFlagsLowBits & kSimdOpLowFlags::kOpLowFlag_Integer) {
+        switch(LaneBytes(operand.opSize)) {
+            case 1 : PairAdd(kernels.PairAddI8, dst.i8, srcA.i8, srcB.i8, vectorBytes); break;
+            case 2 : PairAdd(kernels.PairAddI16, dst.i16, srcA.i16, srcB.i16, vectorBytes); break;
+            case 4 : PairAdd(kernels.PairAddI32, dst.i32, srcA.i32, srcB.i32, vectorBytes); break;
+            default : PairAdd(kernels.PairAddI64, dst.i64, srcA.i64, srcB.i64, vectorBytes); break;
+        }
+        return true;
+    }
+
+    if (operand.opSize == kSimdOpSize::kOpSize_Fp8) {
+        PairAdd(kernels.PairAddFp8, dst.i8, srcA.i8, srcB.i8, vectorBytes);
+        return true;
+    }
+
+    float src[2 * kMaxVectorBytes], result[kMaxVectorBytes];
+    auto numLanes = ToFloats(kernels, src, srcA, operand.opSize, vectorBytes);
+    if (numLanes == 0) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    ToFloats(kernels, src + numLanes, srcB, operand.opSize, vectorBytes);
+    kernels.PairAddF32(result, src, 2 * numLanes);
+    FromFloats(kernels, dst, result, operand.opSize, vectorBytes);
+    return true;
+}
+
+//
+// ve_dp3.<sz> v<dst>,v<srcA>,v<srcB>   ; per group of 4 lanes; dst[0..3] = a0*b0 + a1*b1 + a2*b2
+// ve_dp4.<sz> v<dst>,v<srcA>,v<srcB>   ; per group of 4 lanes; dst[0..3] = a0*b0 + a1*b1 + a2*b2 + a3*b3
+//
+// So a 512 bit fp32 vector does four vec4 dot products (i.e. a 4x4 matrix times a vector) in one instruction.
+// Posits are rounded once, on the final sum. A vector with less than 4 lanes (i64 at VL128) is an invalid instruction.
+//
+bool SIMDInstructionSetImpl::ExecuteDot(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand, size_t numComponents) {
+    auto &dst = simdRegisters.registers[operand.opDstRegIndex];
+    auto &srcA = simdRegisters.registers[operand.opSrcAIndex];
+    auto &srcB = simdRegisters.registers[operand.opSrcBIndex];
+    auto vectorBytes = simdRegisters.control.VectorBytes();
+    auto numLanes = NumLanes(vectorBytes, operand.opSize);
+    if (numLanes < 4) {
+        return RaiseInvalidInstruction(cpu);
+    }
+
+    if (operand.opFlagsLowBits & kSimdOpLowFlags::kOpLowFlag_Integer) {
+        switch(LaneBytes(operand.opSize)) {
+            case 1 : DotInt(dst.i8, srcA.i8, srcB.i8, numLanes, numComponents); break;
+            case 2 : DotInt(dst.i16, srcA.i16, srcB.i16, numLanes, numComponents); break;
+            case 4 : DotInt(dst.i32, srcA.i32, srcB.i32, numLanes, numComponents); break;
+            default : DotInt(dst.i64, srcA.i64, srcB.i64, numLanes, numComponents); break;
+        }
+        return true;
+    }
+
+    auto &kernels = SIMDKernels::Get();
+    float a[kMaxVectorBytes], b[kMaxVectorBytes], products[kMaxVectorBytes], result[kMaxVectorBytes];
+    if (ToFloats(kernels, a, srcA, operand.opSize, vectorBytes) == 0) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    ToFloats(kernels, b, srcB, operand.opSize, vectorBytes);
+    kernels.MulF32(products, a, b, numLanes);
+    for(size_t group=0;group<numLanes;group+=4) {
+        float sum = 0.0f;
+        for(size_t i=0;i<numComponents;i++) {
+            sum += products[group + i];
+        }
+        for(size_t i=0;i<4;i++) {
+            result[group + i] = sum;
+        }
+    }
+    FromFloats(kernels, dst, result, operand.opSize, vectorBytes);
+    return true;
+}
+
+//
+// ve_mad.<sz> v<dst>,v<srcA>,v<srcB>   ; dst[i] = srcA[i] * srcB[i] + dst[i]
+//
+bool SIMDInstructionSetImpl::ExecuteMad(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand) {
+    auto &dst = simdRegisters.registers[operand.opDstRegIndex];
+    auto &srcA = simdRegisters.registers[operand.opSrcAIndex];
+    auto &srcB = simdRegisters.registers[operand.opSrcBIndex];
+    auto vectorBytes = simdRegisters.control.VectorBytes();
+    auto numLanes = NumLanes(vectorBytes, operand.opSize);
+
+    if (operand.opFlagsLowBits & kSimdOpLowFlags::kOpLowFlag_Integer) {
+        switch(LaneBytes(operand.opSize)) {
+            case 1 : MadInt(dst.i8, srcA.i8, srcB.i8, numLanes); break;
+            case 2 : MadInt(dst.i16, srcA.i16, srcB.i16, numLanes); break;
+            case 4 : MadInt(dst.i32, srcA.i32, srcB.i32, numLanes); break;
+            default : MadInt(dst.i64, srcA.i64, srcB.i64, numLanes); break;
+        }
+        return true;
+    }
+
+    auto &kernels = SIMDKernels::Get();
+    float a[kMaxVectorBytes], b[kMaxVectorBytes], acc[kMaxVectorBytes], result[kMaxVectorBytes];
+    if (ToFloats(kernels, a, srcA, operand.opSize, vectorBytes) == 0) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    ToFloats(kernels, b, srcB, operand.opSize, vectorBytes);
+    ToFloats(kernels, acc, dst, operand.opSize, vectorBytes);
+    kernels.MulF32(result, a, b, numLanes);
+    for(size_t i=0;i<numLanes;i++) {
+        result[i] += acc[i];
+    }
+    FromFloats(kernels, dst, result, operand.opSize, vectorBytes);
+    return true;
+}
+
+//
+// ve_unpckfp8.fp32 v<dst>,v<srcA>,<group>  ; dst = fp32(srcA.fp8[group*4 .. group*4+3])
+// Widens one group of narrow lanes to the full vector, op.size is the destination size
+//
+bool SIMDInstructionSetImpl::ExecuteUnpack(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand, kSimdOpSize srcSize) {
+    auto dstSize = operand.opSize;
+    if ((operand.opFlagsLowBits & kSimdOpLowFlags::kOpLowFlag_Integer) || (dstSize <= srcSize) || (dstSize == kSimdOpSize::kOpSize_Fp64)) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    auto &dst = simdRegisters.registers[operand.opDstRegIndex];
+    auto &src = simdRegisters.registers[operand.opSrcAIndex];
+    auto vectorBytes = simdRegisters.control.VectorBytes();
+
+    auto numDstLanes = NumLanes(vectorBytes, dstSize);
+    auto numGroups = NumLanes(vectorBytes, srcSize) / numDstLanes;
+    auto group = operand.opMask & (numGroups - 1);
+
+    // dst and src may be the same register
+    auto &kernels = SIMDKernels::Get();
+    float values[kMaxVectorBytes];
+    DecodeLanes(kernels, values, src, srcSize, group * numDstLanes, numDstLanes);
+    FromFloats(kernels, dst, values, dstSize, vectorBytes);
+    return true;
+}
+
+//
+// ve_packfp32.fp8 v<dst>,v<srcA>,<group>   ; dst.fp8[group*4 .. group*4+3] = fp8(srcA), other lanes of dst are kept
+// Narrows the full vector into one group of lanes, op.size is the destination size
+//
+bool SIMDInstructionSetImpl::ExecutePack(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand, kSimdOpSize srcSize) {
+    auto dstSize = operand.opSize;
+    if ((operand.opFlagsLowBits & kSimdOpLowFlags::kOpLowFlag_Integer) || (dstSize >= srcSize)) {
+        return RaiseInvalidInstruction(cpu);
+    }
+    auto &dst = simdRegisters.registers[operand.opDstRegIndex];
+    auto &src = simdRegisters.registers[operand.opSrcAIndex];
+    auto vectorBytes = simdRegisters.control.VectorBytes();
+
+    auto &kernels = SIMDKernels::Get();
+    float values[kMaxVectorBytes];
+    auto numSrcLanes = ToFloats(kernels, values, src, srcSize, vectorBytes);
+    auto numGroups = NumLanes(vectorBytes, dstSize) / numSrcLanes;
+    auto group = operand.opMask & (numGroups - 1);
+    EncodeLanes(kernels, dst, dstSize, group * numSrcLanes, values, numSrcLanes);
+    return true;
+}
@@ -7,16 +7,45 @@
 
 #include "InstructionSetV1/InstructionSetV1Impl.h"
 #include "SIMDInstructionSetDef.h"
+#include "SIMDKernels.h"
+
 namespace gnilk {
     namespace vcpu {
 
         class SIMDInstructionDecoder;
 
+        //
+        // Executes the SIMD extension, the register file lives with the core (see CPUBase::GetExtensionState).
+        //
+        // The vector length is a per core option (SetVectorLength) - 128, 256 or 512 bits, see SIMDControlRegister.
+        // Lanes follow the op.size (fp8 => 16 lanes per 128 bits, fp16 => 8, fp32 => 4), integer lanes (kOpLowFlag_Integer) also
+        // support 64 bits. Posit lanes are computed as host floats, fp8/fp16 are converted through tables and fp8
+        // mul/add come straight from tables (see SIMDPositTables). fp64 posits are reserved.
+        //
+        // The mask has one bit per quarter of the vector, MSB is lane 0 ('a') - 0 means all lanes.
+        // For unpack/pack the mask is instead the index of the group of narrow lanes to read/write.
+        //
+        // Lanes are stored with lane 0 at the lowest address, each lane in guest byte order (like MMU::Write).
+        // Masked, strided and indexed memory access coalesce the lanes per cache line (MMU::ReadLine/WriteLineMasked).
+        //
         class SIMDInstructionSetImpl : public InstructionSetImplBase {
         public:
             bool ExecuteInstruction(CPUBase &cpu) override;
+            // Kept over reset, the core supports all lengths up to this one
+            static void SetVectorLength(CPUBase &cpu, kSimdControlBits vectorLength);
         protected:
-            void ExecuteLoad(CPUBase &cpu, SIMDInstructionSetDef::Operand &operand);
+            bool ExecuteLoad(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand);
+            bool ExecuteStore(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand);
+            bool ExecuteLoadStrided(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand);
+            bool ExecuteStoreStrided(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand);
+            bool ExecuteGather(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand);
+            bool ExecuteScatter(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand);
+            bool ExecuteMul(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand);
+            bool ExecuteHAdd(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand);
+            bool ExecuteDot(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand, size_t numComponents);
+            bool ExecuteMad(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand);
+            bool ExecuteUnpack(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand, kSimdOpSize srcSize);
+            bool ExecutePack(CPUBase &cpu, SIMDRegisters &simdRegisters, SIMDInstructionSetDef::Operand &operand, kSimdOpSize srcSize);
         };
     }
 }
@@ -0,0 +1,353 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#include <string.h>
+#include <math.h>
+#include <type_traits>
+#include "SIMDKernels.h"
+#include "SIMDPositTables.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VCPU_SIMD_HOST_X86
+#include <immintrin.h>
+#endif
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+//
+// Scalar - reference and fallback
+//
+namespace {
+    // Wrap around on overflow - do the math unsigned, wide enough to avoid promotion to (signed) int
+    template<typename T>
+    static T WrapMul(T a, T b) {
+        using W = std::conditional_t<(sizeof(T) <= 4), uint32_t, uint64_t>;
+        return static_cast<T>(static_cast<W>(static_cast<std::make_unsigned_t<T>>(a)) * static_cast<W>(static_cast<std::make_unsigned_t<T>>(b)));
+    }
+    template<typename T>
+    static T WrapAdd(T a, T b) {
+        using W = std::conditional_t<(sizeof(T) <= 4), uint32_t, uint64_t>;
+        return static_cast<T>(static_cast<W>(static_cast<std::make_unsigned_t<T>>(a)) + static_cast<W>(static_cast<std::make_unsigned_t<T>>(b)));
+    }
+
+    template<typename T>
+    static void ScalarMulI(T *dst, const T *a, const T *b) {
+        for(size_t i=0;i<16/sizeof(T);i++) {
+            dst[i] = WrapMul(a[i], b[i]);
+        }
+    }
+    template<typename T>
+    static void ScalarPairAddI(T *dst, const T *src) {
+        for(size_t i=0;i<16/sizeof(T);i++) {
+            dst[i] = WrapAdd(src[2*i], src[2*i+1]);
+        }
+    }
+
+    static void ScalarMulF32(float *dst, const float *a, const float *b, size_t n) {
+        for(size_t i=0;i<n;i++) {
+            dst[i] = a[i] * b[i];
+        }
+    }
+    static void ScalarPairAddF32(float *dst, const float *src, size_t n) {
+        for(size_t i=0;i<n/2;i++) {
+            dst[i] = src[2*i] + src[2*i+1];
+        }
+    }
+
+    static void ScalarFp8ToF32(float *dst, const int8_t *src, size_t n) {
+        auto &tables = SIMDPositTables::Instance();
+        for(size_t i=0;i<n;i++) {
+            dst[i] = tables.Fp8ToFloat(src[i]);
+        }
+    }
+    static void ScalarFp16ToF32(float *dst, const int16_t *src, size_t n) {
+        auto &tables = SIMDPositTables::Instance();
+        for(size_t i=0;i<n;i++) {
+            dst[i] = tables.Fp16ToFloat(src[i]);
+        }
+    }
+    static void ScalarF32ToFp8(int8_t *dst, const float *src, size_t n) {
+        auto &tables = SIMDPositTables::Instance();
+        for(size_t i=0;i<n;i++) {
+            dst[i] = tables.FloatToFp8(src[i]);
+        }
+    }
+    static void ScalarF32ToFp16(int16_t *dst, const float *src, size_t n) {
+        auto &tables = SIMDPositTables::Instance();
+        for(size_t i=0;i<n;i++) {
+            dst[i] = tables.FloatToFp16(src[i]);
+        }
+    }
+    static void ScalarMulFp8(int8_t *dst, const int8_t *a, const int8_t *b) {
+        auto &tables = SIMDPositTables::Instance();
+        for(size_t i=0;i<16;i++) {
+            dst[i] = tables.MulFp8(a[i], b[i]);
+        }
+    }
+    static void ScalarPairAddFp8(int8_t *dst, const int8_t *src) {
+        auto &tables = SIMDPositTables::Instance();
+        for(size_t i=0;i<16;i++) {
+            dst[i] = tables.AddFp8(src[2*i], src[2*i+1]);
+        }
+    }
+}
+
+static const SIMDKernels kernelsScalar = {
+    .level = SIMDKernelLevel::Scalar,
+    .MulF32 = ScalarMulF32,
+    .PairAddF32 = ScalarPairAddF32,
+    .MulI8 = ScalarMulI<int8_t>,
+    .MulI16 = ScalarMulI<int16_t>,
+    .MulI32 = ScalarMulI<int32_t>,
+    .MulI64 = ScalarMulI<int64_t>,
+    .PairAddI8 = ScalarPairAddI<int8_t>,
+    .PairAddI16 = ScalarPairAddI<int16_t>,
+    .PairAddI32 = ScalarPairAddI<int32_t>,
+    .PairAddI64 = ScalarPairAddI<int64_t>,
+    .Fp8ToF32 = ScalarFp8ToF32,
+    .Fp16ToF32 = ScalarFp16ToF32,
+    .F32ToFp8 = ScalarF32ToFp8,
+    .F32ToFp16 = ScalarF32ToFp16,
+    .MulFp8 = ScalarMulFp8,
+    .PairAddFp8 = ScalarPairAddFp8,
+};
+
+#ifdef VCPU_SIMD_HOST_X86
+//
+// SSE4.2 (and what it implies; SSE3 hadd, SSSE3 phadd, SSE4.1 pmulld)
+// There is no 8 bit multiply and no 64 bit multiply/horizontal add before AVX-512 - those stay scalar
+//
+namespace {
+    __attribute__((target("sse4.2")))
+    static void SSEMulF32(float *dst, const float *a, const float *b, size_t n) {
+        for(size_t i=0;i<n;i+=4) {
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+    }
+    __attribute__((target("sse4.2")))
+    static void SSEPairAddF32(float *dst, const float *src, size_t n) {
+        for(size_t i=0;i<n;i+=8) {
+            _mm_storeu_ps(dst + i/2, _mm_hadd_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(src + i + 4)));
+        }
+    }
+    __attribute__((target("sse4.2")))
+    static void SSEMulI16(int16_t *dst, const int16_t *a, const int16_t *b) {
+        auto res = _mm_mullo_epi16(_mm_loadu_si128((const __m128i *)a), _mm_loadu_si128((const __m128i *)b));
+        _mm_storeu_si128((__m128i *)dst, res);
+    }
+    __attribute__((target("sse4.2")))
+    static void SSEMulI32(int32_t *dst, const int32_t *a, const int32_t *b) {
+        auto res = _mm_mullo_epi32(_mm_loadu_si128((const __m128i *)a), _mm_loadu_si128((const __m128i *)b));
+        _mm_storeu_si128((__m128i *)dst, res);
+    }
+    __attribute__((target("sse4.2")))
+    static void SSEPairAddI16(int16_t *dst, const int16_t *src) {
+        auto res = _mm_hadd_epi16(_mm_loadu_si128((const __m128i *)src), _mm_loadu_si128((const __m128i *)(src + 8)));
+        _mm_storeu_si128((__m128i *)dst, res);
+    }
+    __attribute__((target("sse4.2")))
+    static void SSEPairAddI32(int32_t *dst, const int32_t *src) {
+        auto res = _mm_hadd_epi32(_mm_loadu_si128((const __m128i *)src), _mm_loadu_si128((const __m128i *)(src + 4)));
+        _mm_storeu_si128((__m128i *)dst, res);
+    }
+
+    //
+    // AVX2 - only pays off for the float lanes, the fp8/fp16 registers unpack to 16/8 host floats
+    // The integer registers are 128 bits, they use the SSE versions
+    //
+    __attribute__((target("avx2")))
+    static void AVX2MulF32(float *dst, const float *a, const float *b, size_t n) {
+        size_t i = 0;
+        for(;i+8<=n;i+=8) {
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        }
+        if (i < n) {
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+    }
+    __attribute__((target("avx2")))
+    static void AVX2PairAddF32(float *dst, const float *src, size_t n) {
+        size_t i = 0;
+        for(;i+16<=n;i+=16) {
+            // hadd works within the 128 bit halves: a01,a23,b01,b23 | a45,a67,b45,b67 - swap the middle pairs
+            auto sum = _mm256_hadd_ps(_mm256_loadu_ps(src + i), _mm256_loadu_ps(src + i + 8));
+            sum = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), 0b11'01'10'00));
+            _mm256_storeu_ps(dst + i/2, sum);
+        }
+        if (i < n) {
+            _mm_storeu_ps(dst + i/2, _mm_hadd_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(src + i + 4)));
+        }
+    }
+
+    __attribute__((target("avx2")))
+    static void AVX2Fp8ToF32(float *dst, const int8_t *src, size_t n) {
+        auto table = SIMDPositTables::Instance().fp8Values.data();
+        size_t i = 0;
+        for(;i+8<=n;i+=8) {
+            auto idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + i)));
+            _mm256_storeu_ps(dst + i, _mm256_i32gather_ps(table, idx, 4));
+        }
+        if (i < n) {
+            int32_t packed;
+            memcpy(&packed, src + i, sizeof(packed));
+            auto idx = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+            _mm_storeu_ps(dst + i, _mm_i32gather_ps(table, idx, 4));
+        }
+    }
+    __attribute__((target("avx2")))
+    static void AVX2Fp16ToF32(float *dst, const int16_t *src, size_t n) {
+        auto table = SIMDPositTables::Instance().fp16Values.data();
+        size_t i = 0;
+        for(;i+8<=n;i+=8) {
+            auto idx = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+            _mm256_storeu_ps(dst + i, _mm256_i32gather_ps(table, idx, 4));
+        }
+        if (i < n) {
+            auto idx = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(src + i)));
+            _mm_storeu_ps(dst + i, _mm_i32gather_ps(table, idx, 4));
+        }
+    }
+
+    // SIMDPositTables::Encode eight lanes at a time (n is a multiple of 8) - lanes out of range go to the library
+    template<typename TRaw, int nbits, int es>
+    __attribute__((target("avx2")))
+    static void AVX2F32ToPosit(TRaw *dst, const float *src, size_t n, const float *thresholds, float minPos, float maxPos, TRaw (*fallback)(float)) {
+        auto signMask = _mm256_set1_ps(-0.0f);
+        auto minPosVec = _mm256_set1_ps(minPos);
+        auto maxPosVec = _mm256_set1_ps(maxPos);
+        auto one = _mm256_set1_epi32(1);
+        size_t i = 0;
+        for(;i+8<=n;i+=8) {
+            auto value = _mm256_loadu_ps(src + i);
+            auto absValue = _mm256_andnot_ps(signMask, value);
+            auto bits = _mm256_castps_si256(absValue);
+
+            // TruncatedPattern
+            auto scale = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+            auto k = _mm256_srai_epi32(scale, es);
+            auto e = _mm256_and_si256(scale, _mm256_set1_epi32((1 << es) - 1));
+            auto kPositive = _mm256_cmpgt_epi32(k, _mm256_set1_epi32(-1));
+            auto regime = _mm256_blendv_epi8(one, _mm256_slli_epi32(_mm256_sub_epi32(_mm256_sllv_epi32(one, _mm256_add_epi32(k, one)), one), 1), kPositive);
+            auto regimeLen = _mm256_blendv_epi8(_mm256_sub_epi32(one, k), _mm256_add_epi32(k, _mm256_set1_epi32(2)), kPositive);
+            auto nFollowing = _mm256_sub_epi32(_mm256_set1_epi32(nbits - 1), regimeLen);
+            auto tail = _mm256_or_si256(_mm256_slli_epi32(e, 23), _mm256_and_si256(bits, _mm256_set1_epi32(0x7f'ffff)));
+            auto pattern = _mm256_or_si256(_mm256_sllv_epi32(regime, nFollowing),
+                                           _mm256_srlv_epi32(tail, _mm256_sub_epi32(_mm256_set1_epi32(es + 23), nFollowing)));
+
+            // zero below minpos, and keep lanes out of range inside the table
+            auto inRange = _mm256_cmp_ps(absValue, maxPosVec, _CMP_LT_OQ);
+            auto aboveMin = _mm256_cmp_ps(absValue, minPosVec, _CMP_GE_OQ);
+            pattern = _mm256_and_si256(pattern, _mm256_castps_si256(_mm256_and_ps(inRange, aboveMin)));
+
+            auto threshold = _mm256_i32gather_ps(thresholds, pattern, 4);
+            auto roundUp = _mm256_castps_si256(_mm256_cmp_ps(threshold, absValue, _CMP_LE_OQ));
+            pattern = _mm256_sub_epi32(pattern, roundUp);
+
+            // negative => two's complement of the positive posit
+            auto negative = _mm256_srai_epi32(_mm256_castps_si256(value), 31);
+            pattern = _mm256_sub_epi32(_mm256_xor_si256(pattern, negative), negative);
+
+            alignas(32) int32_t raw[8];
+            _mm256_store_si256((__m256i *)raw, pattern);
+            auto inRangeBits = _mm256_movemask_ps(inRange);
+            for(int lane=0;lane<8;lane++) {
+                dst[i + lane] = (inRangeBits & (1 << lane)) ? static_cast<TRaw>(raw[lane]) : fallback(src[i + lane]);
+            }
+        }
+    }
+    __attribute__((target("avx2")))
+    static void AVX2F32ToFp8(int8_t *dst, const float *src, size_t n) {
+        auto &tables = SIMDPositTables::Instance();
+        size_t nVector = tables.bFp8TableEncode ? (n & ~size_t(7)) : 0;
+        AVX2F32ToPosit<int8_t, SIMDPositTables::kFp8Bits, SIMDPositTables::kFp8Es>(dst, src, nVector, tables.fp8Thresholds.data(),
+                                                                                 tables.fp8MinPos, tables.fp8MaxPos, SIMDPositTables::LibFloatToFp8);
+        ScalarF32ToFp8(dst + nVector, src + nVector, n - nVector);
+    }
+    __attribute__((target("avx2")))
+    static void AVX2F32ToFp16(int16_t *dst, const float *src, size_t n) {
+        auto &tables = SIMDPositTables::Instance();
+        size_t nVector = tables.bFp16TableEncode ? (n & ~size_t(7)) : 0;
+        AVX2F32ToPosit<int16_t, SIMDPositTables::kFp16Bits, SIMDPositTables::kFp16Es>(dst, src, nVector, tables.fp16Thresholds.data(),
+                                                                                    tables.fp16MinPos, tables.fp16MaxPos, SIMDPositTables::LibFloatToFp16);
+        ScalarF32ToFp16(dst + nVector, src + nVector, n - nVector);
+    }
+}
+
+static const SIMDKernels kernelsSSE42 = {
+    .level = SIMDKernelLevel::SSE42,
+    .MulF32 = SSEMulF32,
+    .PairAddF32 = SSEPairAddF32,
+    .MulI8 = ScalarMulI<int8_t>,
+    .MulI16 = SSEMulI16,
+    .MulI32 = SSEMulI32,
+    .MulI64 = ScalarMulI<int64_t>,
+    .PairAddI8 = ScalarPairAddI<int8_t>,
+    .PairAddI16 = SSEPairAddI16,
+    .PairAddI32 = SSEPairAddI32,
+    .PairAddI64 = ScalarPairAddI<int64_t>,
+    .Fp8ToF32 = ScalarFp8ToF32,
+    .Fp16ToF32 = ScalarFp16ToF32,
+    .F32ToFp8 = ScalarF32ToFp8,
+    .F32ToFp16 = ScalarF32ToFp16,
+    .MulFp8 = ScalarMulFp8,
+    .PairAddFp8 = ScalarPairAddFp8,
+};
+
+static const SIMDKernels kernelsAVX2 = {
+    .level = SIMDKernelLevel::AVX2,
+    .MulF32 = AVX2MulF32,
+    .PairAddF32 = AVX2PairAddF32,
+    .MulI8 = ScalarMulI<int8_t>,
+    .MulI16 = SSEMulI16,
+    .MulI32 = SSEMulI32,
+    .MulI64 = ScalarMulI<int64_t>,
+    .PairAddI8 = ScalarPairAddI<int8_t>,
+    .PairAddI16 = SSEPairAddI16,
+    .PairAddI32 = SSEPairAddI32,
+    .PairAddI64 = ScalarPairAddI<int64_t>,
+    .Fp8ToF32 = AVX2Fp8ToF32,
+    .Fp16ToF32 = AVX2Fp16ToF32,
+    .F32ToFp8 = AVX2F32ToFp8,
+    .F32ToFp16 = AVX2F32ToFp16,
+    .MulFp8 = ScalarMulFp8,
+    .PairAddFp8 = ScalarPairAddFp8,
+};
+#endif
+
+SIMDKernelLevel SIMDKernels::GetHostLevel() {
+    static const SIMDKernelLevel hostLevel = []() {
+#ifdef VCPU_SIMD_HOST_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SIMDKernelLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return SIMDKernelLevel::SSE42;
+        }
+#endif
+        return SIMDKernelLevel::Scalar;
+    }();
+    return hostLevel;
+}
+
+const SIMDKernels &SIMDKernels::Get() {
+    static const SIMDKernels &kernels = Get(GetHostLevel());
+    return kernels;
+}
+
+const SIMDKernels &SIMDKernels::Get(SIMDKernelLevel maxLevel) {
+    auto level = (maxLevel < GetHostLevel()) ? maxLevel : GetHostLevel();
+#ifdef VCPU_SIMD_HOST_X86
+    switch(level) {
+        case SIMDKernelLevel::AVX2 :
+            return kernelsAVX2;
+        case SIMDKernelLevel::SSE42 :
+            return kernelsSSE42;
+        default:
+            break;
+    }
+#endif
+    return kernelsScalar;
+}
@@ -0,0 +1,65 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_SIMDKERNELS_H
+#define VCPU_SIMDKERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace gnilk {
+    namespace vcpu {
+
+        // Host implementations of the SIMD lane operations.
+        // The table is picked once, at runtime, from what the host supports - AVX2, SSE4.2 or plain C++.
+        // Non-x86 hosts always get the scalar table.
+        //
+        // Integer lanes are one 128 bit register (like the emulated ones) and wrap around on overflow.
+        // Floats are host floats, the posit lanes are converted before/after (see SIMDInstructionSetImpl) - the fp8/fp16
+        // conversions are table driven, AVX2 does the lookups with gathers.
+        enum class SIMDKernelLevel : uint8_t {
+            Scalar,
+            SSE42,
+            AVX2,
+        };
+
+        struct SIMDKernels {
+            SIMDKernelLevel level;
+
+            // dst[i] = a[i] * b[i], n is a multiple of 4
+            void (*MulF32)(float *dst, const float *a, const float *b, size_t n);
+            // dst[i] = src[2i] + src[2i+1], n (number of source values) is a multiple of 8
+            void (*PairAddF32)(float *dst, const float *src, size_t n);
+
+            // dst[i] = a[i] * b[i], one register
+            void (*MulI8)(int8_t *dst, const int8_t *a, const int8_t *b);
+            void (*MulI16)(int16_t *dst, const int16_t *a, const int16_t *b);
+            void (*MulI32)(int32_t *dst, const int32_t *a, const int32_t *b);
+            void (*MulI64)(int64_t *dst, const int64_t *a, const int64_t *b);
+
+            // dst[i] = src[2i] + src[2i+1], two registers in - one out
+            void (*PairAddI8)(int8_t *dst, const int8_t *src);
+            void (*PairAddI16)(int16_t *dst, const int16_t *src);
+            void (*PairAddI32)(int32_t *dst, const int32_t *src);
+            void (*PairAddI64)(int64_t *dst, const int64_t *src);
+
+            // fp8/fp16 posit conversions through SIMDPositTables, raw posit bits - n is a multiple of 4
+            void (*Fp8ToF32)(float *dst, const int8_t *src, size_t n);
+            void (*Fp16ToF32)(float *dst, const int16_t *src, size_t n);
+            void (*F32ToFp8)(int8_t *dst, const float *src, size_t n);
+            void (*F32ToFp16)(int16_t *dst, const float *src, size_t n);
+            // fp8 posit arithmetic through the precomputed tables, one register (two for the pair add)
+            void (*MulFp8)(int8_t *dst, const int8_t *a, const int8_t *b);
+            void (*PairAddFp8)(int8_t *dst, const int8_t *src);
+
+            // Best the host can do
+            static const SIMDKernels &Get();
+            // A specific level, capped to what the host supports - mainly for testing
+            static const SIMDKernels &Get(SIMDKernelLevel maxLevel);
+            static SIMDKernelLevel GetHostLevel();
+        };
+    }
+}
+
+#endif //VCPU_SIMDKERNELS_H
@@ -0,0 +1,143 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#include <math.h>
+#include <limits>
+#include <bit>
+
+#include "SIMDInstructionSetDef.h"
+#include "SIMDPositTables.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+// The posit is just its bit pattern
+template<typename TRaw, typename TPosit>
+static TRaw ToRaw(const TPosit &posit) {
+    return std::bit_cast<TRaw>(posit);
+}
+
+template<typename TPosit, typename TRaw>
+static TPosit FromRaw(TRaw raw) {
+    return std::bit_cast<TPosit>(raw);
+}
+
+int8_t SIMDPositTables::LibFloatToFp8(float value) {
+    return ToRaw<int8_t>(fp8(value));
+}
+int16_t SIMDPositTables::LibFloatToFp16(float value) {
+    return ToRaw<int16_t>(fp16(value));
+}
+float SIMDPositTables::LibFp8ToFloat(int8_t raw) {
+    return static_cast<float>(FromRaw<fp8>(raw));
+}
+float SIMDPositTables::LibFp16ToFloat(int16_t raw) {
+    return static_cast<float>(FromRaw<fp16>(raw));
+}
+
+//
+// Thresholds between the positive values - the smallest float which encodes to 'n+1'.
+// Positive floats are ordered like their bit patterns, so this is a bisection on the bits between two neighbouring
+// values. This assumes the library rounds monotonically, which any sane rounding does.
+//
+template<typename TRaw>
+static void BuildThresholds(std::vector<float> &thresholds, const float *values, TRaw maxRaw, TRaw (*encode)(float)) {
+    thresholds.assign(maxRaw, std::numeric_limits<float>::infinity());
+    for(TRaw n=0;n<maxRaw;n++) {
+        auto lo = std::bit_cast<uint32_t>(values[n]);
+        auto hi = std::bit_cast<uint32_t>(values[n + 1]);
+        while((hi - lo) > 1) {
+            auto mid = lo + (hi - lo) / 2;
+            if (encode(std::bit_cast<float>(mid)) > n) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+        thresholds[n] = std::bit_cast<float>(hi);
+    }
+}
+
+//
+// The truncated pattern must hit every posit exactly and stay on it up to the next one, otherwise the layout isn't
+// what we think (TruncatedPattern) and encoding goes through the library instead.
+//
+template<typename TRaw, int nbits, int es>
+static bool VerifyTruncatedPattern(const float *values, TRaw maxRaw) {
+    for(TRaw n=1;n<maxRaw;n++) {
+        auto bitsAt = std::bit_cast<uint32_t>(values[n]);
+        auto bitsBelowNext = std::bit_cast<uint32_t>(values[n + 1]) - 1;
+        if ((SIMDPositTables::TruncatedPattern<nbits, es>(bitsAt) != static_cast<uint32_t>(n)) ||
+            (SIMDPositTables::TruncatedPattern<nbits, es>(bitsBelowNext) != static_cast<uint32_t>(n))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename TRaw, int nbits, int es>
+static TRaw Encode(const std::vector<float> &thresholds, float minPos, float maxPos, float value, TRaw (*fallback)(float)) {
+    auto absValue = fabsf(value);
+    if (!(absValue < maxPos)) {
+        return fallback(value);
+    }
+    uint32_t pattern = 0;
+    if (absValue >= minPos) {
+        pattern = SIMDPositTables::TruncatedPattern<nbits, es>(std::bit_cast<uint32_t>(absValue));
+    }
+    pattern += (absValue >= thresholds[pattern]) ? 1 : 0;
+
+    auto raw = static_cast<TRaw>(pattern);
+    return signbit(value) ? static_cast<TRaw>(-raw) : raw;
+}
+
+const SIMDPositTables &SIMDPositTables::Instance() {
+    static SIMDPositTables glbTables;
+    return glbTables;
+}
+
+SIMDPositTables::SIMDPositTables() {
+    fp8Values.resize(256);
+    for(int i=0;i<256;i++) {
+        fp8Values[i] = LibFp8ToFloat(static_cast<int8_t>(i));
+    }
+    fp16Values.resize(65536);
+    for(int i=0;i<65536;i++) {
+        fp16Values[i] = LibFp16ToFloat(static_cast<int16_t>(i));
+    }
+
+    fp8MinPos = fp8Values[0x01];
+    fp8MaxPos = fp8Values[0x7f];
+    fp16MinPos = fp16Values[0x0001];
+    fp16MaxPos = fp16Values[0x7fff];
+    BuildThresholds<int8_t>(fp8Thresholds, fp8Values.data(), 0x7f, LibFloatToFp8);
+    BuildThresholds<int16_t>(fp16Thresholds, fp16Values.data(), 0x7fff, LibFloatToFp16);
+    bFp8TableEncode = VerifyTruncatedPattern<int8_t, kFp8Bits, kFp8Es>(fp8Values.data(), 0x7f);
+    bFp16TableEncode = VerifyTruncatedPattern<int16_t, kFp16Bits, kFp16Es>(fp16Values.data(), 0x7fff);
+
+    fp8Mul.resize(65536);
+    fp8Add.resize(65536);
+    for(int a=0;a<256;a++) {
+        auto pa = FromRaw<fp8>(static_cast<int8_t>(a));
+        for(int b=0;b<256;b++) {
+            auto pb = FromRaw<fp8>(static_cast<int8_t>(b));
+            fp8Mul[(a << 8) | b] = ToRaw<int8_t>(fp8(pa * pb));
+            fp8Add[(a << 8) | b] = ToRaw<int8_t>(fp8(pa + pb));
+        }
+    }
+}
+
+int8_t SIMDPositTables::FloatToFp8(float value) const {
+    if (!bFp8TableEncode) {
+        return LibFloatToFp8(value);
+    }
+    return Encode<int8_t, kFp8Bits, kFp8Es>(fp8Thresholds, fp8MinPos, fp8MaxPos, value, LibFloatToFp8);
+}
+
+int16_t SIMDPositTables::FloatToFp16(float value) const {
+    if (!bFp16TableEncode) {
+        return LibFloatToFp16(value);
+    }
+    return Encode<int16_t, kFp16Bits, kFp16Es>(fp16Thresholds, fp16MinPos, fp16MaxPos, value, LibFloatToFp16);
+}
@@ -0,0 +1,108 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_SIMDPOSITTABLES_H
+#define VCPU_SIMDPOSITTABLES_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace gnilk {
+    namespace vcpu {
+
+        //
+        // Lookup tables for the fp8/fp16 posits (see SIMDInstructionSetDef.h), generated from the posit library on
+        // first use - so the results are exactly the same as going through the library, just a lot faster.
+        //
+        // Decoding is a plain lookup (256 resp. 64K floats).
+        // Encoding takes the posit at or below the value straight from the float bits (regime/exponent/fraction
+        // truncated) and rounds up if the value is at or above the rounding threshold to the next posit - the
+        // thresholds come from the library. Posits are symmetric around zero (negate the bits) so only the positive
+        // half is needed. Anything outside [0, maxpos) - NaN, inf and the saturated range - goes to the library.
+        // fp8 multiplication and addition are 64K tables each.
+        //
+        // Everything works on the raw bits of the posits.
+        //
+        class SIMDPositTables {
+        public:
+            // Must match the definitions of fp8/fp16, the tables verify the layout against the library when built
+            static const int kFp8Bits = 8;
+            static const int kFp8Es = 0;
+            static const int kFp16Bits = 16;
+            static const int kFp16Es = 1;
+        public:
+            static const SIMDPositTables &Instance();
+
+            float Fp8ToFloat(int8_t raw) const {
+                return fp8Values[static_cast<uint8_t>(raw)];
+            }
+            float Fp16ToFloat(int16_t raw) const {
+                return fp16Values[static_cast<uint16_t>(raw)];
+            }
+            int8_t FloatToFp8(float value) const;
+            int16_t FloatToFp16(float value) const;
+
+            int8_t MulFp8(int8_t a, int8_t b) const {
+                return fp8Mul[(static_cast<uint8_t>(a) << 8) | static_cast<uint8_t>(b)];
+            }
+            int8_t AddFp8(int8_t a, int8_t b) const {
+                return fp8Add[(static_cast<uint8_t>(a) << 8) | static_cast<uint8_t>(b)];
+            }
+
+            // The posit library conversions, this is what the tables are built from
+            static int8_t LibFloatToFp8(float value);
+            static int16_t LibFloatToFp16(float value);
+            static float LibFp8ToFloat(int8_t raw);
+            static float LibFp16ToFloat(int16_t raw);
+
+            // Pattern of the largest posit at or below 'value', for minpos <= value < maxpos - 'bits' are the float bits
+            // Outside that range it saturates to maxpos/minpos
+            template<int nbits, int es>
+            static uint32_t TruncatedPattern(uint32_t bits) {
+                auto scale = static_cast<int32_t>(bits >> 23) - 127;
+                auto k = scale >> es;
+                auto e = static_cast<uint32_t>(scale) & ((1u << es) - 1);
+                // The regime alone would not fit - this also keeps the shifts below in range
+                if ((k >= 0) && ((k + 2) > (nbits - 1))) {
+                    return (1u << (nbits - 1)) - 1;
+                }
+                if ((k < 0) && ((1 - k) > (nbits - 1))) {
+                    return 1;
+                }
+                // regime is k+1 ones and a zero, or -k zeros and a one
+                uint32_t regime = 1;
+                int regimeLen = 1 - k;
+                if (k >= 0) {
+                    regime = ((1u << (k + 1)) - 1) << 1;
+                    regimeLen = k + 2;
+                }
+                auto nFollowing = nbits - 1 - regimeLen;
+                auto tail = (e << 23) | (bits & 0x7f'ffff);
+                return (regime << nFollowing) | (tail >> (es + 23 - nFollowing));
+            }
+
+        public:
+            // Exposed for the vectorized kernels, see SIMDKernels
+            std::vector<float> fp8Values;
+            std::vector<float> fp16Values;
+            // Smallest value which rounds up to posit 'n+1'
+            std::vector<float> fp8Thresholds;
+            std::vector<float> fp16Thresholds;
+            float fp8MinPos = 0;
+            float fp8MaxPos = 0;
+            float fp16MinPos = 0;
+            float fp16MaxPos = 0;
+            // false if the library doesn't have the layout we expect, encoding then goes to the library
+            bool bFp8TableEncode = false;
+            bool bFp16TableEncode = false;
+
+            std::vector<int8_t> fp8Mul;
+            std::vector<int8_t> fp8Add;
+        private:
+            SIMDPositTables();
+        };
+    }
+}
+
+#endif //VCPU_SIMDPOSITTABLES_H
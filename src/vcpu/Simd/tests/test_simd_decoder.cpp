@@ -3,10 +3,16 @@
 //
 #include <stdint.h>
 #include <vector>
+#include <string.h>
+#include <math.h>
+#include <bit>
 #include <testinterface.h>
 
 #include "VirtualCPU.h"
 #include "Simd/SIMDInstructionDecoder.h"
+#include "Simd/SIMDKernels.h"
+#include "Simd/SIMDPositTables.h"
+#include "Simd/SIMDInstructionSetImpl.h"
 
 using namespace gnilk;
 using namespace gnilk::vcpu;
@@ -15,6 +21,13 @@ extern "C" {
     DLL_EXPORT int test_simd(ITesting *t);
     DLL_EXPORT int test_simd_decode(ITesting *t);
     DLL_EXPORT int test_simd_decode_ext(ITesting *t);
+    DLL_EXPORT int test_simd_kernels(ITesting *t);
+    DLL_EXPORT int test_simd_posittables(ITesting *t);
+    DLL_EXPORT int test_simd_exec_int(ITesting *t);
+    DLL_EXPORT int test_simd_exec_fp32(ITesting *t);
+    DLL_EXPORT int test_simd_exec_vl512(ITesting *t);
+    DLL_EXPORT int test_simd_exec_gather(ITesting *t);
+    DLL_EXPORT int test_simd_exec_dotlanes(ITesting *t);
 }
 DLL_EXPORT int test_simd(ITesting *t) {
     return kTR_Pass;
@@ -58,5 +71,456 @@ DLL_EXPORT int test_simd_decode_ext(ITesting *t) {
     vcpu.Step();
 
 
+    return kTR_Pass;
+}
+
+// All levels the host supports must agree with the scalar version
+DLL_EXPORT int test_simd_kernels(ITesting *t) {
+    auto &scalar = SIMDKernels::Get(SIMDKernelLevel::Scalar);
+    TR_ASSERT(t, scalar.level == SIMDKernelLevel::Scalar);
+    TR_ASSERT(t, SIMDKernels::Get().level == SIMDKernels::GetHostLevel());
+
+    float fa[32], fb[32];
+    int8_t i8[32];
+    int16_t i16[16];
+    int32_t i32[8];
+    int64_t i64[4];
+    for(int i=0;i<32;i++) {
+        fa[i] = float(i) - 7.5f;
+        fb[i] = 0.25f * float(i * 3 % 11);
+        i8[i] = static_cast<int8_t>(i * 37 - 100);
+    }
+    for(int i=0;i<16;i++) {
+        i16[i] = static_cast<int16_t>(300 * i - 2000);
+    }
+    for(int i=0;i<8;i++) {
+        i32[i] = (i & 1) ? -70000 * i : 0x7fff'ffff - i;
+    }
+    for(int i=0;i<4;i++) {
+        i64[i] = (int64_t(1) << 62) + i;
+    }
+
+    for(auto level : {SIMDKernelLevel::Scalar, SIMDKernelLevel::SSE42, SIMDKernelLevel::AVX2}) {
+        auto &kernels = SIMDKernels::Get(level);
+        for(size_t n : {4, 8, 16}) {
+            float expected[32], result[32];
+            scalar.MulF32(expected, fa, fb, n);
+            kernels.MulF32(result, fa, fb, n);
+            TR_ASSERT(t, memcmp(expected, result, n * sizeof(float)) == 0);
+            scalar.PairAddF32(expected, fa, 2 * n);
+            kernels.PairAddF32(result, fa, 2 * n);
+            TR_ASSERT(t, memcmp(expected, result, n * sizeof(float)) == 0);
+        }
+
+        int8_t r8[16], e8[16];
+        scalar.MulI8(e8, i8, i8 + 16);
+        kernels.MulI8(r8, i8, i8 + 16);
+        TR_ASSERT(t, memcmp(e8, r8, sizeof(r8)) == 0);
+        scalar.PairAddI8(e8, i8);
+        kernels.PairAddI8(r8, i8);
+        TR_ASSERT(t, memcmp(e8, r8, sizeof(r8)) == 0);
+
+        int16_t r16[8], e16[8];
+        scalar.MulI16(e16, i16, i16 + 8);
+        kernels.MulI16(r16, i16, i16 + 8);
+        TR_ASSERT(t, memcmp(e16, r16, sizeof(r16)) == 0);
+        scalar.PairAddI16(e16, i16);
+        kernels.PairAddI16(r16, i16);
+        TR_ASSERT(t, memcmp(e16, r16, sizeof(r16)) == 0);
+
+        int32_t r32[4], e32[4];
+        scalar.MulI32(e32, i32, i32 + 4);
+        kernels.MulI32(r32, i32, i32 + 4);
+        TR_ASSERT(t, memcmp(e32, r32, sizeof(r32)) == 0);
+        scalar.PairAddI32(e32, i32);
+        kernels.PairAddI32(r32, i32);
+        TR_ASSERT(t, memcmp(e32, r32, sizeof(r32)) == 0);
+
+        int64_t r64[2], e64[2];
+        scalar.MulI64(e64, i64, i64 + 2);
+        kernels.MulI64(r64, i64, i64 + 2);
+        TR_ASSERT(t, memcmp(e64, r64, sizeof(r64)) == 0);
+        scalar.PairAddI64(e64, i64);
+        kernels.PairAddI64(r64, i64);
+        TR_ASSERT(t, memcmp(e64, r64, sizeof(r64)) == 0);
+    }
+
+    // wrap around
+    int16_t a16[8] = {300, -300, 0x7fff, 1, 2, 3, 4, 5};
+    int16_t b16[8] = {300, 300, 2, 1, 1, 1, 1, 1};
+    int16_t r16[8];
+    SIMDKernels::Get().MulI16(r16, a16, b16);
+    TR_ASSERT(t, r16[0] == static_cast<int16_t>(90000));
+    TR_ASSERT(t, r16[1] == static_cast<int16_t>(-90000));
+    TR_ASSERT(t, r16[2] == -2);
+
+    return kTR_Pass;
+}
+
+// The tables and kernels must give the same bits as the posit library
+DLL_EXPORT int test_simd_posittables(ITesting *t) {
+    auto &tables = SIMDPositTables::Instance();
+    TR_ASSERT(t, tables.bFp8TableEncode);
+    TR_ASSERT(t, tables.bFp16TableEncode);
+
+    // all patterns decode, and encode back (NaR decodes to NaN)
+    for(int i=0;i<65536;i++) {
+        auto raw = static_cast<int16_t>(i);
+        auto value = tables.Fp16ToFloat(raw);
+        auto expected = SIMDPositTables::LibFp16ToFloat(raw);
+        TR_ASSERT(t, memcmp(&value, &expected, sizeof(float)) == 0);
+        TR_ASSERT(t, tables.FloatToFp16(value) == raw);
+        if (i < 256) {
+            auto raw8 = static_cast<int8_t>(i);
+            auto value8 = tables.Fp8ToFloat(raw8);
+            auto expected8 = SIMDPositTables::LibFp8ToFloat(raw8);
+            TR_ASSERT(t, memcmp(&value8, &expected8, sizeof(float)) == 0);
+            TR_ASSERT(t, tables.FloatToFp8(value8) == raw8);
+        }
+    }
+
+    // the pattern saturates outside the range, the regime would not fit
+    TR_ASSERT(t, (SIMDPositTables::TruncatedPattern<8, 0>(std::bit_cast<uint32_t>(1e30f)) == 0x7f));
+    TR_ASSERT(t, (SIMDPositTables::TruncatedPattern<8, 0>(std::bit_cast<uint32_t>(1e-30f)) == 0x01));
+    TR_ASSERT(t, (SIMDPositTables::TruncatedPattern<16, 1>(std::bit_cast<uint32_t>(1e30f)) == 0x7fff));
+
+    // values in between, outside the range and special values - through all kernel levels
+    std::vector<float> values;
+    for(float v = 1e-12f; v < 1e12f; v *= 1.0137f) {
+        values.push_back(v);
+        values.push_back(-v);
+    }
+    for(float v : {0.0f, -0.0f, 1.0f, -1.0f, 1e30f, -1e30f, 1e-30f, tables.fp8MaxPos, tables.fp16MinPos, NAN, INFINITY, -INFINITY}) {
+        values.push_back(v);
+    }
+    while((values.size() % 16) != 0) {
+        values.push_back(0.5f);
+    }
+    for(auto level : {SIMDKernelLevel::Scalar, SIMDKernelLevel::SSE42, SIMDKernelLevel::AVX2}) {
+        auto &kernels = SIMDKernels::Get(level);
+        for(size_t i=0;i<values.size();i+=16) {
+            int8_t r8[16];
+            int16_t r16[16];
+            kernels.F32ToFp8(r8, &values[i], 16);
+            // odd count to get the tail
+            kernels.F32ToFp16(r16, &values[i], 13);
+            kernels.F32ToFp16(r16 + 13, &values[i + 13], 3);
+            for(size_t lane=0;lane<16;lane++) {
+                TR_ASSERT(t, r8[lane] == SIMDPositTables::LibFloatToFp8(values[i + lane]));
+                TR_ASSERT(t, r16[lane] == SIMDPositTables::LibFloatToFp16(values[i + lane]));
+            }
+            float decoded[16];
+            kernels.Fp16ToF32(decoded, r16, 12);
+            kernels.Fp16ToF32(decoded + 12, r16 + 12, 4);
+            for(size_t lane=0;lane<16;lane++) {
+                auto expected = SIMDPositTables::LibFp16ToFloat(r16[lane]);
+                TR_ASSERT(t, memcmp(&decoded[lane], &expected, sizeof(float)) == 0);
+            }
+        }
+    }
+
+    // all fp8 pairs
+    int8_t a[16], b[16], pairs[32], product[16], sum[16];
+    for(int i=0;i<65536;i+=16) {
+        for(int lane=0;lane<16;lane++) {
+            a[lane] = static_cast<int8_t>((i + lane) >> 8);
+            b[lane] = static_cast<int8_t>(i + lane);
+            pairs[2*lane] = a[lane];
+            pairs[2*lane+1] = b[lane];
+        }
+        SIMDKernels::Get().MulFp8(product, a, b);
+        SIMDKernels::Get().PairAddFp8(sum, pairs);
+        for(int lane=0;lane<16;lane++) {
+            auto pa = std::bit_cast<fp8>(a[lane]);
+            auto pb = std::bit_cast<fp8>(b[lane]);
+            TR_ASSERT(t, product[lane] == std::bit_cast<int8_t>(fp8(pa * pb)));
+            TR_ASSERT(t, sum[lane] == std::bit_cast<int8_t>(fp8(pa + pb)));
+        }
+    }
+
+    return kTR_Pass;
+}
+
+static uint8_t execRam[32*4096];
+
+static void RunSimdCode(VirtualCPU &vcpu, const uint8_t *code, size_t szCode) {
+    vcpu.LoadDataToRam(0x2000, code, szCode);
+    vcpu.SetInstrPtr(0x2000);
+    while(!vcpu.IsHalted()) {
+        vcpu.Step();
+    }
+}
+
+DLL_EXPORT int test_simd_exec_int(ITesting *t) {
+    VirtualCPU vcpu;
+    vcpu.Begin(execRam, sizeof(execRam));
+
+    auto &mmu = vcpu.memoryUnit;
+    for(uint32_t i=0;i<8;i++) {
+        mmu.Write<uint32_t>(0x4000 + i * 4, i + 1);
+        mmu.Write<uint32_t>(0x6000 + i * 4, 0xffff'ffff);
+    }
+    auto &regs = vcpu.GetRegisters();
+    regs.addressRegisters[0].data.longword = 0x4000;
+    regs.addressRegisters[1].data.longword = 0x5000;
+    regs.addressRegisters[2].data.longword = 0x6000;
+
+    static const uint8_t kInt = kSimdOpLowFlags::kOpLowFlag_Integer;
+    static const uint8_t kAdv = kSimdOpLowFlags::kOpLowFlag_Advance;
+    uint8_t code[]={
+        // ve_load.i32 v0,(a0)+
+        OperandCode::SIMD, SimdOpCode::LOAD, kOpFlag_SzFp32 | kOpFlag_SrcAddrReg, kInt | kAdv | 0, 0x00,
+        // ve_load.i32 v1,(a0)+
+        OperandCode::SIMD, SimdOpCode::LOAD, kOpFlag_SzFp32 | kOpFlag_SrcAddrReg, kInt | kAdv | 1, 0x00,
+        // ve_mul.i32 v2,v0,v1
+        OperandCode::SIMD, SimdOpCode::VMUL, kOpFlag_SzFp32, kInt | 2, 0x01,
+        // ve_hadd.i32 v3,v0,v1
+        OperandCode::SIMD, SimdOpCode::HADD, kOpFlag_SzFp32, kInt | 3, 0x01,
+        // ve_store.i32 (a1)+,v2
+        OperandCode::SIMD, SimdOpCode::STORE, kOpFlag_SzFp32 | kOpFlag_DstAddrReg, kInt | kAdv | 1, 0x20,
+        // ve_store.i32 (a1),v3
+        OperandCode::SIMD, SimdOpCode::STORE, kOpFlag_SzFp32 | kOpFlag_DstAddrReg, kInt | 1, 0x30,
+        // ve_store.i32 (a2),v0,0b0101
+        OperandCode::SIMD, SimdOpCode::STORE, kOpFlag_SzFp32 | kOpFlag_DstAddrReg, kInt | 2, 0x05,
+        // ve_load.i16 v4,v1,0b1000     <- move, only lanes 0,1
+        OperandCode::SIMD, SimdOpCode::LOAD, kOpFlag_SzFp16, kInt | 4, 0x18,
+        OperandCode::BRK,
+    };
+    RunSimdCode(vcpu, code, sizeof(code));
+
+    auto &simdRegs = vcpu.GetExtensionState<SIMDRegisters>();
+    static const int32_t expectedMul[4] = {5, 12, 21, 32};
+    static const int32_t expectedHAdd[4] = {3, 7, 11, 15};
+    for(int i=0;i<4;i++) {
+        TR_ASSERT(t, simdRegs.registers[0].i32[i] == i + 1);
+        TR_ASSERT(t, simdRegs.registers[2].i32[i] == expectedMul[i]);
+        TR_ASSERT(t, simdRegs.registers[3].i32[i] == expectedHAdd[i]);
+        TR_ASSERT(t, mmu.Read<uint32_t>(0x5000 + i * 4) == (uint32_t)expectedMul[i]);
+        TR_ASSERT(t, mmu.Read<uint32_t>(0x5010 + i * 4) == (uint32_t)expectedHAdd[i]);
+    }
+    TR_ASSERT(t, regs.addressRegisters[0].data.longword == 0x4020);
+    TR_ASSERT(t, regs.addressRegisters[1].data.longword == 0x5010);
+    // masked store, lanes 1 and 3
+    TR_ASSERT(t, mmu.Read<uint32_t>(0x6000) == 0xffff'ffff);
+    TR_ASSERT(t, mmu.Read<uint32_t>(0x6004) == 2);
+    TR_ASSERT(t, mmu.Read<uint32_t>(0x6008) == 0xffff'ffff);
+    TR_ASSERT(t, mmu.Read<uint32_t>(0x600c) == 4);
+    // masked move, first quarter is lane 0 of the i32 register
+    TR_ASSERT(t, simdRegs.registers[4].i32[0] == 5);
+    TR_ASSERT(t, simdRegs.registers[4].i32[1] == 0);
+
+    return kTR_Pass;
+}
+
+// Only whole numbers - they are exact in all the posit configurations
+DLL_EXPORT int test_simd_exec_fp32(ITesting *t) {
+    VirtualCPU vcpu;
+    vcpu.Begin(execRam, sizeof(execRam));
+
+    auto &simdRegs = vcpu.GetExtensionState<SIMDRegisters>();
+    for(int i=0;i<4;i++) {
+        simdRegs.registers[0].values[i] = fp32(float(i + 1));
+        simdRegs.registers[1].values[i] = fp32(2.0f);
+    }
+
+    uint8_t code[]={
+        // ve_mul.fp32 v2,v0,v1
+        OperandCode::SIMD, SimdOpCode::VMUL, kOpFlag_SzFp32, 0x02, 0x01,
+        // ve_hadd.fp32 v3,v0,v1
+        OperandCode::SIMD, SimdOpCode::HADD, kOpFlag_SzFp32, 0x03, 0x01,
+        // ve_packfp32.fp16 v4,v2,1     <- upper four fp16 lanes
+        OperandCode::SIMD, SimdOpCode::PACKFP32, kOpFlag_SzFp16, 0x04, 0x21,
+        // ve_unpckfp16.fp32 v5,v4,1
+        OperandCode::SIMD, SimdOpCode::UNPCKFP16, kOpFlag_SzFp32, 0x05, 0x41,
+        // ve_packfp32.fp8 v6,v0,2
+        OperandCode::SIMD, SimdOpCode::PACKFP32, kOpFlag_SzFp8, 0x06, 0x02,
+        // ve_unpckfp8.fp32 v7,v6,2
+        OperandCode::SIMD, SimdOpCode::UNPCKFP8, kOpFlag_SzFp32, 0x07, 0x62,
+        // ve_mul.fp16 v8,v4,v4
+        OperandCode::SIMD, SimdOpCode::VMUL, kOpFlag_SzFp16, 0x08, 0x44,
+        OperandCode::BRK,
+    };
+    RunSimdCode(vcpu, code, sizeof(code));
+
+    static const float expectedHAdd[4] = {3.0f, 7.0f, 4.0f, 4.0f};
+    for(int i=0;i<4;i++) {
+        auto expectedMul = 2.0f * float(i + 1);
+        TR_ASSERT(t, static_cast<float>(simdRegs.registers[2].values[i]) == expectedMul);
+        TR_ASSERT(t, static_cast<float>(simdRegs.registers[3].values[i]) == expectedHAdd[i]);
+        TR_ASSERT(t, static_cast<float>(simdRegs.registers[4].fp16Values[4 + i]) == expectedMul);
+        TR_ASSERT(t, static_cast<float>(simdRegs.registers[5].values[i]) == expectedMul);
+        TR_ASSERT(t, static_cast<float>(simdRegs.registers[6].fp8Values[8 + i]) == float(i + 1));
+        TR_ASSERT(t, static_cast<float>(simdRegs.registers[7].values[i]) == float(i + 1));
+        TR_ASSERT(t, static_cast<float>(simdRegs.registers[8].fp16Values[4 + i]) == expectedMul * expectedMul);
+    }
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_simd_exec_vl512(ITesting *t) {
+    VirtualCPU vcpu;
+    vcpu.Begin(execRam, sizeof(execRam));
+    SIMDInstructionSetImpl::SetVectorLength(vcpu, kSimdControlBits::kSimdControl_VL512);
+
+    auto &mmu = vcpu.memoryUnit;
+    for(uint32_t i=0;i<16;i++) {
+        mmu.Write<uint32_t>(0x4000 + i * 4, i + 1);
+        mmu.Write<uint32_t>(0x4040 + i * 4, 2);
+    }
+    auto &regs = vcpu.GetRegisters();
+    regs.addressRegisters[0].data.longword = 0x4000;
+    regs.addressRegisters[1].data.longword = 0x5000;
+
+    auto &simdRegs = vcpu.GetExtensionState<SIMDRegisters>();
+    TR_ASSERT(t, simdRegs.control.VectorBytes() == 64);
+    TR_ASSERT(t, simdRegs.control.bits & kSimdControlBits::kSimdFeature_VL256);
+    TR_ASSERT(t, simdRegs.control.bits & kSimdControlBits::kSimdFeature_VL512);
+    // 4x4 matrix times (1,2,3,4)
+    for(int i=0;i<16;i++) {
+        simdRegs.registers[4].values[i] = fp32((i / 4) == (i % 4) ? float(i / 4 + 1) : 0.0f);
+        simdRegs.registers[5].values[i] = fp32(float(i % 4 + 1));
+        simdRegs.registers[7].values[i] = fp32(1.0f);
+    }
+
+    static const uint8_t kInt = kSimdOpLowFlags::kOpLowFlag_Integer;
+    static const uint8_t kAdv = kSimdOpLowFlags::kOpLowFlag_Advance;
+    uint8_t code[]={
+        // ve_load.i32 v0,(a0)+
+        OperandCode::SIMD, SimdOpCode::LOAD, kOpFlag_SzFp32 | kOpFlag_SrcAddrReg, kInt | kAdv | 0, 0x00,
+        // ve_load.i32 v1,(a0)+
+        OperandCode::SIMD, SimdOpCode::LOAD, kOpFlag_SzFp32 | kOpFlag_SrcAddrReg, kInt | kAdv | 1, 0x00,
+        // ve_dp4.i32 v2,v0,v1
+        OperandCode::SIMD, SimdOpCode::DP4, kOpFlag_SzFp32, kInt | 2, 0x01,
+        // ve_dp3.i32 v3,v0,v1
+        OperandCode::SIMD, SimdOpCode::DP3, kOpFlag_SzFp32, kInt | 3, 0x01,
+        // ve_mad.i32 v1,v0,v0
+        OperandCode::SIMD, SimdOpCode::MAD, kOpFlag_SzFp32, kInt | 1, 0x00,
+        // ve_store.i32 (a1)+,v2
+        OperandCode::SIMD, SimdOpCode::STORE, kOpFlag_SzFp32 | kOpFlag_DstAddrReg, kInt | kAdv | 1, 0x20,
+        // ve_dp4.fp32 v6,v4,v5
+        OperandCode::SIMD, SimdOpCode::DP4, kOpFlag_SzFp32, 0x06, 0x45,
+        // ve_mad.fp32 v7,v5,v5
+        OperandCode::SIMD, SimdOpCode::MAD, kOpFlag_SzFp32, 0x07, 0x55,
+        OperandCode::BRK,
+    };
+    RunSimdCode(vcpu, code, sizeof(code));
+
+    for(int i=0;i<16;i++) {
+        auto group = i / 4;
+        TR_ASSERT(t, simdRegs.registers[0].i32[i] == i + 1);
+        TR_ASSERT(t, simdRegs.registers[1].i32[i] == (i + 1) * (i + 1) + 2);
+        TR_ASSERT(t, simdRegs.registers[2].i32[i] == 2 * (16 * group + 10));
+        TR_ASSERT(t, simdRegs.registers[3].i32[i] == 2 * (12 * group + 6));
+        TR_ASSERT(t, mmu.Read<uint32_t>(0x5000 + i * 4) == (uint32_t)(2 * (16 * group + 10)));
+        TR_ASSERT(t, static_cast<float>(simdRegs.registers[6].values[i]) == float((group + 1) * (group + 1)));
+        auto component = float(i % 4 + 1);
+        TR_ASSERT(t, static_cast<float>(simdRegs.registers[7].values[i]) == component * component + 1.0f);
+    }
+    TR_ASSERT(t, regs.addressRegisters[0].data.longword == 0x4080);
+    TR_ASSERT(t, regs.addressRegisters[1].data.longword == 0x5040);
+
+    // The vector length is an option of the core, it survives reset
+    vcpu.Reset();
+    regs.addressRegisters[0].data.longword = 0x4000;
+    uint8_t codeAfterReset[]={
+        // ve_load.i32 v0,(a0)
+        OperandCode::SIMD, SimdOpCode::LOAD, kOpFlag_SzFp32 | kOpFlag_SrcAddrReg, kInt | 0, 0x00,
+        OperandCode::BRK,
+    };
+    RunSimdCode(vcpu, codeAfterReset, sizeof(codeAfterReset));
+    auto &simdRegsAfterReset = vcpu.GetExtensionState<SIMDRegisters>();
+    TR_ASSERT(t, simdRegsAfterReset.control.VectorBytes() == 64);
+    TR_ASSERT(t, simdRegsAfterReset.registers[0].i32[15] == 16);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_simd_exec_gather(ITesting *t) {
+    VirtualCPU vcpu;
+    vcpu.Begin(execRam, sizeof(execRam));
+
+    auto &mmu = vcpu.memoryUnit;
+    for(uint32_t i=0;i<64;i++) {
+        mmu.Write<uint32_t>(0x4000 + i * 4, 100 + i);
+    }
+    auto &regs = vcpu.GetRegisters();
+    regs.addressRegisters[0].data.longword = 0x4000;
+    regs.addressRegisters[1].data.longword = 0x4010;
+    regs.addressRegisters[2].data.longword = 0x5000;
+    regs.addressRegisters[3].data.longword = 0x600c;
+    regs.dataRegisters[0].data.longword = 8;
+    regs.dataRegisters[1].data.longword = static_cast<uint64_t>(-4);
+
+    auto &simdRegs = vcpu.GetExtensionState<SIMDRegisters>();
+    // indices, v2 spans two cache lines
+    static const int32_t indices[4] = {3, 0, 17, -1};
+    static const int32_t scatterIndices[4] = {0, 2, 16, 17};
+    for(int i=0;i<4;i++) {
+        simdRegs.registers[1].i32[i] = indices[i];
+        simdRegs.registers[2].i32[i] = scatterIndices[i];
+    }
+
+    static const uint8_t kInt = kSimdOpLowFlags::kOpLowFlag_Integer;
+    static const uint8_t kAdv = kSimdOpLowFlags::kOpLowFlag_Advance;
+    uint8_t code[]={
+        // ve_loads.i32 v0,(a0)+,d0
+        OperandCode::SIMD, SimdOpCode::LOADS, kOpFlag_SzFp32 | kOpFlag_SrcAddrReg, kInt | kAdv | 0, 0x00,
+        // ve_gather.i32 v3,(a1),v1
+        OperandCode::SIMD, SimdOpCode::GATHER, kOpFlag_SzFp32 | kOpFlag_SrcAddrReg, kInt | 3, 0x11,
+        // ve_scatter.i32 (a2),v0,v2
+        OperandCode::SIMD, SimdOpCode::SCATTER, kOpFlag_SzFp32 | kOpFlag_DstAddrReg, kInt | 2, 0x02,
+        // ve_stores.i32 (a3)+,v0,d1      <- negative stride, reversed
+        OperandCode::SIMD, SimdOpCode::STORES, kOpFlag_SzFp32 | kOpFlag_DstAddrReg, kInt | kAdv | 3, 0x01,
+        // ve_gather.i32 v1,(a1),v1       <- indices and destination are the same register
+        OperandCode::SIMD, SimdOpCode::GATHER, kOpFlag_SzFp32 | kOpFlag_SrcAddrReg, kInt | 1, 0x11,
+        OperandCode::BRK,
+    };
+    RunSimdCode(vcpu, code, sizeof(code));
+
+    static const int32_t expectedGather[4] = {107, 104, 121, 103};
+    for(int i=0;i<4;i++) {
+        TR_ASSERT(t, simdRegs.registers[0].i32[i] == 100 + 2 * i);
+        TR_ASSERT(t, simdRegs.registers[3].i32[i] == expectedGather[i]);
+        TR_ASSERT(t, simdRegs.registers[1].i32[i] == expectedGather[i]);
+        TR_ASSERT(t, mmu.Read<uint32_t>(0x600c - i * 4) == (uint32_t)(100 + 2 * i));
+    }
+    TR_ASSERT(t, regs.addressRegisters[0].data.longword == 0x4020);
+    TR_ASSERT(t, regs.addressRegisters[3].data.longword == 0x5ffc);
+    // scatter only touches the indexed lanes
+    TR_ASSERT(t, mmu.Read<uint32_t>(0x5000) == 100);
+    TR_ASSERT(t, mmu.Read<uint32_t>(0x5004) == 0);
+    TR_ASSERT(t, mmu.Read<uint32_t>(0x5008) == 102);
+    TR_ASSERT(t, mmu.Read<uint32_t>(0x5040) == 104);
+    TR_ASSERT(t, mmu.Read<uint32_t>(0x5044) == 106);
+
+    return kTR_Pass;
+}
+
+// Dot products work on groups of 4 lanes, i64 at VL128 only has two
+DLL_EXPORT int test_simd_exec_dotlanes(ITesting *t) {
+    VirtualCPU vcpu;
+    vcpu.Begin(execRam, sizeof(execRam));
+
+    auto &simdRegs = vcpu.GetExtensionState<SIMDRegisters>();
+    for(int i=0;i<4;i++) {
+        simdRegs.registers[0].i64[i] = i + 1;
+        simdRegs.registers[1].i64[i] = 2;
+        simdRegs.registers[2].i64[i] = 0x4711;
+    }
+
+    static const uint8_t kInt = kSimdOpLowFlags::kOpLowFlag_Integer;
+    uint8_t code[]={
+        // ve_dp4.i64 v2,v0,v1
+        OperandCode::SIMD, SimdOpCode::DP4, kOpFlag_SzFp64, kInt | 2, 0x01,
+        OperandCode::BRK,
+    };
+    RunSimdCode(vcpu, code, sizeof(code));
+
+    // Invalid instruction (not enabled - halts), nothing is written
+    TR_ASSERT(t, simdRegs.control.VectorBytes() == 16);
+    for(int i=0;i<4;i++) {
+        TR_ASSERT(t, simdRegs.registers[2].i64[i] == 0x4711);
+    }
+
     return kTR_Pass;
 }
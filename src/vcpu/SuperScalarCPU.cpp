@@ -46,7 +46,8 @@ bool InstructionPipeline::Tick(CPUBase &cpu) {
 
     // Start decoding another instruction if we have one
     // Note: 'BeginNext' will perform the initial TICK to push the decoder from IDLE
-    if (pipelineDecoders[idxNextAvail].IsIdle()) {
+    // Nothing younger than a serializing instruction (fence, cache maintenance) is started until it has executed
+    if (pipelineDecoders[idxNextAvail].IsIdle() && !HaveSerializing()) {
         return BeginNext(cpu);
     }
     return true;
@@ -91,6 +92,16 @@ bool InstructionPipeline::IsEmpty() {
     return true;
 }
 
+// Check if any decoder holds a serializing instruction
+bool InstructionPipeline::HaveSerializing() {
+    for(auto &pipelineDecoder : pipelineDecoders) {
+        if (!pipelineDecoder.IsIdle() && pipelineDecoder.decoder->IsSerializing()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Update all decoders in the pipeline - IF they have anything to process...
 bool InstructionPipeline::UpdatePipeline(CPUBase &cpu) {
     // Update the pipeline and push to dispatcher
@@ -108,6 +119,32 @@ bool InstructionPipeline::UpdatePipeline(CPUBase &cpu) {
         // Are we ready to execute - in that case - finalize
         // This is enforcing in-order execution - through 'idNextExec'
         if (CanExecute(pipelineDecoder)) {
+            if (pipelineDecoder.decoder->IsResolvableBranch()) {
+                // Note: Waits for the dispatcher to drain if needed
+                ResolveBranch(cpu, pipelineDecoder);
+                continue;
+            }
+            // Serializing instructions execute once everything older has executed, they execute alone so they
+            // know where they started (block operations re-execute themselves)
+            if (pipelineDecoder.decoder->IsSerializing()) {
+                if (!cpu.GetDispatch().IsEmpty()) {
+                    continue;
+                }
+                cpu.instrStartAddress = pipelineDecoder.ip.data.longword;
+            }
+            // A memory operand faulted during decoding - raised once everything older has executed (the fault is
+            // precise), anything younger was fetched after it and is discarded
+            if (pipelineDecoder.decoder->HavePendingFault()) {
+                if (!cpu.GetDispatch().IsEmpty()) {
+                    continue;
+                }
+                cpu.instrStartAddress = pipelineDecoder.ip.data.longword;
+                pipelineDecoder.decoder->Finalize(cpu);
+                idNextExec = NextExecID(idNextExec);
+                pipelineDecoder.Reset();
+                DiscardFetched();
+                continue;
+            }
             // Finalize and push to dispatcher..
             pipelineDecoder.decoder->Finalize(cpu);
             idNextExec = NextExecID(idNextExec);
@@ -176,6 +213,45 @@ bool InstructionPipeline::CanExecute(InstructionPipeline::PipeLineDecoder &plDec
     return true;
 }
 
+//
+// Resolve a branch which is next to execute, the branch is not pushed to the dispatcher
+// Returns
+//      false - older instructions have not yet executed, try again next tick
+//      true  - resolved, if taken the pipeline was flushed and the instr. pointer is at the target
+//
+bool InstructionPipeline::ResolveBranch(CPUBase &cpu, InstructionPipeline::PipeLineDecoder &plDecoder) {
+    // The registers are read when resolving - anything older must have been executed
+    if (!cpu.GetDispatch().IsEmpty()) {
+        return false;
+    }
+
+    uint64_t target = 0;
+    bool taken = plDecoder.decoder->ResolveBranch(cpu, target);
+    idNextExec = NextExecID(idNextExec);
+    plDecoder.Reset();
+    if (!taken) {
+        return true;
+    }
+
+    fmt::println("  ** BRANCH **: taken to {}", target);
+    // Everything still in the pipeline was fetched after the branch, discard it and restart at the target
+    DiscardFetched();
+    cpu.SetInstrPtr(target);
+    return true;
+}
+
+//
+// Drop everything in flight, the caller has moved the instr. pointer to where fetching continues
+//
+void InstructionPipeline::DiscardFetched() {
+    for(auto &pipelineDecoder : pipelineDecoders) {
+        if (!pipelineDecoder.IsIdle()) {
+            pipelineDecoder.Reset();
+        }
+    }
+    idExec = idNextExec;
+}
+
 //
 // Begin's decoding on the next available decoder in the pipeline (note: caller must check if nextAvailable is free)
 // Returns
@@ -218,7 +294,7 @@ void SuperScalarCPU::QuickStart(void *ptrRam, size_t sizeOfRam) {
             .tickCounter = 0,
     };
 
-    AddPeripheral(CPUIntFlag::INT0, CPUKnownIntIds::kTimer0, Timer::Create(&timerConfigBlock));
+    AddPeripheral(CPUIntFlag::INT0, CPUKnownIntIds::kTimer0, Timer::Create(&timerConfigBlock, timerMode));
     pipeline.Reset();
     // NOTE: DO NOT CALL 'CPU::Reset' here since it will zero out the 'ram' ptr...
 }
@@ -227,7 +303,7 @@ void SuperScalarCPU::QuickStart(void *ptrRam, size_t sizeOfRam) {
 void SuperScalarCPU::Begin(void *ptrRam, size_t sizeOfRam) {
     CPUBase::Begin(ptrRam, sizeOfRam);
     // Create the timers
-    AddPeripheral(CPUIntFlag::INT0, CPUKnownIntIds::kTimer0, Timer::Create(&systemBlock->timer0));
+    AddPeripheral(CPUIntFlag::INT0, CPUKnownIntIds::kTimer0, Timer::Create(&systemBlock->timer0, timerMode));
     pipeline.Reset();
 }
 
@@ -238,6 +314,9 @@ void SuperScalarCPU::Reset() {
 }
 
 bool SuperScalarCPU::Tick() {
+    // One tick is one cycle, let peripherals catch up
+    RetireCycles(1);
+    UpdatePeripherals();
     // well - do this one we have something
     return false;
 }
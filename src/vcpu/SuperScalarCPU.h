@@ -30,6 +30,12 @@ namespace gnilk {
         // - track number of 'stalls' either due to waiting for an instruction to become in-order or
         //   if a wait occurs due to dependencies
         //
+        // Compare and branch instructions (breq/brne/brlt/brge) don't depend on the status flags, they are resolved
+        // by the pipeline once all older instructions have executed - a taken branch discards everything fetched
+        // after it and restarts fetching at the target.
+        // Serializing instructions (fence, cflush/cinval/cclean) wait for all older instructions to execute and no
+        // younger instruction is fetched until they have executed.
+        //
         class InstructionPipeline {
         public:
             using OnInstructionDecoded = std::function<void(InstructionDecoderBase &decoder)>;
@@ -72,6 +78,7 @@ namespace gnilk {
             void Reset();
             bool Tick(CPUBase &cpu);    // Progress one tick
             bool IsEmpty();             // Check if pipeline is empty
+            bool HaveSerializing();     // Check if a serializing instruction is in flight
             void Flush(CPUBase &cpu);               // Flush pipeline
 
             size_t GetTickCounter() {
@@ -82,6 +89,8 @@ namespace gnilk {
             bool UpdatePipeline(CPUBase &cpu);      // Update the complete pipeline
             bool ProcessDispatcher(CPUBase &cpu);
             bool CanExecute(PipeLineDecoder &plDecoder);    // check if we are allowed to execute an instruction
+            bool ResolveBranch(CPUBase &cpu, PipeLineDecoder &plDecoder);  // resolve a branch which is next to execute
+            void DiscardFetched();          // drop everything in flight (taken branch, fault)
             bool BeginNext(CPUBase &cpu);   // Start decoding the next instruction
             size_t NextExecID(size_t id);   // advance the Execute ID
 
@@ -6,6 +6,7 @@
 #include "System.h"
 #include "MemorySubSys/FlashBus.h"
 #include "MemorySubSys/RamBus.h"
+#include "MemorySubSys/DirectoryRamBus.h"
 #include "MemorySubSys/HWMappedBus.h"
 #include "VirtualCPU.h"
 
@@ -66,10 +67,46 @@ void SoC::Reset() {
         if (regions[i].flags & kRegionFlag_NonVolatile) continue;
         if (regions[i].ptrPhysical == nullptr) continue;
 
+        // Anything in the L2 is stale now..
+        if (is_instanceof<RamBus>(regions[i].bus.get())) {
+            auto ramBus = std::static_pointer_cast<RamBus>(regions[i].bus);
+            if (ramBus->GetL2Cache() != nullptr) {
+                ramBus->GetL2Cache()->Invalidate();
+            }
+        }
+
         memset(regions[i].ptrPhysical,0,regions[i].szPhysical);
     }
 }
 
+void SoC::SetCoherenceProtocol(kCoherenceProtocol newProtocol) {
+    coherenceProtocol = newProtocol;
+    for(int i=0;i<VCPU_SOC_MAX_CORES;i++) {
+        if (cores[i].cpu == nullptr) continue;
+        cores[i].cpu->memoryUnit.GetCacheController().SetCoherenceProtocol(newProtocol);
+    }
+}
+
+void SoC::EnableL2Cache(const L2CacheConfig &config) {
+    for(int i=0; i < VCPU_MEM_MAX_REGIONS; i++) {
+        if (!(regions[i].flags & kRegionFlag_Valid)) continue;
+        if (!is_instanceof<RamBus>(regions[i].bus.get())) continue;
+
+        auto ramBus = std::static_pointer_cast<RamBus>(regions[i].bus);
+        ramBus->SetL2Cache(L2Cache::Create(config));
+    }
+}
+
+void SoC::DisableL2Cache() {
+    for(int i=0; i < VCPU_MEM_MAX_REGIONS; i++) {
+        if (!(regions[i].flags & kRegionFlag_Valid)) continue;
+        if (!is_instanceof<RamBus>(regions[i].bus.get())) continue;
+
+        auto ramBus = std::static_pointer_cast<RamBus>(regions[i].bus);
+        ramBus->SetL2Cache(nullptr);
+    }
+}
+
 void SoC::SetDefaults() {
     //
     // The default SoC memory configuration has 3 regions;
@@ -106,7 +143,11 @@ void SoC::CreateMemoryRegionsFromConfig(std::span<MemoryRegionConfiguration> con
 
         switch(c.regionFlags) {
             case kMemRegion_Default_Ram :
-                region.bus = RamBus::Create(new RamMemory(region.ptrPhysical, region.szPhysical));
+                if (c.coherence == kCoherenceMode::Directory) {
+                    region.bus = DirectoryRamBus::Create(new RamMemory(region.ptrPhysical, region.szPhysical));
+                } else {
+                    region.bus = RamBus::Create(new RamMemory(region.ptrPhysical, region.szPhysical));
+                }
                 break;
             case kMemRegion_Default_Flash :
                 region.bus = FlashBus::Create(new RamMemory(region.ptrPhysical, region.szPhysical));
@@ -46,6 +46,17 @@ namespace gnilk {
 
             void CreateMemoryRegionsFromConfig(std::span<MemoryRegionConfiguration> configs);
 
+            // Attach a shared L2 cache between the bus and RAM for all RAM regions (each RAM region gets its own L2)
+            void EnableL2Cache(const L2CacheConfig &config);
+            // Flush and detach the L2 from all RAM regions
+            void DisableL2Cache();
+
+            // Cache coherence protocol used by all data caches (default is MESI), switching flushes the core caches
+            void SetCoherenceProtocol(kCoherenceProtocol newProtocol);
+            kCoherenceProtocol GetCoherenceProtocol() const {
+                return coherenceProtocol;
+            }
+
             void MapRegion(uint8_t region, uint8_t flags, uint64_t start, uint64_t end);
             void MapRegion(uint8_t region, uint8_t flags, uint64_t start, uint64_t end, MemoryAccessHandler handler);
 
@@ -114,6 +125,24 @@ namespace gnilk {
 
                 return true;
             }
+            // All of [address, address+nBytes) must be mapped, the range may span regions
+            bool HaveRegionForRange(uint64_t address, size_t nBytes) {
+                if (nBytes == 0) {
+                    return HaveRegionForAddress(address);
+                }
+                auto last = address + nBytes - 1;
+                if (last < address) {
+                    return false;
+                }
+                while(HaveRegionForAddress(address)) {
+                    auto &region = RegionFromAddress(address);
+                    if (last <= region.vAddrEnd) {
+                        return true;
+                    }
+                    address = region.vAddrEnd + 1;
+                }
+                return false;
+            }
 
             Core &GetCore(size_t idxCore) {
                 // YEAH!
@@ -130,6 +159,7 @@ namespace gnilk {
             void CreateDefaultFlashRegion(size_t idxRegion);
         private:
             bool isInitialized = false;
+            kCoherenceProtocol coherenceProtocol = kCoherenceProtocol::MESI;
             Core cores[VCPU_SOC_MAX_CORES];
             // FIXME: Replace with 'memory configuration'
             MemoryRegion regions[VCPU_MEM_MAX_REGIONS];
@@ -3,6 +3,7 @@
 //
 
 #include <chrono>
+#include <algorithm>
 #include "Timer.h"
 #include <thread>
 
@@ -13,8 +14,8 @@ Timer::~Timer() {
     DoStop();
 }
 
-Peripheral::Ref Timer::Create(TimerConfigBlock *ptrConfigBlock) {
-    auto t = std::make_shared<Timer>(ptrConfigBlock);
+Peripheral::Ref Timer::Create(TimerConfigBlock *ptrConfigBlock, kTimerMode timerMode) {
+    auto t = std::make_shared<Timer>(ptrConfigBlock, timerMode);
     return t;
 }
 
@@ -24,6 +25,18 @@ bool Timer::Start() {
     }
     bStopTimer = false;
 
+    // Virtual time - no thread, we just put ourselves in the CPU's event queue
+    if (mode == kTimerMode::VirtualTime) {
+        if (scheduler == nullptr) {
+            return false;
+        }
+        bIsScheduled = true;
+        cyclesPerTick = CyclesPerTick();
+        cycleNextTick = scheduler->GetCycleCount() + cyclesPerTick;
+        OnScheduledEvent(scheduler->GetCycleCount());
+        return true;
+    }
+
     auto t = std::thread([this](){
         ThreadFunc();
     });
@@ -38,6 +51,17 @@ bool Timer::Stop() {
 
 // We call 'Stop' from DTOR - shouldn't call virtual functions from there...
 bool Timer::DoStop() {
+    if (mode == kTimerMode::VirtualTime) {
+        if (!bIsScheduled) {
+            return false;
+        }
+        scheduler->CancelEvent(idNextEvent);
+        config->control.enable = false;
+        bIsScheduled = false;
+        bStopTimer = true;
+        return true;
+    }
+
     if (!timerThread.joinable()) {
         return false;
     }
@@ -109,3 +133,61 @@ void Timer::CountTicks() {
         tLast = tNow;
     }
 }
+
+//
+// Virtual time, called from the CPU when the cycle we asked for has been reached.
+// There is no way for us to know when the control block is changed - so we sample it at the tick rate or at
+// VCPU_TIMER_CONTROL_POLL_HZ (emulated time), whichever comes first.
+//
+void Timer::OnScheduledEvent(uint64_t cycle) {
+    if (bStopTimer || !bIsScheduled) {
+        return;
+    }
+
+    if (config->control.reset) {
+        config->tickCounter = 0;
+        config->control.reset = 0;
+
+        // In order to change frequency you need to 'reset' the clock
+        freqSec = config->freqSec;
+        cyclesPerTick = CyclesPerTick();
+        cycleNextTick = cycle + cyclesPerTick;
+    }
+
+    if (!config->control.enable) {
+        config->control.running = 0;
+        idNextEvent = scheduler->SchedulePeripheral(this, cycle + CyclesPerControlPoll());
+        return;
+    }
+
+    // Just enabled - start counting from here
+    if (!config->control.running) {
+        cycleNextTick = cycle + cyclesPerTick;
+    }
+    config->control.running = 1;
+
+    if (cycle >= cycleNextTick) {
+        config->tickCounter++;
+        RaiseInterrupt();
+        // Keep the cadence, unless we have fallen behind more than a full tick
+        cycleNextTick += cyclesPerTick;
+        if (cycleNextTick <= cycle) {
+            cycleNextTick = cycle + cyclesPerTick;
+        }
+    }
+
+    idNextEvent = scheduler->SchedulePeripheral(this, std::min(cycleNextTick, cycle + CyclesPerControlPoll()));
+}
+
+uint64_t Timer::CyclesPerTick() const {
+    auto clockFreq = scheduler->GetClockFrequency();
+    if ((freqSec == 0) || (freqSec > clockFreq)) {
+        return freqSec==0?clockFreq:1;
+    }
+    return clockFreq / freqSec;
+}
+
+uint64_t Timer::CyclesPerControlPoll() const {
+    auto cycles = scheduler->GetClockFrequency() / VCPU_TIMER_CONTROL_POLL_HZ;
+    return cycles==0?1:cycles;
+}
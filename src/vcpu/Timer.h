@@ -20,6 +20,14 @@ namespace gnilk {
             uint8_t reset : 1;
             uint8_t running : 1;
         };
+        enum class kTimerMode {
+            WallClock,      // Host thread measuring real time - non-deterministic, burns a host core
+            VirtualTime,    // Driven by retired CPU cycles, the timer schedules the next expiry with the CPU
+        };
+
+        // How often, in emulated time, a virtual timer samples the control block while waiting
+        static const uint64_t VCPU_TIMER_CONTROL_POLL_HZ = 1000;
+
         // This is the memory mapping for the timer...
         struct TimerConfigBlock {
             union {
@@ -34,7 +42,7 @@ namespace gnilk {
         public:
             using clock = std::chrono::high_resolution_clock;
         public:
-            Timer(TimerConfigBlock *ptrConfigBlock) : config(ptrConfigBlock) {
+            Timer(TimerConfigBlock *ptrConfigBlock, kTimerMode timerMode = kTimerMode::WallClock) : config(ptrConfigBlock), mode(timerMode) {
 
             }
             virtual ~Timer();
@@ -42,10 +50,15 @@ namespace gnilk {
             // FIXME: Timer should be created with a pointer to memory block for timer-cfg
             static Ref Create(uint64_t freqHz);
 
-            static Ref Create(TimerConfigBlock *ptrConfigBlock);
+            static Ref Create(TimerConfigBlock *ptrConfigBlock, kTimerMode timerMode = kTimerMode::WallClock);
 
             bool Start() override;
             bool Stop() override;
+            void OnScheduledEvent(uint64_t cycle) override;
+
+            kTimerMode GetMode() const {
+                return mode;
+            }
 
             // For unit testing
             std::mutex &GetLock() {
@@ -55,8 +68,11 @@ namespace gnilk {
             bool DoStop();
             void ThreadFunc();
             void CountTicks();
+            uint64_t CyclesPerTick() const;
+            uint64_t CyclesPerControlPoll() const;
         private:
             TimerConfigBlock *config = nullptr;
+            kTimerMode mode = kTimerMode::WallClock;
             bool bStopTimer = false;    // make atomic...
             std::thread timerThread;
             std::mutex lock;
@@ -67,6 +83,11 @@ namespace gnilk {
             // Internal - for emulation//
             bool bHaveFirstTime = false;
             clock::time_point tLast;
+            // Internal - virtual time
+            bool bIsScheduled = false;
+            uint64_t cyclesPerTick = 1;
+            uint64_t cycleNextTick = 0;
+            EventScheduler::EventId idNextEvent = 0;
         };
     }
 }
@@ -0,0 +1,191 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#include <string.h>
+#include <stddef.h>
+#include "UART.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+UART::~UART() {
+    DoStop();
+}
+
+Peripheral::Ref UART::Create() {
+    return std::make_shared<UART>();
+}
+
+void UART::Initialize() {
+    registers = {};
+    bRxIrqEnable = false;
+    bRxOverrun = false;
+    rxFifo.Clear();
+}
+
+bool UART::Start() {
+    if (txThread.joinable()) {
+        return false;
+    }
+    if (outputHandler == nullptr) {
+        SetOutput(stdout);
+    }
+    bStopThread = false;
+    txThread = std::thread([this]() {
+        ThreadFunc();
+    });
+    return true;
+}
+
+bool UART::Stop() {
+    return DoStop();
+}
+
+// We call 'Stop' from DTOR - shouldn't call virtual functions from there...
+bool UART::DoStop() {
+    if (!txThread.joinable()) {
+        return false;
+    }
+    bStopThread = true;
+    bTxThreadSleeping = false;
+    bTxThreadSleeping.notify_one();
+    txThread.join();
+    // Whatever the guest managed to write before we stopped
+    FlushTx();
+    return true;
+}
+
+void UART::SetOutput(FILE *newOutput) {
+    SetOutputHandler([newOutput](const uint8_t *data, size_t nBytes) {
+        fwrite(data, 1, nBytes, newOutput);
+        fflush(newOutput);
+    });
+}
+
+void UART::SetOutputHandler(OutputHandler newOutputHandler) {
+    outputHandler = std::move(newOutputHandler);
+}
+
+void UART::ThreadFunc() {
+    while(!bStopThread) {
+        if (FlushTx() > 0) {
+            continue;
+        }
+        // Nothing to do, sleep until the guest writes something - must check again once the flag is visible
+        // otherwise we could miss a wake-up
+        bTxThreadSleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!txFifo.IsEmpty() || bStopThread) {
+            bTxThreadSleeping = false;
+            continue;
+        }
+        bTxThreadSleeping.wait(true);
+    }
+}
+
+// Called on the CPU thread for every byte - keep it cheap when the TX thread is busy anyway
+void UART::WakeTxThread() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (bTxThreadSleeping.load(std::memory_order_relaxed) && bTxThreadSleeping.exchange(false)) {
+        bTxThreadSleeping.notify_one();
+    }
+}
+
+// Everything available goes to the output in one call
+size_t UART::FlushTx() {
+    uint8_t batch[VCPU_UART_FIFO_SIZE];
+    auto nBytes = txFifo.Read(batch, sizeof(batch));
+    if (nBytes == 0) {
+        return 0;
+    }
+    if (outputHandler != nullptr) {
+        outputHandler(batch, nBytes);
+    }
+    stats.txBytes += nBytes;
+    stats.txBatches++;
+    return nBytes;
+}
+
+size_t UART::Receive(const void *src, size_t nBytes) {
+    auto nWritten = rxFifo.Write(src, nBytes);
+    stats.rxBytes += nWritten;
+    if (nWritten < nBytes) {
+        stats.rxDropped += nBytes - nWritten;
+        bRxOverrun = true;
+    }
+    if ((nWritten > 0) && bRxIrqEnable) {
+        RaiseInterrupt();
+    }
+    return nWritten;
+}
+
+uint64_t UART::Read64(uint64_t offset) {
+    switch(offset) {
+        case offsetof(UARTRegisters, data) :
+            return PopRx();
+        case offsetof(UARTRegisters, status) :
+            return ReadStatus();
+        case offsetof(UARTRegisters, controlBits) :
+            return registers.controlBits;
+        case offsetof(UARTRegisters, rxCount) :
+            return rxFifo.BytesAvailable();
+        default:
+            return 0;
+    }
+}
+
+// Narrow writes merge with this - only 'control' is writable, everything else would have side effects or is read-only
+uint64_t UART::ReadRaw64(uint64_t offset) {
+    if (offset == offsetof(UARTRegisters, controlBits)) {
+        return registers.controlBits;
+    }
+    return 0;
+}
+
+void UART::Write64(uint64_t offset, uint64_t value) {
+    switch(offset) {
+        case offsetof(UARTRegisters, data) :
+            PushTx(value & 0xff);
+            break;
+        case offsetof(UARTRegisters, controlBits) :
+            registers.controlBits = value;
+            bRxIrqEnable = registers.control.rxIrqEnable;
+            break;
+        default:
+            break;
+    }
+}
+
+// Empty FIFO reads as zero - check the status first
+uint8_t UART::PopRx() {
+    uint8_t value = 0;
+    rxFifo.Read(&value, 1);
+    return value;
+}
+
+void UART::PushTx(uint8_t value) {
+    if (txFifo.Write(&value, 1) == 0) {
+        stats.txDropped++;
+        return;
+    }
+    WakeTxThread();
+}
+
+// Note: Reading the status clears the overrun flag
+uint64_t UART::ReadStatus() {
+    uint64_t status = 0;
+    if (!rxFifo.IsEmpty()) {
+        status |= kUARTStatus_RxAvailable;
+    }
+    if (txFifo.IsFull()) {
+        status |= kUARTStatus_TxFull;
+    }
+    if (txFifo.IsEmpty()) {
+        status |= kUARTStatus_TxEmpty;
+    }
+    if (bRxOverrun.exchange(false)) {
+        status |= kUARTStatus_RxOverrun;
+    }
+    return status;
+}
@@ -0,0 +1,154 @@
+//
+// Created by gnilk on 19.10.26.
+//
+
+#ifndef VCPU_UART_H
+#define VCPU_UART_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <atomic>
+#include <thread>
+#include <functional>
+
+#include "Peripheral.h"
+#include "Ringbuffer.h"
+#include "MemorySubSys/HWMappedBus.h"
+
+namespace gnilk {
+    namespace vcpu {
+
+        //
+        // Memory mapped UART - the guest writes bytes to 'data' which end up in the TX FIFO, a host thread drains the
+        // FIFO in batches to the output (stdout, a file or a pipe). The host pushes data with 'Receive', it ends up in
+        // the RX FIFO and raises the RX interrupt (if enabled). The guest reads it back from 'data'.
+        // Both FIFO's are lock-free, the guest never waits for the host (and vice versa).
+        //
+        // Registers are 64 bit in guest byte order (MSB first, like the MMU), the data byte is the LSB - i.e.
+        // at offset 7. Writing/reading a single byte at 'data + 7' or a full 64 bit value at 'data' both work.
+        //
+
+        // FIFO sizes, must be power of two
+        #ifndef VCPU_UART_FIFO_SIZE
+        #define VCPU_UART_FIFO_SIZE 4096
+        #endif
+
+        enum kUARTStatus : uint64_t {
+            kUARTStatus_RxAvailable = 1,
+            kUARTStatus_TxFull = 2,
+            kUARTStatus_TxEmpty = 4,
+            kUARTStatus_RxOverrun = 8,      // host data was dropped, RX FIFO was full - cleared when read
+        };
+
+        struct UARTControl {
+            uint8_t rxIrqEnable : 1;        // raise an interrupt when data arrives
+        };
+
+        // This is the register layout as seen through the HW mapped bus
+        struct UARTRegisters {
+            uint64_t data = {};             // write: TX, read: RX - the byte is at offset 7
+            uint64_t status = {};           // kUARTStatus, read-only
+            union {
+                UARTControl control;
+                uint64_t controlBits = {};
+            };
+            uint64_t rxCount = {};          // bytes waiting in the RX FIFO, read-only
+        };
+
+        class UART : public Peripheral, public HWMappedDevice {
+        public:
+            using OutputHandler = std::function<void(const uint8_t *data, size_t nBytes)>;
+            // Updated by the TX thread, the guest and the host side - read them from anywhere
+            struct Statistics {
+                std::atomic<uint64_t> txBytes = 0;
+                std::atomic<uint64_t> txBatches = 0;     // number of calls to the output handler
+                std::atomic<uint64_t> txDropped = 0;     // guest wrote to a full TX FIFO
+                std::atomic<uint64_t> rxBytes = 0;
+                std::atomic<uint64_t> rxDropped = 0;
+            };
+        public:
+            UART() = default;
+            virtual ~UART();
+
+            static Ref Create();
+
+            void Initialize() override;
+            // Starts the TX thread
+            bool Start() override;
+            // Stops the TX thread, anything left in the TX FIFO is written to the output
+            bool Stop() override;
+
+            // Default output is stdout, use a FILE from 'fopen'/'popen'/'fdopen' for files and pipes
+            // Note: Set the output before the UART is started
+            void SetOutput(FILE *newOutput);
+            void SetOutputHandler(OutputHandler newOutputHandler);
+
+            // Host side, push data to the guest - returns number of bytes accepted
+            // Note: Single producer, only one host thread should call this
+            size_t Receive(const void *src, size_t nBytes);
+
+            // Drain the TX FIFO on the calling thread - when not started
+            size_t FlushTx();
+
+            // HWMappedDevice, see 'UARTRegisters' - the narrow accesses are overridden, reading 'data' has side effects
+            uint64_t Read64(uint64_t offset) override;
+            void Write64(uint64_t offset, uint64_t value) override;
+            uint32_t Read32(uint64_t offset) override { return ReadDataOrNarrow<uint32_t>(offset); }
+            uint16_t Read16(uint64_t offset) override { return ReadDataOrNarrow<uint16_t>(offset); }
+            uint8_t Read8(uint64_t offset) override { return ReadDataOrNarrow<uint8_t>(offset); }
+            void Write32(uint64_t offset, uint32_t value) override { WriteDataOrNarrow<uint32_t>(offset, value); }
+            void Write16(uint64_t offset, uint16_t value) override { WriteDataOrNarrow<uint16_t>(offset, value); }
+            void Write8(uint64_t offset, uint8_t value) override { WriteDataOrNarrow<uint8_t>(offset, value); }
+            uint64_t ReadRaw64(uint64_t offset) override;
+            size_t GetMappedSize() const override {
+                return sizeof(UARTRegisters);
+            }
+
+            const Statistics &GetStatistics() const {
+                return stats;
+            }
+        protected:
+            bool DoStop();
+            void ThreadFunc();
+            void WakeTxThread();
+            uint64_t ReadStatus();
+            uint8_t PopRx();
+            void PushTx(uint8_t value);
+
+            // Only an access including the data byte touches the FIFO's, the rest of the data register reads as zero
+            template<typename T>
+            T ReadDataOrNarrow(uint64_t offset) {
+                if (offset >= sizeof(uint64_t)) {
+                    return ReadNarrow<T>(offset);
+                }
+                return ((offset + sizeof(T)) == sizeof(uint64_t)) ? PopRx() : 0;
+            }
+            template<typename T>
+            void WriteDataOrNarrow(uint64_t offset, T value) {
+                if (offset >= sizeof(uint64_t)) {
+                    WriteNarrow<T>(offset, value);
+                    return;
+                }
+                if ((offset + sizeof(T)) == sizeof(uint64_t)) {
+                    PushTx(value & 0xff);
+                }
+            }
+        private:
+            LockFreeRingbuffer<VCPU_UART_FIFO_SIZE> txFifo;
+            LockFreeRingbuffer<VCPU_UART_FIFO_SIZE> rxFifo;
+            UARTRegisters registers = {};
+            Statistics stats = {};
+            std::atomic<bool> bRxOverrun = false;
+            std::atomic<bool> bRxIrqEnable = false;     // copy of the control bit, 'Receive' runs on a host thread
+
+            OutputHandler outputHandler = nullptr;
+            std::thread txThread;
+            std::atomic<bool> bStopThread = false;
+            // Set by the TX thread before it goes to sleep, the guest side only notifies when this is set
+            std::atomic<bool> bTxThreadSleeping = false;
+        };
+    }
+}
+
+#endif //VCPU_UART_H
@@ -69,14 +69,14 @@ void VirtualCPU::QuickStart(void *ptrRam, size_t sizeOfRam) {
             .tickCounter = 0,
     };
 
-    AddPeripheral(CPUIntFlag::INT0, CPUKnownIntIds::kTimer0, Timer::Create(&timerConfigBlock));
+    AddPeripheral(CPUIntFlag::INT0, CPUKnownIntIds::kTimer0, Timer::Create(&timerConfigBlock, timerMode));
 }
 
 void VirtualCPU::Begin(void *ptrRam, size_t sizeOfRam) {
     CPUBase::Begin(ptrRam, sizeOfRam);
 
     // Create the timers
-    AddPeripheral(CPUIntFlag::INT0, CPUKnownIntIds::kTimer0, Timer::Create(&systemBlock->timer0));
+    AddPeripheral(CPUIntFlag::INT0, CPUKnownIntIds::kTimer0, Timer::Create(&systemBlock->timer0, timerMode));
 }
 
 
@@ -89,6 +89,8 @@ bool VirtualCPU::Step() {
 
     // FIXME: Need to check if ISR's are enabled
 
+    // 0) Time moves even if we are halted, otherwise nothing could wake us up
+    RetireCycles(1);
 
     // 1) update peripherals
     UpdatePeripherals();
@@ -113,6 +115,7 @@ bool VirtualCPU::Step() {
     auto &instructionSet = InstructionSetManager::Instance().GetInstructionSet();
     auto &instructionDecoder = instructionSet.GetDecoder();
 
+    instrStartAddress = registers.instrPointer.data.longword;
     // Perform full decoding of one instruction and push to dispatcher when done...
     if (!instructionDecoder.Decode(*this)) {
         return false;
@@ -0,0 +1,219 @@
+//
+// Created by gnilk on 19.10.26.
+//
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <memory>
+#include <testinterface.h>
+
+#include "System.h"
+#include "VirtualCPU.h"
+#include "DMAController.h"
+#include "MemorySubSys/MemoryUnit.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+
+extern "C" {
+DLL_EXPORT int test_dma(ITesting *t);
+DLL_EXPORT int test_dma_copy(ITesting *t);
+DLL_EXPORT int test_dma_scatter(ITesting *t);
+DLL_EXPORT int test_dma_error(ITesting *t);
+DLL_EXPORT int test_dma_loop(ITesting *t);
+DLL_EXPORT int test_dma_cpu(ITesting *t);
+}
+
+DLL_EXPORT int test_dma(ITesting *t) {
+    t->SetPreCaseCallback([](ITesting *) {
+        SoC::Instance().Reset();
+    });
+    return kTR_Pass;
+}
+
+static void WriteDescriptor(MMU &mmu, uint64_t address, const DMADescriptor &desc) {
+    mmu.Write<uint64_t>(address + offsetof(DMADescriptor, srcAddress), desc.srcAddress);
+    mmu.Write<uint64_t>(address + offsetof(DMADescriptor, dstAddress), desc.dstAddress);
+    mmu.Write<uint64_t>(address + offsetof(DMADescriptor, numBytes), desc.numBytes);
+    mmu.Write<uint64_t>(address + offsetof(DMADescriptor, next), desc.next);
+    mmu.Write<uint64_t>(address + offsetof(DMADescriptor, flags), desc.flags);
+}
+
+static void StartDMA(DMAController &dma, uint64_t descriptor) {
+    DMARegisters regs = {};
+    regs.control.start = 1;
+    // descriptor first, control last - like a driver would do it
+    dma.Write64(offsetof(DMARegisters, descriptor), descriptor);
+    dma.Write64(offsetof(DMARegisters, controlBits), regs.controlBits);
+}
+
+DLL_EXPORT int test_dma_copy(ITesting *t) {
+    MMU core0;
+    MMU core1;
+    core0.Initialize(0);
+    core1.Initialize(1);
+
+    // Source written by core0 - the last lines are still dirty in its cache
+    for(uint64_t i=0;i<256;i+=4) {
+        core0.Write<uint32_t>(0x8000 + i, 0xdead0000 + i);
+    }
+    // core1 holds (soon to be stale) copies of the destination
+    for(uint64_t i=0;i<256;i+=64) {
+        TR_ASSERT(t, core1.Read<uint32_t>(0x9000 + i) == 0);
+    }
+    WriteDescriptor(core0, 0x7000, {.srcAddress = 0x8000, .dstAddress = 0x9000, .numBytes = 256});
+
+    DMAController dma;
+    StartDMA(dma, 0x7000);
+    // Not attached to a CPU - the transfer is done right away
+    TR_ASSERT(t, dma.GetRegisters().status == kDMAStatus_Done);
+    TR_ASSERT(t, dma.GetRegisters().bytesTransferred == 256);
+    // Aligned - one read and one write per line
+    TR_ASSERT(t, dma.GetStatistics().lineWrites == 4);
+
+    for(uint64_t i=0;i<256;i+=4) {
+        TR_ASSERT(t, core1.Read<uint32_t>(0x9000 + i) == (0xdead0000 + i));
+    }
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_dma_scatter(ITesting *t) {
+    MMU core0;
+    core0.Initialize(0);
+
+    for(uint64_t i=0;i<256;i++) {
+        core0.Write<uint8_t>(0x8000 + i, i+1);
+    }
+    // Gather three unaligned pieces into one buffer
+    WriteDescriptor(core0, 0x7000, {.srcAddress = 0x8003, .dstAddress = 0x9001, .numBytes = 10, .next = 0x7040});
+    WriteDescriptor(core0, 0x7040, {.srcAddress = 0x8040, .dstAddress = 0x900b, .numBytes = 70, .next = 0x7080});
+    WriteDescriptor(core0, 0x7080, {.srcAddress = 0x8000, .dstAddress = 0x9051, .numBytes = 1, .next = 0, .flags = kDMADescFlag_Interrupt});
+
+    DMAController dma;
+    StartDMA(dma, 0x7000);
+    TR_ASSERT(t, dma.GetRegisters().status == kDMAStatus_Done);
+    TR_ASSERT(t, dma.GetRegisters().bytesTransferred == 81);
+    TR_ASSERT(t, dma.GetStatistics().descriptors == 3);
+
+    // Bytes around the destination must be intact
+    TR_ASSERT(t, core0.Read<uint8_t>(0x9000) == 0);
+    TR_ASSERT(t, core0.Read<uint8_t>(0x9052) == 0);
+    for(uint64_t i=0;i<10;i++) {
+        TR_ASSERT(t, core0.Read<uint8_t>(0x9001 + i) == 0x04 + i);
+    }
+    for(uint64_t i=0;i<70;i++) {
+        TR_ASSERT(t, core0.Read<uint8_t>(0x900b + i) == 0x41 + i);
+    }
+    TR_ASSERT(t, core0.Read<uint8_t>(0x9051) == 0x01);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_dma_error(ITesting *t) {
+    MMU core0;
+    core0.Initialize(0);
+
+    // Destination in a region that doesn't exist
+    WriteDescriptor(core0, 0x7000, {.srcAddress = 0x8000, .dstAddress = 0x0f00'0000'0000'0000, .numBytes = 16});
+    DMAController dma;
+    StartDMA(dma, 0x7000);
+    TR_ASSERT(t, dma.GetRegisters().status == kDMAStatus_Error);
+
+    // Not a register
+    TR_ASSERT(t, dma.Read64(sizeof(DMARegisters)) == 0);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_dma_loop(ITesting *t) {
+    MMU core0;
+    core0.Initialize(0);
+
+    // Self-linked - must not spin forever when not attached to a CPU
+    WriteDescriptor(core0, 0x7000, {.srcAddress = 0x8000, .dstAddress = 0x9000, .numBytes = 16, .next = 0x7000});
+    DMAController dma({.maxDescriptors = 8});
+    StartDMA(dma, 0x7000);
+    TR_ASSERT(t, dma.GetRegisters().status == kDMAStatus_Error);
+    TR_ASSERT(t, dma.GetStatistics().descriptors == 8);
+    TR_ASSERT(t, dma.GetRegisters().bytesTransferred == 8 * 16);
+
+    // Same with the default limit, an empty descriptor moves nothing but is still counted
+    WriteDescriptor(core0, 0x7000, {.numBytes = 0, .next = 0x7000});
+    DMAController dmaDefault;
+    StartDMA(dmaDefault, 0x7000);
+    TR_ASSERT(t, dmaDefault.GetRegisters().status == kDMAStatus_Error);
+    TR_ASSERT(t, dmaDefault.GetRegisters().bytesTransferred == 0);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_dma_cpu(ITesting *t) {
+    static uint8_t ram[32*4096];
+    memset(ram, 0, sizeof(ram));
+
+    // NOP's everywhere - we just need time to pass
+    uint8_t nops[256];
+    memset(nops, OperandCode::NOP, sizeof(nops));
+    ISR_VECTOR_TABLE isrTable = {
+            .isr0 = 0x1000,
+    };
+    // Descriptor in guest byte order
+    uint8_t desc[sizeof(DMADescriptor)] = {};
+    MMU::ToByteStream<uint64_t>(&desc[offsetof(DMADescriptor, srcAddress)], 0x8000);
+    MMU::ToByteStream<uint64_t>(&desc[offsetof(DMADescriptor, dstAddress)], 0x9000);
+    MMU::ToByteStream<uint64_t>(&desc[offsetof(DMADescriptor, numBytes)], 512);
+    uint8_t data[512];
+    for(int i=0;i<512;i++) {
+        data[i] = i & 255;
+    }
+
+    VirtualCPU vcpu;
+    vcpu.Begin(ram, sizeof(ram));
+    vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+    vcpu.LoadDataToRam(0x1000, nops, sizeof(nops));
+    vcpu.LoadDataToRam(0x2000, nops, sizeof(nops));
+    vcpu.LoadDataToRam(0x7000, desc, sizeof(desc));
+    vcpu.LoadDataToRam(0x8000, data, sizeof(data));
+    vcpu.SetInstrPtr(0x2000);
+
+    auto dma = std::make_shared<DMAController>(DMAConfig{.cyclesPerLine = 4, .linesPerBurst = 2});
+    TR_ASSERT(t, vcpu.AddPeripheral(INT1, 1, dma));
+    vcpu.EnableInterrupt(INT1);
+
+    // Program it through the HW mapped region - like the guest would
+    auto region = SoC::Instance().GetFirstRegionMatching(kRegionFlag_HWMapping);
+    TR_ASSERT(t, region != nullptr);
+    auto hwbus = std::static_pointer_cast<HWMappedBus>(region->bus);
+    TR_ASSERT(t, dma->MapToBus(hwbus, 0x100));
+
+    MMU mmu;
+    mmu.Initialize(0);
+    uint64_t addrRegs = region->vAddrStart + 0x100;
+    DMARegisters regs = {};
+    regs.control.start = 1;
+    regs.control.irqEnable = 1;
+    mmu.Write<uint64_t>(addrRegs + offsetof(DMARegisters, descriptor), 0x7000);
+    mmu.Write<uint64_t>(addrRegs + offsetof(DMARegisters, controlBits), regs.controlBits);
+    TR_ASSERT(t, mmu.Read<uint64_t>(addrRegs + offsetof(DMARegisters, status)) == kDMAStatus_Busy);
+
+    // 8 lines, 2 per burst, 4 cycles per line => 32 cycles
+    for(int i=0;i<30;i++) {
+        vcpu.Step();
+    }
+    TR_ASSERT(t, dma->IsBusy());
+    TR_ASSERT(t, vcpu.GetISRState(1) == CPUISRState::Waiting);
+    for(int i=0;i<4;i++) {
+        vcpu.Step();
+    }
+    TR_ASSERT(t, mmu.Read<uint64_t>(addrRegs + offsetof(DMARegisters, status)) == kDMAStatus_Done);
+    TR_ASSERT(t, mmu.Read<uint64_t>(addrRegs + offsetof(DMARegisters, bytesTransferred)) == 512);
+    TR_ASSERT(t, dma->GetStatistics().busyCycles == 32);
+    TR_ASSERT(t, vcpu.GetISRState(1) == CPUISRState::Executing);
+
+    for(int i=0;i<512;i++) {
+        TR_ASSERT(t, mmu.Read<uint8_t>(0x9000 + i) == (i & 255));
+    }
+
+    return kTR_Pass;
+}
@@ -0,0 +1,115 @@
+//
+// Created by gnilk on 19.10.26.
+//
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <testinterface.h>
+
+#include "EventScheduler.h"
+#include "VirtualCPU.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+
+extern "C" {
+DLL_EXPORT int test_events(ITesting *t);
+DLL_EXPORT int test_events_order(ITesting *t);
+DLL_EXPORT int test_events_cancel(ITesting *t);
+DLL_EXPORT int test_events_reschedule(ITesting *t);
+DLL_EXPORT int test_events_cpu(ITesting *t);
+}
+DLL_EXPORT int test_events(ITesting *t) {
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_events_order(ITesting *t) {
+    EventScheduler scheduler;
+    std::vector<int> order;
+
+    scheduler.Schedule(30, [&order](uint64_t) { order.push_back(3); });
+    scheduler.Schedule(10, [&order](uint64_t) { order.push_back(1); });
+    scheduler.Schedule(20, [&order](uint64_t) { order.push_back(2); });
+    // Same cycle - should run in the order scheduled
+    scheduler.Schedule(20, [&order](uint64_t) { order.push_back(4); });
+    TR_ASSERT(t, scheduler.NextEventCycle() == 10);
+
+    // Nothing due
+    TR_ASSERT(t, !scheduler.IsDue(9));
+    TR_ASSERT(t, scheduler.RunUntil(9) == 0);
+
+    TR_ASSERT(t, scheduler.RunUntil(25) == 3);
+    TR_ASSERT(t, (order == std::vector<int>{1,2,4}));
+    TR_ASSERT(t, scheduler.NextEventCycle() == 30);
+
+    TR_ASSERT(t, scheduler.RunUntil(100) == 1);
+    TR_ASSERT(t, scheduler.NextEventCycle() == EventScheduler::kNoEvent);
+    TR_ASSERT(t, scheduler.GetNumPending() == 0);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_events_cancel(ITesting *t) {
+    EventScheduler scheduler;
+    int count = 0;
+
+    auto idA = scheduler.Schedule(10, [&count](uint64_t) { count += 1; });
+    scheduler.Schedule(10, [&count](uint64_t) { count += 10; });
+    TR_ASSERT(t, scheduler.GetNumPending() == 2);
+
+    TR_ASSERT(t, scheduler.Cancel(idA));
+    // Can't cancel twice
+    TR_ASSERT(t, !scheduler.Cancel(idA));
+    TR_ASSERT(t, scheduler.GetNumPending() == 1);
+
+    scheduler.RunUntil(10);
+    TR_ASSERT(t, count == 10);
+    // Already run
+    TR_ASSERT(t, !scheduler.Cancel(idA));
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_events_reschedule(ITesting *t) {
+    EventScheduler scheduler;
+    int count = 0;
+
+    // Periodic event, every 10 cycles - rescheduling from the handler
+    std::function<void(uint64_t)> periodic = [&](uint64_t cycle) {
+        count++;
+        scheduler.Schedule(cycle + 10, periodic);
+    };
+    scheduler.Schedule(10, periodic);
+
+    for(uint64_t cycle=0;cycle<=100;cycle++) {
+        scheduler.RunUntil(cycle);
+    }
+    TR_ASSERT(t, count == 10);
+    TR_ASSERT(t, scheduler.NextEventCycle() == 110);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_events_cpu(ITesting *t) {
+    static uint8_t ram[32*4096];
+    memset(ram, 0, sizeof(ram));
+
+    VirtualCPU vcpu;
+    vcpu.Begin(ram, sizeof(ram));
+    vcpu.SetInstrPtr(0x2000);
+
+    std::vector<uint64_t> fired;
+    auto now = vcpu.GetCycleCount();
+    vcpu.ScheduleEvent(now + 5, [&fired](uint64_t cycle) { fired.push_back(cycle); });
+    auto id = vcpu.ScheduleEvent(now + 7, [&fired](uint64_t cycle) { fired.push_back(cycle); });
+    vcpu.ScheduleEvent(now + 10, [&fired](uint64_t cycle) { fired.push_back(cycle); });
+    TR_ASSERT(t, vcpu.CancelEvent(id));
+
+    for(int i=0;i<20;i++) {
+        vcpu.Step();
+    }
+    TR_ASSERT(t, (fired == std::vector<uint64_t>{now + 5, now + 10}));
+
+    return kTR_Pass;
+}
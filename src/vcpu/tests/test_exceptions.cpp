@@ -9,6 +9,7 @@
 
 #include "VirtualCPU.h"
 #include "Timer.h"
+#include "System.h"
 
 using namespace gnilk;
 using namespace gnilk::vcpu;
@@ -23,6 +24,9 @@ extern "C" {
     DLL_EXPORT int test_exceptions_illegal_instr(ITesting *t);
     DLL_EXPORT int test_exceptions_in_isr(ITesting *t);
     DLL_EXPORT int test_exceptions_nested(ITesting *t);
+    DLL_EXPORT int test_exceptions_fault(ITesting *t);
+    DLL_EXPORT int test_exceptions_movsfault(ITesting *t);
+    DLL_EXPORT int test_exceptions_loadfault(ITesting *t);
 }
 DLL_EXPORT int test_exceptions(ITesting *t) {
     return kTR_Pass;
@@ -121,6 +125,8 @@ DLL_EXPORT int test_exceptions_in_isr(ITesting *t) {
             OperandCode::NOP, OperandCode::NOP, OperandCode::NOP,
             OperandCode::BRK
     };
+    // Timer runs in virtual time, with a 2kHz clock a 1kHz timer ticks every other instruction
+    vcpu.SetClockFrequency(2000);
     vcpu.Begin(ram, 32*4096);
     vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
     vcpu.LoadDataToRam(0x1000, isrRoutine, sizeof(isrRoutine));
@@ -147,10 +153,6 @@ DLL_EXPORT int test_exceptions_in_isr(ITesting *t) {
     sysblock->timer0.freqSec = 1000;
     sysblock->timer0.control.reset = 1;
     sysblock->timer0.control.enable = 1;
-    // Make this a generic thing
-    while(sysblock->timer0.control.running != 1) {
-        std::this_thread::yield();
-    }
 
 
     for(int i=0;i<30;i++) {
@@ -164,7 +166,6 @@ DLL_EXPORT int test_exceptions_in_isr(ITesting *t) {
         } else {
             fmt::println("{} --- halted ---", i);
         }
-        std::this_thread::sleep_for(std::chrono::microseconds(250));
     }
 
     fmt::println("irq counter={}", irq_counter);
@@ -177,6 +178,203 @@ DLL_EXPORT int test_exceptions_in_isr(ITesting *t) {
     return kTR_Pass;
 }
 
+// Demand paging style - the handler fixes the cause and RTE re-executes the faulting instruction
+DLL_EXPORT int test_exceptions_fault(ITesting *t) {
+    VirtualCPU vcpu;
+    ISR_VECTOR_TABLE isrTable = {
+            .exp_illegal_instr = 0x1200,        // catch-all, should not be used
+            .exp_mmu_fault = 0x1000,
+    };
+
+    uint8_t expRoutine[]={
+            // move.l d0,0x01
+            0x20,0x03,0x03,0x01, 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,
+            // syscall
+            OperandCode::SYS,
+            // rte
+            OperandCode::RTE,
+    };
+    uint8_t mainCode[]={
+            0x98,0x03,0x03,0x80,            // ldl.l d0, (a0) - hw mapped memory is not cacheable => fault
+            OperandCode::BRK
+    };
+    vcpu.Begin(ram, 32*4096);
+    vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+    vcpu.LoadDataToRam(0x1000, expRoutine, sizeof(expRoutine));
+    vcpu.LoadDataToRam(0x2000, mainCode, sizeof(mainCode));
+    vcpu.memoryUnit.Write<uint64_t>(0x3000, 0x4711);
+
+    auto hwRegion = SoC::Instance().GetFirstRegionMatching(kRegionFlag_HWMapping);
+    TR_ASSERT(t, hwRegion != nullptr);
+
+    int exp_counter = 0;
+    ExceptionControlBlock fault = {};
+    vcpu.RegisterSysCall(0x01, "fault",[&exp_counter, &fault](Registers &regs, CPUBase *cpu) {
+        exp_counter++;
+        fault = cpu->GetSystemMemoryBlock()->exceptionControlBlock;
+        // 'map the page'
+        regs.addressRegisters[0].data.longword = 0x3000;
+    });
+
+    auto &regs = vcpu.GetRegisters();
+    regs.addressRegisters[0].data.longword = hwRegion->vAddrStart;
+    regs.dataRegisters[0].data.longword = 0x1234;
+    regs.dataRegisters[5].data.longword = 0x5555;
+
+    vcpu.SetInstrPtr(0x2000);
+    vcpu.EnableException(CPUKnownExceptions::kMMUFault);
+    for(int i=0;i<10;i++) {
+        vcpu.Step();
+    }
+
+    TR_ASSERT(t, exp_counter == 1);
+    TR_ASSERT(t, fault.faultInstrPtr == 0x2000);
+    TR_ASSERT(t, fault.faultAddress == hwRegion->vAddrStart);
+    TR_ASSERT(t, fault.faultAccess == CPUFaultAccess::Read);
+    TR_ASSERT(t, fault.contextBefore.instrPointer.data.longword == 0x2000);
+    TR_ASSERT(t, fault.contextBefore.d0.data.longword == 0x1234);
+    // Re-executed after the handler
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x4711);
+    TR_ASSERT(t, regs.dataRegisters[5].data.longword == 0x5555);
+    TR_ASSERT(t, vcpu.IsHalted());
+    TR_ASSERT(t, !vcpu.IsCPUExpActive());
+
+    return kTR_Pass;
+}
+
+// Block copy, the fault reports the side without memory
+DLL_EXPORT int test_exceptions_movsfault(ITesting *t) {
+    VirtualCPU vcpu;
+    ISR_VECTOR_TABLE isrTable = {
+            .exp_illegal_instr = 0x1200,        // catch-all, should not be used
+            .exp_mmu_fault = 0x1000,
+    };
+
+    uint8_t expRoutine[]={
+            // move.l d0,0x01
+            0x20,0x03,0x03,0x01, 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,
+            // syscall
+            OperandCode::SYS,
+            // rte
+            OperandCode::RTE,
+    };
+    uint8_t mainCode[]={
+            0xa4,0x00,0x90,0x80,            // movs.b (a1), (a0)
+            OperandCode::BRK
+    };
+    vcpu.Begin(ram, 32*4096);
+    vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+    vcpu.LoadDataToRam(0x1000, expRoutine, sizeof(expRoutine));
+    vcpu.LoadDataToRam(0x2000, mainCode, sizeof(mainCode));
+
+    std::vector<ExceptionControlBlock> faults;
+    vcpu.RegisterSysCall(0x01, "fault",[&faults](Registers &regs, CPUBase *cpu) {
+        auto &fault = cpu->GetSystemMemoryBlock()->exceptionControlBlock;
+        faults.push_back(fault);
+        // Move whichever side faulted
+        if (fault.faultAccess == CPUFaultAccess::Read) {
+            regs.addressRegisters[0].data.longword = 0x3000;
+        } else {
+            regs.addressRegisters[1].data.longword = 0x3800;
+        }
+    });
+
+    // Source runs off the end of RAM, and so does the destination
+    static const uint64_t addrEndOfRam = 32*4096 - 16;
+    auto &regs = vcpu.GetRegisters();
+    regs.addressRegisters[0].data.longword = addrEndOfRam;
+    regs.addressRegisters[1].data.longword = addrEndOfRam - 8;
+    regs.dataRegisters[0].data.longword = 64;
+
+    vcpu.SetInstrPtr(0x2000);
+    vcpu.EnableException(CPUKnownExceptions::kMMUFault);
+    for(int i=0;i<20;i++) {
+        vcpu.Step();
+    }
+
+    TR_ASSERT(t, faults.size() == 2);
+    TR_ASSERT(t, faults[0].faultAddress == addrEndOfRam);
+    TR_ASSERT(t, faults[0].faultAccess == CPUFaultAccess::Read);
+    TR_ASSERT(t, faults[1].faultAddress == addrEndOfRam - 8);
+    TR_ASSERT(t, faults[1].faultAccess == CPUFaultAccess::Write);
+    // Re-executed after the handler
+    TR_ASSERT(t, regs.addressRegisters[0].data.longword == 0x3000 + 64);
+    TR_ASSERT(t, regs.addressRegisters[1].data.longword == 0x3800 + 64);
+    TR_ASSERT(t, vcpu.IsHalted());
+
+    return kTR_Pass;
+}
+
+// Plain load/store, the fault reports the address and access type
+DLL_EXPORT int test_exceptions_loadfault(ITesting *t) {
+    VirtualCPU vcpu;
+    ISR_VECTOR_TABLE isrTable = {
+            .exp_illegal_instr = 0x1200,        // catch-all, should not be used
+            .exp_mmu_fault = 0x1000,
+    };
+
+    uint8_t expRoutine[]={
+            // move.l d0,0x01
+            0x20,0x03,0x03,0x01, 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,
+            // syscall
+            OperandCode::SYS,
+            // rte
+            OperandCode::RTE,
+    };
+    uint8_t mainCode[]={
+            0x20,0x03,0x13,0x80,            // move.l d1, (a0)
+            0x20,0x03,0x90,0x13,            // move.l (a1), d1
+            OperandCode::BRK
+    };
+    vcpu.Begin(ram, 32*4096);
+    vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+    vcpu.LoadDataToRam(0x1000, expRoutine, sizeof(expRoutine));
+    vcpu.LoadDataToRam(0x2000, mainCode, sizeof(mainCode));
+    vcpu.memoryUnit.Write<uint64_t>(0x3000, 0x4711);
+
+    std::vector<ExceptionControlBlock> faults;
+    vcpu.RegisterSysCall(0x01, "fault",[&faults](Registers &regs, CPUBase *cpu) {
+        auto &fault = cpu->GetSystemMemoryBlock()->exceptionControlBlock;
+        faults.push_back(fault);
+        // 'map the page'
+        if (fault.faultAccess == CPUFaultAccess::Read) {
+            regs.addressRegisters[0].data.longword = 0x3000;
+        } else {
+            regs.addressRegisters[1].data.longword = 0x3800;
+        }
+    });
+
+    // Both straddle the end of RAM
+    static const uint64_t addrEndOfRam = 32*4096 - 4;
+    auto &regs = vcpu.GetRegisters();
+    regs.addressRegisters[0].data.longword = addrEndOfRam;
+    regs.addressRegisters[1].data.longword = addrEndOfRam;
+    regs.dataRegisters[1].data.longword = 0x1234;
+
+    vcpu.SetInstrPtr(0x2000);
+    vcpu.EnableException(CPUKnownExceptions::kMMUFault);
+    for(int i=0;i<20;i++) {
+        vcpu.Step();
+    }
+
+    TR_ASSERT(t, faults.size() == 2);
+    TR_ASSERT(t, faults[0].faultInstrPtr == 0x2000);
+    TR_ASSERT(t, faults[0].faultAddress == addrEndOfRam);
+    TR_ASSERT(t, faults[0].faultAccess == CPUFaultAccess::Read);
+    // The faulting load must not have reached the register
+    TR_ASSERT(t, faults[0].contextBefore.instrPointer.data.longword == 0x2000);
+    TR_ASSERT(t, faults[1].faultInstrPtr == 0x2004);
+    TR_ASSERT(t, faults[1].faultAddress == addrEndOfRam);
+    TR_ASSERT(t, faults[1].faultAccess == CPUFaultAccess::Write);
+    // Re-executed after the handler
+    TR_ASSERT(t, regs.dataRegisters[1].data.longword == 0x4711);
+    TR_ASSERT(t, vcpu.memoryUnit.Read<uint64_t>(0x3800) == 0x4711);
+    TR_ASSERT(t, vcpu.IsHalted());
+    TR_ASSERT(t, !vcpu.IsCPUExpActive());
+
+    return kTR_Pass;
+}
+
 DLL_EXPORT int test_exceptions_nested(ITesting *t) {
     VirtualCPU vcpu;
     // See: 'Interrupt.h' for definition
@@ -0,0 +1,266 @@
+//
+// Created by gnilk on 19.10.26.
+//
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <testinterface.h>
+
+#include "System.h"
+#include "VirtualCPU.h"
+#include "HostIO.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+static uint8_t ram[32*4096];
+
+extern "C" {
+DLL_EXPORT int test_hostio(ITesting *t);
+DLL_EXPORT int test_hostio_file(ITesting *t);
+DLL_EXPORT int test_hostio_errors(ITesting *t);
+DLL_EXPORT int test_hostio_pipe(ITesting *t);
+}
+
+DLL_EXPORT int test_hostio(ITesting *t) {
+    t->SetPreCaseCallback([](ITesting *) {
+        SoC::Instance().Reset();
+    });
+    return kTR_Pass;
+}
+
+static const uint64_t addrRing = 0x4000;
+static const uint64_t addrPath = 0x5000;
+static const uint64_t addrBuffer = 0x6000;
+
+static int64_t Submit(VirtualCPU &vcpu, kHostIOSysCall op, uint64_t d1, uint64_t d2, uint64_t d3, uint64_t userData) {
+    auto &regs = vcpu.GetRegisters();
+    regs.dataRegisters[1].data.longword = d1;
+    regs.dataRegisters[2].data.longword = d2;
+    regs.dataRegisters[3].data.longword = d3;
+    regs.dataRegisters[4].data.longword = userData;
+    vcpu.InvokeSysCall(kHostIOSysCallBase + op);
+    return static_cast<int64_t>(regs.dataRegisters[0].data.longword);
+}
+
+// Keep the core running until the host has posted 'tail' completions, returns the result of the last one
+static bool WaitForCompletion(VirtualCPU &vcpu, uint64_t tail, HostIOCompletion &outCompletion) {
+    auto &mmu = vcpu.memoryUnit;
+    auto tStart = std::chrono::steady_clock::now();
+    while(mmu.Read<uint64_t>(addrRing + offsetof(HostIOCompletionRing, tail)) < tail) {
+        if ((std::chrono::steady_clock::now() - tStart) > std::chrono::seconds(10)) {
+            return false;
+        }
+        vcpu.Step();
+        std::this_thread::yield();
+    }
+    auto numEntries = mmu.Read<uint64_t>(addrRing + offsetof(HostIOCompletionRing, numEntries));
+    auto addrCompletion = addrRing + sizeof(HostIOCompletionRing) + ((tail - 1) & (numEntries - 1)) * sizeof(HostIOCompletion);
+    outCompletion.userData = mmu.Read<uint64_t>(addrCompletion + offsetof(HostIOCompletion, userData));
+    outCompletion.result = static_cast<int64_t>(mmu.Read<uint64_t>(addrCompletion + offsetof(HostIOCompletion, result)));
+    // consume it
+    mmu.Write<uint64_t>(addrRing + offsetof(HostIOCompletionRing, head), tail);
+    return true;
+}
+
+static std::shared_ptr<HostIO> SetupHostIO(VirtualCPU &vcpu, int &irqCounter) {
+    ISR_VECTOR_TABLE isrTable = {
+            .isr0 = 0x1000,
+    };
+    uint8_t isrRoutine[]={
+        // move.l d0,0x01
+        0x20,0x03,0x03,0x01, 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,
+        // syscall
+        OperandCode::SYS,
+        OperandCode::RTI,
+    };
+    // The guest keeps computing while the host works
+    uint8_t mainCode[]={
+        0x90,0x00,0x73,0x01,0x33,       // cmp.b d7, 0x33
+        0xd1,0x00,0x01,0xf7,            // bne.b -9
+    };
+    vcpu.Begin(ram, sizeof(ram));
+    vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+    vcpu.LoadDataToRam(0x1000, isrRoutine, sizeof(isrRoutine));
+    vcpu.LoadDataToRam(0x2000, mainCode, sizeof(mainCode));
+    vcpu.SetInstrPtr(0x2000);
+    vcpu.RegisterSysCall(0x01, "count",[&irqCounter](Registers &regs, CPUBase *cpu) {
+        irqCounter++;
+    });
+
+    auto hostio = std::make_shared<HostIO>();
+    vcpu.AddPeripheral(INT1, 1, hostio);
+    vcpu.EnableInterrupt(INT1);
+    hostio->RegisterSysCalls(vcpu);
+
+    auto &mmu = vcpu.memoryUnit;
+    mmu.Write<uint64_t>(addrRing + offsetof(HostIOCompletionRing, head), 0);
+    mmu.Write<uint64_t>(addrRing + offsetof(HostIOCompletionRing, tail), 0);
+    mmu.Write<uint64_t>(addrRing + offsetof(HostIOCompletionRing, numEntries), 4);
+    return hostio;
+}
+
+static void WriteString(VirtualCPU &vcpu, uint64_t address, const std::string &str) {
+    for(size_t i=0;i<str.size();i++) {
+        vcpu.memoryUnit.Write<uint8_t>(address + i, str[i]);
+    }
+    vcpu.memoryUnit.Write<uint8_t>(address + str.size(), 0);
+}
+
+DLL_EXPORT int test_hostio_file(ITesting *t) {
+    VirtualCPU vcpu;
+    int irqCounter = 0;
+    auto hostio = SetupHostIO(vcpu, irqCounter);
+
+    auto path = (std::filesystem::temp_directory_path() / "vcpu_test_hostio.bin").string();
+    std::filesystem::remove(path);
+    WriteString(vcpu, addrPath, path);
+
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Setup, addrRing, 0, 0, 0) == 0);
+
+    // Open for writing - the call returns right away, the result comes in the completion
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Open, addrPath, kHostIOOpen_Write | kHostIOOpen_Create, 0, 1) == 0);
+    HostIOCompletion completion = {};
+    TR_ASSERT(t, WaitForCompletion(vcpu, 1, completion));
+    TR_ASSERT(t, completion.userData == 1);
+    TR_ASSERT(t, completion.result >= 0);
+    auto handle = static_cast<uint64_t>(completion.result);
+
+    static const char *message = "hello from the guest";
+    WriteString(vcpu, addrBuffer, message);
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Write, handle, addrBuffer, strlen(message), 2) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 2, completion));
+    TR_ASSERT(t, completion.userData == 2);
+    TR_ASSERT(t, completion.result == (int64_t)strlen(message));
+
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Close, handle, 0, 0, 3) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 3, completion));
+    TR_ASSERT(t, completion.result == 0);
+    TR_ASSERT(t, std::filesystem::file_size(path) == strlen(message));
+
+    // Read it back - the completion ring wraps here
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Open, addrPath, kHostIOOpen_Read, 0, 4) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 4, completion));
+    TR_ASSERT(t, completion.result >= 0);
+    handle = static_cast<uint64_t>(completion.result);
+
+    static const uint64_t addrReadBuffer = 0x7000;
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Read, handle, addrReadBuffer, 256, 5) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 5, completion));
+    TR_ASSERT(t, completion.userData == 5);
+    TR_ASSERT(t, completion.result == (int64_t)strlen(message));
+    for(size_t i=0;i<strlen(message);i++) {
+        TR_ASSERT(t, vcpu.memoryUnit.Read<uint8_t>(addrReadBuffer + i) == (uint8_t)message[i]);
+    }
+    // End of file
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Read, handle, addrReadBuffer, 256, 6) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 6, completion));
+    TR_ASSERT(t, completion.result == 0);
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Close, handle, 0, 0, 7) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 7, completion));
+
+    TR_ASSERT(t, hostio->GetOutstanding() == 0);
+    TR_ASSERT(t, hostio->GetStatistics().completed == 7);
+    TR_ASSERT(t, hostio->GetStatistics().bytesRead == strlen(message));
+    TR_ASSERT(t, hostio->GetStatistics().bytesWritten == strlen(message));
+    // Give the last ISR a chance to run - interrupts raised while the ISR is executing are dropped, the guest
+    // should drain the ring in the ISR, so we can't expect one per completion
+    for(int i=0;i<16;i++) {
+        vcpu.Step();
+    }
+    TR_ASSERT(t, irqCounter > 0);
+    TR_ASSERT(t, !vcpu.IsHalted());
+
+    vcpu.End();
+    std::filesystem::remove(path);
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_hostio_errors(ITesting *t) {
+    VirtualCPU vcpu;
+    int irqCounter = 0;
+    auto hostio = SetupHostIO(vcpu, irqCounter);
+
+    // No completion ring yet
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Read, 0, addrBuffer, 16, 1) == -EINVAL);
+    // Ring size must be a power of two
+    vcpu.memoryUnit.Write<uint64_t>(addrRing + offsetof(HostIOCompletionRing, numEntries), 3);
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Setup, addrRing, 0, 0, 0) == -EINVAL);
+    vcpu.memoryUnit.Write<uint64_t>(addrRing + offsetof(HostIOCompletionRing, numEntries), 4);
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Setup, addrRing, 0, 0, 0) == 0);
+
+    // Invalid handles and flags are rejected at submission
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Read, 42, addrBuffer, 16, 1) == -EBADF);
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Close, 42, 0, 0, 1) == -EBADF);
+    WriteString(vcpu, addrPath, "cat");
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Open, addrPath, kHostIOOpen_Pipe | kHostIOOpen_Read | kHostIOOpen_Write, 0, 1) == -EINVAL);
+    TR_ASSERT(t, hostio->GetStatistics().rejected == 4);
+
+    // Host errors come back in the completion
+    WriteString(vcpu, addrPath, "/this/path/does/not/exist");
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Open, addrPath, kHostIOOpen_Read, 0, 2) == 0);
+    HostIOCompletion completion = {};
+    TR_ASSERT(t, WaitForCompletion(vcpu, 1, completion));
+    TR_ASSERT(t, completion.userData == 2);
+    TR_ASSERT(t, completion.result == -ENOENT);
+
+    vcpu.End();
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_hostio_pipe(ITesting *t) {
+    VirtualCPU vcpu;
+    int irqCounter = 0;
+    auto hostio = SetupHostIO(vcpu, irqCounter);
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Setup, addrRing, 0, 0, 0) == 0);
+
+    // Read the output of a command
+    WriteString(vcpu, addrPath, "echo hello");
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Open, addrPath, kHostIOOpen_Pipe | kHostIOOpen_Read, 0, 1) == 0);
+    HostIOCompletion completion = {};
+    TR_ASSERT(t, WaitForCompletion(vcpu, 1, completion));
+    TR_ASSERT(t, completion.result >= 0);
+    auto handle = static_cast<uint64_t>(completion.result);
+
+    // The whole buffer must be in guest memory, not just the start of it
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Read, handle, sizeof(ram) - 16, 256, 2) == -EFAULT);
+
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Read, handle, addrBuffer, 256, 2) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 2, completion));
+    TR_ASSERT(t, completion.result == 6);
+    static const char *expected = "hello\n";
+    for(size_t i=0;i<strlen(expected);i++) {
+        TR_ASSERT(t, vcpu.memoryUnit.Read<uint8_t>(addrBuffer + i) == (uint8_t)expected[i]);
+    }
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Close, handle, 0, 0, 3) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 3, completion));
+    TR_ASSERT(t, completion.result == 0);
+
+    // Write to the input of a command
+    WriteString(vcpu, addrPath, "cat > /dev/null");
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Open, addrPath, kHostIOOpen_Pipe | kHostIOOpen_Write, 0, 4) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 4, completion));
+    TR_ASSERT(t, completion.result >= 0);
+    handle = static_cast<uint64_t>(completion.result);
+
+    static const char *message = "hello from the guest";
+    WriteString(vcpu, addrBuffer, message);
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Write, handle, addrBuffer, strlen(message), 5) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 5, completion));
+    TR_ASSERT(t, completion.result == (int64_t)strlen(message));
+    TR_ASSERT(t, Submit(vcpu, kHostIOSysCall_Close, handle, 0, 0, 6) == 0);
+    TR_ASSERT(t, WaitForCompletion(vcpu, 6, completion));
+    TR_ASSERT(t, completion.result == 0);
+
+    TR_ASSERT(t, hostio->GetStatistics().rejected == 1);
+    TR_ASSERT(t, hostio->GetStatistics().bytesRead == 6);
+    TR_ASSERT(t, hostio->GetStatistics().bytesWritten == strlen(message));
+
+    vcpu.End();
+    return kTR_Pass;
+}
@@ -22,6 +22,8 @@ static void DumpRegs(const VirtualCPU &cpu);
 extern "C" {
     DLL_EXPORT int test_int(ITesting *t);
     DLL_EXPORT int test_int_invoke(ITesting *t);
+    DLL_EXPORT int test_int_pending(ITesting *t);
+    DLL_EXPORT int test_int_nested(ITesting *t);
 }
 DLL_EXPORT int test_int(ITesting *t) {
     return kTR_Pass;
@@ -47,6 +49,8 @@ DLL_EXPORT int test_int_invoke(ITesting *t) {
             OperandCode::NOP, OperandCode::NOP, OperandCode::NOP,
             OperandCode::BRK
     };
+    // Timer runs in virtual time, with a 50Hz clock a 10Hz timer ticks every 5th instruction
+    vcpu.SetClockFrequency(50);
     vcpu.Begin(ram, 32*4096);
     vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
     vcpu.LoadDataToRam(0x1000, isrRoutine, sizeof(isrTable));
@@ -66,14 +70,10 @@ DLL_EXPORT int test_int_invoke(ITesting *t) {
     sysblock->timer0.freqSec = 10;      // Lower the frequency, otherwise the only thing happening is the ISR routine being invoked...
     sysblock->timer0.control.reset = 1;
     sysblock->timer0.control.enable = 1;
-    // Make this a generic thing
-    while(sysblock->timer0.control.running != 1) {
-        std::this_thread::yield();
-    }
 
     printf("Addresses with '*' indicate INT routine\n");
 
-    for(int i=0;i<15;i++) {
+    for(int i=0;i<30;i++) {
         vcpu.Step();
         // this print is quite wrong..
         if (vcpu.IsCPUISRActive() || (!vcpu.GetStatusReg().flags.halt)) {
@@ -84,8 +84,6 @@ DLL_EXPORT int test_int_invoke(ITesting *t) {
         } else {
             fmt::println("{} --- halted ---", i);
         }
-        // This will more or less cause ISR routine to constantly be invoked...
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
 
     fmt::println("irq counter={}", irq_counter);
@@ -96,6 +94,120 @@ DLL_EXPORT int test_int_invoke(ITesting *t) {
 
 
 
+DLL_EXPORT int test_int_pending(ITesting *t) {
+    VirtualCPU vcpu;
+    ISR_VECTOR_TABLE isrTable = {
+            .isr0 = 0x1000,
+    };
+    vcpu.Begin(ram, 32*4096);
+    vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+
+    // Dummy peripherals - we raise the interrupts ourselves
+    vcpu.AddPeripheral(INT1, 1, std::make_shared<Peripheral>());
+    vcpu.AddPeripheral(INT2, 2, std::make_shared<Peripheral>());
+    vcpu.EnableInterrupt(INT1);
+    vcpu.EnableInterrupt(INT2);
+
+    TR_ASSERT(t, !vcpu.InvokeISRHandlers());
+
+    // Raise from other threads, these are lock-free
+    std::thread threadA([&vcpu]() {
+        for(int i=0;i<1000;i++) {
+            vcpu.RaiseInterrupt(2);
+        }
+    });
+    std::thread threadB([&vcpu]() {
+        vcpu.RaiseInterrupt(1);
+    });
+    threadA.join();
+    threadB.join();
+    // Not mapped - should be dropped
+    vcpu.RaiseInterrupt(3);
+
+    // Lowest id goes first, the other stays flagged
+    TR_ASSERT(t, vcpu.InvokeISRHandlers());
+    TR_ASSERT(t, vcpu.GetRegisters().dataRegisters[0].data.longword == 1);
+    TR_ASSERT(t, vcpu.GetISRState(1) == CPUISRState::Executing);
+    TR_ASSERT(t, vcpu.GetISRState(2) == CPUISRState::Flagged);
+    TR_ASSERT(t, vcpu.GetISRState(3) == CPUISRState::Waiting);
+
+    return kTR_Pass;
+}
+DLL_EXPORT int test_int_nested(ITesting *t) {
+    VirtualCPU vcpu;
+    ISR_VECTOR_TABLE isrTable = {
+            .isr0 = 0x1000,
+            .isr1 = 0x1000,
+            .isr2 = 0x1100,
+    };
+    uint8_t lowPrioISR[]={
+            OperandCode::NOP,
+            OperandCode::NOP,
+            OperandCode::RTI,
+    };
+    uint8_t highPrioISR[]={
+            OperandCode::RTI,
+    };
+    uint8_t mainCode[]={
+            OperandCode::NOP, OperandCode::NOP, OperandCode::NOP, OperandCode::NOP,
+            OperandCode::BRK,
+    };
+
+    vcpu.Begin(ram, 32*4096);
+    vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+    vcpu.LoadDataToRam(0x1000, lowPrioISR, sizeof(lowPrioISR));
+    vcpu.LoadDataToRam(0x1100, highPrioISR, sizeof(highPrioISR));
+    vcpu.LoadDataToRam(0x2000, mainCode, sizeof(mainCode));
+    vcpu.SetInstrPtr(0x2000);
+
+    vcpu.AddPeripheral(INT1, 1, std::make_shared<Peripheral>());
+    vcpu.AddPeripheral(INT2, 2, std::make_shared<Peripheral>());
+    vcpu.EnableInterrupt(INT1);
+    vcpu.EnableInterrupt(INT2);
+    vcpu.SetInterruptPriority(1, 1);
+    vcpu.SetInterruptPriority(2, 5);
+
+    auto &regs = vcpu.GetRegisters();
+    regs.dataRegisters[0].data.longword = 0x4711;
+
+    // High priority first, low priority must wait
+    vcpu.RaiseInterrupt(2);
+    TR_ASSERT(t, vcpu.InvokeISRHandlers());
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 0x1100);
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 2);
+    vcpu.RaiseInterrupt(1);
+    TR_ASSERT(t, !vcpu.InvokeISRHandlers());
+    TR_ASSERT(t, vcpu.GetISRState(1) == CPUISRState::Flagged);
+
+    // rti - back to main, and d0 restored
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, vcpu.GetISRNestingDepth() == 0);
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 0x2000);
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x4711);
+
+    // Low priority is now invoked, executes the first nop
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, vcpu.GetISRState(1) == CPUISRState::Executing);
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 0x1001);
+
+    // High priority preempts the low priority ISR, executes rti directly
+    vcpu.RaiseInterrupt(2);
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, vcpu.GetISRNestingDepth() == 1);
+    TR_ASSERT(t, vcpu.IsCPUISRActive());
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 0x1001);
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 1);
+
+    // Finish low priority ISR
+    TR_ASSERT(t, vcpu.Step());      // nop
+    TR_ASSERT(t, vcpu.Step());      // rti
+    TR_ASSERT(t, vcpu.GetISRNestingDepth() == 0);
+    TR_ASSERT(t, !vcpu.IsCPUISRActive());
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 0x2000);
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x4711);
+
+    return kTR_Pass;
+}
 
 /// helpers
 static void DumpStatus(const VirtualCPU &cpu) {
@@ -5,6 +5,7 @@
 #include <vector>
 #include <testinterface.h>
 
+#include "System.h"
 #include "VirtualCPU.h"
 #include "SuperScalarCPU.h"
 
@@ -15,6 +16,10 @@ extern "C" {
 DLL_EXPORT int test_pipeline(ITesting *t);
 DLL_EXPORT int test_pipeline_instr_move_reg2reg(ITesting *t);
 DLL_EXPORT int test_pipeline_instr_move_immediate(ITesting *t);
+DLL_EXPORT int test_pipeline_instr_cmpbranch(ITesting *t);
+DLL_EXPORT int test_pipeline_instr_fence(ITesting *t);
+DLL_EXPORT int test_pipeline_instr_fill(ITesting *t);
+DLL_EXPORT int test_pipeline_instr_faultguard(ITesting *t);
 }
 DLL_EXPORT int test_pipeline(ITesting *t) {
     return kTR_Pass;
@@ -113,5 +118,191 @@ DLL_EXPORT int test_pipeline_instr_move_immediate(ITesting *t) {
     return kTR_Pass;
 }
 
+DLL_EXPORT int test_pipeline_instr_cmpbranch(ITesting *t) {
+    // Rest is zero (brk) - the pipeline fetches past the branches
+    uint8_t program[1024]= {
+            // move.b d0, 3
+            0x20,0x00,0x03,0x01, 0x03,
+            // lp: add.b d1, 1
+            0x30,0x00,0x13,0x01, 0x01,
+            // brlt.b d1,d0,lp
+            0xd6,0x00,0x10, 0xff,0xf6,
+            // breq.b d2,zero,+1
+            0xd4,0x10,0x2f, 0x00,0x01,
+            // brk - skipped
+            0x00,
+            // move.b d3, 1
+            0x20,0x00,0x33,0x01, 0x01,
+            // brk
+            0x00,
+    };
+    SuperScalarCPU cpu;
+    cpu.QuickStart(program, 1024);
+    auto &regs = cpu.GetRegisters();
+
+    InstructionPipeline pipeline;
+    pipeline.Reset();
+
+    while(!cpu.IsHalted()) {
+        pipeline.DbgDump();
+        pipeline.Tick(cpu);
+        if (pipeline.GetTickCounter() > 200) {
+            return kTR_Fail;
+        }
+    }
+    pipeline.Flush(cpu);
+    TR_ASSERT(t, pipeline.IsEmpty());
+    TR_ASSERT(t, regs.dataRegisters[1].data.byte == 3);
+    TR_ASSERT(t, regs.dataRegisters[3].data.byte == 1);
+    // Resolved without the flags
+    TR_ASSERT(t, regs.statusReg.flags.zero == 0);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_pipeline_instr_fence(ITesting *t) {
+    uint8_t program[1024]= {
+            // move.b d0, 1
+            0x20,0x00,0x03,0x01, 0x01,
+            // fence
+            0x64,
+            // move.b d1, 2
+            0x20,0x00,0x13,0x01, 0x02,
+            // brk
+            0x00,
+    };
+    SuperScalarCPU cpu;
+    cpu.QuickStart(program, 1024);
+    auto &regs = cpu.GetRegisters();
+
+    InstructionPipeline pipeline;
+    pipeline.Reset();
+
+    bool haveSerialized = false;
+    while(!cpu.IsHalted()) {
+        pipeline.DbgDump();
+        pipeline.Tick(cpu);
+        // Nothing after the fence is fetched while it is in flight
+        if (pipeline.HaveSerializing()) {
+            TR_ASSERT(t, cpu.GetInstrPtr().data.longword == 6);
+            haveSerialized = true;
+        }
+        if (pipeline.GetTickCounter() > 200) {
+            return kTR_Fail;
+        }
+    }
+    pipeline.Flush(cpu);
+    TR_ASSERT(t, haveSerialized);
+    TR_ASSERT(t, pipeline.IsEmpty());
+    TR_ASSERT(t, regs.dataRegisters[0].data.byte == 1);
+    TR_ASSERT(t, regs.dataRegisters[1].data.byte == 2);
+
+    return kTR_Pass;
+}
 
+DLL_EXPORT int test_pipeline_instr_fill(ITesting *t) {
+    static uint8_t program[16384]= {
+            // fill.b (a1), 0x55
+            0xa5,0x00,0x90,0x01, 0x55,
+            // move.b d1, 2
+            0x20,0x00,0x13,0x01, 0x02,
+            // brk
+            0x00,
+    };
+    SuperScalarCPU cpu;
+    cpu.QuickStart(program, sizeof(program));
+    auto &regs = cpu.GetRegisters();
+    regs.addressRegisters[1].data.longword = 0x1000;
+    regs.dataRegisters[0].data.longword = 5000;
 
+    InstructionPipeline pipeline;
+    pipeline.Reset();
+
+    while(!cpu.IsHalted()) {
+        pipeline.Tick(cpu);
+        if (pipeline.GetTickCounter() > 200) {
+            return kTR_Fail;
+        }
+    }
+    pipeline.Flush(cpu);
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0);
+    TR_ASSERT(t, regs.addressRegisters[1].data.longword == 0x1000 + 5000);
+    TR_ASSERT(t, regs.dataRegisters[1].data.byte == 2);
+
+    return kTR_Pass;
+}
+
+// Runs a guarded load, the guard skips the load when d2 == d4 - returns the number of MMU faults taken
+static int RunFaultGuard(SuperScalarCPU &cpu, uint64_t guard, uint64_t badAddress) {
+    static uint8_t ram[65536];
+    ISR_VECTOR_TABLE isrTable = {
+            .exp_illegal_instr = 0x1200,        // catch-all, should not be used
+            .exp_mmu_fault = 0x1000,
+    };
+    uint8_t expRoutine[]={
+            // move.l d0,0x01
+            0x20,0x03,0x03,0x01, 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,
+            // syscall
+            OperandCode::SYS,
+            // rte
+            OperandCode::RTE,
+    };
+    uint8_t program[]= {
+            // breq.l d2,d4,skip
+            0xd4,0x03,0x24, 0x00,0x04,
+            // move.l d0, (a0)
+            0x20,0x03,0x03,0x80,
+            // skip: move.b d3, 1
+            0x20,0x00,0x33,0x01, 0x01,
+            // brk
+            0x00,
+    };
+    cpu.Begin(ram, sizeof(ram));
+    cpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+    cpu.LoadDataToRam(0x1000, expRoutine, sizeof(expRoutine));
+    cpu.LoadDataToRam(0x2000, program, sizeof(program));
+    cpu.memoryUnit.Write<uint64_t>(0x3000, 0x4711);
+
+    int nFaults = 0;
+    cpu.RegisterSysCall(0x01, "fault",[&nFaults](Registers &regs, CPUBase *cpu) {
+        nFaults++;
+        // 'map the page'
+        regs.addressRegisters[0].data.longword = 0x3000;
+    });
+
+    auto &regs = cpu.GetRegisters();
+    regs.addressRegisters[0].data.longword = badAddress;
+    regs.dataRegisters[4].data.longword = guard;
+    cpu.SetInstrPtr(0x2000);
+    cpu.EnableException(CPUKnownExceptions::kMMUFault);
+
+    InstructionPipeline pipeline;
+    pipeline.Reset();
+    while(!cpu.IsHalted()) {
+        pipeline.Tick(cpu);
+        if (pipeline.GetTickCounter() > 200) {
+            return -1;
+        }
+    }
+    pipeline.Flush(cpu);
+    return nFaults;
+}
+
+// The load behind a taken guard is fetched but never executes, it must not fault
+DLL_EXPORT int test_pipeline_instr_faultguard(ITesting *t) {
+    auto &ramRegion = SoC::Instance().GetMemoryRegionFromAddress(0);
+    auto badAddress = ramRegion.vAddrEnd + 0x100;
+    {
+        SuperScalarCPU cpu;
+        TR_ASSERT(t, RunFaultGuard(cpu, 0, badAddress) == 0);
+        TR_ASSERT(t, cpu.GetRegisters().dataRegisters[3].data.byte == 1);
+    }
+    // Guard not taken - the fault is raised when the load executes and the load is re-executed
+    {
+        SuperScalarCPU cpu;
+        TR_ASSERT(t, RunFaultGuard(cpu, 1, badAddress) == 1);
+        TR_ASSERT(t, cpu.GetRegisters().dataRegisters[0].data.longword == 0x4711);
+        TR_ASSERT(t, cpu.GetRegisters().dataRegisters[3].data.byte == 1);
+    }
+    return kTR_Pass;
+}
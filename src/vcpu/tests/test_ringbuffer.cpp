@@ -2,6 +2,7 @@
 // Created by gnilk on 28.05.24.
 //
 #include <stdint.h>
+#include <thread>
 #include <testinterface.h>
 
 #include "Ringbuffer.h"
@@ -16,6 +17,7 @@ DLL_EXPORT int test_ringbuffer_write(ITesting *t);
 DLL_EXPORT int test_ringbuffer_read(ITesting *t);
 DLL_EXPORT int test_ringbuffer_write_read_wrap(ITesting *t);
 DLL_EXPORT int test_ringbuffer_write_read_wrap2(ITesting *t);
+DLL_EXPORT int test_ringbuffer_lockfree(ITesting *t);
 }
 DLL_EXPORT int test_ringbuffer(ITesting *t) {
     return kTR_Pass;
@@ -104,3 +106,46 @@ DLL_EXPORT int test_ringbuffer_write_read_wrap2(ITesting *t) {
     return kTR_Pass;
 }
 
+
+DLL_EXPORT int test_ringbuffer_lockfree(ITesting *t) {
+    LockFreeRingbuffer<32> ringbuffer;
+    uint8_t dummy[40] = {};
+
+    // Partial writes/reads
+    TR_ASSERT(t, ringbuffer.Write(dummy, 40) == 32);
+    TR_ASSERT(t, ringbuffer.IsFull());
+    TR_ASSERT(t, ringbuffer.Read(dummy, 24) == 24);
+    TR_ASSERT(t, ringbuffer.Write(dummy, 24) == 24);
+    TR_ASSERT(t, ringbuffer.Read(dummy, 40) == 32);
+    TR_ASSERT(t, ringbuffer.IsEmpty());
+
+    // One producer, one consumer - everything must arrive in order
+    static const uint32_t numBytes = 1'000'000;
+    std::thread producer([&ringbuffer]() {
+        for(uint32_t i=0;i<numBytes;) {
+            uint8_t value = i & 255;
+            if (ringbuffer.Write(&value, 1) == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            i++;
+        }
+    });
+    uint32_t nRead = 0;
+    bool inOrder = true;
+    while(nRead < numBytes) {
+        uint8_t values[16];
+        auto n = ringbuffer.Read(values, sizeof(values));
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+        for(size_t i=0;i<n;i++) {
+            inOrder &= (values[i] == ((nRead + i) & 255));
+        }
+        nRead += n;
+    }
+    producer.join();
+    TR_ASSERT(t, inOrder);
+
+    return kTR_Pass;
+}
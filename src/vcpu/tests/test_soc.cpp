@@ -24,6 +24,7 @@ DLL_EXPORT int test_soc_getflashregion(ITesting *t);
 DLL_EXPORT int test_soc_resetram(ITesting *t);
 DLL_EXPORT int test_soc_regionfromaddr(ITesting *t);
 DLL_EXPORT int test_soc_hwmapping(ITesting *t);
+DLL_EXPORT int test_soc_hwdevices(ITesting *t);
 DLL_EXPORT int test_soc_getregionfromtype(ITesting *t);
 DLL_EXPORT int test_soc_flash_upload(ITesting *t);
 }
@@ -140,6 +141,83 @@ DLL_EXPORT int test_soc_hwmapping(ITesting *t) {
 
 }
 
+// Plain register file, 4 x 64 bit
+class TestDevice : public HWMappedDevice {
+public:
+    uint64_t Read64(uint64_t offset) override {
+        return regs[(offset >> 3) & 3];
+    }
+    void Write64(uint64_t offset, uint64_t value) override {
+        regs[(offset >> 3) & 3] = value;
+    }
+    size_t GetMappedSize() const override {
+        return sizeof(regs);
+    }
+    uint64_t regs[4] = {};
+};
+
+DLL_EXPORT int test_soc_hwdevices(ITesting *t) {
+    auto hwbus = std::make_shared<HWMappedBus>();
+    TestDevice devA, devB;
+    TR_ASSERT(t, devA.MapToBus(hwbus, 0x100));
+    TR_ASSERT(t, devB.MapToBus(hwbus, 0x200));
+    // Same page as A - rejected
+    TestDevice devC;
+    TR_ASSERT(t, !devC.MapToBus(hwbus, 0x180));
+    TR_ASSERT(t, hwbus->GetDeviceForAddress(0x108) == &devA);
+    TR_ASSERT(t, hwbus->GetDeviceForAddress(0x200) == &devB);
+    TR_ASSERT(t, hwbus->GetDeviceForAddress(0x300) == nullptr);
+
+    // 64 bit, guest byte order
+    uint8_t data[8] = {0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08};
+    hwbus->WriteData(0x108, data, 8);
+    TR_ASSERT(t, devA.regs[1] == 0x0102030405060708);
+    TR_ASSERT(t, devB.regs[1] == 0);
+
+    // Narrow writes are read-modify-write of the containing register
+    uint8_t byte = 0xaa;
+    hwbus->WriteData(0x10f, &byte, 1);
+    TR_ASSERT(t, devA.regs[1] == 0x01020304050607aa);
+    uint8_t word[2] = {0x12, 0x34};
+    hwbus->WriteData(0x108, word, 2);
+    TR_ASSERT(t, devA.regs[1] == 0x12340304050607aa);
+
+    uint8_t readBack[4] = {};
+    hwbus->ReadData(readBack, 0x10c, 4);
+    TR_ASSERT(t, readBack[0] == 0x05);
+    TR_ASSERT(t, readBack[3] == 0xaa);
+
+    // Crossing a register is split in bytes
+    devB.regs[0] = 0x00000000000000ff;
+    devB.regs[1] = 0xee00000000000000;
+    uint16_t cross = 0;
+    hwbus->ReadData(&cross, 0x207, 2);
+    TR_ASSERT(t, ((uint8_t *)&cross)[0] == 0xff);
+    TR_ASSERT(t, ((uint8_t *)&cross)[1] == 0xee);
+
+    // Outside any device -> legacy handlers
+    bool bLegacyCalled = false;
+    hwbus->SetReadWriteHandlers([&bLegacyCalled](void *dst, uint64_t address, size_t nBytes) {
+        bLegacyCalled = true;
+    }, nullptr);
+    hwbus->ReadData(readBack, 0x300, 4);
+    TR_ASSERT(t, bLegacyCalled);
+
+    // Unmapped devices no longer receive accesses - and the page can be reused
+    devA.UnmapFromBus();
+    TR_ASSERT(t, hwbus->GetDeviceForAddress(0x108) == nullptr);
+    TR_ASSERT(t, devC.MapToBus(hwbus, 0x180));
+    {
+        TestDevice devD;
+        TR_ASSERT(t, devD.MapToBus(hwbus, 0x400));
+    }
+    // Destroyed
+    TR_ASSERT(t, hwbus->GetDeviceForAddress(0x400) == nullptr);
+    TR_ASSERT(t, hwbus->GetDeviceForAddress(0x200) == &devB);
+
+    return kTR_Pass;
+}
+
 DLL_EXPORT int test_soc_getregionfromtype(ITesting *t) {
     auto region = SoC::Instance().GetFirstRegionFromBusType<HWMappedBus>();
     TR_ASSERT(t, region != nullptr);
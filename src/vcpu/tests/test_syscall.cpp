@@ -0,0 +1,233 @@
+//
+// Created by gnilk on 19.10.26.
+//
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <testinterface.h>
+
+#include "System.h"
+#include "VirtualCPU.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+static uint8_t ram[32*4096];
+
+extern "C" {
+DLL_EXPORT int test_syscall(ITesting *t);
+DLL_EXPORT int test_syscall_register(ITesting *t);
+DLL_EXPORT int test_syscall_ring(ITesting *t);
+DLL_EXPORT int test_syscall_ringcorrupt(ITesting *t);
+DLL_EXPORT int test_syscall_ringrange(ITesting *t);
+}
+
+DLL_EXPORT int test_syscall(ITesting *t) {
+    t->SetPreCaseCallback([](ITesting *) {
+        SoC::Instance().Reset();
+    });
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_syscall_register(ITesting *t) {
+    VirtualCPU vcpu;
+    vcpu.Begin(ram, 32*4096);
+
+    int nCalls = 0;
+    TR_ASSERT(t, vcpu.RegisterSysCall(0x10, "count", [&nCalls](Registers &regs, CPUBase *cpu) {
+        nCalls++;
+    }));
+    // Duplicates and the reserved ring id are rejected
+    TR_ASSERT(t, !vcpu.RegisterSysCall(0x10, "count", [](Registers &regs, CPUBase *cpu) {}));
+    TR_ASSERT(t, !vcpu.RegisterSysCall(kSysCall_SubmitRing, "ring", [](Registers &regs, CPUBase *cpu) {}));
+
+    TR_ASSERT(t, vcpu.InvokeSysCall(0x10));
+    TR_ASSERT(t, nCalls == 1);
+    // Holes in the table and beyond the end
+    TR_ASSERT(t, !vcpu.InvokeSysCall(0x01));
+    TR_ASSERT(t, !vcpu.InvokeSysCall(0x1000));
+
+    // Through the instruction
+    uint8_t code[] = {
+        // move.l d0, 0x10
+        0x20,0x03,0x03,0x01, 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x10,
+        // syscall
+        OperandCode::SYS,
+        OperandCode::BRK,
+    };
+    vcpu.LoadDataToRam(0x2000, code, sizeof(code));
+    vcpu.SetInstrPtr(0x2000);
+    while(!vcpu.IsHalted()) {
+        vcpu.Step();
+    }
+    TR_ASSERT(t, nCalls == 2);
+
+    return kTR_Pass;
+}
+
+static void WriteRequest(MMU &mmu, uint64_t ring, uint64_t idx, uint64_t id, uint64_t arg) {
+    auto numEntries = mmu.Read<uint64_t>(ring + offsetof(SysCallRing, numEntries));
+    auto address = ring + sizeof(SysCallRing) + (idx & (numEntries - 1)) * sizeof(SysCallRequest);
+    mmu.Write<uint64_t>(address + offsetof(SysCallRequest, id), id);
+    mmu.Write<uint64_t>(address + offsetof(SysCallRequest, args), arg);
+    mmu.Write<uint64_t>(address + offsetof(SysCallRequest, result), 0xffff'ffff);
+}
+
+static uint64_t ReadResult(MMU &mmu, uint64_t ring, uint64_t idx) {
+    auto numEntries = mmu.Read<uint64_t>(ring + offsetof(SysCallRing, numEntries));
+    auto address = ring + sizeof(SysCallRing) + (idx & (numEntries - 1)) * sizeof(SysCallRequest);
+    return mmu.Read<uint64_t>(address + offsetof(SysCallRequest, result));
+}
+
+DLL_EXPORT int test_syscall_ring(ITesting *t) {
+    VirtualCPU vcpu;
+    vcpu.Begin(ram, 32*4096);
+
+    std::vector<uint64_t> written;
+    vcpu.RegisterSysCall(0x01, "write", [&written](Registers &regs, CPUBase *cpu) {
+        written.push_back(regs.dataRegisters[1].data.longword);
+        regs.dataRegisters[0].data.longword = regs.dataRegisters[1].data.longword * 2;
+    });
+
+    auto &mmu = vcpu.memoryUnit;
+    static const uint64_t ring = 0x4000;
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, head), 0);
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, tail), 0);
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, numEntries), 4);
+
+    // First batch, 3 requests - one unknown
+    WriteRequest(mmu, ring, 0, 0x01, 100);
+    WriteRequest(mmu, ring, 1, 0x42, 0);
+    WriteRequest(mmu, ring, 2, 0x01, 200);
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, tail), 3);
+
+    uint8_t code[] = {
+        // move.l d0, 0xffff
+        0x20,0x03,0x03,0x01, 0x00,0x00,0x00,0x00,0x00,0x00,0xff,0xff,
+        // syscall
+        OperandCode::SYS,
+        OperandCode::BRK,
+    };
+    vcpu.LoadDataToRam(0x2000, code, sizeof(code));
+    vcpu.SetInstrPtr(0x2000);
+    auto &regs = vcpu.GetRegisters();
+    regs.addressRegisters[0].data.longword = ring;
+    regs.dataRegisters[1].data.longword = 0x4711;
+    while(!vcpu.IsHalted()) {
+        vcpu.Step();
+    }
+
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 3);
+    // Guest registers are left alone
+    TR_ASSERT(t, regs.dataRegisters[1].data.longword == 0x4711);
+    TR_ASSERT(t, written.size() == 2);
+    TR_ASSERT(t, ReadResult(mmu, ring, 0) == 200);
+    TR_ASSERT(t, ReadResult(mmu, ring, 1) == 0);
+    TR_ASSERT(t, ReadResult(mmu, ring, 2) == 400);
+    TR_ASSERT(t, mmu.Read<uint64_t>(ring + offsetof(SysCallRing, head)) == 3);
+
+    // Second batch wraps around the end of the ring
+    WriteRequest(mmu, ring, 3, 0x01, 1);
+    WriteRequest(mmu, ring, 4, 0x01, 2);
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, tail), 5);
+    TR_ASSERT(t, vcpu.InvokeSysCall(kSysCall_SubmitRing));
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 2);
+    TR_ASSERT(t, written.size() == 4);
+    TR_ASSERT(t, ReadResult(mmu, ring, 3) == 2);
+    TR_ASSERT(t, ReadResult(mmu, ring, 4) == 4);
+    TR_ASSERT(t, mmu.Read<uint64_t>(ring + offsetof(SysCallRing, head)) == 5);
+
+    // Empty ring
+    TR_ASSERT(t, vcpu.InvokeSysCall(kSysCall_SubmitRing));
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0);
+    TR_ASSERT(t, written.size() == 4);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_syscall_ringcorrupt(ITesting *t) {
+    VirtualCPU vcpu;
+    vcpu.Begin(ram, 32*4096);
+
+    // Clobbers d5, the next request must not see it
+    std::vector<uint64_t> seen;
+    vcpu.RegisterSysCall(0x01, "clobber", [&seen](Registers &regs, CPUBase *cpu) {
+        seen.push_back(regs.dataRegisters[5].data.longword);
+        regs.dataRegisters[5].data.longword = 0xdead;
+    });
+
+    auto &mmu = vcpu.memoryUnit;
+    auto &regs = vcpu.GetRegisters();
+    static const uint64_t ring = 0x4000;
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, head), 0);
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, numEntries), 4);
+    regs.addressRegisters[0].data.longword = ring;
+    regs.dataRegisters[5].data.longword = 0x4711;
+
+    // Tail is more than a full ring ahead of head - rejected, nothing is processed
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, tail), 5);
+    TR_ASSERT(t, vcpu.InvokeSysCall(kSysCall_SubmitRing));
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == (uint64_t)-1);
+    TR_ASSERT(t, mmu.Read<uint64_t>(ring + offsetof(SysCallRing, head)) == 0);
+
+    // Tail behind head wraps to a huge distance - rejected as well
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, head), 2);
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, tail), 1);
+    TR_ASSERT(t, vcpu.InvokeSysCall(kSysCall_SubmitRing));
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == (uint64_t)-1);
+    TR_ASSERT(t, seen.empty());
+
+    // A full ring is fine, each request starts from the guest registers
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, head), 0);
+    for(uint64_t i=0;i<4;i++) {
+        WriteRequest(mmu, ring, i, 0x01, i);
+    }
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, tail), 4);
+    TR_ASSERT(t, vcpu.InvokeSysCall(kSysCall_SubmitRing));
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 4);
+    TR_ASSERT(t, seen.size() == 4);
+    for(auto v : seen) {
+        TR_ASSERT(t, v == 0x4711);
+    }
+    TR_ASSERT(t, regs.dataRegisters[5].data.longword == 0x4711);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_syscall_ringrange(ITesting *t) {
+    VirtualCPU vcpu;
+    vcpu.Begin(ram, 32*4096);
+
+    int nCalls = 0;
+    vcpu.RegisterSysCall(0x01, "count", [&nCalls](Registers &regs, CPUBase *cpu) {
+        nCalls++;
+    });
+
+    auto &mmu = vcpu.memoryUnit;
+    auto &regs = vcpu.GetRegisters();
+
+    // The default RAM region is 64k - header outside RAM
+    auto &ramRegion = SoC::Instance().GetMemoryRegionFromAddress(0);
+    regs.addressRegisters[0].data.longword = ramRegion.vAddrEnd + 0x100;
+    TR_ASSERT(t, vcpu.InvokeSysCall(kSysCall_SubmitRing));
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == (uint64_t)-1);
+
+    // Header fits, the entries run off the end of RAM
+    auto ring = ramRegion.vAddrEnd - 128;
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, head), 0);
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, tail), 1);
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, numEntries), 16);
+    WriteRequest(mmu, ring, 0, 0x01, 0);
+    regs.addressRegisters[0].data.longword = ring;
+    TR_ASSERT(t, vcpu.InvokeSysCall(kSysCall_SubmitRing));
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == (uint64_t)-1);
+    TR_ASSERT(t, mmu.Read<uint64_t>(ring + offsetof(SysCallRing, head)) == 0);
+
+    // The size of the entries would wrap around
+    mmu.Write<uint64_t>(ring + offsetof(SysCallRing, numEntries), uint64_t(1) << 62);
+    TR_ASSERT(t, vcpu.InvokeSysCall(kSysCall_SubmitRing));
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == (uint64_t)-1);
+    TR_ASSERT(t, nCalls == 0);
+
+    return kTR_Pass;
+}
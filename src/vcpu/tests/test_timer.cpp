@@ -5,6 +5,7 @@
 // Created by gnilk on 14.12.23.
 //
 #include <stdint.h>
+#include <string.h>
 #include <vector>
 #include <testinterface.h>
 #include <chrono>
@@ -22,6 +23,8 @@ extern "C" {
     DLL_EXPORT int test_timer_ticks1000hz(ITesting *t);
     DLL_EXPORT int test_timer_startstop(ITesting *t);
     DLL_EXPORT int test_timer_interrupt(ITesting *t);
+    DLL_EXPORT int test_timer_virtual(ITesting *t);
+    DLL_EXPORT int test_timer_virtual_startstop(ITesting *t);
 }
 
 DLL_EXPORT int test_timer(ITesting *t) {
@@ -170,3 +173,76 @@ DLL_EXPORT int test_timer_interrupt(ITesting *t) {
     return kTR_Pass;
 }
 
+static uint8_t ram[32*4096];
+
+// Run the CPU for a number of steps and return the timer0 tick counter
+static uint64_t RunVirtualTimer(uint64_t clockFreq, uint64_t timerFreq, int nSteps) {
+    memset(ram, 0, sizeof(ram));
+    VirtualCPU vcpu;
+    vcpu.SetClockFrequency(clockFreq);
+    vcpu.Begin(ram, sizeof(ram));
+    vcpu.SetInstrPtr(0x2000);
+
+    auto sysblock = vcpu.GetSystemMemoryBlock();
+    sysblock->timer0.freqSec = timerFreq;
+    sysblock->timer0.control.reset = 1;
+    sysblock->timer0.control.enable = 1;
+
+    // Memory is zero - we just execute 'brk' (0x00) and sit halted
+    for(int i=0;i<nSteps;i++) {
+        vcpu.Step();
+    }
+    return sysblock->timer0.tickCounter;
+}
+
+DLL_EXPORT int test_timer_virtual(ITesting *t) {
+    // 1MHz clock, 1kHz timer => one tick every 1000 cycles
+    auto ticks = RunVirtualTimer(1'000'000, 1000, 100'000);
+    printf("ticks=%d\n", (int)ticks);
+    // The control block is sampled at 1kHz, we might lose one tick waiting for the 'reset'
+    TR_ASSERT(t, (ticks >= 98) && (ticks <= 100));
+
+    // Deterministic, same number of steps gives the same number of ticks
+    TR_ASSERT(t, RunVirtualTimer(1'000'000, 1000, 100'000) == ticks);
+
+    // Timer runs in emulated time, not host time
+    auto ticksFastClock = RunVirtualTimer(10'000'000, 1000, 100'000);
+    TR_ASSERT(t, ticksFastClock < ticks);
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_timer_virtual_startstop(ITesting *t) {
+    memset(ram, 0, sizeof(ram));
+    VirtualCPU vcpu;
+    vcpu.SetClockFrequency(1000);
+    vcpu.Begin(ram, sizeof(ram));
+    vcpu.SetInstrPtr(0x2000);
+
+    auto sysblock = vcpu.GetSystemMemoryBlock();
+    for(int i=0;i<100;i++) {
+        vcpu.Step();
+    }
+    TR_ASSERT(t, sysblock->timer0.tickCounter == 0);
+    TR_ASSERT(t, sysblock->timer0.control.running == 0);
+
+    // 100Hz => every 10 cycles
+    sysblock->timer0.freqSec = 100;
+    sysblock->timer0.control.reset = 1;
+    sysblock->timer0.control.enable = 1;
+    for(int i=0;i<100;i++) {
+        vcpu.Step();
+    }
+    TR_ASSERT(t, sysblock->timer0.control.running == 1);
+    TR_ASSERT(t, sysblock->timer0.tickCounter >= 9);
+
+    sysblock->timer0.control.enable = 0;
+    vcpu.Step();
+    auto tc = sysblock->timer0.tickCounter;
+    for(int i=0;i<100;i++) {
+        vcpu.Step();
+    }
+    TR_ASSERT(t, sysblock->timer0.control.running == 0);
+    TR_ASSERT(t, tc == sysblock->timer0.tickCounter);
+
+    return kTR_Pass;
+}
@@ -0,0 +1,147 @@
+//
+// Created by gnilk on 19.10.26.
+//
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <testinterface.h>
+
+#include "System.h"
+#include "VirtualCPU.h"
+#include "UART.h"
+#include "MemorySubSys/MemoryUnit.h"
+
+using namespace gnilk;
+using namespace gnilk::vcpu;
+
+
+extern "C" {
+DLL_EXPORT int test_uart(ITesting *t);
+DLL_EXPORT int test_uart_tx(ITesting *t);
+DLL_EXPORT int test_uart_tx_thread(ITesting *t);
+DLL_EXPORT int test_uart_rx(ITesting *t);
+}
+
+DLL_EXPORT int test_uart(ITesting *t) {
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_uart_tx(ITesting *t) {
+    UART uart;
+    std::string output;
+    uart.SetOutputHandler([&output](const uint8_t *data, size_t nBytes) {
+        output.append((const char *)data, nBytes);
+    });
+
+    // Byte access at the data byte and full 64 bit access to the register
+    uart.Write8(offsetof(UARTRegisters, data) + 7, 'a');
+    uart.Write64(offsetof(UARTRegisters, data), 'b');
+    // Any other byte of the data register is ignored
+    uart.Write8(offsetof(UARTRegisters, data), 'c');
+    TR_ASSERT(t, !(uart.Read64(offsetof(UARTRegisters, status)) & kUARTStatus_TxEmpty));
+
+    // Not started - nothing goes out until we flush, and then in one batch
+    TR_ASSERT(t, output.empty());
+    TR_ASSERT(t, uart.FlushTx() == 2);
+    TR_ASSERT(t, output == "ab");
+    TR_ASSERT(t, uart.GetStatistics().txBatches == 1);
+
+    // Overflow the FIFO
+    for(int i=0;i<VCPU_UART_FIFO_SIZE + 10;i++) {
+        uart.Write8(offsetof(UARTRegisters, data) + 7, 'a');
+    }
+    TR_ASSERT(t, uart.Read64(offsetof(UARTRegisters, status)) & kUARTStatus_TxFull);
+    TR_ASSERT(t, uart.GetStatistics().txDropped == 10);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_uart_tx_thread(ITesting *t) {
+    UART uart;
+    std::mutex lock;
+    std::string output;
+    uart.SetOutputHandler([&](const uint8_t *data, size_t nBytes) {
+        std::lock_guard guard(lock);
+        output.append((const char *)data, nBytes);
+    });
+    TR_ASSERT(t, uart.Start());
+
+    std::string expected;
+    for(int i=0;i<100000;i++) {
+        uint8_t ch = 'a' + (i % 26);
+        // Like a guest, wait for room in the FIFO
+        while(uart.Read64(offsetof(UARTRegisters, status)) & kUARTStatus_TxFull) {
+            std::this_thread::yield();
+        }
+        uart.Write8(offsetof(UARTRegisters, data) + 7, ch);
+        expected.push_back(ch);
+    }
+    TR_ASSERT(t, uart.Stop());
+    TR_ASSERT(t, output == expected);
+    TR_ASSERT(t, uart.GetStatistics().txDropped == 0);
+    TR_ASSERT(t, uart.GetStatistics().txBytes == expected.size());
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_uart_rx(ITesting *t) {
+    static uint8_t ram[32*4096];
+    memset(ram, 0, sizeof(ram));
+    ISR_VECTOR_TABLE isrTable = {
+            .isr0 = 0x1000,
+    };
+
+    VirtualCPU vcpu;
+    vcpu.Begin(ram, sizeof(ram));
+    vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+
+    auto uart = std::make_shared<UART>();
+    TR_ASSERT(t, vcpu.AddPeripheral(INT1, 1, uart));
+    vcpu.EnableInterrupt(INT1);
+
+    auto region = SoC::Instance().GetFirstRegionMatching(kRegionFlag_HWMapping);
+    TR_ASSERT(t, region != nullptr);
+    auto hwbus = std::static_pointer_cast<HWMappedBus>(region->bus);
+    TR_ASSERT(t, uart->MapToBus(hwbus, 0x200));
+
+    MMU mmu;
+    mmu.Initialize(0);
+    uint64_t addrRegs = region->vAddrStart + 0x200;
+
+    // No interrupt until enabled
+    TR_ASSERT(t, uart->Receive("x", 1) == 1);
+    TR_ASSERT(t, !vcpu.InvokeISRHandlers());
+    TR_ASSERT(t, mmu.Read<uint8_t>(addrRegs + offsetof(UARTRegisters, data) + 7) == 'x');
+
+    UARTRegisters regs = {};
+    regs.control.rxIrqEnable = 1;
+    mmu.Write<uint64_t>(addrRegs + offsetof(UARTRegisters, controlBits), regs.controlBits);
+
+    TR_ASSERT(t, uart->Receive("abc", 3) == 3);
+    TR_ASSERT(t, vcpu.InvokeISRHandlers());
+    TR_ASSERT(t, vcpu.GetISRState(1) == CPUISRState::Executing);
+
+    TR_ASSERT(t, mmu.Read<uint64_t>(addrRegs + offsetof(UARTRegisters, rxCount)) == 3);
+    TR_ASSERT(t, mmu.Read<uint64_t>(addrRegs + offsetof(UARTRegisters, status)) & kUARTStatus_RxAvailable);
+    TR_ASSERT(t, mmu.Read<uint8_t>(addrRegs + offsetof(UARTRegisters, data) + 7) == 'a');
+    // 64 bit read, byte is the LSB
+    TR_ASSERT(t, mmu.Read<uint64_t>(addrRegs + offsetof(UARTRegisters, data)) == 'b');
+    TR_ASSERT(t, mmu.Read<uint8_t>(addrRegs + offsetof(UARTRegisters, data) + 7) == 'c');
+    TR_ASSERT(t, !(mmu.Read<uint64_t>(addrRegs + offsetof(UARTRegisters, status)) & kUARTStatus_RxAvailable));
+
+    // Overrun is reported once
+    static uint8_t flood[VCPU_UART_FIFO_SIZE + 1] = {};
+    TR_ASSERT(t, uart->Receive(flood, sizeof(flood)) == VCPU_UART_FIFO_SIZE);
+    // Narrow writes to a read-only register don't read it (which would clear the overrun)
+    mmu.Write<uint8_t>(addrRegs + offsetof(UARTRegisters, status) + 7, 0);
+    mmu.Write<uint16_t>(addrRegs + offsetof(UARTRegisters, controlBits) + 6, 1);
+    TR_ASSERT(t, mmu.Read<uint64_t>(addrRegs + offsetof(UARTRegisters, controlBits)) == 1);
+    TR_ASSERT(t, mmu.Read<uint64_t>(addrRegs + offsetof(UARTRegisters, status)) & kUARTStatus_RxOverrun);
+    TR_ASSERT(t, !(mmu.Read<uint64_t>(addrRegs + offsetof(UARTRegisters, status)) & kUARTStatus_RxOverrun));
+
+    vcpu.End();
+    return kTR_Pass;
+}
@@ -3,6 +3,7 @@
 // Note: This serves as the 'InstructionSetV1Decoder' test bed - it was written before extensions were added
 //
 #include <stdint.h>
+#include <string.h>
 #include <vector>
 #include <testinterface.h>
 
@@ -10,6 +11,8 @@
 #include "Simd/SIMDInstructionSet.h"
 
 #include "VirtualCPU.h"
+#include "System.h"
+#include "MemorySubSys/RamBus.h"
 
 using namespace gnilk;
 using namespace gnilk::vcpu;
@@ -30,6 +33,10 @@ extern "C" {
     DLL_EXPORT int test_vcpu_instr_add_immediate(ITesting *t);
     DLL_EXPORT int test_vcpu_instr_add_reg2reg(ITesting *t);
     DLL_EXPORT int test_vcpu_instr_add_overflow(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_sub(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_mul(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_div(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_logic(ITesting *t);
 
     DLL_EXPORT int test_vcpu_instr_push(ITesting *t);
     DLL_EXPORT int test_vcpu_instr_pop(ITesting *t);
@@ -44,9 +51,18 @@ extern "C" {
     DLL_EXPORT int test_vcpu_instr_cmp_absolute(ITesting *t);
     DLL_EXPORT int test_vcpu_instr_beq(ITesting *t);
     DLL_EXPORT int test_vcpu_instr_bne(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_bcc_bcs(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_jmp(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_ldl_stc(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_cas(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_cache(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_movs_fill(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_movs_overlap(ITesting *t);
+    DLL_EXPORT int test_vcpu_instr_movs_overlapint(ITesting *t);
     DLL_EXPORT int test_vcpu_halt(ITesting *t);
     DLL_EXPORT int test_vcpu_flags_orequals(ITesting *t);
     DLL_EXPORT int test_vcpu_disasm(ITesting *t);
+    DLL_EXPORT int test_vcpu_mnemonics(ITesting *t);
 
 }
 
@@ -375,6 +391,100 @@ DLL_EXPORT int test_vcpu_instr_add_reg2reg(ITesting *t) {
     return kTR_Pass;
 }
 
+DLL_EXPORT int test_vcpu_instr_sub(ITesting *t) {
+    uint8_t program[]= {
+        0x40,0x00,0x03,0x01, 0x11,      // sub.b d0, 0x11
+        0x40,0x01,0x03,0x13,            // sub.w d0, d1
+    };
+    VirtualCPU vcpu;
+    vcpu.QuickStart(program, 1024);
+    auto &regs = vcpu.GetRegisters();
+    auto &status = vcpu.GetStatusReg();
+    regs.dataRegisters[0].data.longword = 0x12345644;
+    regs.dataRegisters[1].data.longword = 0x5633;
+
+    vcpu.Step();
+    // upper bits are preserved
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x12345633);
+    vcpu.Step();
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x12340000);
+    TR_ASSERT(t, status.flags.zero == 1);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_vcpu_instr_mul(ITesting *t) {
+    uint8_t program[]= {
+        0x50,0x01,0x03,0x01, 0x00,0x10,     // mul.w d0, 0x10
+        0x50,0x00,0x13,0x01, 0x10,          // mul.b d1, 0x10
+    };
+    VirtualCPU vcpu;
+    vcpu.QuickStart(program, 1024);
+    auto &regs = vcpu.GetRegisters();
+    auto &status = vcpu.GetStatusReg();
+    regs.dataRegisters[0].data.longword = 0x0123;
+    regs.dataRegisters[1].data.longword = 0x0120;
+
+    vcpu.Step();
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x1230);
+    TR_ASSERT(t, status.flags.carry == 0);
+    TR_ASSERT(t, status.flags.overflow == 0);
+    vcpu.Step();
+    // 0x20 * 0x10 doesn't fit a byte
+    TR_ASSERT(t, regs.dataRegisters[1].data.longword == 0x0100);
+    TR_ASSERT(t, status.flags.zero == 1);
+    TR_ASSERT(t, status.flags.carry == 1);
+    TR_ASSERT(t, status.flags.overflow == 1);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_vcpu_instr_div(ITesting *t) {
+    uint8_t program[]= {
+        0x55,0x02,0x03,0x01, 0x00,0x00,0x00,0x10,       // div.d d0, 0x10
+        0x55,0x02,0x03,0x13,                            // div.d d0, d1     ; d1 = 0
+    };
+    VirtualCPU vcpu;
+    vcpu.QuickStart(program, 1024);
+    auto &regs = vcpu.GetRegisters();
+    regs.dataRegisters[0].data.longword = 0x1000;
+    regs.dataRegisters[1].data.longword = 0;
+
+    vcpu.Step();
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x100);
+    // division by zero raises an exception and leaves the destination as is
+    vcpu.Step();
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x100);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_vcpu_instr_logic(ITesting *t) {
+    uint8_t program[]= {
+        0xb0,0x00,0x03,0x01, 0x0f,      // and.b d0, 0x0f
+        0xb1,0x00,0x03,0x01, 0x80,      // or.b d0, 0x80
+        0xb2,0x00,0x03,0x13,            // xor.b d0, d1
+    };
+    VirtualCPU vcpu;
+    vcpu.QuickStart(program, 1024);
+    auto &regs = vcpu.GetRegisters();
+    auto &status = vcpu.GetStatusReg();
+    regs.dataRegisters[0].data.longword = 0x4711;
+    regs.dataRegisters[1].data.longword = 0x81;
+
+    vcpu.Step();
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x4701);
+    vcpu.Step();
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x4781);
+    TR_ASSERT(t, status.flags.negative == 1);
+    vcpu.Step();
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x4700);
+    TR_ASSERT(t, status.flags.zero == 1);
+    TR_ASSERT(t, status.flags.negative == 0);
+
+    return kTR_Pass;
+}
+
 DLL_EXPORT int test_vcpu_instr_push(ITesting *t) {
     uint8_t program[]={
         0x70,0x00,0x01, 0x43,                       // push.b 0x43
@@ -847,6 +957,361 @@ DLL_EXPORT int test_vcpu_instr_bne(ITesting *t) {
     return kTR_Pass;
 }
 
+DLL_EXPORT int test_vcpu_instr_bcc_bcs(ITesting *t) {
+    uint8_t program[]={
+        OperandCode::SEC,                   // 0
+        0xd2,0x00,0x01,0x10,                // 1, bcc.b +16     ; not taken
+        0xd3,0x00,0x01,0x01,                // 5, bcs.b +1      ; taken -> 10
+        OperandCode::BRK,                   // 9
+        OperandCode::CLC,                   // 10
+        0xd2,0x00,0x01,0xf4,                // 11, bcc.b -12    ; taken -> 3
+    };
+    VirtualCPU vcpu;
+    auto &status = vcpu.GetStatusReg();
+    vcpu.QuickStart(program, 1024);
+    auto &instrPtr = vcpu.GetInstrPtr();
+
+    vcpu.Step();
+    TR_ASSERT(t, status.flags.carry == 1);
+    vcpu.Step();
+    TR_ASSERT(t, instrPtr.data.longword == 5);
+    vcpu.Step();
+    TR_ASSERT(t, instrPtr.data.longword == 10);
+    vcpu.Step();
+    TR_ASSERT(t, status.flags.carry == 0);
+    vcpu.Step();
+    TR_ASSERT(t, instrPtr.data.longword == 3);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_vcpu_instr_jmp(ITesting *t) {
+    uint8_t program[]={
+        OperandCode::JMP,0x00,0x01,0x02,            // 0, jmp.b +2 -> 6
+        OperandCode::NOP,                           // 4
+        OperandCode::BRK,                           // 5
+        OperandCode::JMP,0x03,0x03,                 // 6, jmp.l d0
+    };
+    VirtualCPU vcpu;
+    vcpu.QuickStart(program, 1024);
+    auto &regs = vcpu.GetRegisters();
+    auto &instrPtr = vcpu.GetInstrPtr();
+    regs.dataRegisters[0].data.longword = 4;
+
+    vcpu.Step();
+    TR_ASSERT(t, instrPtr.data.longword == 6);
+    // long is absolute
+    vcpu.Step();
+    TR_ASSERT(t, instrPtr.data.longword == 4);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_vcpu_instr_ldl_stc(ITesting *t) {
+    uint8_t program[]={
+        0x98,0x03,0x03,0x80,            // ldl.l d0, (a0)
+        0x99,0x03,0x80,0x13,            // stc.l (a0), d1
+        0x99,0x03,0x80,0x13,            // stc.l (a0), d1 <- no reservation, should fail
+    };
+    // QuickStart copies the full RAM size - make sure the data we operate on is known
+    uint8_t ram[1024] = {};
+    memcpy(ram, program, sizeof(program));
+
+    VirtualCPU vcpu;
+    auto &regs = vcpu.GetRegisters();
+    auto &status = vcpu.GetStatusReg();
+
+    vcpu.QuickStart(ram, sizeof(ram));
+    regs.addressRegisters[0].data.longword = 0x200;
+    regs.dataRegisters[1].data.longword = 0x4711;
+
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0);
+
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, status.flags.zero == 1);
+
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, status.flags.zero == 0);
+
+    // Verify the store went through
+    vcpu.GetInstrPtr().data.longword = 0;
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0x4711);
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_vcpu_instr_cas(ITesting *t) {
+    uint8_t program[]={
+        0x9a,0x01,0x88,0x23,0x10,       // cas.w (a0+0x10), d2
+        0x9a,0x01,0x88,0x23,0x10,       // cas.w (a0+0x10), d2 <- d0 no longer matches, should fail
+    };
+    // QuickStart copies the full RAM size - make sure the data we operate on is known
+    uint8_t ram[1024] = {};
+    memcpy(ram, program, sizeof(program));
+
+    VirtualCPU vcpu;
+    auto &regs = vcpu.GetRegisters();
+    auto &status = vcpu.GetStatusReg();
+
+    vcpu.QuickStart(ram, sizeof(ram));
+    regs.addressRegisters[0].data.longword = 0x200;
+    regs.dataRegisters[0].data.word = 0;
+    regs.dataRegisters[2].data.word = 0x1234;
+
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, status.flags.zero == 1);
+    TR_ASSERT(t, regs.dataRegisters[0].data.word == 0);
+
+    // Failure - d0 gets the current value
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, status.flags.zero == 0);
+    TR_ASSERT(t, regs.dataRegisters[0].data.word == 0x1234);
+
+    return kTR_Pass;
+}
+
+// Read RAM behind the data cache - MMU::CopyToExtFromRam flushes the cache first
+static uint64_t ReadRamUncached(uint64_t address) {
+    uint8_t data[sizeof(uint64_t)];
+    auto ram = SoC::Instance().GetFirstRegionFromBusType<RamBus>();
+    ram->bus->ReadData(data, address, sizeof(data));
+    return MMU::FromByteStream<uint64_t>(data);
+}
+
+DLL_EXPORT int test_vcpu_instr_cache(ITesting *t) {
+    uint8_t program[]={
+        0x20,0x03,0x80,0x13,            // move.l (a0), d1
+        0xaa,0x03,0x80,                 // cclean (a0)
+        0x20,0x03,0x80,0x23,            // move.l (a0), d2
+        0xa9,0x03,0x80,                 // cinval (a0)  <- d2 is lost
+        0xab,0x03,0x80,                 // prefetch (a0)
+        0x20,0x03,0x80,0x23,            // move.l (a0), d2
+        0xa8,0x03,0x80,                 // cflush (a0)
+        0x64,                           // fence
+    };
+    // QuickStart copies the full RAM size - make sure the data we operate on is known
+    uint8_t ram[1024] = {};
+    memcpy(ram, program, sizeof(program));
+
+    VirtualCPU vcpu;
+    auto &regs = vcpu.GetRegisters();
+    auto &cacheController = vcpu.memoryUnit.GetCacheController();
+
+    vcpu.QuickStart(ram, sizeof(ram));
+    regs.addressRegisters[0].data.longword = 0x200;
+    regs.dataRegisters[1].data.longword = 0x4711;
+    regs.dataRegisters[2].data.longword = 0x4712;
+
+    // The write stays in the cache until cleaned
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, ReadRamUncached(0x200) == 0);
+    auto nInvalid = cacheController.GetInvalidLineCount();
+
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, ReadRamUncached(0x200) == 0x4711);
+    TR_ASSERT(t, cacheController.GetInvalidLineCount() == nInvalid);
+
+    // Invalidate drops the line without write back
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, ReadRamUncached(0x200) == 0x4711);
+    TR_ASSERT(t, cacheController.GetInvalidLineCount() == (nInvalid + 1));
+
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, cacheController.GetInvalidLineCount() == nInvalid);
+
+    // Flush writes back and drops the line
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, ReadRamUncached(0x200) == 0x4712);
+    TR_ASSERT(t, cacheController.GetInvalidLineCount() == (nInvalid + 1));
+
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == sizeof(program));
+
+    return kTR_Pass;
+}
+
+DLL_EXPORT int test_vcpu_instr_movs_fill(ITesting *t) {
+    uint8_t program[]={
+        0xa4,0x00,0x90,0x80,            // movs.b (a1), (a0)
+        0xa5,0x00,0x90,0x01,0x55,       // fill.b (a1), 0x55
+        0xa5,0x01,0x90,0x13,            // fill.w (a1), d1
+    };
+    static uint8_t ram[16384] = {};
+    memset(ram, 0, sizeof(ram));
+    memcpy(ram, program, sizeof(program));
+    for(int i=0;i<256;i++) {
+        ram[0x400 + i] = i;
+    }
+
+    VirtualCPU vcpu;
+    auto &regs = vcpu.GetRegisters();
+
+    vcpu.QuickStart(ram, sizeof(ram));
+
+    // Neither end is line aligned
+    regs.addressRegisters[0].data.longword = 0x405;
+    regs.addressRegisters[1].data.longword = 0x813;
+    regs.dataRegisters[0].data.longword = 200;
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0);
+    TR_ASSERT(t, regs.addressRegisters[0].data.longword == 0x405 + 200);
+    TR_ASSERT(t, regs.addressRegisters[1].data.longword == 0x813 + 200);
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 4);
+
+    // More than one chunk - the instruction re-executes until the count is zero
+    regs.addressRegisters[1].data.longword = 0x1003;
+    regs.dataRegisters[0].data.longword = 5000;
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 4);
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword < 5000);
+    TR_ASSERT(t, regs.addressRegisters[1].data.longword == 0x1003 + (5000 - regs.dataRegisters[0].data.longword));
+    while(regs.dataRegisters[0].data.longword != 0) {
+        TR_ASSERT(t, vcpu.Step());
+    }
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 9);
+    TR_ASSERT(t, regs.addressRegisters[1].data.longword == 0x1003 + 5000);
+
+    regs.addressRegisters[1].data.longword = 0x3001;
+    regs.dataRegisters[0].data.longword = 3;
+    regs.dataRegisters[1].data.longword = 0x1234;
+    TR_ASSERT(t, vcpu.Step());
+
+    vcpu.memoryUnit.CopyToExtFromRam(ram, 0, sizeof(ram));
+    TR_ASSERT(t, ram[0x812] == 0);
+    for(int i=0;i<200;i++) {
+        TR_ASSERT(t, ram[0x813 + i] == 5 + i);
+    }
+    TR_ASSERT(t, ram[0x813 + 200] == 0);
+    TR_ASSERT(t, ram[0x1002] == 0);
+    for(int i=0;i<5000;i++) {
+        TR_ASSERT(t, ram[0x1003 + i] == 0x55);
+    }
+    TR_ASSERT(t, ram[0x1003 + 5000] == 0);
+    uint8_t expectedFill[] = {0x00, 0x12, 0x34, 0x12, 0x34, 0x12, 0x34, 0x00};
+    TR_ASSERT(t, memcmp(&ram[0x3000], expectedFill, sizeof(expectedFill)) == 0);
+
+    return kTR_Pass;
+}
+
+// memmove semantics - more than one chunk in both directions
+DLL_EXPORT int test_vcpu_instr_movs_overlap(ITesting *t) {
+    uint8_t program[]={
+        0xa4,0x00,0x90,0x80,            // movs.b (a1), (a0)
+        0xa4,0x00,0x90,0x80,            // movs.b (a1), (a0)
+    };
+    static uint8_t ram[16384] = {};
+    memset(ram, 0, sizeof(ram));
+    memcpy(ram, program, sizeof(program));
+    static const size_t nBytes = 5000;
+    for(size_t i=0;i<nBytes;i++) {
+        ram[0x400 + i] = i * 7;
+    }
+
+    VirtualCPU vcpu;
+    auto &regs = vcpu.GetRegisters();
+    vcpu.QuickStart(ram, sizeof(ram));
+
+    // Up - the destination overlaps the end of the source
+    regs.addressRegisters[0].data.longword = 0x400;
+    regs.addressRegisters[1].data.longword = 0x411;
+    regs.dataRegisters[0].data.longword = nBytes;
+    // The tail goes first and the instruction re-executes, only the count moves
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 0);
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == nBytes - 4096);
+    TR_ASSERT(t, regs.addressRegisters[0].data.longword == 0x400);
+    TR_ASSERT(t, regs.addressRegisters[1].data.longword == 0x411);
+    vcpu.memoryUnit.CopyToExtFromRam(ram, 0, sizeof(ram));
+    TR_ASSERT(t, ram[0x411 + nBytes - 4096] == (uint8_t)((nBytes - 4096) * 7));
+    TR_ASSERT(t, ram[0x411 + nBytes - 1] == (uint8_t)((nBytes - 1) * 7));
+    while(vcpu.GetInstrPtr().data.longword == 0) {
+        TR_ASSERT(t, vcpu.Step());
+    }
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0);
+    TR_ASSERT(t, regs.addressRegisters[0].data.longword == 0x400);
+    TR_ASSERT(t, regs.addressRegisters[1].data.longword == 0x411);
+    vcpu.memoryUnit.CopyToExtFromRam(ram, 0, sizeof(ram));
+    for(size_t i=0;i<nBytes;i++) {
+        TR_ASSERT(t, ram[0x411 + i] == (uint8_t)(i * 7));
+    }
+
+    // And back down again
+    regs.addressRegisters[0].data.longword = 0x411;
+    regs.addressRegisters[1].data.longword = 0x400;
+    regs.dataRegisters[0].data.longword = nBytes;
+    while(regs.dataRegisters[0].data.longword != 0) {
+        TR_ASSERT(t, vcpu.Step());
+    }
+    vcpu.memoryUnit.CopyToExtFromRam(ram, 0, sizeof(ram));
+    for(size_t i=0;i<nBytes;i++) {
+        TR_ASSERT(t, ram[0x400 + i] == (uint8_t)(i * 7));
+    }
+
+    return kTR_Pass;
+}
+
+// The backwards copy is chunked as well - an interrupt is taken in between the chunks
+DLL_EXPORT int test_vcpu_instr_movs_overlapint(ITesting *t) {
+    ISR_VECTOR_TABLE isrTable = {
+            .isr1 = 0x3000,
+    };
+    uint8_t isrRoutine[]={
+            OperandCode::NOP,
+            OperandCode::RTI,
+    };
+    uint8_t program[]={
+        0xa4,0x00,0x90,0x80,            // movs.b (a1), (a0)
+        OperandCode::BRK,
+    };
+    static const size_t nBytes = 5000;
+    static uint8_t ram[32768] = {};
+    memset(ram, 0, sizeof(ram));
+    for(size_t i=0;i<nBytes;i++) {
+        ram[0x4000 + i] = i * 3;
+    }
+
+    VirtualCPU vcpu;
+    auto &regs = vcpu.GetRegisters();
+    vcpu.Begin(ram, sizeof(ram));
+    vcpu.LoadDataToRam(0, &isrTable, sizeof(isrTable));
+    vcpu.LoadDataToRam(0x3000, isrRoutine, sizeof(isrRoutine));
+    vcpu.LoadDataToRam(0x2000, program, sizeof(program));
+    vcpu.SetInstrPtr(0x2000);
+    vcpu.AddPeripheral(INT1, 1, std::make_shared<Peripheral>());
+    vcpu.EnableInterrupt(INT1);
+
+    regs.addressRegisters[0].data.longword = 0x4000;
+    regs.addressRegisters[1].data.longword = 0x4020;
+    regs.dataRegisters[0].data.longword = nBytes;
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 0x2000);
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == nBytes - 4096);
+
+    // The ISR runs before the copy is finished and the copy resumes afterwards
+    vcpu.RaiseInterrupt(1);
+    TR_ASSERT(t, vcpu.Step());
+    TR_ASSERT(t, vcpu.IsCPUISRActive());
+    TR_ASSERT(t, vcpu.GetInstrPtr().data.longword == 0x3001);
+    int nSteps = 0;
+    while(vcpu.GetInstrPtr().data.longword != 0x2004) {
+        TR_ASSERT(t, nSteps++ < 10);
+        TR_ASSERT(t, vcpu.Step());
+    }
+    TR_ASSERT(t, !vcpu.IsCPUISRActive());
+    TR_ASSERT(t, regs.dataRegisters[0].data.longword == 0);
+    TR_ASSERT(t, regs.addressRegisters[1].data.longword == 0x4020);
+
+    for(size_t i=0;i<nBytes;i++) {
+        TR_ASSERT(t, vcpu.memoryUnit.Read<uint8_t>(0x4020 + i) == (uint8_t)(i * 3));
+    }
+
+    return kTR_Pass;
+}
+
 DLL_EXPORT int test_vcpu_halt(ITesting *t) {
     uint8_t program[]={
             OperandCode::NOP, // nop
@@ -902,4 +1367,20 @@ DLL_EXPORT int test_vcpu_disasm(ITesting *t) {
     return kTR_Pass;
 }
 
-
+DLL_EXPORT int test_vcpu_mnemonics(ITesting *t) {
+    InstructionSetV1Def definition;
+    auto &table = definition.GetInstructionSet();
+    // every named op code must come back from its mnemonic
+    for(size_t opCode = 0; opCode < table.size(); opCode++) {
+        if (!table[opCode].isDefined || table[opCode].name.empty()) {
+            continue;
+        }
+        auto res = definition.GetOperandFromStr(std::string(table[opCode].name));
+        TR_ASSERT(t, res.has_value());
+        TR_ASSERT(t, *res == opCode);
+    }
+    TR_ASSERT(t, !definition.GetOperandFromStr("").has_value());
+    TR_ASSERT(t, !definition.GetOperandFromStr("movx").has_value());
+    TR_ASSERT(t, *definition.GetOperandFromStr("move") == OperandCode::MOV);
+    return kTR_Pass;
+}